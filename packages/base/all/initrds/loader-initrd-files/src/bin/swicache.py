@@ -2,64 +2,187 @@
 import argparse
 import os
 import sys
+import json
 import hashlib
 import shutil
 import logging
+import zipfile
+from multiprocessing.pool import ThreadPool
 
 logging.basicConfig()
 logger = logging.getLogger("swicache")
 logger.setLevel(logging.INFO)
 
-def filehash(fname, blocksize=1024*1024):
-   h = hashlib.sha1()
-   with open(fname,'rb') as f:
-       block = 0
-       while block != b'':
-           block = f.read(blocksize)
-           h.update(block)
-   return h.hexdigest()
+#
+# The cached SWI is described by DST.swicache:
+#
+#   size, mtime  -- of the source it was copied from
+#   manifest     -- sha1 of the source's embedded 'swi-digests' member
+#   chunk_size, chunks
+#                -- sha1 of each chunk of the cached file
+#
+# The cache is current when the source size matches and either the
+# manifest digest (when the SWI carries one) or the mtime matches.
+# Only when that fails is the source hashed, in parallel chunks, and
+# compared with the recorded chunks before deciding to copy.
+#
+CHUNK_SIZE = 4 * 1024 * 1024
+SWI_DIGESTS = 'swi-digests'
+
+def chunkhash(fname, index, chunk_size):
+    with open(fname, 'rb') as f:
+        f.seek(index * chunk_size)
+        return hashlib.sha1(f.read(chunk_size)).hexdigest()
+
+def filechunks(fname, chunk_size=CHUNK_SIZE, workers=None):
+    """sha1 of each chunk of fname, hashed concurrently.
+
+    hashlib drops the GIL for large buffers so threads are enough."""
+    size = os.path.getsize(fname)
+    count = (size + chunk_size - 1) // chunk_size
+    if workers is None:
+        try:
+            import multiprocessing
+            workers = multiprocessing.cpu_count()
+        except NotImplementedError:
+            workers = 1
+    pool = ThreadPool(max(1, min(workers, count)))
+    try:
+        return pool.map(lambda i: chunkhash(fname, i, chunk_size), range(count))
+    finally:
+        pool.close()
+        pool.join()
+
+def manifest_digest(fname):
+    """sha1 of the SWI's embedded digest list, or None for older SWIs."""
+    try:
+        z = zipfile.ZipFile(fname)
+        try:
+            if SWI_DIGESTS in z.namelist():
+                return hashlib.sha1(z.read(SWI_DIGESTS)).hexdigest()
+        finally:
+            z.close()
+    except (IOError, zipfile.BadZipfile):
+        pass
+    return None
+
+def read_meta(fname):
+    try:
+        return json.load(open(fname))
+    except (IOError, ValueError):
+        return None
+
+def write_meta(fname, meta):
+    tmp = fname + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(meta, f)
+    os.rename(tmp, fname)
+
+def meta_current(meta, src_meta, dst):
+    if meta is None or not os.path.exists(dst):
+        return False
+    if os.path.getsize(dst) != meta.get('size') or src_meta['size'] != meta.get('size'):
+        return False
+    if src_meta['manifest'] is not None:
+        return src_meta['manifest'] == meta.get('manifest')
+    return src_meta['mtime'] == meta.get('mtime')
 
-def write_hash(fname, digest):
-    open(fname, "w").write(digest)
+def verify(dst, meta_file):
+    """Re-hash the cached copy and check it against its metadata and,
+    when present, the digests embedded in the SWI itself."""
+    meta = read_meta(meta_file)
+    if meta is None:
+        return True
 
-def read_hash(fname):
-    return open(fname).read()
+    ok = filechunks(dst, meta['chunk_size'], workers=1) == meta['chunks']
+
+    if ok:
+        z = zipfile.ZipFile(dst)
+        try:
+            if SWI_DIGESTS in z.namelist():
+                digests = json.loads(z.read(SWI_DIGESTS))
+                for (name, chunks) in digests['members'].items():
+                    with z.open(name) as f:
+                        found = [ hashlib.sha1(block).hexdigest()
+                                  for block in iter(lambda: f.read(digests['chunk_size']), b'') ]
+                    if found != chunks:
+                        logger.error("%s: member %s does not match its digests" % (dst, name))
+                        ok = False
+        finally:
+            z.close()
+
+    if not ok:
+        # Force a fresh copy on the next boot.
+        logger.error("%s: cache verification failed" % dst)
+        os.unlink(meta_file)
+    return ok
+
+def verify_background(dst, meta_file):
+    if os.fork() != 0:
+        return
+    try:
+        os.setsid()
+        os.nice(19)
+        verify(dst, meta_file)
+    except Exception as e:
+        logger.error("%s: background verification: %s" % (dst, e))
+    finally:
+        os._exit(0)
 
 ap = argparse.ArgumentParser(description="SWI Cacher")
 ap.add_argument("src")
 ap.add_argument("dst")
 ap.add_argument("--force", action='store_true')
+ap.add_argument("--verify-background", action='store_true',
+                help="Re-hash the cached copy in the background.")
 
 ops = ap.parse_args()
 
-# Generate hash of the source file
-logger.info("Generating hash for %s..." % ops.src)
-src_hash = filehash(ops.src)
-logger.info("Generated hash for %s: %s" % (ops.src, src_hash))
+meta_file = "%s.swicache" % ops.dst
+
+st = os.stat(ops.src)
+src_meta = dict(size=st.st_size,
+                mtime=int(st.st_mtime),
+                manifest=manifest_digest(ops.src))
+
+meta = read_meta(meta_file)
 
-dst_hash_file = "%s.md5sum" % ops.dst
+if not ops.force and meta_current(meta, src_meta, ops.dst):
+    logger.info("Cache file is up to date.")
+    if ops.verify_background:
+        verify_background(ops.dst, meta_file)
+    sys.exit(0)
 
-if not ops.force:
-    if os.path.exists(ops.dst) and os.path.exists(dst_hash_file):
-        # Destination exists and the hash file exists.
-        dst_hash = read_hash(dst_hash_file)
-        if dst_hash == src_hash:
-           # Src and destination are the same.
-           logger.info("Cache file is up to date.")
-           sys.exit(0)
+# Metadata differs, compare content.
+logger.info("Generating chunk hashes for %s..." % ops.src)
+src_chunks = filechunks(ops.src)
+
+src_meta['chunk_size'] = CHUNK_SIZE
+src_meta['chunks'] = src_chunks
+
+if (not ops.force and meta is not None and os.path.exists(ops.dst) and
+    os.path.getsize(ops.dst) == src_meta['size'] and
+    meta.get('chunk_size') == CHUNK_SIZE and meta.get('chunks') == src_chunks):
+    logger.info("Cache file is up to date, refreshing metadata.")
+    write_meta(meta_file, src_meta)
+    if ops.verify_background:
+        verify_background(ops.dst, meta_file)
+    sys.exit(0)
 
 #
 # Either force==True, a destination file is missing, or the
 # current file is out of date.
 #
-logger.info("Updating %s --> %s, %s" % (ops.src, ops.dst, src_hash))
+logger.info("Updating %s --> %s" % (ops.src, ops.dst))
 if not os.path.isdir(os.path.dirname(ops.dst)):
    os.makedirs(os.path.dirname(ops.dst))
+if os.path.exists(meta_file):
+    os.unlink(meta_file)
 shutil.copyfile(ops.src, ops.dst)
-write_hash(dst_hash_file, src_hash);
+write_meta(meta_file, src_meta)
+# Caches written by older loaders
+if os.path.exists("%s.md5sum" % ops.dst):
+    os.unlink("%s.md5sum" % ops.dst)
 logger.info("Syncing...")
 os.system("sync")
 logger.info("Done.")
-
-
-
@@ -18,6 +18,14 @@ import onl.YamlUtils
 import subprocess
 import platform
 import ast
+import socket
+import threading
+import time
+import errno
+import fcntl
+import struct
+import ctypes
+import Queue
 
 class OnlInfoObject(object):
     DEFAULT_INDENT="    "
@@ -99,6 +107,138 @@ class PlatformInfo(object):
     CPLD_VERSIONS='CPLD Versions'
 
 
+############################################################
+#
+# Waits for sysfs paths to appear, woken by kernel uevents.
+#
+# A single netlink listener thread notifies every waiter on
+# each event and waiters re-check their path. If the netlink
+# socket cannot be opened, or the listener fails, the waiters
+# fall back to polling.
+#
+############################################################
+class OnlUeventWaiter(object):
+
+    NETLINK_KOBJECT_UEVENT = 15
+    POLL_INTERVAL = 0.05
+    # close() cannot interrupt a blocking recv() under Python 2,
+    # so the listener wakes up this often to check for it.
+    RECV_TIMEOUT = 0.25
+
+    def __init__(self):
+        self.cond = threading.Condition()
+        self.sock = None
+        self.thread = None
+        self.listening = False
+        self.closing = False
+        try:
+            sock = socket.socket(socket.AF_NETLINK, socket.SOCK_DGRAM,
+                                 self.NETLINK_KOBJECT_UEVENT)
+            sock.bind((0, 1))
+            sock.settimeout(self.RECV_TIMEOUT)
+        except (socket.error, AttributeError):
+            return
+        self.sock = sock
+        self.listening = True
+        self.thread = threading.Thread(target=self.__listen)
+        self.thread.daemon = True
+        self.thread.start()
+
+    def __listen(self):
+        try:
+            while not self.closing:
+                try:
+                    self.sock.recv(8192)
+                except socket.timeout:
+                    continue
+                except socket.error, e:
+                    # Events were dropped, the waiters re-check their paths.
+                    if e.errno != errno.ENOBUFS:
+                        raise
+                with self.cond:
+                    self.cond.notify_all()
+        except socket.error, e:
+            if not self.closing:
+                print "uevent listener failed, polling instead: %s" % e
+        finally:
+            with self.cond:
+                self.listening = False
+                self.cond.notify_all()
+
+    def wait(self, path, timeout):
+        deadline = time.time() + timeout
+        with self.cond:
+            while not os.path.exists(path):
+                remaining = deadline - time.time()
+                if remaining <= 0:
+                    return False
+                # Missed events are covered by re-checking at least once a second.
+                interval = 1.0 if self.listening else self.POLL_INTERVAL
+                self.cond.wait(min(remaining, interval))
+        return True
+
+    def close(self):
+        self.closing = True
+        if self.sock:
+            try:
+                self.sock.shutdown(socket.SHUT_RDWR)
+            except socket.error:
+                pass
+            self.thread.join()
+            self.sock.close()
+            self.sock = None
+
+
+############################################################
+#
+# SMBus access from the platform scripts, in place of
+# running i2cget/i2cset/i2cdump for each register.
+#
+############################################################
+class OnlSmbus(object):
+
+    I2C_SLAVE = 0x0703
+    I2C_SMBUS = 0x0720
+    I2C_SMBUS_WRITE = 0
+    I2C_SMBUS_READ = 1
+    I2C_SMBUS_BYTE_DATA = 2
+    I2C_SMBUS_BLOCK_DATA = 5
+    I2C_SMBUS_BLOCK_MAX = 32
+
+    def __init__(self, bus_number):
+        self.fd = os.open("/dev/i2c-%d" % bus_number, os.O_RDWR)
+        self.addr = None
+
+    def __access(self, addr, read_write, command, size, data=None):
+        if addr != self.addr:
+            fcntl.ioctl(self.fd, self.I2C_SLAVE, addr)
+            self.addr = addr
+        # union i2c_smbus_data
+        buf = ctypes.create_string_buffer(self.I2C_SMBUS_BLOCK_MAX + 2)
+        if data is not None:
+            buf[0] = chr(data)
+        # struct i2c_smbus_ioctl_data
+        args = struct.pack("BBIP", read_write, command, size, ctypes.addressof(buf))
+        fcntl.ioctl(self.fd, self.I2C_SMBUS, args)
+        return [ ord(c) for c in buf.raw ]
+
+    def read_byte_data(self, addr, command):
+        return self.__access(addr, self.I2C_SMBUS_READ, command,
+                             self.I2C_SMBUS_BYTE_DATA)[0]
+
+    def write_byte_data(self, addr, command, value):
+        self.__access(addr, self.I2C_SMBUS_WRITE, command,
+                      self.I2C_SMBUS_BYTE_DATA, value)
+
+    def read_block_data(self, addr, command):
+        data = self.__access(addr, self.I2C_SMBUS_READ, command,
+                             self.I2C_SMBUS_BLOCK_DATA)
+        return data[1:1 + data[0]]
+
+    def close(self):
+        os.close(self.fd)
+
+
 ############################################################
 #
 # ONL Platform Base
@@ -230,8 +370,8 @@ class OnlPlatformBase(object):
             for e in [ ".ko", "" ]:
                 path = os.path.join(d, "%s%s" % (module, e))
                 if os.path.exists(path):
-                    cmd = "insmod %s %s" % (path, " ".join([ "%s=%s" % (k,v) for (k,v) in params.iteritems() ]))
-                    subprocess.check_call(cmd, shell=True);
+                    cmd = [ "insmod", path ] + [ "%s=%s" % (k,v) for (k,v) in params.iteritems() ]
+                    subprocess.check_call(cmd)
                     return True
                 else:
                     trypaths.append(path)
@@ -429,6 +569,93 @@ class OnlPlatformBase(object):
         for (driver, addr, bus_number) in new_device_list:
             self.new_i2c_device(driver, addr, bus_number)
 
+    # Drivers whose probe registers new adapters. Adapter numbers are
+    # handed out in registration order, so these are never reordered.
+    I2C_MUX_DRIVERS = ( 'pca9540', 'pca9541', 'pca9542', 'pca9543', 'pca9544',
+                        'pca9545', 'pca9546', 'pca9547', 'pca9548', 'pca9846',
+                        'pca9847', 'pca9848', 'pca9849', )
+
+    I2C_BUS_TIMEOUT = 10
+    I2C_BIND_TIMEOUT = 2
+
+    def new_i2c_devices_concurrent(self, new_device_list, timeout=None):
+        """Instantiate (driver, addr, bus_number) devices concurrently.
+
+        Muxes are created in list order from the calling thread. Every
+        other device is queued to a worker for its bus, which starts
+        as soon as its first device is seen. It waits for the bus
+        adapter to appear (i.e. for the parent mux to probe), creates
+        its devices in list order and waits for each one to bind to
+        its driver. Devices on different buses, and the muxes created
+        meanwhile, probe in parallel. Returns the per-device probe
+        times."""
+
+        if timeout is None:
+            timeout = self.I2C_BUS_TIMEOUT
+
+        waiter = OnlUeventWaiter()
+        queues = {}
+        workers = []
+        stats = []
+        lock = threading.Lock()
+
+        def probe(driver, addr, bus_number):
+            bus = '/sys/bus/i2c/devices/i2c-%d' % bus_number
+            devdir = "%d-%4.4x" % (bus_number, addr)
+            start = time.time()
+            if not waiter.wait(bus, timeout):
+                status = 'no bus'
+            else:
+                self.new_device(driver, addr, bus, devdir)
+                if not os.path.exists(os.path.join(bus, devdir)):
+                    status = 'no device'
+                elif waiter.wait(os.path.join(bus, devdir, 'driver'), self.I2C_BIND_TIMEOUT):
+                    status = 'ok'
+                else:
+                    status = 'unbound'
+            with lock:
+                stats.append((driver, addr, bus_number, time.time() - start, status))
+
+        def worker(q):
+            while True:
+                d = q.get()
+                if d is None:
+                    return
+                probe(*d)
+
+        try:
+            for (driver, addr, bus_number) in new_device_list:
+                if driver in self.I2C_MUX_DRIVERS:
+                    probe(driver, addr, bus_number)
+                    continue
+                if bus_number not in queues:
+                    queues[bus_number] = Queue.Queue()
+                    t = threading.Thread(target=worker, args=(queues[bus_number],))
+                    t.start()
+                    workers.append(t)
+                queues[bus_number].put((driver, addr, bus_number))
+        finally:
+            for q in queues.values():
+                q.put(None)
+            for t in workers:
+                t.join()
+            waiter.close()
+
+        for (driver, addr, bus_number, elapsed, status) in stats:
+            if status != 'ok':
+                print "Device %s:0x%x:i2c-%d %s after %.3fs" % (driver, addr, bus_number, status, elapsed)
+        if stats:
+            slowest = max(stats, key=lambda s: s[3])
+            print "Instantiated %d i2c devices, slowest %s:0x%x:i2c-%d %.3fs" % ((len(stats),) + slowest[:4])
+
+        self.i2c_probe_times = getattr(self, 'i2c_probe_times', []) + stats
+        return stats
+
+    def i2c_probe_report(self, count=10):
+        """The slowest device probes seen by new_i2c_devices_concurrent()."""
+        stats = sorted(getattr(self, 'i2c_probe_times', []), key=lambda s: s[3], reverse=True)
+        return "\n".join("%-16s 0x%2.2x i2c-%-4d %8.3fs %s" % s for s in stats[:count])
+
     def ifnumber(self):
         # The default assumption for any platform
         # is ma1 and lo
@@ -25,6 +25,26 @@
 
 #include <faultd/faultd_config.h>
 #include <AIM/aim_pvs.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/** Maximum size of a GNU build-id */
+#define FAULTD_BUILD_ID_SIZE_MAX 20
+
+/**
+ * A loaded object (executable or shared library) referenced
+ * by a backtrace.
+ */
+typedef struct faultd_module_s {
+    /** The load base (the address bias of the object) */
+    void* base;
+    /** The GNU build-id of the object */
+    uint8_t build_id[FAULTD_BUILD_ID_SIZE_MAX];
+    /** The size of the build-id, or zero if it has none */
+    int build_id_size;
+    /** The path of the object */
+    char path[FAULTD_CONFIG_BINARY_SIZE];
+} faultd_module_t;
 
 /**
  * This structure contains the full fault information. 
@@ -58,21 +78,119 @@ typedef struct faultd_info_s {
     int backtrace_size; 
     /** The backtrace */
     void* backtrace[FAULTD_CONFIG_BACKTRACE_SIZE_MAX]; 
+    /** The index in modules[] of each backtrace address, or -1 */
+    int8_t backtrace_module[FAULTD_CONFIG_BACKTRACE_SIZE_MAX];
+
+    /** The modules referenced by the backtrace */
+    faultd_module_t modules[FAULTD_CONFIG_BACKTRACE_SIZE_MAX];
+    /** The number of modules */
+    int module_count;
 
     /** 
-     * This will store the output from backtrace_symbols_fd(). 
-     *
-     * When writing the message to the pipe, set it to non-zero. 
-     * The reader will then read additional bytes until the null 
-     * terminating byte is found. 
-     *
-     * The pointer will then be replaced on the receiving side. 
+     * The symbolized backtrace, one frame per line, as
+     * backtrace_symbols_fd() would have produced it.
      *
+     * This is never produced by the faulting process. The server
+     * fills it in from the binaries with faultd_info_symbolize().
+     * It is allocated and must be freed with aim_free().
      */
     char* backtrace_symbols;
 
 } faultd_info_t; 
     
+/**
+ * @brief Resolve the backtrace modules.
+ * @param info The fault information.
+ * @note Fills in modules[] and backtrace_module[] from the
+ * modules loaded in this process. This is async-signal-safe.
+ */
+int faultd_info_modules_resolve(faultd_info_t* info);
+
+/**
+ * @brief Refresh the table of modules loaded in this process.
+ * @note This is done by faultd_handler_register() and
+ * faultd_client_create(). Call it again after dlopen() so faults in
+ * the new modules can be symbolized.
+ */
+int faultd_modules_refresh(void);
+
+/**
+ * @brief Symbolize the backtrace from the binaries.
+ * @param info The fault information.
+ * @note Separate debug files under FAULTD_CONFIG_DEBUG_DIR are used
+ * when available. Binaries whose build-id does not match the
+ * report are not used.
+ */
+int faultd_info_symbolize(faultd_info_t* info);
+
+
+/**************************************************************************//**
+ *
+ * Binary fault reports
+ *
+ * Fault records are passed from the faulting process and stored
+ * in a compact binary format:
+ *
+ *  header    faultd_record_header_t
+ *  pcs       uint64_t[pc_count]
+ *  modules   uint8_t[pc_count], module index or 0xFF
+ *  binary    uint8_t size, bytes
+ *  module    uint64_t base, uint8_t build_id_size, build_id,
+ *            uint8_t path_size, path    (module_count times)
+ *
+ * All values are in host byte order.
+ *
+ *****************************************************************************/
+
+#define FAULTD_RECORD_MAGIC 0x46445231  /* FDR1 */
+
+typedef struct faultd_record_header_s {
+    uint32_t magic;
+    /** Total size of the record, including the header */
+    uint16_t size;
+    uint8_t pc_count;
+    uint8_t module_count;
+    uint32_t pid;
+    uint32_t tid;
+    int32_t signal;
+    int32_t signal_code;
+    int32_t last_errno;
+    uint32_t reserved;
+    uint64_t fault_address;
+} faultd_record_header_t;
+
+/**
+ * @brief Encode fault information as a binary record.
+ * @param info The fault information.
+ * @param dst The destination buffer.
+ * @param size The size of the buffer.
+ * @returns The size of the record.
+ * @note Modules which do not fit are dropped. This is async-signal-safe.
+ */
+int faultd_info_encode(faultd_info_t* info, uint8_t* dst, int size);
+
+/**
+ * @brief Decode a binary record.
+ * @param info Receives the fault information.
+ * @param src The record.
+ * @param size The size of the record.
+ */
+int faultd_info_decode(faultd_info_t* info, const uint8_t* src, int size);
+
+/**
+ * @brief Write a binary report.
+ * @param info The fault information.
+ * @param fd The output descriptor.
+ */
+int faultd_report_write(faultd_info_t* info, int fd);
+
+/**
+ * @brief Read a binary report.
+ * @param info Receives the fault information.
+ * @param fd The input descriptor.
+ * @returns 1 if a report was read, 0 at the end of the file.
+ */
+int faultd_report_read(faultd_info_t* info, int fd);
 
 
 /**************************************************************************//**
@@ -85,6 +203,9 @@ typedef struct faultd_server_s faultd_server_t;
 
 typedef int faultd_sid_t; 
 
+/** The suffix of the record ring shared with the clients of a pipe. */
+#define FAULTD_RING_SUFFIX ".ring"
+
 /**
  * @brief Create a faultd server object. 
  * @param rfso Receives the faultd_server object. 
@@ -103,6 +224,7 @@ void faultd_server_destroy(faultd_server_t* fco);
  * @param pipename The name of the pipe. 
  * @returns The service id. 
  * @note FAULTD_CONFIG_PIPE_NAME_DEFAULT will be used if pipename is NULL. 
+ * @note The record ring is created as the pipe name with FAULTD_RING_SUFFIX.
  */
 faultd_sid_t faultd_server_add(faultd_server_t* fso, char* pipename); 
 
@@ -162,9 +284,10 @@ int faultd_client_create(faultd_client_t** fco, const char* pipename);
  * @brief Send a fault message to the server. 
  * @param fco The faultd client object. 
  * @param info The fault information. 
- * @note If backtrace_symbols is not NULL, the
- * backtrace_symbols_fd() will be called on the backtrace 
- * and included in the report. 
+ * @note The record is stored in the service's shared memory ring
+ * and only its sequence number is written to the pipe. The
+ * backtrace modules are resolved if module_count is zero.
+ * This is async-signal-safe.
  */
 int faultd_client_write(faultd_client_t* fco, faultd_info_t* info); 
 
@@ -181,6 +304,15 @@ void faultd_client_destroy(faultd_client_t* fco);
  *
  *
  *****************************************************************************/
+/**
+ * @brief Register the fault handler.
+ * @param localfd If >= 0, the signal and the raw backtrace
+ * (module+offset) are also written to this descriptor.
+ * @param pipename The faultd server pipe, or NULL.
+ * @param binaryname The name reported for this process.
+ * @note The handler does not symbolize. It records the backtrace
+ * addresses and the build-id and load base of their modules.
+ */
 int faultd_handler_register(int localfd, 
                             const char* pipename, 
                             const char* binaryname); 
@@ -197,7 +329,8 @@ int faultd_handler_register(int localfd,
  * @brief Output the fault message information to the given PVS. 
  * @param info The fault message. 
  * @param pvs The output pvs. 
- * @param decode If set, the backtrace will be processing through addr2line
+ * @param decode If set, the backtrace will be symbolized with
+ * faultd_info_symbolize() if it has not been already.
  */
 int faultd_info_show(faultd_info_t* info, aim_pvs_t* pvs, int decode); 
 
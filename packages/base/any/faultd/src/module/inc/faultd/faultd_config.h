@@ -188,6 +188,46 @@
 #define FAULTD_CONFIG_MAIN_PIPENAME "/var/run/faultd.fifo"
 #endif
 
+/**
+ * FAULTD_CONFIG_RING_SLOTS
+ *
+ * Number of fault records in the shared memory ring. */
+
+
+#ifndef FAULTD_CONFIG_RING_SLOTS
+#define FAULTD_CONFIG_RING_SLOTS 16
+#endif
+
+/**
+ * FAULTD_CONFIG_RING_SLOT_SIZE
+ *
+ * Size of each fault record slot in the shared memory ring. */
+
+
+#ifndef FAULTD_CONFIG_RING_SLOT_SIZE
+#define FAULTD_CONFIG_RING_SLOT_SIZE 4096
+#endif
+
+/**
+ * FAULTD_CONFIG_MODULES_MAX
+ *
+ * Maximum number of loaded modules tracked for fault reports. */
+
+
+#ifndef FAULTD_CONFIG_MODULES_MAX
+#define FAULTD_CONFIG_MODULES_MAX 64
+#endif
+
+/**
+ * FAULTD_CONFIG_DEBUG_DIR
+ *
+ * Directory searched for separate debug files by build-id. */
+
+
+#ifndef FAULTD_CONFIG_DEBUG_DIR
+#define FAULTD_CONFIG_DEBUG_DIR "/usr/lib/debug"
+#endif
+
 
 
 /**
@@ -26,8 +26,9 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
-
-#include <execinfo.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include "faultd_int.h"
 #include "faultd_log.h"
 
 
@@ -64,6 +65,11 @@ typedef struct faultd_service_s {
      */
     int writefd;         
 
+    /**
+     * The record ring shared by the server and its clients.
+     */
+    faultd_ring_t* ring;
+
 } faultd_service_t; 
 
 
@@ -119,10 +125,68 @@ faultd_service_destroy__(faultd_service_t* sp)
         if(sp->writefd) { 
             close(sp->writefd); 
         }
+        if(sp->ring) {
+            munmap(sp->ring, FAULTD_RING_SIZE);
+        }
         AIM_MEMSET(sp, 0, sizeof(*sp)); 
     }
 }
 
+/**
+ * Map the record ring of a pipe.
+ *
+ * The server creates (or resets) the ring. Clients map an
+ * existing ring and report inline on the pipe without one.
+ */
+static faultd_ring_t*
+faultd_ring_map__(const char* pipename, int create)
+{
+    char path[PATH_MAX];
+    faultd_ring_t* ring;
+    struct stat st;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s%s", pipename, FAULTD_RING_SUFFIX);
+
+    if((fd = open(path, create ? (O_RDWR | O_CREAT) : O_RDWR, 0644)) < 0) {
+        if(create) {
+            AIM_LOG_ERROR("open(%s): %s", path, strerror(errno));
+        }
+        return NULL;
+    }
+    if(create && ftruncate(fd, FAULTD_RING_SIZE) < 0) {
+        AIM_LOG_ERROR("ftruncate(%s): %s", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    if(fstat(fd, &st) < 0 || st.st_size < FAULTD_RING_SIZE) {
+        close(fd);
+        return NULL;
+    }
+
+    ring = mmap(NULL, FAULTD_RING_SIZE, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+    close(fd);
+    if(ring == MAP_FAILED) {
+        return NULL;
+    }
+
+    if(create) {
+        AIM_MEMSET(ring, 0, FAULTD_RING_SIZE);
+        ring->slots = FAULTD_CONFIG_RING_SLOTS;
+        ring->slot_size = FAULTD_CONFIG_RING_SLOT_SIZE;
+        __sync_synchronize();
+        ring->magic = FAULTD_RING_MAGIC;
+    }
+    else if(ring->magic != FAULTD_RING_MAGIC ||
+            ring->slots != FAULTD_CONFIG_RING_SLOTS ||
+            ring->slot_size != FAULTD_CONFIG_RING_SLOT_SIZE) {
+        munmap(ring, FAULTD_RING_SIZE);
+        return NULL;
+    }
+    return ring;
+}
+
 int 
 faultd_server_add(faultd_server_t* fso, char* pipename)
 {
@@ -189,6 +253,11 @@ faultd_server_add(faultd_server_t* fso, char* pipename)
                 goto server_add_failed;
             }
 
+            /*
+             * Without the ring, clients report inline on the pipe.
+             */
+            sp->ring = faultd_ring_map__(sp->pipename, 1);
+
             /* Good to go. 'i' is the service id.  */
             return i;
         }
@@ -237,6 +306,11 @@ faultd_server_process(faultd_server_t* fdo, faultd_sid_t sid,
 
 struct faultd_client_s { 
     faultd_service_t s;
+    /** Inline report, when the server's ring is not available */
+    struct {
+        faultd_msg_t msg;
+        uint8_t record[FAULTD_RING_RECORD_SIZE];
+    } __attribute__((packed)) inline_report;
 }; /* faultd_client_t */
 
 int
@@ -265,6 +339,9 @@ faultd_client_create(faultd_client_t** rfco, const char* pipename)
     }
     fco->s.pipefd = rv; 
 
+    fco->s.ring = faultd_ring_map__(fco->s.pipename, 0);
+    faultd_modules_refresh();
+
     *rfco = fco; 
     return 0; 
     
@@ -282,37 +359,6 @@ faultd_client_destroy(faultd_client_t* fco)
     }
 }
 
-static int
-read_until__(int fd, char terminator, char* dst, int size)
-{
-    int rv; 
-    int count = 0;
-    char c; 
-
-    do { 
-        rv = read(fd, &c, 1); 
-        if(rv < 0) { 
-            if(errno == EINTR) { 
-                continue; 
-            }
-            else {
-                return rv; 
-            }
-        }
-        if(count < size) { 
-            dst[count] = c; 
-        }
-        if(c == terminator) { 
-            return count; 
-        }
-        count++; 
-    
-        /* Fixme - need a timeout */
-    } while(1);
-}
-
-
-
 static int
 read_size__(int fd, char* dst, int size)
 {
@@ -426,6 +472,49 @@ faultd_wait_services__(faultd_server_t* fso, int sid, fd_set* rfds)
 }
 
 
+/**
+ * Read the next fault message on a service pipe and decode its record.
+ */
+static int
+faultd_service_read__(faultd_service_t* sp, faultd_info_t* info)
+{
+    faultd_msg_t msg;
+    faultd_ring_slot_t* slot;
+    uint8_t record[FAULTD_RING_RECORD_SIZE];
+
+    if(read_size__(sp->pipefd, (char*)&msg, sizeof(msg)) < 0) {
+        return -1;
+    }
+    if(msg.magic != FAULTD_MSG_MAGIC || msg.size > sizeof(record)) {
+        return -1;
+    }
+
+    if(msg.seq == 0) {
+        /* Inline record */
+        if(read_size__(sp->pipefd, (char*)record, msg.size) < 0) {
+            return -1;
+        }
+    }
+    else {
+        if(sp->ring == NULL) {
+            return -1;
+        }
+        slot = FAULTD_RING_SLOT(sp->ring, msg.seq);
+        if(slot->seq != msg.seq) {
+            AIM_LOG_ERROR("fault record %u was overwritten.", msg.seq);
+            return -1;
+        }
+        FAULTD_MEMCPY(record, slot->data, msg.size);
+        __sync_synchronize();
+        if(slot->seq != msg.seq) {
+            AIM_LOG_ERROR("fault record %u was overwritten.", msg.seq);
+            return -1;
+        }
+    }
+
+    return faultd_info_decode(info, record, msg.size);
+}
+
 int 
 faultd_server_read(faultd_server_t* fso, faultd_info_t* info, int sid)
 {
@@ -455,26 +544,13 @@ faultd_server_read(faultd_server_t* fso, faultd_info_t* info, int sid)
         i++, count++) { 
         int s = i % AIM_ARRAYSIZE(fso->services); 
         if(FD_ISSET(fso->services[s].pipefd, &rfds)) { 
-            rv = read_size__(fso->services[s].pipefd, (char*)info, sizeof(*info)); 
+            rv = faultd_service_read__(fso->services + s, info); 
     
             if(rv < 0) { 
                 /* Do something here, like restare the pipe */
-                AIM_LOG_ERROR("truncated read on pipe."); 
+                AIM_LOG_ERROR("invalid fault message on pipe."); 
                 continue; 
             }
-            
-            /**
-             * Backtrace symbols information available? 
-             */
-            if(info->backtrace_symbols) { 
-                /*
-                 * The backtrace symbol information is of variable length. 
-                 */
-                info->backtrace_symbols = aim_zmalloc(FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE); 
-                /* Backtrace symbols are terminated with a null character. */
-                read_until__(fso->services[s].pipefd, 0, info->backtrace_symbols, 
-                             FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE); 
-            }
 
             info->pipename = fso->services[s].pipename; 
             fso->sid_last = s; 
@@ -489,20 +565,289 @@ faultd_server_read(faultd_server_t* fso, faultd_info_t* info, int sid)
 int
 faultd_client_write(faultd_client_t* fco, faultd_info_t* info)
 {
-    int rv = write_size__(fco->s.pipefd, (char*)info, sizeof(*info)); 
-    
-    if(rv < 0) { 
-        return rv; 
+    faultd_ring_t* ring = fco->s.ring;
+    faultd_msg_t msg;
+    int size;
+
+    if(info->module_count == 0) {
+        faultd_info_modules_resolve(info);
+    }
+
+    msg.magic = FAULTD_MSG_MAGIC;
+
+    if(ring) {
+        faultd_ring_slot_t* slot;
+        uint32_t seq;
+
+        /* Sequence number zero means an inline record. */
+        while((seq = __sync_add_and_fetch(&ring->head, 1)) == 0);
+
+        slot = FAULTD_RING_SLOT(ring, seq);
+        slot->seq = 0;
+        __sync_synchronize();
+        size = faultd_info_encode(info, slot->data, FAULTD_RING_RECORD_SIZE);
+        if(size < 0) {
+            /* The slot stays unpublished (seq zero). */
+            return -1;
+        }
+        slot->size = size;
+        __sync_synchronize();
+        slot->seq = seq;
+
+        msg.seq = seq;
+        msg.size = size;
+        return (write_size__(fco->s.pipefd, (char*)&msg, sizeof(msg)) < 0) ? -1 : 0;
     }
 
-    if(info->backtrace_symbols) { 
-        char c = 0; 
-        backtrace_symbols_fd(info->backtrace, info->backtrace_size, 
-                             fco->s.pipefd); 
-        /* Terminate backtrace symbols with a null character. */
-        write_size__(fco->s.pipefd, &c, 1); 
+    size = faultd_info_encode(info, fco->inline_report.record,
+                              sizeof(fco->inline_report.record));
+    if(size < 0) {
+        return -1;
     }
-    return 0; 
+    msg.seq = 0;
+    msg.size = size;
+    fco->inline_report.msg = msg;
+    return (write_size__(fco->s.pipefd, (char*)&fco->inline_report,
+                         sizeof(msg) + size) < 0) ? -1 : 0;
+}
+
+/*
+ * Binary record encoding. These are used in the fault handler
+ * and must remain async-signal-safe.
+ */
+static int
+put__(uint8_t** p, uint8_t* end, const void* src, int size)
+{
+    if(end - *p < size) {
+        return -1;
+    }
+    FAULTD_MEMCPY(*p, src, size);
+    *p += size;
+    return 0;
+}
+
+static int
+put_string__(uint8_t** p, uint8_t* end, const char* str)
+{
+    uint8_t len;
+    for(len = 0; len < 0xFF && str[len]; len++);
+    if(put__(p, end, &len, 1) < 0) {
+        return -1;
+    }
+    return put__(p, end, str, len);
+}
+
+static int
+get__(const uint8_t** p, const uint8_t* end, void* dst, int size)
+{
+    if(end - *p < size) {
+        return -1;
+    }
+    FAULTD_MEMCPY(dst, *p, size);
+    *p += size;
+    return 0;
+}
+
+static int
+get_string__(const uint8_t** p, const uint8_t* end, char* dst, int size)
+{
+    uint8_t len;
+    if(get__(p, end, &len, 1) < 0 || end - *p < len) {
+        return -1;
+    }
+    if(len >= size) {
+        /* Truncate */
+        FAULTD_MEMCPY(dst, *p, size - 1);
+        dst[size - 1] = 0;
+    }
+    else {
+        FAULTD_MEMCPY(dst, *p, len);
+        dst[len] = 0;
+    }
+    *p += len;
+    return 0;
+}
+
+int
+faultd_info_encode(faultd_info_t* info, uint8_t* dst, int size)
+{
+    faultd_record_header_t h;
+    uint8_t* end = dst + (size > 0xFFFF ? 0xFFFF : size);
+    uint8_t* p = dst + sizeof(h);
+    uint8_t* index;
+    int pcs = info->backtrace_size;
+    int modules = 0;
+    int i;
+
+    if(size < sizeof(h)) {
+        return -1;
+    }
+    if(pcs < 0) {
+        pcs = 0;
+    }
+    if(pcs > FAULTD_CONFIG_BACKTRACE_SIZE_MAX) {
+        pcs = FAULTD_CONFIG_BACKTRACE_SIZE_MAX;
+    }
+
+    for(i = 0; i < pcs; i++) {
+        uint64_t pc = (uintptr_t)info->backtrace[i];
+        if(put__(&p, end, &pc, sizeof(pc)) < 0) {
+            pcs = i;
+            break;
+        }
+    }
+
+    /* Module indices, filled in once we know which modules fit. */
+    index = p;
+    if(end - p < pcs) {
+        return -1;
+    }
+    p += pcs;
+
+    if(put_string__(&p, end, info->binary) < 0) {
+        return -1;
+    }
+
+    for(i = 0; i < info->module_count && i < 0xFF; i++) {
+        faultd_module_t* m = info->modules + i;
+        uint8_t* start = p;
+        uint64_t base = (uintptr_t)m->base;
+        uint8_t id_size = m->build_id_size;
+
+        if(put__(&p, end, &base, sizeof(base)) < 0 ||
+           put__(&p, end, &id_size, 1) < 0 ||
+           put__(&p, end, m->build_id, id_size) < 0 ||
+           put_string__(&p, end, m->path) < 0) {
+            /* Does not fit */
+            p = start;
+            break;
+        }
+        modules++;
+    }
+
+    for(i = 0; i < pcs; i++) {
+        int m = info->backtrace_module[i];
+        index[i] = (m >= 0 && m < modules) ? m : 0xFF;
+    }
+
+    FAULTD_MEMSET(&h, 0, sizeof(h));
+    h.magic = FAULTD_RECORD_MAGIC;
+    h.size = p - dst;
+    h.pc_count = pcs;
+    h.module_count = modules;
+    h.pid = info->pid;
+    h.tid = info->tid;
+    h.signal = info->signal;
+    h.signal_code = info->signal_code;
+    h.last_errno = info->last_errno;
+    h.fault_address = (uintptr_t)info->fault_address;
+    FAULTD_MEMCPY(dst, &h, sizeof(h));
+
+    return h.size;
+}
+
+int
+faultd_info_decode(faultd_info_t* info, const uint8_t* src, int size)
+{
+    faultd_record_header_t h;
+    const uint8_t* p = src;
+    const uint8_t* end;
+    int i;
+
+    FAULTD_MEMSET(info, 0, sizeof(*info));
+
+    if(get__(&p, src + size, &h, sizeof(h)) < 0 ||
+       h.magic != FAULTD_RECORD_MAGIC || h.size > size ||
+       h.pc_count > FAULTD_CONFIG_BACKTRACE_SIZE_MAX ||
+       h.module_count > FAULTD_CONFIG_BACKTRACE_SIZE_MAX) {
+        return -1;
+    }
+    end = src + h.size;
+
+    info->pid = h.pid;
+    info->tid = h.tid;
+    info->signal = h.signal;
+    info->signal_code = h.signal_code;
+    info->last_errno = h.last_errno;
+    info->fault_address = (void*)(uintptr_t)h.fault_address;
+
+    info->backtrace_size = h.pc_count;
+    for(i = 0; i < h.pc_count; i++) {
+        uint64_t pc;
+        if(get__(&p, end, &pc, sizeof(pc)) < 0) {
+            return -1;
+        }
+        info->backtrace[i] = (void*)(uintptr_t)pc;
+    }
+    for(i = 0; i < h.pc_count; i++) {
+        uint8_t m;
+        if(get__(&p, end, &m, 1) < 0) {
+            return -1;
+        }
+        info->backtrace_module[i] = (m < h.module_count) ? m : -1;
+    }
+
+    if(get_string__(&p, end, info->binary, sizeof(info->binary)) < 0) {
+        return -1;
+    }
+
+    info->module_count = h.module_count;
+    for(i = 0; i < h.module_count; i++) {
+        faultd_module_t* m = info->modules + i;
+        uint64_t base;
+        uint8_t id_size;
+
+        if(get__(&p, end, &base, sizeof(base)) < 0 ||
+           get__(&p, end, &id_size, 1) < 0 ||
+           id_size > FAULTD_BUILD_ID_SIZE_MAX ||
+           get__(&p, end, m->build_id, id_size) < 0 ||
+           get_string__(&p, end, m->path, sizeof(m->path)) < 0) {
+            return -1;
+        }
+        m->base = (void*)(uintptr_t)base;
+        m->build_id_size = id_size;
+    }
+    return 0;
+}
+
+int
+faultd_report_write(faultd_info_t* info, int fd)
+{
+    uint8_t record[FAULTD_RING_RECORD_SIZE];
+    int size = faultd_info_encode(info, record, sizeof(record));
+
+    if(size < 0) {
+        return size;
+    }
+    return (write_size__(fd, (char*)record, size) < 0) ? -1 : 0;
+}
+
+int
+faultd_report_read(faultd_info_t* info, int fd)
+{
+    faultd_record_header_t h;
+    uint8_t* record;
+    int rv;
+
+    do {
+        rv = read(fd, &h, sizeof(h));
+    } while(rv < 0 && errno == EINTR);
+
+    if(rv == 0) {
+        return 0;
+    }
+    if(rv != sizeof(h) || h.magic != FAULTD_RECORD_MAGIC || h.size < sizeof(h)) {
+        return -1;
+    }
+
+    record = aim_zmalloc(h.size);
+    FAULTD_MEMCPY(record, &h, sizeof(h));
+    rv = read_size__(fd, (char*)record + sizeof(h), h.size - sizeof(h));
+    if(rv >= 0) {
+        rv = faultd_info_decode(info, record, h.size);
+    }
+    aim_free(record);
+    return (rv < 0) ? -1 : 1;
 }
 
 int
@@ -521,18 +866,22 @@ faultd_info_show(faultd_info_t* info, aim_pvs_t* pvs, int decode)
     for(i = 0; i < info->backtrace_size; i++) { 
         aim_printf(pvs, "    %p\n", info->backtrace[i]); 
     }
+    aim_printf(pvs, "modules=%d\n", info->module_count);
+    for(i = 0; i < info->module_count; i++) {
+        faultd_module_t* m = info->modules + i;
+        int b;
+        aim_printf(pvs, "    %p %s ", m->base, m->path);
+        for(b = 0; b < m->build_id_size; b++) {
+            aim_printf(pvs, "%02x", m->build_id[b]);
+        }
+        aim_printf(pvs, "\n");
+    }
+    if(decode && info->backtrace_symbols == NULL) {
+        faultd_info_symbolize(info);
+    }
     aim_printf(pvs, "backtrace_symbols: %p\n", info->backtrace_symbols); 
     if(info->backtrace_symbols) {
         aim_printf(pvs, "%s\n", info->backtrace_symbols); 
     }
     return 0; 
-}       
-        
-
-
-
-        
-    
-    
-    
-    
+}
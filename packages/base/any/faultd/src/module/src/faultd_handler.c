@@ -24,6 +24,7 @@
 
 #include <faultd/faultd.h>
 #include <AIM/aim.h>
+#include "faultd_int.h"
 
 #include <stdio.h>
 #include <unistd.h>
@@ -71,7 +72,89 @@ int signal_backtrace__(void** buffer, int size, ucontext_t* context,
     }
     return rv;
 }
-  #include <AIM/aim_pvs.h>
+/*
+ * Async-signal-safe formatting for the local descriptor.
+ */
+static char*
+fmt_hex__(char* dst, uintptr_t v)
+{
+    char tmp[2 * sizeof(v)];
+    int n = 0;
+
+    *dst++ = '0';
+    *dst++ = 'x';
+    do {
+        tmp[n++] = "0123456789abcdef"[v & 0xF];
+        v >>= 4;
+    } while(v);
+    while(n) {
+        *dst++ = tmp[--n];
+    }
+    return dst;
+}
+
+static char*
+fmt_dec__(char* dst, int v)
+{
+    char tmp[12];
+    int n = 0;
+    unsigned int u = (v < 0) ? -(unsigned int)v : v;
+
+    if(v < 0) {
+        *dst++ = '-';
+    }
+    do {
+        tmp[n++] = '0' + (u % 10);
+        u /= 10;
+    } while(u);
+    while(n) {
+        *dst++ = tmp[--n];
+    }
+    return dst;
+}
+
+static char*
+fmt_str__(char* dst, const char* src, int size)
+{
+    return dst + faultd_strlcpy(dst, src, size);
+}
+
+/*
+ * Write the signal and the raw backtrace, as module+offset, to
+ * the local descriptor. These can be symbolized offline
+ * (addr2line -e module offset).
+ */
+static void
+faultd_local_write__(int fd, faultd_info_t* info)
+{
+    char line[FAULTD_CONFIG_BINARY_SIZE + 64];
+    char* p;
+    int i;
+
+    p = fmt_str__(line, "signal ", 8);
+    p = fmt_dec__(p, info->signal);
+    *p++ = '\n';
+    write(fd, line, p - line);
+
+    for(i = 0; i < info->backtrace_size; i++) {
+        int m = info->backtrace_module[i];
+        uintptr_t pc = (uintptr_t)info->backtrace[i];
+
+        p = line;
+        if(m >= 0) {
+            p = fmt_str__(p, info->modules[m].path, FAULTD_CONFIG_BINARY_SIZE);
+            *p++ = '+';
+            p = fmt_hex__(p, pc - (uintptr_t)info->modules[m].base);
+            *p++ = ' ';
+        }
+        *p++ = '[';
+        p = fmt_hex__(p, pc);
+        *p++ = ']';
+        *p++ = '\n';
+        write(fd, line, p - line);
+    }
+}
+
 static void
 faultd_signal_handler__(int signal, siginfo_t* siginfo, void* context)
 {
@@ -91,9 +174,15 @@ faultd_signal_handler__(int signal, siginfo_t* siginfo, void* context)
 
     /*
      * Generate our fault information.
+     *
+     * Only raw addresses and the modules they belong to are
+     * recorded here. Symbolization is left to the faultd server,
+     * so nothing in the handler allocates, takes locks or reads
+     * the binaries, and the process can exit (and be restarted)
+     * as soon as possible.
      */
     faultd_info__.pid = getpid();
-    faultd_info__.tid = 0;
+    faultd_info__.tid = syscall(SYS_gettid);
     faultd_info__.signal = signal;
     faultd_info__.signal_code = siginfo->si_code;
     faultd_info__.fault_address = siginfo->si_addr;
@@ -102,18 +191,13 @@ faultd_signal_handler__(int signal, siginfo_t* siginfo, void* context)
     faultd_info__.backtrace_size = signal_backtrace__(faultd_info__.backtrace,
                                                       AIM_ARRAYSIZE(faultd_info__.backtrace),
                                                       context, 0);
-    faultd_info__.backtrace_symbols = (void*)1;
+    faultd_info_modules_resolve(&faultd_info__);
+
     if(faultd_client__) {
         faultd_client_write(faultd_client__, &faultd_info__);
     }
     if(localfd__ >= 0) {
-        char* signame = strsignal(faultd_info__.signal);
-        char* nl = "\n";
-        write(localfd__, signame, strlen(signame)+1);
-        write(localfd__, nl, 2);
-        backtrace_symbols_fd(faultd_info__.backtrace,
-                             faultd_info__.backtrace_size,
-                             localfd__);
+        faultd_local_write__(localfd__, &faultd_info__);
     }
 
     /*
@@ -131,28 +215,24 @@ faultd_handler_register(int localfd,
     int rv;
     struct sigaction saction;
     void* dummy_backtrace[1];
-    int dummy_backtrace_size;
-    int fd;
 
     if ( (rv = pthread_spin_init(&thread_lock__, 0)) ) {
         return rv;
     }
 
     /*
-     * These calls to backtrace are to assure that
-     * backtrace() and backtrace_symbols_fd() have actually
-     * been loaded into our process -- its possible they
-     * come from a dynamic library, and we don't want them
+     * This call to backtrace is to assure that backtrace() has
+     * actually been loaded into our process -- its possible it
+     * comes from a dynamic library, and we don't want it
      * to get loaded at fault-time.
      */
-    dummy_backtrace_size = backtrace(dummy_backtrace, 1);
+    backtrace(dummy_backtrace, 1);
 
-    /** Note - we could just pass an invalid descriptor here, but it
-     * it flags errors in valgrind.
+    /*
+     * The modules are recorded now, so the handler does not
+     * need the dynamic loader.
      */
-    fd = open("/dev/null", O_WRONLY);
-    backtrace_symbols_fd(dummy_backtrace, dummy_backtrace_size, fd);
-    close(fd);
+    faultd_modules_refresh();
 
     AIM_MEMSET(&faultd_info__, 0, sizeof(faultd_info__));
     if(!binaryname) {
@@ -25,6 +25,78 @@
 #define __FAULTD_INT_H__
 
 #include <faultd/faultd_config.h>
+#include <faultd/faultd.h>
+
+/**
+ * Record ring.
+ *
+ * The server creates the ring next to its pipe and the clients
+ * map it when they are created, so nothing needs to be allocated
+ * or opened in the fault handler. A client claims a slot with an
+ * atomic increment of head, writes the record, publishes the
+ * slot's sequence number and writes a faultd_msg_t with that
+ * sequence number to the pipe.
+ */
+#define FAULTD_RING_MAGIC 0x46445247  /* FDRG */
+
+typedef struct faultd_ring_s {
+    uint32_t magic;
+    uint32_t slots;
+    uint32_t slot_size;
+    /** Sequence number of the last claimed slot */
+    uint32_t head;
+    uint8_t reserved[48];
+} faultd_ring_t;
+
+typedef struct faultd_ring_slot_s {
+    /** Sequence number of the record, zero while it is written */
+    volatile uint32_t seq;
+    uint32_t size;
+    uint8_t data[];
+} faultd_ring_slot_t;
+
+#define FAULTD_RING_SIZE                                                \
+    (sizeof(faultd_ring_t) + FAULTD_CONFIG_RING_SLOTS * FAULTD_CONFIG_RING_SLOT_SIZE)
+
+#define FAULTD_RING_RECORD_SIZE                                         \
+    (FAULTD_CONFIG_RING_SLOT_SIZE - sizeof(faultd_ring_slot_t))
+
+/*
+ * The ring header is writable by the clients. Slots are located with
+ * the compile-time geometry, never with the header's slots and
+ * slot_size, so a bad client cannot move the server outside the ring.
+ */
+#define FAULTD_RING_SLOT(_ring, _seq)                                   \
+    ((faultd_ring_slot_t*)((uint8_t*)(_ring) + sizeof(faultd_ring_t) + \
+                           (((_seq) - 1) % FAULTD_CONFIG_RING_SLOTS) *  \
+                           FAULTD_CONFIG_RING_SLOT_SIZE))
+
+/**
+ * Pipe message.
+ *
+ * If seq is zero the client could not map the ring and the
+ * record (size bytes) follows the message on the pipe.
+ */
+#define FAULTD_MSG_MAGIC 0x4644534d  /* FDSM */
+
+typedef struct faultd_msg_s {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t size;
+} faultd_msg_t;
+
+/**
+ * Find the GNU build-id in a block of ELF notes.
+ * Returns the size of the build-id, or 0.
+ */
+int faultd_notes_build_id(const uint8_t* notes, uint64_t size,
+                          uint8_t* build_id);
+
+/**
+ * Async-signal-safe bounded string copy.
+ * Returns the length of the result.
+ */
+int faultd_strlcpy(char* dst, const char* src, int size);
 
 
 #endif /* __FAULTD_INT_H__ */
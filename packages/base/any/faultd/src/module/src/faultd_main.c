@@ -36,6 +36,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <fcntl.h>
 
 AIM_LOG_STRUCT_DEFINE(
                       AIM_LOG_OPTIONS_DEFAULT,
@@ -44,6 +45,7 @@ AIM_LOG_STRUCT_DEFINE(
 
 
 static int test__(const char* binaryname, const char* pipename);
+static int show__(const char* reportfile);
 
 /**
  * Basic faultd Agent
@@ -60,7 +62,7 @@ static char help__[] =
 \n\
 SYNOPSIS\n\
 \n\
-        faultd [-dr|-d] [-pid file] [-t] [-h | --help]\n\
+        faultd [-dr|-d] [-pid file] [-r file] [-s file] [-t] [-h | --help]\n\
 \n\
 OPTIONS\n\
         -d            Daemonize.\n\
@@ -69,6 +71,10 @@ OPTIONS\n\
         -p            Server pipe. Default is %s\n\
 \n\
         -pid file     Write PID to the given filename.\n\
+\n\
+        -r file       Append binary fault reports to the given file.\n\
+\n\
+        -s file       Symbolize and show the fault reports in the given file.\n\
 \n\
         -t            Test mode. Sends a test backtrace the the existing faultd\n\
                       server.\n\
@@ -84,6 +90,9 @@ faultd_main(int argc, char* argv[])
     char** arg;
 
     char* pidfile = NULL;
+    char* reportfile = NULL;
+    char* showfile = NULL;
+    int reportfd = -1;
     int daemonize = 0;
     int restart = 0;
     int test = 0;
@@ -119,6 +128,22 @@ faultd_main(int argc, char* argv[])
                 exit(1);
             }
         }
+        else if(!strcmp(*arg, "-r")) {
+            arg++;
+            reportfile = *arg;
+            if(!reportfile) {
+                fprintf(stderr, "-r requires an argument.\n");
+                exit(1);
+            }
+        }
+        else if(!strcmp(*arg, "-s")) {
+            arg++;
+            showfile = *arg;
+            if(!showfile) {
+                fprintf(stderr, "-s requires an argument.\n");
+                exit(1);
+            }
+        }
         else if(!strcmp(*arg, "-t")) {
             test = 1;
         }
@@ -132,6 +157,10 @@ faultd_main(int argc, char* argv[])
         return test__(argv[0], pipename);
     }
 
+    if(showfile) {
+        return show__(showfile);
+    }
+
     /**
      * Start Server
      */
@@ -184,21 +213,59 @@ faultd_main(int argc, char* argv[])
         fclose(fp);
     }
 
+    if(reportfile) {
+        reportfd = open(reportfile, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if(reportfd < 0) {
+            aim_printf(aim_pvs_syslog, "open(%s): %s\n",
+                       reportfile, strerror(errno));
+        }
+    }
+
     /**
      * Process Fault Messages
+     *
+     * The faulting process only sends raw addresses. They are
+     * symbolized here, after it has already exited.
      */
     for(;;) {
         faultd_info_t faultd_info;
         memset(&faultd_info, 0, sizeof(faultd_info));
         if(faultd_server_read(faultd_server, &faultd_info, sid) >= 0) {
-            faultd_info_show(&faultd_info, aim_pvs_syslog, 0);
+            if(reportfd >= 0) {
+                faultd_report_write(&faultd_info, reportfd);
+            }
+            faultd_info_show(&faultd_info, aim_pvs_syslog, 1);
             if(aim_pvs_isatty(&aim_pvs_stderr)) {
-                faultd_info_show(&faultd_info, &aim_pvs_stderr, 0);
+                faultd_info_show(&faultd_info, &aim_pvs_stderr, 1);
             }
+            aim_free(faultd_info.backtrace_symbols);
         }
     }
 }
 
+static int
+show__(const char* reportfile)
+{
+    faultd_info_t faultd_info;
+    int fd, rv;
+
+    if((fd = open(reportfile, O_RDONLY)) < 0) {
+        fprintf(stderr, "open(%s): %s\n", reportfile, strerror(errno));
+        return 1;
+    }
+    while((rv = faultd_report_read(&faultd_info, fd)) > 0) {
+        faultd_info.pipename = (char*)reportfile;
+        faultd_info_show(&faultd_info, &aim_pvs_stdout, 1);
+        aim_free(faultd_info.backtrace_symbols);
+    }
+    close(fd);
+    if(rv < 0) {
+        fprintf(stderr, "%s: invalid fault report.\n", reportfile);
+        return 1;
+    }
+    return 0;
+}
+
 static int
 test__(const char* binaryname, const char* pipename)
 {
@@ -0,0 +1,208 @@
+/**************************************************************************//**
+ * <bsn.cl fy=2013 v=onl>
+ *
+ *        Copyright 2013, 2014 BigSwitch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ *****************************************************************************
+ *
+ * Loaded module table.
+ *
+ * The load base, address range and build-id of every object in
+ * the process are collected ahead of time, so the fault handler
+ * can attribute backtrace addresses without calling into the
+ * dynamic loader.
+ *
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <faultd/faultd_config.h>
+#include <faultd/faultd.h>
+#include "faultd_int.h"
+
+#include <link.h>
+#include <elf.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct faultd_module_entry_s {
+    uintptr_t base;
+    uintptr_t start;
+    uintptr_t end;
+    uint8_t build_id[FAULTD_BUILD_ID_SIZE_MAX];
+    int build_id_size;
+    char path[FAULTD_CONFIG_BINARY_SIZE];
+} faultd_module_entry_t;
+
+typedef struct faultd_module_table_s {
+    faultd_module_entry_t entries[FAULTD_CONFIG_MODULES_MAX];
+    int count;
+} faultd_module_table_t;
+
+/*
+ * Two tables, so a refresh never modifies the table the
+ * fault handler may be reading.
+ */
+static faultd_module_table_t tables__[2];
+static faultd_module_table_t* volatile current__ = NULL;
+static pthread_mutex_t refresh_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+int
+faultd_strlcpy(char* dst, const char* src, int size)
+{
+    int i;
+    if(size <= 0) {
+        return 0;
+    }
+    for(i = 0; i < size - 1 && src[i]; i++) {
+        dst[i] = src[i];
+    }
+    dst[i] = 0;
+    return i;
+}
+
+int
+faultd_notes_build_id(const uint8_t* notes, uint64_t size, uint8_t* build_id)
+{
+    uint64_t offset = 0;
+
+    while(offset + sizeof(ElfW(Nhdr)) <= size) {
+        const ElfW(Nhdr)* n = (const ElfW(Nhdr)*)(notes + offset);
+        uint64_t name = offset + sizeof(*n);
+        uint64_t desc = name + ((n->n_namesz + 3) & ~3);
+        uint64_t next = desc + ((n->n_descsz + 3) & ~3);
+
+        if(next > size) {
+            break;
+        }
+        if(n->n_type == NT_GNU_BUILD_ID && n->n_namesz == 4 &&
+           !memcmp(notes + name, "GNU", 4)) {
+            int len = n->n_descsz;
+            if(len > FAULTD_BUILD_ID_SIZE_MAX) {
+                len = FAULTD_BUILD_ID_SIZE_MAX;
+            }
+            memcpy(build_id, notes + desc, len);
+            return len;
+        }
+        offset = next;
+    }
+    return 0;
+}
+
+static int
+faultd_modules_add__(struct dl_phdr_info* info, size_t size, void* cookie)
+{
+    faultd_module_table_t* table = cookie;
+    faultd_module_entry_t* e;
+    int i;
+
+    if(table->count == FAULTD_CONFIG_MODULES_MAX) {
+        return 1;
+    }
+
+    e = table->entries + table->count;
+    memset(e, 0, sizeof(*e));
+    e->base = info->dlpi_addr;
+    e->start = UINTPTR_MAX;
+
+    for(i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = info->dlpi_phdr + i;
+        uintptr_t start = info->dlpi_addr + ph->p_vaddr;
+
+        if(ph->p_type == PT_LOAD) {
+            if(start < e->start) {
+                e->start = start;
+            }
+            if(start + ph->p_memsz > e->end) {
+                e->end = start + ph->p_memsz;
+            }
+        }
+        else if(ph->p_type == PT_NOTE && e->build_id_size == 0) {
+            e->build_id_size = faultd_notes_build_id((const uint8_t*)start,
+                                                     ph->p_memsz, e->build_id);
+        }
+    }
+
+    if(e->end == 0) {
+        return 0;
+    }
+
+    if(info->dlpi_name && info->dlpi_name[0]) {
+        faultd_strlcpy(e->path, info->dlpi_name, sizeof(e->path));
+    }
+    else {
+        /* The main executable */
+        ssize_t len = readlink("/proc/self/exe", e->path, sizeof(e->path) - 1);
+        e->path[len > 0 ? len : 0] = 0;
+    }
+
+    table->count++;
+    return 0;
+}
+
+int
+faultd_modules_refresh(void)
+{
+    faultd_module_table_t* table;
+
+    pthread_mutex_lock(&refresh_lock__);
+    table = (current__ == tables__) ? tables__ + 1 : tables__;
+    table->count = 0;
+    dl_iterate_phdr(faultd_modules_add__, table);
+    __sync_synchronize();
+    current__ = table;
+    pthread_mutex_unlock(&refresh_lock__);
+    return table->count;
+}
+
+int
+faultd_info_modules_resolve(faultd_info_t* info)
+{
+    faultd_module_table_t* table = current__;
+    int8_t index[FAULTD_CONFIG_MODULES_MAX];
+    int i, m;
+
+    info->module_count = 0;
+    for(i = 0; i < info->backtrace_size; i++) {
+        info->backtrace_module[i] = -1;
+    }
+    if(table == NULL) {
+        return 0;
+    }
+
+    for(m = 0; m < table->count; m++) {
+        index[m] = -1;
+    }
+
+    for(i = 0; i < info->backtrace_size; i++) {
+        uintptr_t pc = (uintptr_t)info->backtrace[i];
+        for(m = 0; m < table->count; m++) {
+            const faultd_module_entry_t* e = table->entries + m;
+            if(pc >= e->start && pc < e->end) {
+                if(index[m] < 0) {
+                    faultd_module_t* fm = info->modules + info->module_count;
+                    fm->base = (void*)e->base;
+                    memcpy(fm->build_id, e->build_id, e->build_id_size);
+                    fm->build_id_size = e->build_id_size;
+                    faultd_strlcpy(fm->path, e->path, sizeof(fm->path));
+                    index[m] = info->module_count++;
+                }
+                info->backtrace_module[i] = index[m];
+                break;
+            }
+        }
+    }
+    return info->module_count;
+}
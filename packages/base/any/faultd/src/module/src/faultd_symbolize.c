@@ -0,0 +1,298 @@
+/**************************************************************************//**
+ * <bsn.cl fy=2013 v=onl>
+ *
+ *        Copyright 2013, 2014 BigSwitch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ *****************************************************************************
+ *
+ * Offline symbolization.
+ *
+ * The backtrace of a fault report is resolved in the server
+ * from the symbol tables of the binaries (or their separate
+ * debug files) the report's build-ids refer to.
+ *
+ *****************************************************************************/
+#include <faultd/faultd_config.h>
+#include <faultd/faultd.h>
+#include "faultd_int.h"
+#include "faultd_log.h"
+
+#include <link.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if __ELF_NATIVE_CLASS == 64
+#define ELFCLASS_NATIVE__ ELFCLASS64
+#else
+#define ELFCLASS_NATIVE__ ELFCLASS32
+#endif
+
+typedef struct faultd_elf_s {
+    const uint8_t* data;
+    size_t size;
+    const ElfW(Ehdr)* ehdr;
+} faultd_elf_t;
+
+#define ELF_IN_BOUNDS(_elf, _offset, _size)                             \
+    ((uint64_t)(_offset) <= (_elf)->size &&                             \
+     (uint64_t)(_size) <= (_elf)->size - (uint64_t)(_offset))
+
+static void
+faultd_elf_close__(faultd_elf_t* elf)
+{
+    if(elf->data) {
+        munmap((void*)elf->data, elf->size);
+    }
+    memset(elf, 0, sizeof(*elf));
+}
+
+static int
+faultd_elf_open__(faultd_elf_t* elf, const char* path)
+{
+    struct stat st;
+    void* data;
+    int fd;
+
+    memset(elf, 0, sizeof(*elf));
+
+    if((fd = open(path, O_RDONLY)) < 0) {
+        return -1;
+    }
+    if(fstat(fd, &st) < 0 || st.st_size < sizeof(ElfW(Ehdr))) {
+        close(fd);
+        return -1;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        return -1;
+    }
+
+    elf->data = data;
+    elf->size = st.st_size;
+    elf->ehdr = data;
+
+    if(memcmp(elf->ehdr->e_ident, ELFMAG, SELFMAG) ||
+       elf->ehdr->e_ident[EI_CLASS] != ELFCLASS_NATIVE__ ||
+       !ELF_IN_BOUNDS(elf, elf->ehdr->e_shoff,
+                      (uint64_t)elf->ehdr->e_shnum * sizeof(ElfW(Shdr))) ||
+       !ELF_IN_BOUNDS(elf, elf->ehdr->e_phoff,
+                      (uint64_t)elf->ehdr->e_phnum * sizeof(ElfW(Phdr)))) {
+        faultd_elf_close__(elf);
+        return -1;
+    }
+    return 0;
+}
+
+static const ElfW(Shdr)*
+faultd_elf_sections__(const faultd_elf_t* elf)
+{
+    return (const ElfW(Shdr)*)(elf->data + elf->ehdr->e_shoff);
+}
+
+static int
+faultd_elf_build_id__(const faultd_elf_t* elf, uint8_t* build_id)
+{
+    const ElfW(Shdr)* sh = faultd_elf_sections__(elf);
+    const ElfW(Phdr)* ph = (const ElfW(Phdr)*)(elf->data + elf->ehdr->e_phoff);
+    int i, rv;
+
+    for(i = 0; i < elf->ehdr->e_shnum; i++) {
+        if(sh[i].sh_type == SHT_NOTE &&
+           ELF_IN_BOUNDS(elf, sh[i].sh_offset, sh[i].sh_size)) {
+            if((rv = faultd_notes_build_id(elf->data + sh[i].sh_offset,
+                                           sh[i].sh_size, build_id))) {
+                return rv;
+            }
+        }
+    }
+    /* Stripped of section headers */
+    for(i = 0; i < elf->ehdr->e_phnum; i++) {
+        if(ph[i].p_type == PT_NOTE &&
+           ELF_IN_BOUNDS(elf, ph[i].p_offset, ph[i].p_filesz)) {
+            if((rv = faultd_notes_build_id(elf->data + ph[i].p_offset,
+                                           ph[i].p_filesz, build_id))) {
+                return rv;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Find the function containing addr in the given symbol table type.
+ */
+static const char*
+faultd_elf_symbol__(const faultd_elf_t* elf, uint32_t type,
+                    uintptr_t addr, uintptr_t* offset)
+{
+    const ElfW(Shdr)* sh = faultd_elf_sections__(elf);
+    const ElfW(Sym)* best = NULL;
+    const char* strtab = NULL;
+    uint64_t strsize = 0;
+    int i;
+
+    for(i = 0; i < elf->ehdr->e_shnum; i++) {
+        const ElfW(Shdr)* str;
+        const ElfW(Sym)* syms;
+        uint64_t s, count;
+
+        if(sh[i].sh_type != type || sh[i].sh_link >= elf->ehdr->e_shnum) {
+            continue;
+        }
+        str = sh + sh[i].sh_link;
+        if(!ELF_IN_BOUNDS(elf, sh[i].sh_offset, sh[i].sh_size) ||
+           !ELF_IN_BOUNDS(elf, str->sh_offset, str->sh_size)) {
+            continue;
+        }
+
+        syms = (const ElfW(Sym)*)(elf->data + sh[i].sh_offset);
+        count = sh[i].sh_size / sizeof(ElfW(Sym));
+
+        for(s = 0; s < count; s++) {
+            const ElfW(Sym)* sym = syms + s;
+            if(ELF32_ST_TYPE(sym->st_info) != STT_FUNC ||
+               sym->st_shndx == SHN_UNDEF || sym->st_value > addr) {
+                continue;
+            }
+            if(addr < sym->st_value + sym->st_size) {
+                /* Contains the address */
+                best = sym;
+                break;
+            }
+            if(sym->st_size == 0 && (best == NULL || sym->st_value > best->st_value)) {
+                /* Unsized, nearest preceding */
+                best = sym;
+            }
+        }
+        strtab = (const char*)(elf->data + str->sh_offset);
+        strsize = str->sh_size;
+        break;
+    }
+
+    if(best == NULL || best->st_name >= strsize) {
+        return NULL;
+    }
+    *offset = addr - best->st_value;
+    return strtab + best->st_name;
+}
+
+/*
+ * Open the binary for a module: its separate debug file if there
+ * is one, otherwise the module itself. Either must match the
+ * build-id of the report, if it has one.
+ */
+static int
+faultd_module_open__(const faultd_module_t* m, faultd_elf_t* elf)
+{
+    char paths[2][FAULTD_CONFIG_BINARY_SIZE + 64];
+    uint8_t build_id[FAULTD_BUILD_ID_SIZE_MAX];
+    int count = 0;
+    int i;
+
+    if(m->build_id_size) {
+        char* p = paths[count++];
+        p += sprintf(p, "%s/.build-id/%02x/", FAULTD_CONFIG_DEBUG_DIR,
+                     m->build_id[0]);
+        for(i = 1; i < m->build_id_size; i++) {
+            p += sprintf(p, "%02x", m->build_id[i]);
+        }
+        strcpy(p, ".debug");
+    }
+    if(m->path[0]) {
+        faultd_strlcpy(paths[count++], m->path, sizeof(paths[0]));
+    }
+
+    for(i = 0; i < count; i++) {
+        if(faultd_elf_open__(elf, paths[i]) < 0) {
+            continue;
+        }
+        if(m->build_id_size == 0 ||
+           (faultd_elf_build_id__(elf, build_id) == m->build_id_size &&
+            !memcmp(build_id, m->build_id, m->build_id_size))) {
+            return 0;
+        }
+        AIM_LOG_VERBOSE("%s: build-id does not match the report.", paths[i]);
+        faultd_elf_close__(elf);
+    }
+    return -1;
+}
+
+int
+faultd_info_symbolize(faultd_info_t* info)
+{
+    faultd_elf_t elfs[FAULTD_CONFIG_BACKTRACE_SIZE_MAX];
+    int opened[FAULTD_CONFIG_BACKTRACE_SIZE_MAX];
+    int size = FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE;
+    int len = 0;
+    int i;
+
+    if(info->backtrace_symbols) {
+        aim_free(info->backtrace_symbols);
+    }
+    info->backtrace_symbols = aim_zmalloc(size);
+
+    for(i = 0; i < info->module_count; i++) {
+        opened[i] = 0;
+    }
+
+    for(i = 0; i < info->backtrace_size && len < size; i++) {
+        uintptr_t pc = (uintptr_t)info->backtrace[i];
+        int m = info->backtrace_module[i];
+        char* dst = info->backtrace_symbols + len;
+        const faultd_module_t* mod;
+        const char* sym = NULL;
+        uintptr_t addr, offset = 0;
+
+        if(m < 0 || m >= info->module_count) {
+            len += snprintf(dst, size - len, "[%p]\n", (void*)pc);
+            continue;
+        }
+
+        mod = info->modules + m;
+        addr = pc - (uintptr_t)mod->base;
+
+        if(opened[m] == 0) {
+            opened[m] = (faultd_module_open__(mod, elfs + m) == 0) ? 1 : -1;
+        }
+        if(opened[m] > 0) {
+            sym = faultd_elf_symbol__(elfs + m, SHT_SYMTAB, addr, &offset);
+            if(sym == NULL) {
+                sym = faultd_elf_symbol__(elfs + m, SHT_DYNSYM, addr, &offset);
+            }
+        }
+
+        if(sym) {
+            len += snprintf(dst, size - len, "%s(%s+0x%lx) [%p]\n",
+                            mod->path, sym, (unsigned long)offset, (void*)pc);
+        }
+        else {
+            len += snprintf(dst, size - len, "%s(+0x%lx) [%p]\n",
+                            mod->path, (unsigned long)addr, (void*)pc);
+        }
+    }
+
+    for(i = 0; i < info->module_count; i++) {
+        if(opened[i] > 0) {
+            faultd_elf_close__(elfs + i);
+        }
+    }
+    return 0;
+}
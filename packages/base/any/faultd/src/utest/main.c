@@ -40,16 +40,11 @@ client_main(int argc, char* argv[])
     faultd_client_t* clientfd; 
     int count = 1; 
     int i; 
-    void* backtrace_symbols = NULL; 
     char* service = LOCALNAME; 
 
     if(argc >= 1) { 
         count = atoi(argv[0]); 
     }
-    if(argc >= 2) { 
-        intptr_t bts = atoi(argv[1]); 
-        backtrace_symbols = (void*)bts; 
-    }
     if(argc >= 3) { 
         service = argv[2]; 
     }
@@ -58,6 +53,7 @@ client_main(int argc, char* argv[])
             perror("client_create: "); 
             abort(); 
         }
+        memset(&info, 0, sizeof(info)); 
         strcpy(info.binary, "client_main"); 
         info.pid = getpid(); 
         info.tid = 100;
@@ -66,7 +62,6 @@ client_main(int argc, char* argv[])
         info.fault_address = (void*)(0xDEAD); 
         info.last_errno = -42; 
         info.backtrace_size = backtrace(info.backtrace, AIM_ARRAYSIZE(info.backtrace)); 
-        info.backtrace_symbols = backtrace_symbols;
         printf("writing msg...\n"); 
         faultd_client_write(clientfd, &info); 
         faultd_client_destroy(clientfd);
@@ -114,7 +109,67 @@ server_main(int argc, char* argv[])
 int
 utest_main(int argc, char* argv[])
 {
-    fprintf(stderr, "No standalone unit test implemented.\n"); 
+    /* Binary record encode/decode round trip */
+    faultd_info_t info;
+    faultd_info_t decoded;
+    uint8_t record[4096];
+    int size;
+    int i;
+
+    memset(&info, 0, sizeof(info));
+    strcpy(info.binary, "utest_main");
+    info.pid = 1234;
+    info.tid = 1235;
+    info.signal = SIGSEGV;
+    info.signal_code = 1;
+    info.fault_address = (void*)(0xDEAD);
+    info.last_errno = -42;
+    info.backtrace_size = 4;
+    for(i = 0; i < info.backtrace_size; i++) {
+        info.backtrace[i] = (void*)(uintptr_t)(0x400000 + i * 0x10);
+        info.backtrace_module[i] = (i == 3) ? -1 : i % 2;
+    }
+    info.module_count = 2;
+    for(i = 0; i < info.module_count; i++) {
+        info.modules[i].base = (void*)(uintptr_t)(0x10000 * (i + 1));
+        info.modules[i].build_id_size = 20;
+        memset(info.modules[i].build_id, 0xA0 + i, 20);
+        sprintf(info.modules[i].path, "/lib/module%d.so", i);
+    }
+
+    size = faultd_info_encode(&info, record, sizeof(record));
+    AIM_TRUE_OR_DIE(size > 0, "encode failed: %d", size);
+    AIM_TRUE_OR_DIE(faultd_info_decode(&decoded, record, size) >= 0,
+                    "decode failed");
+
+    AIM_TRUE_OR_DIE(!strcmp(decoded.binary, info.binary));
+    AIM_TRUE_OR_DIE(decoded.pid == info.pid);
+    AIM_TRUE_OR_DIE(decoded.tid == info.tid);
+    AIM_TRUE_OR_DIE(decoded.signal == info.signal);
+    AIM_TRUE_OR_DIE(decoded.signal_code == info.signal_code);
+    AIM_TRUE_OR_DIE(decoded.fault_address == info.fault_address);
+    AIM_TRUE_OR_DIE(decoded.last_errno == info.last_errno);
+    AIM_TRUE_OR_DIE(decoded.backtrace_size == info.backtrace_size);
+    for(i = 0; i < info.backtrace_size; i++) {
+        AIM_TRUE_OR_DIE(decoded.backtrace[i] == info.backtrace[i]);
+        AIM_TRUE_OR_DIE(decoded.backtrace_module[i] == info.backtrace_module[i]);
+    }
+    AIM_TRUE_OR_DIE(decoded.module_count == info.module_count);
+    for(i = 0; i < info.module_count; i++) {
+        AIM_TRUE_OR_DIE(decoded.modules[i].base == info.modules[i].base);
+        AIM_TRUE_OR_DIE(decoded.modules[i].build_id_size ==
+                        info.modules[i].build_id_size);
+        AIM_TRUE_OR_DIE(!memcmp(decoded.modules[i].build_id,
+                                info.modules[i].build_id, 20));
+        AIM_TRUE_OR_DIE(!strcmp(decoded.modules[i].path, info.modules[i].path));
+    }
+
+    /* Truncated records must not decode */
+    AIM_TRUE_OR_DIE(faultd_info_decode(&decoded, record, size - 1) < 0);
+
+    /* Too small for the header */
+    AIM_TRUE_OR_DIE(faultd_info_encode(&info, record, 8) < 0);
+
     return 0; 
 }
 
@@ -47,17 +47,45 @@
 #define I2C_RW_RETRY_COUNT		10
 #define I2C_RW_RETRY_INTERVAL	60 /* ms */
 
+/* Default refresh interval of each register tier, see update_interval_* */
+#define PSU_TIER_STATIC_INTERVAL    10000 /* ms, also picks up a hot-swapped PSU */
+#define PSU_TIER_SLOW_INTERVAL      3000 /* ms */
+#define PSU_TIER_FAST_INTERVAL      1500 /* ms */
+#define PSU_TIER_MFR_RETRY_INTERVAL 30000 /* ms, after the mfr data could not be read */
+
 /* Addresses scanned 
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
 
+/* Registers are refreshed in tiers, only the tier holding the requested
+ * attribute is read. Static registers (vout_mode) and the mfr data are
+ * refreshed at the static interval, since ONLP only checks the CPLD presence
+ * bit and a replaced PSU may never fail a read here. The mfr block reads are
+ * not implemented by some older PSUs, so they have their own tier which
+ * the telemetry does not depend on, and are retried with a backoff.
+ */
+enum accton_i2c_psu_tier {
+    PSU_TIER_STATIC,
+    PSU_TIER_SLOW,
+    PSU_TIER_FAST,
+    PSU_TIER_MFR,
+    PSU_TIER_MAX
+};
+
+struct accton_i2c_psu_tier_data {
+    char                valid;           /* !=0 if registers are valid */
+    char                failed;          /* !=0 if the last read failed */
+    unsigned long       last_updated;    /* In jiffies */
+    unsigned long       retry_at;        /* In jiffies, if failed */
+    unsigned int        interval;        /* In ms, 0: never refresh */
+};
+
 /* Each client has this additional data 
  */
 struct accton_i2c_psu_data {
     struct device      *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+    struct accton_i2c_psu_tier_data tier[PSU_TIER_MAX];
     u8   vout_mode;     /* Register value */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
@@ -84,9 +112,11 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf);
 static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf);
+static ssize_t show_interval(struct device *dev, struct device_attribute *da, char *buf);
+static ssize_t set_interval(struct device *dev, struct device_attribute *da, const char *buf, size_t count);
 			 			 
 static int accton_i2c_psu_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev);
+static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev, int index);
 
 enum accton_i2c_psu_sysfs_attributes {
     PSU_V_IN,
@@ -104,6 +134,27 @@ enum accton_i2c_psu_sysfs_attributes {
 	PSU_MFR_MODEL,
 	PSU_MFR_REVISION,
 	PSU_MFR_SERIAL,
+    PSU_ATTR_MAX
+};
+
+/* Register tier backing each attribute
+ */
+static const u8 accton_i2c_psu_attr_tier[PSU_ATTR_MAX] = {
+    [PSU_V_IN]            = PSU_TIER_FAST,
+    [PSU_V_OUT]           = PSU_TIER_FAST,
+    [PSU_I_IN]            = PSU_TIER_FAST,
+    [PSU_I_OUT]           = PSU_TIER_FAST,
+    [PSU_P_IN]            = PSU_TIER_FAST,
+    [PSU_P_OUT]           = PSU_TIER_FAST,
+    [PSU_TEMP1_INPUT]     = PSU_TIER_SLOW,
+    [PSU_FAN1_FAULT]      = PSU_TIER_FAST,
+    [PSU_FAN1_DUTY_CYCLE] = PSU_TIER_SLOW,
+    [PSU_FAN1_SPEED]      = PSU_TIER_SLOW,
+    [PSU_PMBUS_REVISION]  = PSU_TIER_STATIC,
+    [PSU_MFR_ID]          = PSU_TIER_MFR,
+    [PSU_MFR_MODEL]       = PSU_TIER_MFR,
+    [PSU_MFR_REVISION]    = PSU_TIER_MFR,
+    [PSU_MFR_SERIAL]      = PSU_TIER_MFR
 };
 
 /* sysfs attributes for hwmon 
@@ -123,6 +174,9 @@ static SENSOR_DEVICE_ATTR(psu_mfr_id,		S_IRUGO, show_ascii,  NULL, PSU_MFR_ID);
 static SENSOR_DEVICE_ATTR(psu_mfr_model,	S_IRUGO, show_ascii,  NULL, PSU_MFR_MODEL);
 static SENSOR_DEVICE_ATTR(psu_mfr_revision,	S_IRUGO, show_ascii, NULL, PSU_MFR_REVISION);
 static SENSOR_DEVICE_ATTR(psu_mfr_serial,	S_IRUGO, show_ascii, NULL, PSU_MFR_SERIAL);
+static SENSOR_DEVICE_ATTR(update_interval_static, S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_STATIC);
+static SENSOR_DEVICE_ATTR(update_interval_slow,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_SLOW);
+static SENSOR_DEVICE_ATTR(update_interval_fast,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_FAST);
 
 static struct attribute *accton_i2c_psu_attributes[] = {
     &sensor_dev_attr_psu_v_in.dev_attr.attr,
@@ -140,6 +194,9 @@ static struct attribute *accton_i2c_psu_attributes[] = {
     &sensor_dev_attr_psu_mfr_model.dev_attr.attr,
     &sensor_dev_attr_psu_mfr_revision.dev_attr.attr,
     &sensor_dev_attr_psu_mfr_serial.dev_attr.attr,
+    &sensor_dev_attr_update_interval_static.dev_attr.attr,
+    &sensor_dev_attr_update_interval_slow.dev_attr.attr,
+    &sensor_dev_attr_update_interval_fast.dev_attr.attr,
     NULL
 };
 
@@ -180,11 +237,15 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, attr->index);
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 0;
+
+    if (!data) {
+        return 0;
+    }
     
     switch (attr->index) {
     case PSU_V_IN:
@@ -232,19 +293,27 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
-
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, attr->index);
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
+    if (!data) {
+        return 0;
+    }
+
     return sprintf(buf, "%d\n", data->fan_fault >> shift);
 }
 
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, attr->index);
     int exponent, mantissa;    
 
+    if (!data) {
+        return 0;
+    }
+
     exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
     mantissa = data->v_out;
 
@@ -256,9 +325,9 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, attr->index);
 	
-	if (!data->valid) {
+	if (!data) {
 		return 0;
 	}
 
@@ -270,10 +339,10 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev, attr->index);
 	u8 *ptr = NULL;
 
-	if (!data->valid) {
+	if (!data) {
 		return 0;
 	}	
 	switch (attr->index) {
@@ -297,6 +366,38 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 	return sprintf(buf, "%s\n", ptr);
 }
 
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+             char *buf)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
+
+    return sprintf(buf, "%u\n", data->tier[attr->index].interval);
+}
+
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+			const char *buf, size_t count)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
+    unsigned int interval;
+    int error;
+
+    error = kstrtouint(buf, 10, &interval);
+    if (error)
+        return error;
+
+    mutex_lock(&data->update_lock);
+    data->tier[attr->index].interval = interval;
+    if (attr->index == PSU_TIER_STATIC) {
+        data->tier[PSU_TIER_MFR].interval = interval;
+    }
+    mutex_unlock(&data->update_lock);
+
+    return count;
+}
 
 static const struct attribute_group accton_i2c_psu_group = {
     .attrs = accton_i2c_psu_attributes,
@@ -321,8 +422,11 @@ static int accton_i2c_psu_probe(struct i2c_client *client,
     }
 
     i2c_set_clientdata(client, data);
-    data->valid = 0;
     mutex_init(&data->update_lock);
+    data->tier[PSU_TIER_STATIC].interval = PSU_TIER_STATIC_INTERVAL;
+    data->tier[PSU_TIER_SLOW].interval   = PSU_TIER_SLOW_INTERVAL;
+    data->tier[PSU_TIER_FAST].interval   = PSU_TIER_FAST_INTERVAL;
+    data->tier[PSU_TIER_MFR].interval    = PSU_TIER_STATIC_INTERVAL;
 
     dev_info(&client->dev, "chip found\n");
 
@@ -469,104 +573,173 @@ EXIT_READ_BLOCK_DATA:
 struct reg_data_byte {
     u8   reg;
     u8  *value;
+    u8   tier;
 };
 
 struct reg_data_word {
     u8   reg;
     u16 *value;
+    u8   tier;
 };
 
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev)
+static int accton_i2c_psu_update_tier(struct i2c_client *client,
+              struct accton_i2c_psu_data *data, int tier)
+{
+    int i, status, nregs = 0, nerrs = 0;
+    struct reg_data_byte regs_byte[] = { {PMBUS_REGISTER_VOUT_MODE, &data->vout_mode, PSU_TIER_STATIC},
+                                         {PMBUS_REGISTER_STATUS_FAN, &data->fan_fault, PSU_TIER_FAST}};
+    struct reg_data_word regs_word[] = { {PMBUS_REGISTER_READ_VIN, &data->v_in, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_VOUT, &data->v_out, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_IIN, &data->i_in, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_IOUT, &data->i_out, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_POUT, &data->p_out, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_PIN, &data->p_in, PSU_TIER_FAST},
+                                         {PMBUS_REGISTER_READ_TEMPERATURE_1, &(data->temp_input[0]), PSU_TIER_SLOW},
+                                         {PMBUS_REGISTER_READ_TEMPERATURE_2, &(data->temp_input[1]), PSU_TIER_SLOW},
+                                         {PMBUS_REGISTER_FAN_COMMAND_1, &(data->fan_duty_cycle[0]), PSU_TIER_SLOW},
+                                         {PMBUS_REGISTER_READ_FAN_SPEED_1, &(data->fan_speed[0]), PSU_TIER_SLOW},
+                                         {PMBUS_REGISTER_READ_FAN_SPEED_2, &(data->fan_speed[1]), PSU_TIER_SLOW},
+                                         };
+
+    dev_dbg(&client->dev, "Starting accton_i2c_psu update, tier %d\n", tier);
+
+    /* Read byte data */        
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].tier != tier) {
+            continue;
+        }
+
+        nregs++;
+        status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            nerrs++;
+        }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
+                
+    /* Read word data */                    
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].tier != tier) {
+            continue;
+        }
+
+        nregs++;
+        status = accton_i2c_psu_read_word(client, regs_word[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            nerrs++;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+        
+    }
+
+    /* Single register errors are tolerated, a tier that cannot be read
+     * at all means the PSU is gone.
+     */
+    if (nregs && nerrs == nregs) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/* Read the mfr strings. A string that cannot be read is left empty,
+ * the tier fails only if none can be read.
+ */
+static int accton_i2c_psu_update_mfr(struct i2c_client *client,
+              struct accton_i2c_psu_data *data)
+{
+    int i, status, nerrs = 0;
+    struct reg_data_block {
+        u8   reg;
+        u8  *value;
+        int  size;
+    } regs_block[] = { {PMBUS_REGISTER_MFR_ID, data->mfr_id, ARRAY_SIZE(data->mfr_id)},
+                       {PMBUS_REGISTER_MFR_MODEL, data->mfr_model, ARRAY_SIZE(data->mfr_model)},
+                       {PMBUS_REGISTER_MFR_REVISION, data->mfr_revsion, ARRAY_SIZE(data->mfr_revsion)},
+                       {PMBUS_REGISTER_MFR_SERIAL, data->mfr_serial, ARRAY_SIZE(data->mfr_serial)},
+                       };
+
+    for (i = 0; i < ARRAY_SIZE(regs_block); i++) {
+        status = accton_i2c_psu_read_block_data(client, regs_block[i].reg,
+                                                regs_block[i].value, regs_block[i].size);
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", regs_block[i].reg, status);
+            memset(regs_block[i].value, 0, regs_block[i].size);
+            nerrs++;
+        }
+    }
+
+    return (nerrs == ARRAY_SIZE(regs_block)) ? -EIO : 0;
+}
+
+/* Refresh the registers backing attribute 'index', plus the static tier
+ * (vout_mode is needed to scale psu_v_out). Returns NULL if they could
+ * not be read.
+ */
+static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev, int index)
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
+    int tiers[] = { PSU_TIER_STATIC, accton_i2c_psu_attr_tier[index] };
+    int i, j, status = 0;
     
     mutex_lock(&data->update_lock);
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {PMBUS_REGISTER_VOUT_MODE, &data->vout_mode},
-                                             {PMBUS_REGISTER_STATUS_FAN, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {PMBUS_REGISTER_READ_VIN, &data->v_in},
-                                             {PMBUS_REGISTER_READ_VOUT, &data->v_out},
-                                             {PMBUS_REGISTER_READ_IIN, &data->i_in},
-                                             {PMBUS_REGISTER_READ_IOUT, &data->i_out},
-                                             {PMBUS_REGISTER_READ_POUT, &data->p_out},
-                                             {PMBUS_REGISTER_READ_PIN, &data->p_in},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_1, &(data->temp_input[0])},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_2, &(data->temp_input[1])},
-                                             {PMBUS_REGISTER_FAN_COMMAND_1, &(data->fan_duty_cycle[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_1, &(data->fan_speed[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_2, &(data->fan_speed[1])},
-                                             };
-
-        dev_dbg(&client->dev, "Starting accton_i2c_psu update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    for (i = 0; i < ARRAY_SIZE(tiers); i++) {
+        struct accton_i2c_psu_tier_data *tier = &data->tier[tiers[i]];
+
+        if (tier->valid && (!tier->interval ||
+            !time_after(jiffies, tier->last_updated + msecs_to_jiffies(tier->interval)))) {
+            continue;
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = accton_i2c_psu_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
+
+        if (tier->failed && time_before(jiffies, tier->retry_at)) {
+            status = -EIO;
+            break;
+        }
+
+        tier->valid = 0;
+        if (tiers[i] == PSU_TIER_MFR) {
+            status = accton_i2c_psu_update_mfr(client, data);
+        }
+        else {
+            status = accton_i2c_psu_update_tier(client, data, tiers[i]);
+        }
+
+        if (status < 0 && tiers[i] == PSU_TIER_MFR) {
+            /* Not supported by this PSU, or it is gone. Back off. */
+            tier->failed = 1;
+            tier->retry_at = jiffies + msecs_to_jiffies(PSU_TIER_MFR_RETRY_INTERVAL);
+            break;
+        }
+
+        if (status < 0) {
+            /* The PSU may be gone, re-read everything once it is back */
+            for (j = 0; j < PSU_TIER_MAX; j++) {
+                data->tier[j].valid = 0;
+                data->tier[j].failed = 0;
             }
-            
+            break;
         }
-        /* Read mfr_id */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_ID, data->mfr_id,
-										 ARRAY_SIZE(data->mfr_id));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_ID, status);
-			goto exit;
-		}		
-		/* Read mfr_model */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_MODEL, data->mfr_model,
-										 ARRAY_SIZE(data->mfr_model));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_MODEL, status);
-			goto exit;
-		}
-        /* Read mfr_revsion */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_REVISION, data->mfr_revsion,
-										 ARRAY_SIZE(data->mfr_revsion));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_REVISION, status);
-			goto exit;
-		}
-		/* Read mfr_serial */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_SERIAL, data->mfr_serial,
-										 ARRAY_SIZE(data->mfr_serial));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_SERIAL, status);
-			goto exit;
-		}
-        
-        data->last_updated = jiffies;
-        data->valid = 1;
+
+        tier->last_updated = jiffies;
+        tier->valid = 1;
+        tier->failed = 0;
     }
 
-exit:
     mutex_unlock(&data->update_lock);
 
-    return data;
+    return (status < 0) ? NULL : data;
 }
 
 static int __init accton_i2c_psu_init(void)
@@ -34,17 +34,38 @@
 
 #define MAX_FAN_DUTY_CYCLE 100
 
+/* Default refresh interval of each register tier, see update_interval_* */
+#define PSU_TIER_STATIC_INTERVAL    10000 /* ms, also picks up a hot-swapped PSU */
+#define PSU_TIER_SLOW_INTERVAL      3000 /* ms */
+#define PSU_TIER_FAST_INTERVAL      1500 /* ms */
+
 /* Addresses scanned 
  */
 static const unsigned short normal_i2c[] = { 0x3c, 0x3d, 0x3e, 0x3f, I2C_CLIENT_END };
 
+/* Registers are refreshed in tiers, only the tier holding the requested
+ * attribute is read. The static tier (vout_mode) is refreshed at the static
+ * interval, since a replaced PSU may never fail a read here.
+ */
+enum cpr_4011_4mxx_tier {
+    PSU_TIER_STATIC,
+    PSU_TIER_SLOW,
+    PSU_TIER_FAST,
+    PSU_TIER_MAX
+};
+
+struct cpr_4011_4mxx_tier_data {
+    char                valid;           /* !=0 if registers are valid */
+    unsigned long       last_updated;    /* In jiffies */
+    unsigned int        interval;        /* In ms, 0: never refresh */
+};
+
 /* Each client has this additional data 
  */
 struct cpr_4011_4mxx_data {
     struct device      *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+    struct cpr_4011_4mxx_tier_data tier[PSU_TIER_MAX];
     u8   vout_mode;     /* Register value */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
@@ -62,8 +83,10 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da, char
 static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t show_vout(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da, const char *buf, size_t count);
+static ssize_t show_interval(struct device *dev, struct device_attribute *da, char *buf);
+static ssize_t set_interval(struct device *dev, struct device_attribute *da, const char *buf, size_t count);
 static int cpr_4011_4mxx_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev);
+static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev, int index);
 
 enum cpr_4011_4mxx_sysfs_attributes {
     PSU_V_IN,
@@ -76,6 +99,22 @@ enum cpr_4011_4mxx_sysfs_attributes {
     PSU_FAN1_FAULT,
     PSU_FAN1_DUTY_CYCLE,
     PSU_FAN1_SPEED,
+    PSU_ATTR_MAX
+};
+
+/* Register tier backing each attribute
+ */
+static const u8 cpr_4011_4mxx_attr_tier[PSU_ATTR_MAX] = {
+    [PSU_V_IN]            = PSU_TIER_FAST,
+    [PSU_V_OUT]           = PSU_TIER_FAST,
+    [PSU_I_IN]            = PSU_TIER_FAST,
+    [PSU_I_OUT]           = PSU_TIER_FAST,
+    [PSU_P_IN]            = PSU_TIER_FAST,
+    [PSU_P_OUT]           = PSU_TIER_FAST,
+    [PSU_TEMP1_INPUT]     = PSU_TIER_SLOW,
+    [PSU_FAN1_FAULT]      = PSU_TIER_FAST,
+    [PSU_FAN1_DUTY_CYCLE] = PSU_TIER_SLOW,
+    [PSU_FAN1_SPEED]      = PSU_TIER_SLOW
 };
 
 /* sysfs attributes for hwmon 
@@ -90,6 +129,9 @@ static SENSOR_DEVICE_ATTR(psu_temp1_input, S_IRUGO, show_linear,      NULL, PSU_
 static SENSOR_DEVICE_ATTR(psu_fan1_fault,  S_IRUGO, show_fan_fault,   NULL, PSU_FAN1_FAULT);
 static SENSOR_DEVICE_ATTR(psu_fan1_duty_cycle_percentage, S_IWUSR | S_IRUGO, show_linear, set_fan_duty_cycle, PSU_FAN1_DUTY_CYCLE);
 static SENSOR_DEVICE_ATTR(psu_fan1_speed_rpm, S_IRUGO, show_linear,   NULL, PSU_FAN1_SPEED);
+static SENSOR_DEVICE_ATTR(update_interval_static, S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_STATIC);
+static SENSOR_DEVICE_ATTR(update_interval_slow,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_SLOW);
+static SENSOR_DEVICE_ATTR(update_interval_fast,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_FAST);
 
 static struct attribute *cpr_4011_4mxx_attributes[] = {
     &sensor_dev_attr_psu_v_in.dev_attr.attr,
@@ -102,6 +144,9 @@ static struct attribute *cpr_4011_4mxx_attributes[] = {
     &sensor_dev_attr_psu_fan1_fault.dev_attr.attr,
     &sensor_dev_attr_psu_fan1_duty_cycle_percentage.dev_attr.attr,
     &sensor_dev_attr_psu_fan1_speed_rpm.dev_attr.attr,
+    &sensor_dev_attr_update_interval_static.dev_attr.attr,
+    &sensor_dev_attr_update_interval_slow.dev_attr.attr,
+    &sensor_dev_attr_update_interval_fast.dev_attr.attr,
     NULL
 };
 
@@ -142,11 +187,15 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, attr->index);
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 1000;
+
+    if (!data) {
+        return 0;
+    }
     
     switch (attr->index) {
     case PSU_V_IN:
@@ -190,20 +239,28 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
-
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, attr->index);
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
+    if (!data) {
+        return 0;
+    }
+
     return sprintf(buf, "%d\n", data->fan_fault >> shift);
 }
 
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev, attr->index);
     int exponent, mantissa;
     int multiplier = 1000;
 
+    if (!data) {
+        return 0;
+    }
+
     exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
     mantissa = data->v_out;
 
@@ -211,6 +268,36 @@ static ssize_t show_vout(struct device *dev, struct device_attribute *da,
                             sprintf(buf, "%d\n", (mantissa * multiplier) / (1 << -exponent));
 }
 
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+             char *buf)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct cpr_4011_4mxx_data *data = i2c_get_clientdata(client);
+
+    return sprintf(buf, "%u\n", data->tier[attr->index].interval);
+}
+
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+			const char *buf, size_t count)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct cpr_4011_4mxx_data *data = i2c_get_clientdata(client);
+    unsigned int interval;
+    int error;
+
+    error = kstrtouint(buf, 10, &interval);
+    if (error)
+        return error;
+
+    mutex_lock(&data->update_lock);
+    data->tier[attr->index].interval = interval;
+    mutex_unlock(&data->update_lock);
+
+    return count;
+}
+
 static const struct attribute_group cpr_4011_4mxx_group = {
     .attrs = cpr_4011_4mxx_attributes,
 };
@@ -234,8 +321,10 @@ static int cpr_4011_4mxx_probe(struct i2c_client *client,
     }
 
     i2c_set_clientdata(client, data);
-    data->valid = 0;
     mutex_init(&data->update_lock);
+    data->tier[PSU_TIER_STATIC].interval = PSU_TIER_STATIC_INTERVAL;
+    data->tier[PSU_TIER_SLOW].interval   = PSU_TIER_SLOW_INTERVAL;
+    data->tier[PSU_TIER_FAST].interval   = PSU_TIER_FAST_INTERVAL;
 
     dev_info(&client->dev, "chip found\n");
 
@@ -316,73 +405,119 @@ static int cpr_4011_4mxx_write_word(struct i2c_client *client, u8 reg, u16 value
 struct reg_data_byte {
     u8   reg;
     u8  *value;
+    u8   tier;
 };
 
 struct reg_data_word {
     u8   reg;
     u16 *value;
+    u8   tier;
 };
 
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev)
+static int cpr_4011_4mxx_update_tier(struct i2c_client *client,
+              struct cpr_4011_4mxx_data *data, int tier)
+{
+    int i, status, nregs = 0, nerrs = 0;
+    struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode, PSU_TIER_STATIC},
+                                         {0x81, &data->fan_fault, PSU_TIER_FAST}};
+    struct reg_data_word regs_word[] = { {0x88, &data->v_in, PSU_TIER_FAST},
+                                         {0x8b, &data->v_out, PSU_TIER_FAST},
+                                         {0x89, &data->i_in, PSU_TIER_FAST},
+                                         {0x8c, &data->i_out, PSU_TIER_FAST},
+                                         {0x96, &data->p_out, PSU_TIER_FAST},
+                                         {0x97, &data->p_in, PSU_TIER_FAST},
+                                         {0x8d, &(data->temp_input[0]), PSU_TIER_SLOW},
+                                         {0x8e, &(data->temp_input[1]), PSU_TIER_SLOW},
+                                         {0x3b, &(data->fan_duty_cycle[0]), PSU_TIER_SLOW},
+                                         {0x3c, &(data->fan_duty_cycle[1]), PSU_TIER_SLOW},
+                                         {0x90, &(data->fan_speed[0]), PSU_TIER_SLOW},
+                                         {0x91, &(data->fan_speed[1]), PSU_TIER_SLOW}};
+
+    dev_dbg(&client->dev, "Starting cpr_4011_4mxx update, tier %d\n", tier);
+
+    /* Read byte data */        
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].tier != tier) {
+            continue;
+        }
+
+        nregs++;
+        status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            nerrs++;
+        }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
+                
+    /* Read word data */                    
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].tier != tier) {
+            continue;
+        }
+
+        nregs++;
+        status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
+        
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            nerrs++;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
+
+    /* Single register errors are tolerated, a tier that cannot be read
+     * at all means the PSU is gone.
+     */
+    return (nregs && nerrs == nregs) ? -EIO : 0;
+}
+
+/* Refresh the registers backing attribute 'index', plus the static tier
+ * (vout_mode is needed to scale psu_v_out). Returns NULL if they could
+ * not be read.
+ */
+static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev, int index)
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct cpr_4011_4mxx_data *data = i2c_get_clientdata(client);
+    int tiers[] = { PSU_TIER_STATIC, cpr_4011_4mxx_attr_tier[index] };
+    int i, j, status = 0;
     
     mutex_lock(&data->update_lock);
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status;
-        struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode},
-                                             {0x81, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x96, &data->p_out},
-                                             {0x97, &data->p_in},
-                                             {0x8d, &(data->temp_input[0])},
-                                             {0x8e, &(data->temp_input[1])},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &(data->fan_speed[0])},
-                                             {0x91, &(data->fan_speed[1])}};
-
-        dev_dbg(&client->dev, "Starting cpr_4011_4mxx update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    for (i = 0; i < ARRAY_SIZE(tiers); i++) {
+        struct cpr_4011_4mxx_tier_data *tier = &data->tier[tiers[i]];
+
+        if (tier->valid && (!tier->interval ||
+            !time_after(jiffies, tier->last_updated + msecs_to_jiffies(tier->interval)))) {
+            continue;
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
+
+        tier->valid = 0;
+        status = cpr_4011_4mxx_update_tier(client, data, tiers[i]);
+
+        if (status < 0) {
+            /* The PSU may be gone, re-read everything once it is back */
+            for (j = 0; j < PSU_TIER_MAX; j++) {
+                data->tier[j].valid = 0;
             }
+            break;
         }
-        
-        data->last_updated = jiffies;
-        data->valid = 1;
+
+        tier->last_updated = jiffies;
+        tier->valid = 1;
     }
 
     mutex_unlock(&data->update_lock);
 
-    return data;
+    return (status < 0) ? NULL : data;
 }
 
 static int __init cpr_4011_4mxx_init(void)
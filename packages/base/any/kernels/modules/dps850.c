@@ -37,6 +37,12 @@
 #define I2C_RW_RETRY_COUNT		10
 #define I2C_RW_RETRY_INTERVAL	60 /* ms */
 
+/* Default refresh interval of each register tier, see update_interval_* */
+#define PSU_TIER_STATIC_INTERVAL	10000 /* ms, also picks up a hot-swapped PSU */
+#define PSU_TIER_SLOW_INTERVAL		3000 /* ms */
+#define PSU_TIER_FAST_INTERVAL		1500 /* ms */
+#define PSU_TIER_MFR_RETRY_INTERVAL	30000 /* ms, after the mfr data could not be read */
+
 /* Addresses scanned
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
@@ -45,13 +51,34 @@ enum chips {
 	DPS850
 };
 
+/* Registers are refreshed in tiers, only the tier holding the requested
+ * attribute is read. Static registers (vout_mode) and the mfr strings are
+ * refreshed at the static interval, since a replaced PSU may never fail a
+ * read here. The mfr block reads have their own tier so the telemetry does
+ * not depend on them, and are retried with a backoff.
+ */
+enum dps850_tier {
+	PSU_TIER_STATIC,
+	PSU_TIER_SLOW,
+	PSU_TIER_FAST,
+	PSU_TIER_MFR,
+	PSU_TIER_MAX
+};
+
+struct dps850_tier_data {
+	char				valid;		 /* !=0 if registers are valid */
+	char				failed;		 /* !=0 if the last read failed */
+	unsigned long	   last_updated;   /* In jiffies */
+	unsigned long	   retry_at;	   /* In jiffies, if failed */
+	unsigned int		interval;	   /* In ms, 0: never refresh */
+};
+
 /* Each client has this additional data
  */
 struct dps850_data {
 	struct device	  *hwmon_dev;
 	struct mutex		update_lock;
-	char				valid;		 /* !=0 if registers are valid */
-	unsigned long	   last_updated;   /* In jiffies */
+	struct dps850_tier_data tier[PSU_TIER_MAX];
 	u8	 chip;			/* chip id */
 	u8   vout_mode;	 	/* Register value */
 	u16  v_in;		  	/* Register value */
@@ -72,7 +99,11 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
 			 char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf);
-static struct dps850_data *dps850_update_device(struct device *dev);
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+			 char *buf);
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+			 const char *buf, size_t count);
+static struct dps850_data *dps850_update_device(struct device *dev, int index);
 static int dps850_write_word(struct i2c_client *client, u8 reg, u16 value);
 
 enum dps850_sysfs_attributes {
@@ -87,7 +118,25 @@ enum dps850_sysfs_attributes {
 	PSU_TEMP3_INPUT,
 	PSU_FAN1_SPEED,
 	PSU_MFR_MODEL,
-	PSU_MFR_SERIAL
+	PSU_MFR_SERIAL,
+	PSU_ATTR_MAX
+};
+
+/* Register tier backing each attribute
+ */
+static const u8 dps850_attr_tier[PSU_ATTR_MAX] = {
+	[PSU_V_IN]		  = PSU_TIER_FAST,
+	[PSU_V_OUT]		  = PSU_TIER_FAST,
+	[PSU_I_IN]		  = PSU_TIER_FAST,
+	[PSU_I_OUT]		  = PSU_TIER_FAST,
+	[PSU_P_IN]		  = PSU_TIER_FAST,
+	[PSU_P_OUT]		  = PSU_TIER_FAST,
+	[PSU_TEMP1_INPUT] = PSU_TIER_SLOW,
+	[PSU_TEMP2_INPUT] = PSU_TIER_SLOW,
+	[PSU_TEMP3_INPUT] = PSU_TIER_SLOW,
+	[PSU_FAN1_SPEED]  = PSU_TIER_SLOW,
+	[PSU_MFR_MODEL]	  = PSU_TIER_MFR,
+	[PSU_MFR_SERIAL]  = PSU_TIER_MFR
 };
 
 /* sysfs attributes for hwmon
@@ -104,6 +153,9 @@ static SENSOR_DEVICE_ATTR(psu_temp3_input, 	S_IRUGO, show_linear,	NULL, PSU_TEMP
 static SENSOR_DEVICE_ATTR(psu_fan1_speed_rpm, S_IRUGO, show_linear, NULL, PSU_FAN1_SPEED);
 static SENSOR_DEVICE_ATTR(psu_mfr_model,	S_IRUGO, show_ascii,  NULL, PSU_MFR_MODEL);
 static SENSOR_DEVICE_ATTR(psu_mfr_serial,	S_IRUGO, show_ascii, NULL, PSU_MFR_SERIAL);
+static SENSOR_DEVICE_ATTR(update_interval_static, S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_STATIC);
+static SENSOR_DEVICE_ATTR(update_interval_slow,	  S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_SLOW);
+static SENSOR_DEVICE_ATTR(update_interval_fast,	  S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_FAST);
 
 static struct attribute *dps850_attributes[] = {
 	&sensor_dev_attr_psu_v_out.dev_attr.attr,
@@ -118,6 +170,9 @@ static struct attribute *dps850_attributes[] = {
 	&sensor_dev_attr_psu_fan1_speed_rpm.dev_attr.attr,
 	&sensor_dev_attr_psu_mfr_model.dev_attr.attr,
 	&sensor_dev_attr_psu_mfr_serial.dev_attr.attr,
+	&sensor_dev_attr_update_interval_static.dev_attr.attr,
+	&sensor_dev_attr_update_interval_slow.dev_attr.attr,
+	&sensor_dev_attr_update_interval_fast.dev_attr.attr,
 	NULL
 };
 
@@ -133,13 +188,13 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_data *data = dps850_update_device(dev, attr->index);
 
 	u16 value = 0;
 	int exponent, mantissa;
 	int multiplier = 1000;
 
-	if (!data->valid) {
+	if (!data) {
 		return 0;
 	}	
 	
@@ -181,10 +236,10 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_data *data = dps850_update_device(dev, attr->index);
 	u8 *ptr = NULL;
 
-	if (!data->valid) {
+	if (!data) {
 		return 0;
 	}	
 	
@@ -205,11 +260,12 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
-	struct dps850_data *data = dps850_update_device(dev);
+	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+	struct dps850_data *data = dps850_update_device(dev, attr->index);
 	int exponent, mantissa;
 	int multiplier = 1000;
 
-	if (!data->valid) {
+	if (!data) {
 		return 0;
 	}
 
@@ -220,6 +276,39 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
 							sprintf(buf, "%d\n", (mantissa * multiplier) / (1 << -exponent));
 }
 
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+			 char *buf)
+{
+	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+	struct i2c_client *client = to_i2c_client(dev);
+	struct dps850_data *data = i2c_get_clientdata(client);
+
+	return sprintf(buf, "%u\n", data->tier[attr->index].interval);
+}
+
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+			 const char *buf, size_t count)
+{
+	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+	struct i2c_client *client = to_i2c_client(dev);
+	struct dps850_data *data = i2c_get_clientdata(client);
+	unsigned int interval;
+	int error;
+
+	error = kstrtouint(buf, 10, &interval);
+	if (error)
+		return error;
+
+	mutex_lock(&data->update_lock);
+	data->tier[attr->index].interval = interval;
+	if (attr->index == PSU_TIER_STATIC) {
+		data->tier[PSU_TIER_MFR].interval = interval;
+	}
+	mutex_unlock(&data->update_lock);
+
+	return count;
+}
+
 static const struct attribute_group dps850_group = {
 	.attrs = dps850_attributes,
 };
@@ -247,6 +336,10 @@ static int dps850_probe(struct i2c_client *client,
 	i2c_set_clientdata(client, data);
 	mutex_init(&data->update_lock);
 	data->chip = dev_id->driver_data;
+	data->tier[PSU_TIER_STATIC].interval = PSU_TIER_STATIC_INTERVAL;
+	data->tier[PSU_TIER_SLOW].interval   = PSU_TIER_SLOW_INTERVAL;
+	data->tier[PSU_TIER_FAST].interval   = PSU_TIER_FAST_INTERVAL;
+	data->tier[PSU_TIER_MFR].interval	= PSU_TIER_STATIC_INTERVAL;
 	dev_info(&client->dev, "chip found\n");
 
 	/* Register sysfs hooks */
@@ -384,116 +477,165 @@ static int dps850_read_block(struct i2c_client *client, u8 command, u8 *data,
 struct reg_data_byte {
 	u8   reg;
 	u8  *value;
+	u8   tier;
 };
 
 struct reg_data_word {
 	u8   reg;
 	u16 *value;
+	u8   tier;
 };
 
-static struct dps850_data *dps850_update_device(struct device *dev)
+static int dps850_update_tier(struct i2c_client *client, struct dps850_data *data,
+			  int tier)
 {
-	struct i2c_client *client = to_i2c_client(dev);
-	struct dps850_data *data = i2c_get_clientdata(client);
+	int i, status;
+	struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode, PSU_TIER_STATIC}};
+	struct reg_data_word regs_word[] = { {0x88, &data->v_in, PSU_TIER_FAST},
+										 {0x8b, &data->v_out, PSU_TIER_FAST},
+										 {0x89, &data->i_in, PSU_TIER_FAST},
+										 {0x8c, &data->i_out, PSU_TIER_FAST},
+										 {0x96, &data->p_out, PSU_TIER_FAST},
+										 {0x97, &data->p_in, PSU_TIER_FAST},
+										 {0x8d, &(data->temp_input[0]), PSU_TIER_SLOW},
+										 {0x8e, &(data->temp_input[1]), PSU_TIER_SLOW},
+										 {0x8f, &(data->temp_input[2]), PSU_TIER_SLOW},
+										 {0x90, &data->fan_speed, PSU_TIER_SLOW}};
+
+	dev_dbg(&client->dev, "Starting dps850 update, tier %d\n", tier);
+
+	/* Read byte data */
+	for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+		if (regs_byte[i].tier != tier) {
+			continue;
+		}
 
-	mutex_lock(&data->update_lock);
+		status = dps850_read_byte(client, regs_byte[i].reg);
 
-	if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-		|| !data->valid) {
-		int i, status, length;
-		u8 command, buf;
-		struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode}};
-		struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-											 {0x8b, &data->v_out},
-											 {0x89, &data->i_in},
-											 {0x8c, &data->i_out},
-											 {0x96, &data->p_out},
-											 {0x97, &data->p_in},
-											 {0x8d, &(data->temp_input[0])},
-											 {0x8e, &(data->temp_input[1])},
-											 {0x8f, &(data->temp_input[2])},
-											 {0x90, &data->fan_speed}};
-
-		dev_dbg(&client->dev, "Starting dps850 update\n");
-		data->valid = 0;
-
-		/* Read byte data */
-		for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-			status = dps850_read_byte(client, regs_byte[i].reg);
-
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_byte[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_byte[i].value) = status;
-			}
+		if (status < 0) {
+			dev_dbg(&client->dev, "reg %d, err %d\n",
+					regs_byte[i].reg, status);
+			return status;
 		}
+		else {
+			*(regs_byte[i].value) = status;
+		}
+	}
 
-		/* Read word data */
-		for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-			status = dps850_read_word(client, regs_word[i].reg);
+	/* Read word data */
+	for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+		if (regs_word[i].tier != tier) {
+			continue;
+		}
 
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_word[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_word[i].value) = status;
-			}
+		status = dps850_read_word(client, regs_word[i].reg);
+
+		if (status < 0) {
+			dev_dbg(&client->dev, "reg %d, err %d\n",
+					regs_word[i].reg, status);
+			return status;
 		}
+		else {
+			*(regs_word[i].value) = status;
+		}
+	}
+
+	return 0;
+}
+
+/* Read the mfr strings. A string that cannot be read is left empty, the
+ * tier fails only if none can be read.
+ */
+static int dps850_update_mfr(struct i2c_client *client, struct dps850_data *data)
+{
+	int i, status, length, nerrs = 0;
+	u8 buf;
+	struct reg_data_block {
+		u8   reg;
+		u8  *value;
+		int  size;
+	} regs_block[] = { {0x9a, data->mfr_model, ARRAY_SIZE(data->mfr_model)},
+					   {0x9e, data->mfr_serial, ARRAY_SIZE(data->mfr_serial)}};
+
+	for (i = 0; i < ARRAY_SIZE(regs_block); i++) {
+		memset(regs_block[i].value, 0, regs_block[i].size);
 
-		/* Read mfr_model */
-		command = 0x9a;
-		length  = 1;
-		memset(data->mfr_model, 0, sizeof(data->mfr_model));
-		
 		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+		status = dps850_read_block(client, regs_block[i].reg, &buf, 1);
+		if (status >= 0) {
+			length = min_t(int, buf + 1, regs_block[i].size - 1);
+			status = dps850_read_block(client, regs_block[i].reg,
+									   regs_block[i].value, length);
 		}
-		
-		status = dps850_read_block(client, command, data->mfr_model, buf+1);
-		data->mfr_model[buf+1] = '\0';
 
 		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+			dev_dbg(&client->dev, "reg %d, err %d\n", regs_block[i].reg, status);
+			memset(regs_block[i].value, 0, regs_block[i].size);
+			nerrs++;
+		}
+	}
+
+	return (nerrs == ARRAY_SIZE(regs_block)) ? -EIO : 0;
+}
+
+/* Refresh the registers backing attribute 'index', plus the static tier
+ * (vout_mode is needed to scale psu_v_out). Returns NULL if they could
+ * not be read.
+ */
+static struct dps850_data *dps850_update_device(struct device *dev, int index)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct dps850_data *data = i2c_get_clientdata(client);
+	int tiers[] = { PSU_TIER_STATIC, dps850_attr_tier[index] };
+	int i, j, status = 0;
+
+	mutex_lock(&data->update_lock);
+
+	for (i = 0; i < ARRAY_SIZE(tiers); i++) {
+		struct dps850_tier_data *tier = &data->tier[tiers[i]];
+
+		if (tier->valid && (!tier->interval ||
+			!time_after(jiffies, tier->last_updated + msecs_to_jiffies(tier->interval)))) {
+			continue;
 		}
 
+		if (tier->failed && time_before(jiffies, tier->retry_at)) {
+			status = -EIO;
+			break;
+		}
 
-		/* Read mfr_serial */
-		command = 0x9e;
-		length  = 1;
-		memset(data->mfr_serial, 0, sizeof(data->mfr_serial));
-		
-		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+		tier->valid = 0;
+		if (tiers[i] == PSU_TIER_MFR) {
+			status = dps850_update_mfr(client, data);
+		}
+		else {
+			status = dps850_update_tier(client, data, tiers[i]);
+		}
+
+		if (status < 0 && tiers[i] == PSU_TIER_MFR) {
+			/* Not supported by this PSU, or it is gone. Back off. */
+			tier->failed = 1;
+			tier->retry_at = jiffies + msecs_to_jiffies(PSU_TIER_MFR_RETRY_INTERVAL);
+			break;
 		}
-		
- 		status = dps850_read_block(client, command, data->mfr_serial, buf+1);
-		data->mfr_serial[buf+1] = '\0';
 
 		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+			/* The PSU may be gone, re-read everything once it is back */
+			for (j = 0; j < PSU_TIER_MAX; j++) {
+				data->tier[j].valid = 0;
+				data->tier[j].failed = 0;
+			}
+			break;
 		}
 
-		data->last_updated = jiffies;
-		data->valid = 1;
+		tier->last_updated = jiffies;
+		tier->valid = 1;
+		tier->failed = 0;
 	}
 
-exit:
 	mutex_unlock(&data->update_lock);
 
-	return data;
+	return (status < 0) ? NULL : data;
 }
 
 static int __init dps850_init(void)
@@ -104,6 +104,34 @@
  * NOTE: This version of the driver ONLY SUPPORTS BANK 0 PAGES on CMIS
  * devices.
  *
+ * Page cache (optional, see the page_cache module parameter and the
+ * per-device 'page_cache' sysfs attribute):
+ *
+ * The identity pages do not change while a module stays inserted, yet
+ * userspace re-reads them on every poll.  With the cache enabled, reads
+ * of the static pages below are served from memory after the first
+ * access.  Everything else (lower page 00h of QSFP/CMIS, all of A2h on
+ * SFP, and every other page) is volatile and always goes to hardware.
+ *
+ *	SFP (optoe2)	A0h lower and upper (offset 0-255)
+ *	QSFP (optoe1)	upper page 00h and 01h (offset 128-383)
+ *	CMIS (optoe3)	upper page 00h, 01h and 02h (offset 128-511)
+ *
+ * Before a cached page is returned, the identifier byte is read from
+ * the module.  A failed read or a changed identifier is treated as a
+ * presence transition and drops the cache, as does any failed transfer.
+ * Platform code that sees presence changes directly (a CPLD or an
+ * interrupt) should write to 'invalidate' so that a module swapped for
+ * one of the same type is not missed.
+ *
+ * While the cache is enabled the driver also remembers the last page
+ * written to the page select register during a request, skips
+ * redundant page select writes within it and no longer restores
+ * page 0 after each paged access.  The page is selected again by the
+ * first paged access of every request, since a replacement module
+ * powers up on page 0.
+ * Hits, misses and page select counts are reported in 'cache_stats'.
+ *
  **/
 
 /* #define DEBUG 1 */
@@ -181,6 +209,10 @@ struct optoe_platform_data {
 #define OPTOE_WRITE_OP 1
 #define OPTOE_EOF 0  /* used for access beyond end of device */
 
+/* page cache geometry, in 128 byte chunks of the linear address space */
+#define OPTOE_CACHE_CHUNKS 4
+#define OPTOE_PAGE_UNKNOWN -1
+
 struct optoe_data {
 	struct optoe_platform_data chip;
 	int use_smbus;
@@ -206,6 +238,17 @@ struct optoe_data {
 	/* dev_class: ONE_ADDR (QSFP) or TWO_ADDR (SFP) */
 	int dev_class;
 
+	/* page cache, all protected by lock */
+	int cache_enabled;
+	u8 *cache;			/* OPTOE_CACHE_CHUNKS pages */
+	unsigned long cache_valid;	/* bitmap of filled chunks */
+	u8 cache_id;			/* identifier byte of cached module */
+	int cur_page;			/* page select reg, or OPTOE_PAGE_UNKNOWN */
+	unsigned long cache_hits;
+	unsigned long cache_misses;
+	unsigned long page_selects;
+	unsigned long page_selects_skipped;
+
 	struct i2c_client *client[];
 };
 
@@ -227,6 +270,15 @@ static unsigned int io_limit = OPTOE_PAGE_SIZE;
  */
 static unsigned int write_timeout = 25;
 
+/*
+ * Initial state of the per-device page cache.  Off by default since a
+ * module swapped for an identical type between two reads can only be
+ * detected by the platform; see the description at the top of the file.
+ */
+static bool page_cache;
+module_param(page_cache, bool, 0444);
+MODULE_PARM_DESC(page_cache, "Cache static EEPROM pages (default: 0)");
+
 /*
  * flags to distinguish one-address (QSFP family) from two-address (SFP family)
  * If the family is not known, figure it out when the device is accessed
@@ -504,6 +556,45 @@ static ssize_t optoe_eeprom_write(struct optoe_data *optoe,
 	return -ETIMEDOUT;
 }
 
+/*
+ * The page select register lives on client[0] for single address
+ * devices and on client[1] (0x51) for SFP.
+ */
+static struct i2c_client *optoe_paged_client(struct optoe_data *optoe)
+{
+	return optoe->client[(optoe->dev_class == TWO_ADDR) ? 1 : 0];
+}
+
+static void optoe_cache_invalidate(struct optoe_data *optoe)
+{
+	optoe->cache_valid = 0;
+	optoe->cur_page = OPTOE_PAGE_UNKNOWN;
+}
+
+/*
+ * Write the page select register, skipping the write when the page
+ * cache knows the device is already on that page.
+ */
+static int optoe_select_page(struct optoe_data *optoe,
+		struct i2c_client *client, uint8_t page)
+{
+	int ret;
+
+	if (optoe->cache_enabled && optoe->cur_page == page) {
+		optoe->page_selects_skipped++;
+		return 0;
+	}
+
+	ret = optoe_eeprom_write(optoe, client, &page,
+		OPTOE_PAGE_SELECT_REG, 1);
+	if (ret < 0) {
+		optoe->cur_page = OPTOE_PAGE_UNKNOWN;
+		return ret;
+	}
+	optoe->cur_page = page;
+	optoe->page_selects++;
+	return ret;
+}
 
 static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 				char *buf, loff_t off,
@@ -519,9 +610,15 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	dev_dbg(&client->dev,
 		"%s off %lld  page:%d phy_offset:%lld, count:%ld, opcode:%d\n",
 		__func__, off, page, phy_offset, (long int) count, opcode);
-	if (page > 0) {
-		ret = optoe_eeprom_write(optoe, client, &page,
-			OPTOE_PAGE_SELECT_REG, 1);
+	/*
+	 * Without the cache, page 0 is assumed to be selected between
+	 * accesses.  With it, the last page selected is tracked instead,
+	 * so the upper half of the paged client always needs a check.
+	 */
+	if (page > 0 || (optoe->cache_enabled &&
+			phy_offset >= OPTOE_PAGE_SIZE &&
+			client == optoe_paged_client(optoe))) {
+		ret = optoe_select_page(optoe, client, page);
 		if (ret < 0) {
 			dev_dbg(&client->dev,
 				"Write page register for page %d failed ret:%d!\n",
@@ -552,11 +649,10 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	}
 
 
-	if (page > 0) {
+	if (page > 0 && !optoe->cache_enabled) {
 		/* return the page register to page 0 (why?) */
 		page = 0;
-		ret = optoe_eeprom_write(optoe, client, &page,
-			OPTOE_PAGE_SELECT_REG, 1);
+		ret = optoe_select_page(optoe, client, page);
 		if (ret < 0) {
 			dev_err(&client->dev,
 				"Restore page register to 0 failed:%d!\n", ret);
@@ -672,6 +768,82 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 	return len;
 }
 
+/*
+ * Static chunks hold identity and advertising data that cannot change
+ * while the module stays inserted.  Chunks are 128 byte units of the
+ * linear address space presented by this driver (chunk = offset / 128).
+ */
+static int optoe_chunk_static(struct optoe_data *optoe, int chunk)
+{
+	if (chunk >= OPTOE_CACHE_CHUNKS)
+		return 0;
+
+	switch (optoe->dev_class) {
+	case TWO_ADDR:
+		/* A0h, lower and upper */
+		return chunk <= 1;
+	case ONE_ADDR:
+		/* upper page 00h (ID fields) and 01h (AST table) */
+		return chunk == 1 || chunk == 2;
+	case CMIS_ADDR:
+		/* upper page 00h, 01h (advertising) and 02h (thresholds) */
+		return chunk >= 1 && chunk <= 3;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Make sure the module behind the cache is the one that filled it.
+ * Called once per request, before the first cached chunk is used.
+ */
+static int optoe_cache_check(struct optoe_data *optoe)
+{
+	u8 id;
+	int status;
+
+	status = optoe_eeprom_read(optoe, optoe->client[0], &id,
+			OPTOE_ID_REG, 1);
+	if (status < 0) {
+		optoe_cache_invalidate(optoe);
+		return status;
+	}
+	if (optoe->cache_valid && id != optoe->cache_id) {
+		dev_dbg(&optoe->client[0]->dev,
+			"identifier changed 0x%x -> 0x%x, dropping cache\n",
+			optoe->cache_id, id);
+		optoe_cache_invalidate(optoe);
+	}
+	optoe->cache_id = id;
+	return 0;
+}
+
+/*
+ * Serve 'len' bytes at 'offset' (within 'chunk') from the cache,
+ * filling the whole chunk from hardware on a miss.
+ */
+static ssize_t optoe_cache_read(struct optoe_data *optoe, char *buf,
+		int chunk, loff_t offset, size_t len)
+{
+	loff_t chunk_start = chunk * OPTOE_PAGE_SIZE;
+	u8 *page = optoe->cache + chunk_start;
+	ssize_t status;
+
+	if (!test_bit(chunk, &optoe->cache_valid)) {
+		status = optoe_eeprom_update_client(optoe, (char *)page, chunk_start,
+				OPTOE_PAGE_SIZE, OPTOE_READ_OP);
+		if (status != OPTOE_PAGE_SIZE)
+			return (status < 0) ? status : -EIO;
+		set_bit(chunk, &optoe->cache_valid);
+		optoe->cache_misses++;
+	} else {
+		optoe->cache_hits++;
+	}
+
+	memcpy(buf, page + (offset - chunk_start), len);
+	return len;
+}
+
 static ssize_t optoe_read_write(struct optoe_data *optoe,
 		char *buf, loff_t off, size_t len, int opcode)
 {
@@ -682,6 +854,8 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 	size_t pending_len = 0, chunk_len = 0;
 	loff_t chunk_offset = 0, chunk_start_offset = 0;
 	loff_t chunk_end_offset = 0;
+	loff_t select_reg;
+	int cached, checked = 0;
 
 	dev_dbg(&client->dev,
 		"%s: off %lld  len:%ld, opcode:%s\n",
@@ -696,11 +870,19 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 	 */
 	mutex_lock(&optoe->lock);
 
+	/*
+	 * The module may have been replaced, or its page changed by
+	 * another master, since the last request.
+	 */
+	optoe->cur_page = OPTOE_PAGE_UNKNOWN;
+
 	/*
 	 * Confirm this access fits within the device suppored addr range
 	 */
 	status = optoe_page_legal(optoe, off, len);
 	if ((status == OPTOE_EOF) || (status < 0)) {
+		if (status < 0)
+			optoe_cache_invalidate(optoe);
 		mutex_unlock(&optoe->lock);
 		return status;
 	}
@@ -752,17 +934,36 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 			off, (long int) len, chunk_start_offset, chunk_offset,
 			(long int) chunk_len, (long int) pending_len);
 
+		cached = optoe->cache_enabled && optoe_chunk_static(optoe, chunk);
+		if (cached && opcode == OPTOE_READ_OP && !checked) {
+			status = optoe_cache_check(optoe);
+			if (status < 0) {
+				if (retval == 0)
+					retval = status;
+				break;
+			}
+			checked = 1;
+		}
+
 		/*
 		 * note: chunk_offset is from the start of the EEPROM,
 		 * not the start of the chunk
 		 */
-		status = optoe_eeprom_update_client(optoe, buf,
-				chunk_offset, chunk_len, opcode);
+		if (cached && opcode == OPTOE_READ_OP) {
+			status = optoe_cache_read(optoe, buf, chunk,
+					chunk_offset, chunk_len);
+		} else {
+			if (cached)
+				clear_bit(chunk, &optoe->cache_valid);
+			status = optoe_eeprom_update_client(optoe, buf,
+					chunk_offset, chunk_len, opcode);
+		}
 		if (status != chunk_len) {
 			/* This is another 'no device present' path */
 			dev_dbg(&client->dev,
 			"o_u_c: chunk %d c_offset %lld c_len %ld failed %d!\n",
 			chunk, chunk_offset, (long int) chunk_len, status);
+			optoe_cache_invalidate(optoe);
 			if (status > 0)
 				retval += status;
 			if (retval == 0)
@@ -773,6 +974,14 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 		pending_len -= status;
 		retval += status;
 	}
+
+	/* a direct write to the page select register loses track of it */
+	select_reg = OPTOE_PAGE_SELECT_REG;
+	if (optoe->dev_class == TWO_ADDR)
+		select_reg += 2 * OPTOE_PAGE_SIZE;
+	if (opcode == OPTOE_WRITE_OP && off <= select_reg &&
+			off + len > select_reg)
+		optoe->cur_page = OPTOE_PAGE_UNKNOWN;
 	mutex_unlock(&optoe->lock);
 
 	return retval;
@@ -818,6 +1027,7 @@ static int optoe_remove(struct i2c_client *client)
 #endif
 
 	kfree(optoe->writebuf);
+	kfree(optoe->cache);
 	kfree(optoe);
 	return 0;
 }
@@ -879,6 +1089,7 @@ static ssize_t set_dev_class(struct device *dev,
 		optoe->num_addresses = 1;
 	}
 	optoe->dev_class = dev_class;
+	optoe_cache_invalidate(optoe);
 	mutex_unlock(&optoe->lock);
 
 	return count;
@@ -928,13 +1139,96 @@ static ssize_t set_port_name(struct device *dev,
 static DEVICE_ATTR(port_name,  0644, show_port_name, set_port_name);
 #endif  /* if NOT defined EEPROM_CLASS, the common case */
 
+static ssize_t show_page_cache(struct device *dev,
+			struct device_attribute *dattr, char *buf)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	ssize_t count;
+
+	mutex_lock(&optoe->lock);
+	count = sprintf(buf, "%d\n", optoe->cache_enabled);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+static ssize_t set_page_cache(struct device *dev,
+			struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	struct i2c_client *paged;
+	bool enable;
+	u8 page = 0;
+
+	if (strtobool(buf, &enable) != 0)
+		return -EINVAL;
+
+	mutex_lock(&optoe->lock);
+	if (optoe->cache_enabled && !enable) {
+		/*
+		 * Uncached accesses assume page 0 is selected, put it
+		 * back.  Failure only means the module is gone.
+		 */
+		paged = optoe_paged_client(optoe);
+		if (paged && optoe->cur_page != 0)
+			optoe_eeprom_write(optoe, paged, &page,
+				OPTOE_PAGE_SELECT_REG, 1);
+	}
+	optoe->cache_enabled = enable;
+	optoe_cache_invalidate(optoe);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+static ssize_t set_invalidate(struct device *dev,
+			struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+
+	/* any write drops the cache, the value is ignored */
+	mutex_lock(&optoe->lock);
+	optoe_cache_invalidate(optoe);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+static ssize_t show_cache_stats(struct device *dev,
+			struct device_attribute *dattr, char *buf)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	ssize_t count;
+
+	mutex_lock(&optoe->lock);
+	count = sprintf(buf,
+		"hits: %lu\nmisses: %lu\npage_selects: %lu\npage_selects_skipped: %lu\n",
+		optoe->cache_hits, optoe->cache_misses,
+		optoe->page_selects, optoe->page_selects_skipped);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
 static DEVICE_ATTR(dev_class,  0644, show_dev_class, set_dev_class);
+static DEVICE_ATTR(page_cache, 0644, show_page_cache, set_page_cache);
+static DEVICE_ATTR(invalidate, 0200, NULL, set_invalidate);
+static DEVICE_ATTR(cache_stats, 0444, show_cache_stats, NULL);
 
 static struct attribute *optoe_attrs[] = {
 #ifndef EEPROM_CLASS
 	&dev_attr_port_name.attr,
 #endif
 	&dev_attr_dev_class.attr,
+	&dev_attr_page_cache.attr,
+	&dev_attr_invalidate.attr,
+	&dev_attr_cache_stats.attr,
 	NULL,
 };
 
@@ -1016,6 +1310,15 @@ static int optoe_probe(struct i2c_client *client,
 
 	mutex_init(&optoe->lock);
 
+	optoe->cache = kzalloc(OPTOE_CACHE_CHUNKS * OPTOE_PAGE_SIZE,
+			GFP_KERNEL);
+	if (!optoe->cache) {
+		err = -ENOMEM;
+		goto exit_kfree;
+	}
+	optoe->cache_enabled = page_cache;
+	optoe->cur_page = OPTOE_PAGE_UNKNOWN;
+
 	/* determine whether this is a one-address or two-address module */
 	if ((strcmp(client->name, "optoe1") == 0) ||
 	    (strcmp(client->name, "sff8436") == 0)) {
@@ -1155,6 +1458,7 @@ err_struct:
 
 	kfree(optoe->writebuf);
 exit_kfree:
+	kfree(optoe->cache);
 	kfree(optoe);
 exit:
 	dev_dbg(&client->dev, "probe error %d\n", err);
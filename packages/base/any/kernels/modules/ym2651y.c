@@ -39,6 +39,12 @@
 #define I2C_RW_RETRY_COUNT      10
 #define I2C_RW_RETRY_INTERVAL   60 /* ms */
 
+/* Default refresh interval of each register tier, see update_interval_* */
+#define PSU_TIER_STATIC_INTERVAL    10000 /* ms, also picks up a hot-swapped PSU */
+#define PSU_TIER_SLOW_INTERVAL      3000 /* ms */
+#define PSU_TIER_FAST_INTERVAL      1500 /* ms */
+#define PSU_TIER_MFR_RETRY_INTERVAL 30000 /* ms, after the mfr data could not be read */
+
 static int support_i2c_block = 1; // 1: support I2C_FUNC_SMBUS_I2C_BLOCK 0: not support
 
 /* Addresses scanned
@@ -53,13 +59,36 @@ enum chips {
     YPEB1200AM
 };
 
+/* Registers are refreshed in tiers, only the tier holding the requested
+ * attribute is read. Static registers (capability and limits) and the mfr
+ * strings are refreshed at the static interval, since ONLP only checks the
+ * CPLD presence bit and a replaced PSU may never fail a read here. The mfr
+ * block reads are not implemented by some PSUs, so they have their own
+ * tier which the telemetry does not depend on, and are retried with a
+ * backoff.
+ */
+enum ym2651y_tier {
+    PSU_TIER_STATIC,
+    PSU_TIER_SLOW,
+    PSU_TIER_FAST,
+    PSU_TIER_MFR,
+    PSU_TIER_MAX
+};
+
+struct ym2651y_tier_data {
+    char                valid;         /* !=0 if registers are valid */
+    char                failed;        /* !=0 if the last read failed */
+    unsigned long       last_updated;  /* In jiffies */
+    unsigned long       retry_at;      /* In jiffies, if failed */
+    unsigned int        interval;      /* In ms, 0: never refresh */
+};
+
 /* Each client has this additional data
  */
 struct ym2651y_data {
     struct device     *hwmon_dev;
     struct mutex        update_lock;
-    char                valid;         /* !=0 if registers are valid */
-    unsigned long      last_updated;    /* In jiffies */
+    struct ym2651y_tier_data tier[PSU_TIER_MAX];
     u8   chip;          /* chip id */
     u8   capability;     /* Register value */
     u16  status_word;   /* Register value */
@@ -105,7 +134,11 @@ static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf);
-static struct ym2651y_data *ym2651y_update_device(struct device *dev);
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+             char *buf);
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+             const char *buf, size_t count);
+static struct ym2651y_data *ym2651y_update_device(struct device *dev, int index);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da,
              const char *buf, size_t count);
 static int ym2651y_write_word(struct i2c_client *client, u8 reg, u16 value);
@@ -141,7 +174,44 @@ enum ym2651y_sysfs_attributes {
     PSU_MFR_IOUT_MAX,
     PSU_MFR_PIN_MAX,
     PSU_MFR_POUT_MAX,
-    PSU_MFR_MODEL_OPTION
+    PSU_MFR_MODEL_OPTION,
+    PSU_ATTR_MAX
+};
+
+/* Register tier backing each attribute
+ */
+static const u8 ym2651y_attr_tier[PSU_ATTR_MAX] = {
+    [PSU_POWER_ON]         = PSU_TIER_FAST,
+    [PSU_TEMP_FAULT]       = PSU_TIER_FAST,
+    [PSU_POWER_GOOD]       = PSU_TIER_FAST,
+    [PSU_FAN1_FAULT]       = PSU_TIER_FAST,
+    [PSU_FAN_DIRECTION]    = PSU_TIER_MFR,
+    [PSU_OVER_TEMP]        = PSU_TIER_FAST,
+    [PSU_V_IN]             = PSU_TIER_FAST,
+    [PSU_I_IN]             = PSU_TIER_FAST,
+    [PSU_P_IN]             = PSU_TIER_FAST,
+    [PSU_V_OUT]            = PSU_TIER_FAST,
+    [PSU_I_OUT]            = PSU_TIER_FAST,
+    [PSU_P_OUT]            = PSU_TIER_FAST,
+    [PSU_TEMP1_INPUT]      = PSU_TIER_SLOW,
+    [PSU_TEMP2_INPUT]      = PSU_TIER_SLOW,
+    [PSU_TEMP3_INPUT]      = PSU_TIER_SLOW,
+    [PSU_FAN1_SPEED]       = PSU_TIER_SLOW,
+    [PSU_FAN1_DUTY_CYCLE]  = PSU_TIER_SLOW,
+    [PSU_PMBUS_REVISION]   = PSU_TIER_STATIC,
+    [PSU_MFR_ID]           = PSU_TIER_MFR,
+    [PSU_MFR_MODEL]        = PSU_TIER_MFR,
+    [PSU_MFR_REVISION]     = PSU_TIER_MFR,
+    [PSU_MFR_SERIAL]       = PSU_TIER_MFR,
+    [PSU_MFR_VIN_MIN]      = PSU_TIER_STATIC,
+    [PSU_MFR_VIN_MAX]      = PSU_TIER_STATIC,
+    [PSU_MFR_VOUT_MIN]     = PSU_TIER_STATIC,
+    [PSU_MFR_VOUT_MAX]     = PSU_TIER_STATIC,
+    [PSU_MFR_IIN_MAX]      = PSU_TIER_STATIC,
+    [PSU_MFR_IOUT_MAX]     = PSU_TIER_STATIC,
+    [PSU_MFR_PIN_MAX]      = PSU_TIER_STATIC,
+    [PSU_MFR_POUT_MAX]     = PSU_TIER_STATIC,
+    [PSU_MFR_MODEL_OPTION] = PSU_TIER_MFR
 };
 
 /* sysfs attributes for hwmon
@@ -177,6 +247,9 @@ static SENSOR_DEVICE_ATTR(psu_mfr_iout_max, S_IRUGO, show_linear, NULL, PSU_MFR_
 static SENSOR_DEVICE_ATTR(psu_mfr_pin_max,  S_IRUGO, show_linear, NULL, PSU_MFR_PIN_MAX);
 static SENSOR_DEVICE_ATTR(psu_mfr_pout_max, S_IRUGO, show_linear, NULL, PSU_MFR_POUT_MAX);
 static SENSOR_DEVICE_ATTR(psu_mfr_model_opt,S_IRUGO, show_ascii,  NULL, PSU_MFR_MODEL_OPTION);
+static SENSOR_DEVICE_ATTR(update_interval_static, S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_STATIC);
+static SENSOR_DEVICE_ATTR(update_interval_slow,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_SLOW);
+static SENSOR_DEVICE_ATTR(update_interval_fast,   S_IWUSR | S_IRUGO, show_interval, set_interval, PSU_TIER_FAST);
 
 static struct attribute *ym2651y_attributes[] = {
     &sensor_dev_attr_psu_power_on.dev_attr.attr,
@@ -210,6 +283,9 @@ static struct attribute *ym2651y_attributes[] = {
     &sensor_dev_attr_psu_mfr_vout_max.dev_attr.attr,
     &sensor_dev_attr_psu_mfr_iout_max.dev_attr.attr,
     &sensor_dev_attr_psu_mfr_model_opt.dev_attr.attr,
+    &sensor_dev_attr_update_interval_static.dev_attr.attr,
+    &sensor_dev_attr_update_interval_slow.dev_attr.attr,
+    &sensor_dev_attr_update_interval_fast.dev_attr.attr,
     NULL
 };
 
@@ -217,9 +293,9 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -231,10 +307,10 @@ static ssize_t show_word(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     u16 status = 0;
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -292,18 +368,19 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     u8 *ptr = NULL;
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 1000;
-    ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
+    ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
+
     switch (attr->index) {
     case PSU_V_IN:
         if ((strncmp(ptr, "DPS-850A", strlen("DPS-850A")) == 0)||
@@ -384,10 +461,10 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     u8 shift;
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -399,9 +476,10 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
 static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -412,10 +490,10 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     u8 *ptr = NULL;
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -460,11 +538,11 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     int exponent, mantissa;
     int multiplier = 1000;
 
-    if (!data->valid) {
+    if (!data) {
         return 0;
     }
 
@@ -490,10 +568,14 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct i2c_client *client = to_i2c_client(dev);
-    struct ym2651y_data *data = i2c_get_clientdata(client);
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct ym2651y_data *data = ym2651y_update_device(dev, attr->index);
     u8 *ptr = NULL;
 
+    if (!data) {
+        return 0;
+    }
+
     ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
     if (data->chip == YM2401) {
         return show_vout_by_mode(dev, da, buf);
@@ -507,6 +589,39 @@ static ssize_t show_vout(struct device *dev, struct device_attribute *da,
     }
 }
 
+static ssize_t show_interval(struct device *dev, struct device_attribute *da,
+             char *buf)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct ym2651y_data *data = i2c_get_clientdata(client);
+
+    return sprintf(buf, "%u\n", data->tier[attr->index].interval);
+}
+
+static ssize_t set_interval(struct device *dev, struct device_attribute *da,
+             const char *buf, size_t count)
+{
+    struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
+    struct i2c_client *client = to_i2c_client(dev);
+    struct ym2651y_data *data = i2c_get_clientdata(client);
+    unsigned int interval;
+    int error;
+
+    error = kstrtouint(buf, 10, &interval);
+    if (error)
+        return error;
+
+    mutex_lock(&data->update_lock);
+    data->tier[attr->index].interval = interval;
+    if (attr->index == PSU_TIER_STATIC) {
+        data->tier[PSU_TIER_MFR].interval = interval;
+    }
+    mutex_unlock(&data->update_lock);
+
+    return count;
+}
+
 static const struct attribute_group ym2651y_group = {
     .attrs = ym2651y_attributes,
 };
@@ -538,6 +653,10 @@ static int ym2651y_probe(struct i2c_client *client,
     i2c_set_clientdata(client, data);
     mutex_init(&data->update_lock);
     data->chip = dev_id->driver_data;
+    data->tier[PSU_TIER_STATIC].interval = PSU_TIER_STATIC_INTERVAL;
+    data->tier[PSU_TIER_SLOW].interval   = PSU_TIER_SLOW_INTERVAL;
+    data->tier[PSU_TIER_FAST].interval   = PSU_TIER_FAST_INTERVAL;
+    data->tier[PSU_TIER_MFR].interval    = PSU_TIER_STATIC_INTERVAL;
     dev_info(&client->dev, "chip found\n");
 
     /* Register sysfs hooks */
@@ -679,183 +798,207 @@ static int ym2651y_read_block(struct i2c_client *client, u8 command, u8 *data,
 struct reg_data_byte {
     u8   reg;
     u8  *value;
+    u8   tier;
 };
 
 struct reg_data_word {
     u8   reg;
     u16 *value;
+    u8   tier;
 };
 
-static struct ym2651y_data *ym2651y_update_device(struct device *dev)
+static int ym2651y_update_tier(struct i2c_client *client, struct ym2651y_data *data,
+              int tier)
 {
-    struct i2c_client *client = to_i2c_client(dev);
-    struct ym2651y_data *data = i2c_get_clientdata(client);
-
-    mutex_lock(&data->update_lock);
-
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {0x19, &data->capability},
-                                             {0x20, &data->vout_mode},
-                                             {0x7d, &data->over_temp},
-                                             {0x81, &data->fan_fault},
-                                             {0x98, &data->pmbus_revision}};
-        struct reg_data_word regs_word[] = { {0x79, &data->status_word},
-                                             {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x97, &data->p_in},
-                                             {0x96, &data->p_out},
-                                             {0x8d, &(data->temp[0])},
-                                             {0x8e, &(data->temp[1])},
-                                             {0x8f, &(data->temp[2])},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &data->fan_speed},
-                                             {0xa0, &data->mfr_vin_min},
-                                             {0xa1, &data->mfr_vin_max},
-                                             {0xa2, &data->mfr_iin_max},
-                                             {0xa3, &data->mfr_pin_max},
-                                             {0xa4, &data->mfr_vout_min},
-                                             {0xa5, &data->mfr_vout_max},
-                                             {0xa6, &data->mfr_iout_max},
-                                             {0xa7, &data->mfr_pout_max}};
-
-        dev_dbg(&client->dev, "Starting ym2651 update\n");
-        data->valid = 0;
-
-        /* Read byte data */
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = ym2651y_read_byte(client, regs_byte[i].reg);
-
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    int i, status;
+    struct reg_data_byte regs_byte[] = { {0x19, &data->capability, PSU_TIER_STATIC},
+                                         {0x20, &data->vout_mode, PSU_TIER_STATIC},
+                                         {0x7d, &data->over_temp, PSU_TIER_FAST},
+                                         {0x81, &data->fan_fault, PSU_TIER_FAST},
+                                         {0x98, &data->pmbus_revision, PSU_TIER_STATIC}};
+    struct reg_data_word regs_word[] = { {0x79, &data->status_word, PSU_TIER_FAST},
+                                         {0x88, &data->v_in, PSU_TIER_FAST},
+                                         {0x8b, &data->v_out, PSU_TIER_FAST},
+                                         {0x89, &data->i_in, PSU_TIER_FAST},
+                                         {0x8c, &data->i_out, PSU_TIER_FAST},
+                                         {0x97, &data->p_in, PSU_TIER_FAST},
+                                         {0x96, &data->p_out, PSU_TIER_FAST},
+                                         {0x8d, &(data->temp[0]), PSU_TIER_SLOW},
+                                         {0x8e, &(data->temp[1]), PSU_TIER_SLOW},
+                                         {0x8f, &(data->temp[2]), PSU_TIER_SLOW},
+                                         {0x3b, &(data->fan_duty_cycle[0]), PSU_TIER_SLOW},
+                                         {0x3c, &(data->fan_duty_cycle[1]), PSU_TIER_SLOW},
+                                         {0x90, &data->fan_speed, PSU_TIER_SLOW},
+                                         {0xa0, &data->mfr_vin_min, PSU_TIER_STATIC},
+                                         {0xa1, &data->mfr_vin_max, PSU_TIER_STATIC},
+                                         {0xa2, &data->mfr_iin_max, PSU_TIER_STATIC},
+                                         {0xa3, &data->mfr_pin_max, PSU_TIER_STATIC},
+                                         {0xa4, &data->mfr_vout_min, PSU_TIER_STATIC},
+                                         {0xa5, &data->mfr_vout_max, PSU_TIER_STATIC},
+                                         {0xa6, &data->mfr_iout_max, PSU_TIER_STATIC},
+                                         {0xa7, &data->mfr_pout_max, PSU_TIER_STATIC}};
+
+    dev_dbg(&client->dev, "Starting ym2651 update, tier %d\n", tier);
+
+    /* Read byte data */
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        if (regs_byte[i].tier != tier) {
+            continue;
         }
 
-        /* Read word data */
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = ym2651y_read_word(client, regs_word[i].reg);
+        status = ym2651y_read_byte(client, regs_byte[i].reg);
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_word[i].value) = status;
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            return status;
         }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
 
-        if (support_i2c_block) {
+    /* Read word data */
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        if (regs_word[i].tier != tier) {
+            continue;
+        }
 
-            /* Read fan_direction */
-            command = 0xC3;
-            status = ym2651y_read_block(client, command, data->fan_dir,
-                                         ARRAY_SIZE(data->fan_dir)-1);
-            data->fan_dir[ARRAY_SIZE(data->fan_dir)-1] = '\0';
+        status = ym2651y_read_word(client, regs_word[i].reg);
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            return status;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
 
-            /* Read mfr_id */
-            command = 0x99;
-            status = ym2651y_read_block(client, command, data->mfr_id,
-                                            ARRAY_SIZE(data->mfr_id)-1);
-            data->mfr_id[ARRAY_SIZE(data->mfr_id)-1] = '\0';
+    return 0;
+}
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+/* Read fan_dir and the mfr strings. A string that cannot be read is left
+ * empty, the tier fails only if none can be read.
+ */
+static int ym2651y_update_mfr(struct i2c_client *client, struct ym2651y_data *data)
+{
+    int i, status, length, nerrs = 0;
+    u8 buf;
+    struct reg_data_block {
+        u8   reg;
+        u8  *value;
+        int  size;
+        int  counted;   /* The first byte gives the length */
+    } regs_block[] = { {0xc3, data->fan_dir, ARRAY_SIZE(data->fan_dir), 0},
+                       {0x99, data->mfr_id, ARRAY_SIZE(data->mfr_id), 0},
+                       {0x9a, data->mfr_model, ARRAY_SIZE(data->mfr_model), 1},
+                       {0xd0, data->mfr_model_opt, ARRAY_SIZE(data->mfr_model_opt), 1},
+                       {0x9b, data->mfr_revsion, ARRAY_SIZE(data->mfr_revsion), 0},
+                       {0x9e, data->mfr_serial, ARRAY_SIZE(data->mfr_serial), 1},
+                       };
+
+    if (!support_i2c_block) {
+        return 0;
+    }
 
-            /* Read mfr_model */
-            command = 0x9a;
-            length  = 1;
+    for (i = 0; i < ARRAY_SIZE(regs_block); i++) {
+        length = regs_block[i].size - 1;
+        status = 0;
 
+        if (regs_block[i].counted) {
             /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+            status = ym2651y_read_block(client, regs_block[i].reg, &buf, 1);
+            if (status >= 0 && buf + 1 < length) {
+                length = buf + 1;
             }
+        }
 
-            status = ym2651y_read_block(client, command, data->mfr_model, buf+1);
-            data->mfr_model[buf+1] = '\0';
+        if (status >= 0) {
+            status = ym2651y_read_block(client, regs_block[i].reg,
+                                        regs_block[i].value, length);
+        }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", regs_block[i].reg, status);
+            memset(regs_block[i].value, 0, regs_block[i].size);
+            nerrs++;
+            continue;
+        }
 
-            /* Read mfr_model_opt */
-            command = 0xd0;
-            length  = 1;
+        regs_block[i].value[length] = '\0';
+    }
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    return (nerrs == ARRAY_SIZE(regs_block)) ? -EIO : 0;
+}
 
-            status = ym2651y_read_block(client, command, data->mfr_model_opt, buf+1);
-            data->mfr_model_opt[buf+1] = '\0';
+/* Refresh the registers backing attribute 'index', plus the static and
+ * mfr tiers every attribute may depend on (vout_mode, mfr_model). Only
+ * the mfr attributes themselves fail when the mfr tier cannot be read.
+ * Returns NULL if the registers could not be read.
+ */
+static struct ym2651y_data *ym2651y_update_device(struct device *dev, int index)
+{
+    struct i2c_client *client = to_i2c_client(dev);
+    struct ym2651y_data *data = i2c_get_clientdata(client);
+    int tiers[] = { PSU_TIER_STATIC, PSU_TIER_MFR, ym2651y_attr_tier[index] };
+    int i, j, status = 0;
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    mutex_lock(&data->update_lock);
+
+    for (i = 0; i < ARRAY_SIZE(tiers); i++) {
+        struct ym2651y_tier_data *tier = &data->tier[tiers[i]];
 
-            /* Read mfr_revsion */
-            command = 0x9b;
-            status = ym2651y_read_block(client, command, data->mfr_revsion,
-                                            ARRAY_SIZE(data->mfr_revsion)-1);
-            data->mfr_revsion[ARRAY_SIZE(data->mfr_revsion)-1] = '\0';
+        if (tier->valid && (!tier->interval ||
+            !time_after(jiffies, tier->last_updated + msecs_to_jiffies(tier->interval)))) {
+            continue;
+        }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+        if (tier->failed && time_before(jiffies, tier->retry_at)) {
+            if (ym2651y_attr_tier[index] == tiers[i]) {
+                status = -EIO;
+                break;
             }
+            continue;
+        }
 
-            /* Read mfr_serial */
-            command = 0x9e;
-            length  = 1;
+        tier->valid = 0;
+        if (tiers[i] == PSU_TIER_MFR) {
+            status = ym2651y_update_mfr(client, data);
+        }
+        else {
+            status = ym2651y_update_tier(client, data, tiers[i]);
+        }
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+        if (status < 0 && tiers[i] == PSU_TIER_MFR) {
+            /* Not supported by this PSU, or it is gone. Back off. */
+            tier->failed = 1;
+            tier->retry_at = jiffies + msecs_to_jiffies(PSU_TIER_MFR_RETRY_INTERVAL);
+            if (ym2651y_attr_tier[index] == PSU_TIER_MFR) {
+                break;
             }
+            status = 0;
+            continue;
+        }
 
-            status = ym2651y_read_block(client, command, data->mfr_serial, buf+1);
-            data->mfr_serial[buf+1] = '\0';
-
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
+        if (status < 0) {
+            /* The PSU may be gone, re-read everything once it is back */
+            for (j = 0; j < PSU_TIER_MAX; j++) {
+                data->tier[j].valid = 0;
+                data->tier[j].failed = 0;
             }
+            break;
         }
 
-        data->last_updated = jiffies;
-        data->valid = 1;
+        tier->last_updated = jiffies;
+        tier->valid = 1;
+        tier->failed = 0;
     }
 
-exit:
     mutex_unlock(&data->update_lock);
 
-    return data;
+    return (status < 0) ? NULL : data;
 }
 
 static int __init ym2651y_init(void)
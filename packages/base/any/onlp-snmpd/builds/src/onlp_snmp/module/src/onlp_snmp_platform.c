@@ -211,25 +211,25 @@ onlp_snmp_platform_init(void)
     /**
      * This is the base of the platform:general:system tree
      */
-    onlp_sys_info_t si;
-    if(onlp_sys_info_get(&si) >= 0) {
+    const onlp_sys_info_t* si;
+    if(onlp_sys_info_cache_get(&si) >= 0) {
 
 #define REGISTER_STR(_index, _field)                                    \
         do {                                                            \
-            platform_string_register(_index, #_field, (char*)si.onie_info._field); \
+            platform_string_register(_index, #_field, (char*)si->onie_info._field); \
         } while(0)
 
 #define REGISTER_INT(_index, _field)                                    \
         do {                                                            \
-            platform_int_register(_index, #_field, si.onie_info._field); \
+            platform_int_register(_index, #_field, si->onie_info._field); \
         } while(0)
 
         REGISTER_STR(1, product_name);
         REGISTER_STR(2, part_number);
         REGISTER_STR(3, serial_number);
         char* mstring = aim_fstrdup("%.2x:%.2x:%.2x:%.2x:%.2x:%.2x",
-                                    si.onie_info.mac[0], si.onie_info.mac[1], si.onie_info.mac[2],
-                                    si.onie_info.mac[3], si.onie_info.mac[4], si.onie_info.mac[5]);
+                                    si->onie_info.mac[0], si->onie_info.mac[1], si->onie_info.mac[2],
+                                    si->onie_info.mac[3], si->onie_info.mac[4], si->onie_info.mac[5]);
         platform_string_register(4, "mac", mstring);
         aim_free(mstring);
 
@@ -244,6 +244,7 @@ onlp_snmp_platform_init(void)
         REGISTER_STR(13, diag_version);
         REGISTER_STR(14, service_tag);
         REGISTER_STR(15, onie_version);
+        onlp_sys_info_cache_put(si);
     }
 
     resource_int_register(1, "CpuAllPercentUtilization", utilization_handler);
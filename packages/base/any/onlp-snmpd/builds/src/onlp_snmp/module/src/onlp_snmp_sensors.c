@@ -38,6 +38,7 @@
 #include <onlp/thermal.h>
 #include <onlp/fan.h>
 #include <onlp/psu.h>
+#include <onlp/oids.h>
 
 #include "onlp_snmp_log.h"
 
@@ -880,6 +881,32 @@ static update_handler_fn all_update_handler_fns__[] = {
 };
 
 
+/*
+ * Record the status of a sensor which is not present,
+ * without retrieving its full information.
+ */
+static void
+set_next_status__(int sensor_type, onlp_snmp_sensor_t *ss, uint32_t status)
+{
+    sensor_info_t *si = get_next_info(ss);
+
+    AIM_MEMSET(&si->data, 0x0, sizeof(si->data));
+    switch (sensor_type) {
+    case ONLP_SNMP_SENSOR_TYPE_TEMP:
+        si->data.ti.status = status;
+        break;
+    case ONLP_SNMP_SENSOR_TYPE_FAN:
+        si->data.fi.status = status;
+        break;
+    case ONLP_SNMP_SENSOR_TYPE_PSU:
+        si->data.pi.status = status;
+        break;
+    default:
+        break;
+    }
+}
+
+
 /*
  * Add a sensor to the appropriate type-specific control structure.
  * Updates next sensor info, not current sensor info.
@@ -985,9 +1012,13 @@ static void
 update_tables__(void)
 {
     int i;
+    int n;
+    int count = 0;
     onlp_snmp_sensor_ctrl_t *ctrl;
     list_links_t *curr;
     onlp_snmp_sensor_t *ss;
+    onlp_oid_t *oids;
+    uint32_t *statuses;
 
     uint64_t now = aim_time_monotonic();
     if (now - last_sensor_update_time <
@@ -1016,12 +1047,48 @@ update_tables__(void)
      * writing validity into next_info for all sensors */
     onlp_oid_iterate(ONLP_OID_SYS, 0, collect_sensors__, NULL);
 
-    /* for each table: update all sensor info */
+    /* retrieve the status of all valid sensors at once */
+    for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+        ctrl = get_sensor_ctrl__(i);
+        LIST_FOREACH(&ctrl->sensors, curr) {
+            count++;
+        }
+    }
+    oids = AIM_MALLOC((count + 1) * sizeof(*oids));
+    statuses = AIM_MALLOC((count + 1) * sizeof(*statuses));
+    AIM_TRUE_OR_DIE(oids && statuses);
+
+    n = 0;
     for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
         ctrl = get_sensor_ctrl__(i);
         LIST_FOREACH(&ctrl->sensors, curr) {
             ss = container_of(curr, links, onlp_snmp_sensor_t);
             if (get_next_info(ss)->valid) {
+                oids[n++] = (onlp_oid_t) ss->sensor_id;
+            }
+        }
+    }
+    onlp_oid_status_get_multi(oids, n, statuses);
+
+    /* for each table: update the info of present sensors */
+    n = 0;
+    for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
+        ctrl = get_sensor_ctrl__(i);
+        LIST_FOREACH(&ctrl->sensors, curr) {
+            uint32_t status;
+            ss = container_of(curr, links, onlp_snmp_sensor_t);
+            if (!get_next_info(ss)->valid) {
+                continue;
+            }
+            status = statuses[n++];
+            if (status & ONLP_OID_STATUS_FLAG_UNAVAILABLE) {
+                AIM_LOG_ERROR("failed to update %s%s", ss->name, ss->desc);
+                get_next_info(ss)->valid = false;
+            }
+            else if (!(status & ONLP_OID_STATUS_FLAG_PRESENT)) {
+                set_next_status__(i, ss, status);
+            }
+            else {
                 AIM_LOG_INFO("update sensor %s%s", ss->name, ss->desc);
                 /* invoke update handler */
                 if ((*all_update_handler_fns__[i])(ss) != ONLP_STATUS_OK) {
@@ -1032,6 +1099,9 @@ update_tables__(void)
         }
     }
 
+    aim_free(oids);
+    aim_free(statuses);
+
     /* swap front and back buffers */
     swap_curr_next_info();
 
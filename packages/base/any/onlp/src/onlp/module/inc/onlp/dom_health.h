@@ -0,0 +1,158 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * DOM Health
+ *
+ * Tracks the digital optical monitoring values of every port
+ * against the module's own alarm and warning thresholds.
+ *
+ * Thresholds are read once when a module is inserted. Live values
+ * are stored per channel across all ports so every comparison is
+ * made in a single pass. The results are reported as port bitmaps
+ * per measurement class and severity, along with the ports which
+ * raised or cleared each condition since the previous evaluation.
+ *
+ * Values and thresholds are kept in the units of the module
+ * memory map (SFF-8472 and SFF-8636):
+ *
+ *   Temperature  1/256 C (signed)
+ *   Vcc          100 uV
+ *   Bias         2 uA
+ *   Power        0.1 uW
+ *
+ ***********************************************************/
+#ifndef __ONLP_DOM_HEALTH_H__
+#define __ONLP_DOM_HEALTH_H__
+
+#include <onlp/onlp.h>
+#include <onlp/sfp.h>
+
+/** Measurement classes */
+typedef enum onlp_dom_class_e {
+    ONLP_DOM_CLASS_TEMP,
+    ONLP_DOM_CLASS_VCC,
+    ONLP_DOM_CLASS_BIAS,
+    ONLP_DOM_CLASS_TX_POWER,
+    ONLP_DOM_CLASS_RX_POWER,
+    ONLP_DOM_CLASS_COUNT,
+} onlp_dom_class_t;
+
+/** Conditions, in order of the flag bits */
+typedef enum onlp_dom_severity_e {
+    ONLP_DOM_SEVERITY_HIGH_ALARM,
+    ONLP_DOM_SEVERITY_LOW_ALARM,
+    ONLP_DOM_SEVERITY_HIGH_WARNING,
+    ONLP_DOM_SEVERITY_LOW_WARNING,
+    ONLP_DOM_SEVERITY_COUNT,
+} onlp_dom_severity_t;
+
+#define ONLP_DOM_FLAG(_severity) (1 << (_severity))
+
+/** Channels per port */
+#define ONLP_DOM_LANES_MAX 4
+#define ONLP_DOM_CHANNEL_TEMP 0
+#define ONLP_DOM_CHANNEL_VCC  1
+#define ONLP_DOM_CHANNEL_BIAS(_lane) (2 + (_lane))
+#define ONLP_DOM_CHANNEL_TX_POWER(_lane) (2 + ONLP_DOM_LANES_MAX + (_lane))
+#define ONLP_DOM_CHANNEL_RX_POWER(_lane) (2 + 2*ONLP_DOM_LANES_MAX + (_lane))
+/** Padded to a power of two */
+#define ONLP_DOM_CHANNELS 16
+
+/** The highest port number tracked, plus one */
+#define ONLP_DOM_PORTS_MAX 256
+
+typedef struct onlp_dom_channel_s {
+    int32_t value;
+    int32_t high_alarm;
+    int32_t low_alarm;
+    int32_t high_warning;
+    int32_t low_warning;
+    /** ONLP_DOM_FLAG() bits from the last evaluation */
+    uint8_t flags;
+    /** The module reports thresholds for this channel */
+    uint8_t valid;
+} onlp_dom_channel_t;
+
+typedef struct onlp_dom_port_s {
+    /** Number of lanes, 0 if the port is not monitored */
+    int lanes;
+    onlp_dom_channel_t channels[ONLP_DOM_CHANNELS];
+} onlp_dom_port_t;
+
+typedef struct onlp_dom_health_s {
+    /** Ports being monitored */
+    onlp_sfp_bitmap_t monitored;
+
+    /** Ports where the condition holds on any channel of the class */
+    onlp_sfp_bitmap_t flags[ONLP_DOM_CLASS_COUNT][ONLP_DOM_SEVERITY_COUNT];
+
+    /** Changes since the previous evaluation */
+    onlp_sfp_bitmap_t raised[ONLP_DOM_CLASS_COUNT][ONLP_DOM_SEVERITY_COUNT];
+    onlp_sfp_bitmap_t cleared[ONLP_DOM_CLASS_COUNT][ONLP_DOM_SEVERITY_COUNT];
+
+    /** Number of ports with any raised or cleared condition */
+    int changed;
+
+    uint64_t evaluations;
+} onlp_dom_health_t;
+
+/**
+ * @brief Initialize a health result.
+ */
+void onlp_dom_health_t_init(onlp_dom_health_t* health);
+
+/**
+ * @brief Refresh the DOM values of every present port.
+ * @note Thresholds are read when a module is first seen and
+ * dropped when it is removed.
+ */
+int onlp_dom_health_update(void);
+
+/**
+ * @brief Refresh the DOM values of a single port.
+ */
+int onlp_dom_health_port_update(int port);
+
+/**
+ * @brief Compare every value against its thresholds.
+ * @param health [out] Receives the result.
+ */
+int onlp_dom_health_evaluate(onlp_dom_health_t* health);
+
+/**
+ * @brief Get the values, thresholds and last flags of a port.
+ */
+int onlp_dom_health_port_get(int port, onlp_dom_port_t* rv);
+
+/**
+ * @brief Supply the values and thresholds of a port.
+ * @param port The port.
+ * @param src The port data. A NULL src or zero lanes stops monitoring the port.
+ * @note For modules whose DOM is not read through onlp_sfp_dom_read().
+ */
+int onlp_dom_health_port_set(int port, const onlp_dom_port_t* src);
+
+/**
+ * @brief Show the current conditions.
+ */
+void onlp_dom_health_show(aim_pvs_t* pvs);
+
+#endif /* __ONLP_DOM_HEALTH_H__ */
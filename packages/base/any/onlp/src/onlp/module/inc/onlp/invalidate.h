@@ -0,0 +1,113 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Cache Invalidation
+ *
+ * Caches register a handler for the classes of objects they hold.
+ * Platforms bind the sysfs devices behind their objects, and kernel
+ * uevents for a bound device (add, remove, bind, unbind, change)
+ * invalidate only the objects bound to it.
+ *
+ * Handlers are called on the uevent thread, or on the thread
+ * calling onlp_invalidate(). They are called without the ONLP API
+ * lock, so onlp_invalidate() must not be called while holding it
+ * (for example from platform interface code).
+ *
+ ***********************************************************/
+#ifndef __ONLP_INVALIDATE_H__
+#define __ONLP_INVALIDATE_H__
+
+#include <onlp/onlp.h>
+
+typedef enum onlp_invalidate_class_e {
+    ONLP_INVALIDATE_CLASS_SYS,
+    ONLP_INVALIDATE_CLASS_THERMAL,
+    ONLP_INVALIDATE_CLASS_FAN,
+    ONLP_INVALIDATE_CLASS_PSU,
+    ONLP_INVALIDATE_CLASS_LED,
+    ONLP_INVALIDATE_CLASS_SFP,
+    ONLP_INVALIDATE_CLASS_COUNT,
+} onlp_invalidate_class_t;
+
+#define ONLP_INVALIDATE_CLASS_FLAG(_cls) (1 << (_cls))
+#define ONLP_INVALIDATE_CLASS_FLAGS_ALL ((1 << ONLP_INVALIDATE_CLASS_COUNT) - 1)
+
+/** Every object of the class. */
+#define ONLP_INVALIDATE_ID_ALL -1
+
+typedef struct onlp_invalidate_s {
+    onlp_invalidate_class_t cls;
+    /** The OID id (ONLP_OID_ID_GET()) or SFP port, or ONLP_INVALIDATE_ID_ALL */
+    int id;
+    /** The device which changed, or NULL */
+    const char* devpath;
+    /** The uevent action or the caller's reason */
+    const char* reason;
+} onlp_invalidate_t;
+
+typedef void (*onlp_invalidate_handler_f)(const onlp_invalidate_t* inv, void* cookie);
+
+/**
+ * @brief Register a cache invalidation handler.
+ * @param classes ONLP_INVALIDATE_CLASS_FLAG() bits.
+ * @param handler The handler.
+ * @param cookie Passed to the handler.
+ * @note Registering the same handler and cookie again replaces
+ * the classes of the existing registration.
+ */
+int onlp_invalidate_register(uint32_t classes, onlp_invalidate_handler_f handler,
+                             void* cookie);
+
+/**
+ * @brief Unregister a cache invalidation handler.
+ */
+int onlp_invalidate_unregister(onlp_invalidate_handler_f handler, void* cookie);
+
+/**
+ * @brief Invalidate an object.
+ * @param cls The object class.
+ * @param id The object id or port, or ONLP_INVALIDATE_ID_ALL.
+ * @param reason Why (for logging).
+ */
+int onlp_invalidate(onlp_invalidate_class_t cls, int id, const char* reason);
+
+/**
+ * @brief Bind a device to an object.
+ * @param path The device (e.g. /sys/bus/i2c/devices/51-0050).
+ * The device need not exist yet.
+ * @param cls The object class.
+ * @param id The object id or port.
+ * @note Events for the device and the devices below it (such as
+ * its hwmon device) invalidate the object.
+ */
+int onlp_invalidate_bind(const char* path, onlp_invalidate_class_t cls, int id);
+
+/**
+ * @brief Remove all bindings of a device.
+ */
+int onlp_invalidate_unbind(const char* path);
+
+/**
+ * @brief Show the bindings and counters.
+ */
+void onlp_invalidate_show(aim_pvs_t* pvs);
+
+#endif /* __ONLP_INVALIDATE_H__ */
@@ -154,6 +154,26 @@ int onlp_led_mode_set(onlp_oid_t id, onlp_led_mode_t color);
  */
 int onlp_led_char_set(onlp_oid_t id, char c);
 
+/**
+ * @brief Set the mode of several LEDs.
+ * @param ids The LED OIDs.
+ * @param modes The mode for each LED.
+ * @param count The number of LEDs.
+ * @note Only the LEDs whose mode differs from the last mode
+ * written are updated.
+ * @returns The first error, if any. Every LED is attempted.
+ */
+int onlp_led_mode_set_multi(const onlp_oid_t* ids,
+                            const onlp_led_mode_t* modes, int count);
+
+/**
+ * @brief Forget the last state written to an LED.
+ * @param id The LED OID, or 0 for all LEDs.
+ * @note Use this after changing an LED without going through
+ * this API so the next write is not skipped.
+ */
+int onlp_led_shadow_invalidate(onlp_oid_t id);
+
 /**
  * @brief LED OID debug dump
  * @param id The LED OID
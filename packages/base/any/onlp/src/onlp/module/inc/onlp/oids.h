@@ -193,6 +193,29 @@ int onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
  */
 int onlp_oid_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr);
 
+/**
+ * The present bit is common to the status of all OID types.
+ */
+#define ONLP_OID_STATUS_FLAG_PRESENT (1U << 0)
+
+/**
+ * Set in a status from onlp_oid_status_get_multi() when the
+ * status of the OID could not be retrieved.
+ */
+#define ONLP_OID_STATUS_FLAG_UNAVAILABLE (1U << 31)
+
+/**
+ * @brief Get the status of multiple OIDs.
+ * @param oids The OIDs (SYS, THERMAL, FAN, PSU or LED).
+ * @param n The number of OIDs.
+ * @param statuses [out] Receives the status of each OID.
+ * @returns The number of OIDs whose status could not be retrieved.
+ * @note The API lock is taken once for all OIDs, and the platform's
+ * status_get() interfaces are used where implemented, so only the
+ * status (presence, failure) is read from the hardware.
+ */
+int onlp_oid_status_get_multi(const onlp_oid_t* oids, int n, uint32_t* statuses);
+
 
 
 
@@ -61,6 +61,14 @@ int onlp_init(void);
 
 int onlp_denit(void);
 
+/**
+ * @brief Show the per-phase initialization timings.
+ * @param pvs The output pvs
+ * @note Subsystems which have not yet been used are shown as pending
+ * when ONLP_CONFIG_INCLUDE_LAZY_INIT is enabled.
+ */
+void onlp_init_trace_show(aim_pvs_t* pvs);
+
 /**
  * @brief Dump the current platform data.
  * @param pvs The output pvs
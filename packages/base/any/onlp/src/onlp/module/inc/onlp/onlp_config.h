@@ -254,6 +254,56 @@
 #define ONLP_CONFIG_INCLUDE_API_PROFILING 0
 #endif
 
+/**
+ * ONLP_CONFIG_INCLUDE_LAZY_INIT
+ *
+ * Initialize each subsystem on first use rather than in onlp_init(). */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_LAZY_INIT
+#define ONLP_CONFIG_INCLUDE_LAZY_INIT 1
+#endif
+
+/**
+ * ONLP_CONFIG_THERMAL_CONTROL_RATE
+ *
+ * The default thermal control run rate in microseconds. */
+
+
+#ifndef ONLP_CONFIG_THERMAL_CONTROL_RATE
+#define ONLP_CONFIG_THERMAL_CONTROL_RATE 10000000
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_LED_SHADOW
+ *
+ * Remember the last LED state written and skip writes which would not change it. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_LED_SHADOW
+#define ONLP_CONFIG_INCLUDE_LED_SHADOW 1
+#endif
+
+/**
+ * ONLP_CONFIG_LED_SHADOW_TIMEOUT
+ *
+ * How long the last LED state written is trusted, in microseconds. 0 is forever. */
+
+
+#ifndef ONLP_CONFIG_LED_SHADOW_TIMEOUT
+#define ONLP_CONFIG_LED_SHADOW_TIMEOUT 60000000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGER_WORKERS
+ *
+ * The number of platform manager worker threads. 0 runs every management callback on the platform manager thread. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGER_WORKERS
+#define ONLP_CONFIG_PLATFORM_MANAGER_WORKERS 2
+#endif
+
 
 
 /**
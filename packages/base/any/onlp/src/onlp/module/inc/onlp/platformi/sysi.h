@@ -26,6 +26,7 @@
 #define __ONLP_SYSI_H__
 
 #include <onlp/sys.h>
+#include <onlp/thermal_control.h>
 
 
 /**
@@ -142,6 +143,15 @@ int onlp_sysi_platform_manage_init(void);
  */
 int onlp_sysi_platform_manage_fans(void);
 
+/**
+ * @brief Get the platform thermal control policy.
+ * @param tc [out] Receives a pointer to the policy.
+ * @note When provided, the platform manager runs this policy
+ * instead of calling onlp_sysi_platform_manage_fans().
+ * @note Optional
+ */
+int onlp_sysi_thermal_control_get(const onlp_thermal_control_t** tc);
+
 /**
  * @brief Perform necessary platform LED management.
  * @note This function should automatically adjust the LED indicators
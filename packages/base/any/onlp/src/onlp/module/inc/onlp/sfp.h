@@ -172,7 +172,36 @@ int onlp_sfp_dev_readw(int port, uint8_t devaddr, uint8_t addr);
  */
 int onlp_sfp_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value);
 
+/**
+ * @brief Read a range of addresses on the given SFP port's bus.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param addr The starting address.
+ * @param rdata Receives the data.
+ * @param size The number of bytes to read.
+ */
+int onlp_sfp_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size);
 
+/**
+ * @brief Read an upper page of a paged module memory.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param page The page number.
+ * @param rdata Receives the 128 bytes at addresses 128-255 of the page.
+ * @note The page is selected, read and page 0 restored under a
+ * single hold of the API lock.
+ */
+int onlp_sfp_dev_page_read(int port, uint8_t devaddr, uint8_t page, uint8_t* rdata);
+
+/**
+ * @brief Write a range of addresses on the given SFP port's bus.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param addr The starting address.
+ * @param data The data.
+ * @param size The number of bytes to write.
+ */
+int onlp_sfp_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size);
 
 
 /**
@@ -0,0 +1,113 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Bulk OID Snapshots.
+ *
+ * A snapshot walks the OID tree once, with the API lock held for
+ * the whole walk, and stores one fixed size record per OID in a
+ * caller supplied array. Every field is 32 bits wide so the array
+ * can be mapped directly by other languages.
+ *
+ ************************************************************/
+#ifndef __ONLP_SNAPSHOT_H__
+#define __ONLP_SNAPSHOT_H__
+
+#include <onlp/onlp_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+
+/**
+ * Build a snapshot type filter from ONLP_OID_TYPE_* values.
+ * A filter of 0 selects every type.
+ */
+#define ONLP_SNAPSHOT_TYPE(_type) (1 << (_type))
+
+/**
+ * One snapshot record.
+ */
+typedef struct onlp_snapshot_entry_s {
+
+    /** The OID */
+    onlp_oid_t oid;
+
+    /** The parent OID */
+    onlp_oid_t poid;
+
+    /** Result of the info request for this OID */
+    int32_t rv;
+
+    /** OID status flags (ONLP_*_STATUS_*) */
+    uint32_t status;
+
+    /** OID capabilities (ONLP_*_CAPS_*) */
+    uint32_t caps;
+
+    /** Type specific values, selected by the OID type */
+    union {
+        struct {
+            int32_t mcelsius;
+            int32_t warning;
+            int32_t error;
+            int32_t shutdown;
+        } thermal;
+
+        struct {
+            int32_t rpm;
+            int32_t percentage;
+            uint32_t mode;
+        } fan;
+
+        struct {
+            int32_t mvin;
+            int32_t mvout;
+            int32_t miin;
+            int32_t miout;
+            int32_t mpin;
+            int32_t mpout;
+        } psu;
+
+        struct {
+            uint32_t mode;
+            int32_t character;
+        } led;
+
+        int32_t values[6];
+    } u;
+
+    /** The description of this object */
+    onlp_oid_desc_t description;
+
+} onlp_snapshot_entry_t;
+
+/**
+ * @brief Snapshot every OID below the given root.
+ * @param root The root OID (0 for the system OID).
+ * @param types ONLP_SNAPSHOT_TYPE() filter, 0 for all types.
+ * @param entries [out] Receives the records.
+ * @param size The number of records available in entries.
+ * @param count [out] Receives the number of OIDs found. This may be
+ * larger than size, in which case only the first size records are
+ * stored and the call should be repeated with a larger array.
+ */
+int onlp_snapshot_get(onlp_oid_t root, uint32_t types,
+                      onlp_snapshot_entry_t* entries, int size, int* count);
+
+#endif /* __ONLP_SNAPSHOT_H__ */
@@ -62,6 +62,30 @@ int onlp_sys_info_get(onlp_sys_info_t* rv);
  */
 void onlp_sys_info_free(onlp_sys_info_t* info);
 
+/**
+ * @brief Get the cached system information.
+ * @param rv [out] Receives a pointer to the cached information.
+ * @note The ONIE and platform information are read and decoded
+ * once. The structure is owned by the library and must not be
+ * freed or modified. It remains valid until it is released with
+ * onlp_sys_info_cache_put(), even if the cache is invalidated.
+ */
+int onlp_sys_info_cache_get(const onlp_sys_info_t** rv);
+
+/**
+ * @brief Release the cached system information.
+ * @param info The structure returned by onlp_sys_info_cache_get().
+ */
+int onlp_sys_info_cache_put(const onlp_sys_info_t* info);
+
+/**
+ * @brief Discard the cached system information.
+ * @note The next request re-reads the ONIE and platform information.
+ * Structures already returned by onlp_sys_info_cache_get() are freed
+ * once they have been released.
+ */
+int onlp_sys_info_invalidate(void);
+
 /**
  * @brief Get the system header.
  */
@@ -122,6 +146,12 @@ int onlp_sys_platform_manage_join(void);
 
 void onlp_sys_platform_manage_now(void);
 
+/**
+ * @brief Show the platform management callbacks and their timing.
+ * @param pvs The output pvs.
+ */
+void onlp_sys_platform_manage_show(aim_pvs_t* pvs);
+
 int onlp_sys_debug(aim_pvs_t* pvs, int argc, char** argv);
 
 #endif /* __ONLP_SYS_H_ */
@@ -0,0 +1,219 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Thermal Control Engine
+ *
+ * Platforms describe their fan control policy as data and
+ * return it from onlp_sysi_thermal_control_get(). The platform
+ * manager then runs the policy instead of calling
+ * onlp_sysi_platform_manage_fans().
+ *
+ * Each run reads every referenced sensor and fan once, computes
+ * a fan percentage for each sensor group, and writes the highest
+ * one to the fans only when it differs from the last value written.
+ *
+ ***********************************************************/
+#ifndef __ONLP_THERMAL_CONTROL_H__
+#define __ONLP_THERMAL_CONTROL_H__
+
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+
+/** How the sensors in a group are combined. */
+typedef enum onlp_thermal_control_aggregate_e {
+    ONLP_THERMAL_CONTROL_AGGREGATE_MAX,
+    ONLP_THERMAL_CONTROL_AGGREGATE_SUM,
+    ONLP_THERMAL_CONTROL_AGGREGATE_AVERAGE,
+} onlp_thermal_control_aggregate_t;
+
+/** How a group turns its temperature into a fan percentage. */
+typedef enum onlp_thermal_control_mode_e {
+    ONLP_THERMAL_CONTROL_MODE_TABLE,
+    ONLP_THERMAL_CONTROL_MODE_PID,
+} onlp_thermal_control_mode_t;
+
+/**
+ * One step of a hysteresis table.
+ *
+ * The group moves to the next step when the temperature reaches
+ * mcelsius_up and to the previous step when it falls to mcelsius_down,
+ * at most one step per run. The thresholds of the first and last steps
+ * in each direction are ignored.
+ */
+typedef struct onlp_thermal_control_step_s {
+    int percentage;
+    int mcelsius_down;
+    int mcelsius_up;
+} onlp_thermal_control_step_t;
+
+/**
+ * PID gains.
+ *
+ * The error is the temperature above setpoint in degrees C.
+ * The output is base + kp*e + ki*integral(e dt) + kd*de/dt,
+ * with time in seconds.
+ */
+typedef struct onlp_thermal_control_pid_s {
+    int setpoint;
+    int base;
+    double kp;
+    double ki;
+    double kd;
+} onlp_thermal_control_pid_t;
+
+/** A group of sensors controlling the fans together. */
+typedef struct onlp_thermal_control_group_s {
+    /** Name (for status and logging) */
+    const char* name;
+
+    /**
+     * The sensors. Unreadable sensors are left out of MAX and AVERAGE.
+     * A SUM group with an unreadable sensor has no temperature and
+     * runs at the failsafe percentage.
+     */
+    const onlp_oid_t* thermals;
+    int thermal_count;
+    onlp_thermal_control_aggregate_t aggregate;
+
+    onlp_thermal_control_mode_t mode;
+
+    /** Hysteresis table, used for F2B or unknown airflow */
+    const onlp_thermal_control_step_t* table;
+    int table_size;
+
+    /** Hysteresis table for B2F airflow (optional) */
+    const onlp_thermal_control_step_t* table_b2f;
+    int table_b2f_size;
+
+    /** PID gains */
+    onlp_thermal_control_pid_t pid;
+
+} onlp_thermal_control_group_t;
+
+/** Failure policies */
+typedef enum onlp_thermal_control_failsafe_e {
+    /** Use failsafe_percentage when any fan has failed. */
+    ONLP_THERMAL_CONTROL_FAILSAFE_FAN_FAILED = (1 << 0),
+    /** Use failsafe_percentage when any fan is missing. */
+    ONLP_THERMAL_CONTROL_FAILSAFE_FAN_MISSING = (1 << 1),
+    /** Use failsafe_percentage when any sensor cannot be read. */
+    ONLP_THERMAL_CONTROL_FAILSAFE_SENSOR_FAILED = (1 << 2),
+} onlp_thermal_control_failsafe_t;
+
+/** A platform thermal control policy. */
+typedef struct onlp_thermal_control_s {
+    const onlp_thermal_control_group_t* groups;
+    int group_count;
+
+    /** The fans being controlled */
+    const onlp_oid_t* fans;
+    int fan_count;
+
+    /**
+     * Write the percentage to this fan only.
+     * For platforms where all fans share one PWM. If zero,
+     * every present fan is written.
+     */
+    onlp_oid_t fan_set;
+
+    /** Output limits */
+    int min_percentage;
+    int max_percentage;
+
+    /** onlp_thermal_control_failsafe_t flags */
+    uint32_t failsafe;
+    int failsafe_percentage;
+
+    /** Run rate in microseconds. If zero, ONLP_CONFIG_THERMAL_CONTROL_RATE. */
+    uint64_t rate;
+
+} onlp_thermal_control_t;
+
+
+#define ONLP_THERMAL_CONTROL_GROUP_MAX 8
+
+typedef struct onlp_thermal_control_group_status_s {
+    /** Combined temperature */
+    int mcelsius;
+    /** Number of sensors read */
+    int sensors;
+    /** Current table step, or -1 */
+    int step;
+    /** This group's fan percentage */
+    int percentage;
+} onlp_thermal_control_group_status_t;
+
+typedef struct onlp_thermal_control_status_s {
+    /** Nonzero if the platform provides a policy */
+    int enabled;
+    /** Run rate in microseconds */
+    uint64_t rate;
+
+    /** Last percentage written */
+    int percentage;
+    /** Why that percentage was chosen */
+    const char* reason;
+    int group_count;
+    onlp_thermal_control_group_status_t groups[ONLP_THERMAL_CONTROL_GROUP_MAX];
+
+    /** Counters */
+    uint64_t runs;
+    uint64_t writes;
+    uint64_t errors;
+
+    /** Loop timing in microseconds */
+    uint64_t last_run;
+    uint64_t last_duration;
+    uint64_t max_duration;
+    uint64_t total_duration;
+} onlp_thermal_control_status_t;
+
+
+/**
+ * @brief Load the platform policy.
+ * @returns ONLP_STATUS_E_UNSUPPORTED if the platform does not
+ * provide one.
+ */
+int onlp_thermal_control_init(void);
+
+/**
+ * @brief Run the policy once.
+ */
+int onlp_thermal_control_run(void);
+
+/**
+ * @brief Change the run rate.
+ * @param rate The rate in microseconds.
+ */
+int onlp_thermal_control_rate_set(uint64_t rate);
+
+/**
+ * @brief Get the current decisions and loop timing.
+ */
+int onlp_thermal_control_status_get(onlp_thermal_control_status_t* status);
+
+/**
+ * @brief Show the current decisions and loop timing.
+ * @note This is part of onlp_sys_platform_manage_show().
+ */
+void onlp_thermal_control_show(aim_pvs_t* pvs);
+
+#endif /* __ONLP_THERMAL_CONTROL_H__ */
@@ -446,6 +446,12 @@ def onlp_led_init_prototypes():
     libonlp.onlp_led_char_set.restype = ctypes.c_int
     libonlp.onlp_led_char_set.argtypes = (onlp_oid, ctypes.c_char,)
 
+    libonlp.onlp_led_mode_set_multi.restype = ctypes.c_int
+    libonlp.onlp_led_mode_set_multi.argtypes = (ctypes.POINTER(onlp_oid), ctypes.POINTER(ctypes.c_uint32), ctypes.c_int,)
+
+    libonlp.onlp_led_shadow_invalidate.restype = ctypes.c_int
+    libonlp.onlp_led_shadow_invalidate.argtypes = (onlp_oid,)
+
     libonlp.onlp_led_dump.restype = None
     libonlp.onlp_led_dump.argtypes = (onlp_oid, ctypes.POINTER(aim_pvs), ctypes.c_uint32,)
 
@@ -636,6 +642,98 @@ def onlp_sfp_init_prototypes():
     libonlp.onlp_sfp_control_flags_get.restype = ctypes.c_int
     libonlp.onlp_sfp_control_flags_get.argtyeps = (ctypes.c_int, ctypes.POINTER(ctypes.c_uint32),)
 
+# onlp/snapshot.h
+
+def ONLP_SNAPSHOT_TYPE(oidType):
+    return 1 << oidType
+
+class onlp_snapshot_thermal(ctypes.Structure):
+    _fields_ = [("mcelsius", ctypes.c_int32,),
+                ("warning", ctypes.c_int32,),
+                ("error", ctypes.c_int32,),
+                ("shutdown", ctypes.c_int32,),]
+
+class onlp_snapshot_fan(ctypes.Structure):
+    _fields_ = [("rpm", ctypes.c_int32,),
+                ("percentage", ctypes.c_int32,),
+                ("mode", ctypes.c_uint32,),]
+
+class onlp_snapshot_psu(ctypes.Structure):
+    _fields_ = [("mvin", ctypes.c_int32,),
+                ("mvout", ctypes.c_int32,),
+                ("miin", ctypes.c_int32,),
+                ("miout", ctypes.c_int32,),
+                ("mpin", ctypes.c_int32,),
+                ("mpout", ctypes.c_int32,),]
+
+class onlp_snapshot_led(ctypes.Structure):
+    _fields_ = [("mode", ctypes.c_uint32,),
+                ("character", ctypes.c_int32,),]
+
+class onlp_snapshot_values(ctypes.Union):
+    _fields_ = [("thermal", onlp_snapshot_thermal,),
+                ("fan", onlp_snapshot_fan,),
+                ("psu", onlp_snapshot_psu,),
+                ("led", onlp_snapshot_led,),
+                ("values", ctypes.c_int32 * 6,),]
+
+class onlp_snapshot_entry(ctypes.Structure):
+
+    _fields_ = [("oid", onlp_oid,),
+                ("poid", onlp_oid,),
+                ("rv", ctypes.c_int32,),
+                ("status", ctypes.c_uint32,),
+                ("caps", ctypes.c_uint32,),
+                ("u", onlp_snapshot_values,),
+                ("description", ctypes.c_char * ONLP_OID_DESC_SIZE,),]
+
+    def getType(self):
+        return self.oid >> 24
+
+class OnlpSnapshot(object):
+    """Every OID below 'root', read by one onlp_snapshot_get() call.
+
+    The records are held in a single ctypes array ('entries'), which
+    supports the buffer protocol. Indexing and iteration return views
+    into that array rather than copies."""
+
+    def __init__(self, root=0, types=0, size=128):
+        count = ctypes.c_int()
+        while True:
+            entries = (onlp_snapshot_entry * size)()
+            sts = libonlp.onlp_snapshot_get(root, types, entries, size, ctypes.byref(count))
+            if sts < 0:
+                raise ValueError("onlp_snapshot_get failed: %s" % ONLP_STATUS.name(sts))
+            if count.value <= size:
+                break
+            size = count.value
+        self.entries = entries
+        self.count = count.value
+
+    def __len__(self):
+        return self.count
+
+    def __getitem__(self, idx):
+        if idx < 0:
+            idx += self.count
+        if idx < 0 or idx >= self.count:
+            raise IndexError(idx)
+        return self.entries[idx]
+
+    def __iter__(self):
+        for idx in range(self.count):
+            yield self.entries[idx]
+
+    def ofType(self, oidType):
+        return [e for e in self if e.getType() == oidType]
+
+def onlp_snapshot_init_prototypes():
+
+    libonlp.onlp_snapshot_get.restype = ctypes.c_int
+    libonlp.onlp_snapshot_get.argtypes = (onlp_oid, ctypes.c_uint32,
+                                          ctypes.POINTER(onlp_snapshot_entry), ctypes.c_int,
+                                          ctypes.POINTER(ctypes.c_int),)
+
 # onlp/onlp.h
 
 def init_prototypes():
@@ -658,5 +756,6 @@ def init_prototypes():
     onlp_psu_init_prototypes()
     sff_init_prototypes()
     onlp_sfp_init_prototypes()
+    onlp_snapshot_init_prototypes()
 
 init_prototypes()
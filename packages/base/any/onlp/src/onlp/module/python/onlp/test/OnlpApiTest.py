@@ -818,6 +818,7 @@ class LedTest(OnlpTestMixin,
                 self.auditLedOnOff(oid)
             self.auditLedColors(oid)
             self.auditLedBlink(oid)
+            self.auditLedMulti(oid)
 
         finally:
             subprocess.check_call(('service', 'onlpd', 'start',))
@@ -1028,6 +1029,31 @@ class LedTest(OnlpTestMixin,
         finally:
             libonlp.onlp_led_mode_set(oid, saveMode)
 
+    def auditLedMulti(self, oid):
+
+        led = onlp.onlp.onlp_led_info()
+        libonlp.onlp_led_info_get(oid, ctypes.byref(led))
+        saveMode = led.mode
+
+        oids = (onlp.onlp.onlp_oid * 1)(oid)
+        modes = (ctypes.c_uint32 * 1)(saveMode)
+
+        try:
+            # repeated writes of the same mode are accepted (and skipped)
+            for i in range(2):
+                sts = libonlp.onlp_led_mode_set_multi(oids, modes, 1)
+                self.assertStatusOK(sts)
+
+                libonlp.onlp_led_info_get(oid, ctypes.byref(led))
+                self.assertEqual(saveMode, led.mode)
+
+            sts = libonlp.onlp_led_mode_set_multi(oids, modes, 0)
+            self.assertStatusOK(sts)
+
+        finally:
+            libonlp.onlp_led_shadow_invalidate(0)
+            libonlp.onlp_led_mode_set(oid, saveMode)
+
 class ConfigTest(OnlpTestMixin,
                  unittest.TestCase):
     """Test interfaces in onlp/onlp_config.h."""
@@ -1225,6 +1251,64 @@ class PsuTest(OnlpTestMixin,
         bufStr = buf.string_at()
         self.assertIn("psu @", bufStr)
 
+class SnapshotTest(OnlpTestMixin,
+                   unittest.TestCase):
+    """Test interfaces in onlp/snapshot.h."""
+
+    def setUp(self):
+        OnlpTestMixin.setUp(self)
+
+    def tearDown(self):
+        OnlpTestMixin.tearDown(self)
+
+    def testSnapshot(self):
+
+        class V(OidIterator):
+
+            def __init__(self, log):
+                super(V, self).__init__(log)
+                self.oids = []
+
+            def visit(self, oid, cookie):
+                self.oids.append(oid)
+                return onlp.onlp.ONLP_STATUS.OK
+
+        v = V(log=self.log.getChild("snapshot"))
+        libonlp.onlp_oid_iterate(onlp.onlp.ONLP_OID_SYS, 0, v.cvisit(), 0)
+
+        snap = onlp.onlp.OnlpSnapshot()
+        self.assertEqual(v.oids, [e.oid for e in snap])
+
+        for e in snap.ofType(onlp.onlp.ONLP_OID_TYPE.THERMAL):
+            self.assertStatusOK(e.rv)
+            thm = onlp.onlp.onlp_thermal_info()
+            libonlp.onlp_thermal_info_get(e.oid, ctypes.byref(thm))
+            self.assertEqual(thm.hdr.description, e.description)
+            self.assertEqual(thm.status, e.status)
+
+    def testSnapshotFilter(self):
+
+        snap = onlp.onlp.OnlpSnapshot(types=onlp.onlp.ONLP_SNAPSHOT_TYPE(onlp.onlp.ONLP_OID_TYPE.FAN))
+        for e in snap:
+            self.assertEqual(onlp.onlp.ONLP_OID_TYPE.FAN, e.getType())
+
+    def testSnapshotGrow(self):
+        """A short array is reported, then refetched."""
+
+        full = onlp.onlp.OnlpSnapshot()
+        if len(full) < 2:
+            raise unittest.SkipTest("not enough OIDs")
+
+        entries = (onlp.onlp.onlp_snapshot_entry * 1)()
+        count = ctypes.c_int()
+        sts = libonlp.onlp_snapshot_get(0, 0, entries, 1, ctypes.byref(count))
+        self.assertStatusOK(sts)
+        self.assertEqual(len(full), count.value)
+        self.assertEqual(full[0].oid, entries[0].oid)
+
+        short = onlp.onlp.OnlpSnapshot(size=1)
+        self.assertEqual(len(full), len(short))
+
 class Eeprom(ctypes.Structure):
     _fields_ = [('eeprom', ctypes.c_ubyte * 256,),]
 
@@ -0,0 +1,627 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * DOM Health
+ *
+ ***********************************************************/
+#include <onlp/dom_health.h>
+#include <onlp/sfp.h>
+#include <onlp/invalidate.h>
+#include <AIM/aim_printf.h>
+#include <pthread.h>
+#include "onlp_int.h"
+#include "onlp_log.h"
+
+#define DOM_ENTRIES (ONLP_DOM_PORTS_MAX * ONLP_DOM_CHANNELS)
+
+/* Thresholds for channels without monitoring never trip. */
+#define DOM_HIGH_NONE INT32_MAX
+#define DOM_LOW_NONE  INT32_MIN
+
+typedef enum dom_type_e {
+    DOM_TYPE_NONE,
+    DOM_TYPE_UNSUPPORTED,
+    DOM_TYPE_SFF8472,
+    DOM_TYPE_SFF8636,
+    DOM_TYPE_EXTERNAL,
+} dom_type_t;
+
+/*
+ * Structure of arrays, indexed by (port * ONLP_DOM_CHANNELS + channel),
+ * so the evaluation is one straight pass over contiguous values.
+ */
+static struct {
+    pthread_mutex_t lock;
+    int initialized;
+
+    int32_t value[DOM_ENTRIES] __attribute__((aligned(64)));
+    int32_t high_alarm[DOM_ENTRIES] __attribute__((aligned(64)));
+    int32_t low_alarm[DOM_ENTRIES] __attribute__((aligned(64)));
+    int32_t high_warning[DOM_ENTRIES] __attribute__((aligned(64)));
+    int32_t low_warning[DOM_ENTRIES] __attribute__((aligned(64)));
+    uint8_t flags[DOM_ENTRIES] __attribute__((aligned(64)));
+
+    /** Per port: ONLP_DOM_FLAG() bits of each class at (class * 4) */
+    uint32_t summary[ONLP_DOM_PORTS_MAX];
+
+    int lanes[ONLP_DOM_PORTS_MAX];
+    dom_type_t type[ONLP_DOM_PORTS_MAX];
+
+    /** One past the highest monitored port */
+    int ports;
+
+    uint64_t evaluations;
+} dom__ = { PTHREAD_MUTEX_INITIALIZER };
+
+static const uint8_t channel_class__[ONLP_DOM_CHANNELS] = {
+    ONLP_DOM_CLASS_TEMP,
+    ONLP_DOM_CLASS_VCC,
+    ONLP_DOM_CLASS_BIAS, ONLP_DOM_CLASS_BIAS,
+    ONLP_DOM_CLASS_BIAS, ONLP_DOM_CLASS_BIAS,
+    ONLP_DOM_CLASS_TX_POWER, ONLP_DOM_CLASS_TX_POWER,
+    ONLP_DOM_CLASS_TX_POWER, ONLP_DOM_CLASS_TX_POWER,
+    ONLP_DOM_CLASS_RX_POWER, ONLP_DOM_CLASS_RX_POWER,
+    ONLP_DOM_CLASS_RX_POWER, ONLP_DOM_CLASS_RX_POWER,
+    /* Padding, never flagged */
+    ONLP_DOM_CLASS_TEMP, ONLP_DOM_CLASS_TEMP,
+};
+
+static void
+dom_channel_clear__(int i)
+{
+    dom__.value[i] = 0;
+    dom__.high_alarm[i] = DOM_HIGH_NONE;
+    dom__.low_alarm[i] = DOM_LOW_NONE;
+    dom__.high_warning[i] = DOM_HIGH_NONE;
+    dom__.low_warning[i] = DOM_LOW_NONE;
+    dom__.flags[i] = 0;
+}
+
+static void
+dom_port_clear__(int port)
+{
+    int c;
+    for(c = 0; c < ONLP_DOM_CHANNELS; c++) {
+        dom_channel_clear__(port * ONLP_DOM_CHANNELS + c);
+    }
+    dom__.lanes[port] = 0;
+}
+
+static void dom_invalidate__(const onlp_invalidate_t* inv, void* cookie);
+
+static void
+dom_init_locked__(void)
+{
+    int p;
+    if(!dom__.initialized) {
+        for(p = 0; p < ONLP_DOM_PORTS_MAX; p++) {
+            dom_port_clear__(p);
+        }
+        onlp_invalidate_register(ONLP_INVALIDATE_CLASS_FLAG(ONLP_INVALIDATE_CLASS_SFP),
+                                 dom_invalidate__, NULL);
+        dom__.initialized = 1;
+    }
+}
+
+static void
+dom_port_store_locked__(int port, const onlp_dom_port_t* dp,
+                        int thresholds, dom_type_t type)
+{
+    int c;
+
+    dom_init_locked__();
+
+    if(dp == NULL || dp->lanes == 0) {
+        dom_port_clear__(port);
+        dom__.type[port] = type;
+        return;
+    }
+
+    for(c = 0; c < ONLP_DOM_CHANNELS; c++) {
+        const onlp_dom_channel_t* ch = dp->channels + c;
+        int i = port * ONLP_DOM_CHANNELS + c;
+
+        if(thresholds) {
+            if(ch->valid) {
+                dom__.high_alarm[i] = ch->high_alarm;
+                dom__.low_alarm[i] = ch->low_alarm;
+                dom__.high_warning[i] = ch->high_warning;
+                dom__.low_warning[i] = ch->low_warning;
+            }
+            else {
+                dom_channel_clear__(i);
+            }
+        }
+        dom__.value[i] = ch->value;
+    }
+
+    dom__.lanes[port] = dp->lanes;
+    dom__.type[port] = type;
+    if(port >= dom__.ports) {
+        dom__.ports = port + 1;
+    }
+}
+
+
+/*
+ * Module memory map decoding.
+ */
+#define DOM_U16(_p) ((int32_t)(((_p)[0] << 8) | (_p)[1]))
+#define DOM_S16(_p) ((int32_t)(int16_t)(((_p)[0] << 8) | (_p)[1]))
+
+/*
+ * Thresholds are four 16-bit words in both specifications:
+ * high alarm, low alarm, high warning, low warning.
+ */
+static void
+dom_thresholds_decode__(onlp_dom_channel_t* ch, const uint8_t* p, int sign)
+{
+    if(sign) {
+        ch->high_alarm = DOM_S16(p);
+        ch->low_alarm = DOM_S16(p+2);
+        ch->high_warning = DOM_S16(p+4);
+        ch->low_warning = DOM_S16(p+6);
+    }
+    else {
+        ch->high_alarm = DOM_U16(p);
+        ch->low_alarm = DOM_U16(p+2);
+        ch->high_warning = DOM_U16(p+4);
+        ch->low_warning = DOM_U16(p+6);
+    }
+    /* Modules without thresholds for a measurement report zeros. */
+    ch->valid = (ch->high_alarm || ch->low_alarm ||
+                 ch->high_warning || ch->low_warning);
+}
+
+/* SFF-8472, device A2h */
+static void
+dom_sff8472_thresholds__(onlp_dom_port_t* dp, const uint8_t* a2)
+{
+    dp->lanes = 1;
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_TEMP, a2 + 0, 1);
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_VCC, a2 + 8, 0);
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_BIAS(0), a2 + 16, 0);
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_TX_POWER(0), a2 + 24, 0);
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_RX_POWER(0), a2 + 32, 0);
+}
+
+static void
+dom_sff8472_values__(onlp_dom_port_t* dp, const uint8_t* a2)
+{
+    dp->channels[ONLP_DOM_CHANNEL_TEMP].value = DOM_S16(a2 + 96);
+    dp->channels[ONLP_DOM_CHANNEL_VCC].value = DOM_U16(a2 + 98);
+    dp->channels[ONLP_DOM_CHANNEL_BIAS(0)].value = DOM_U16(a2 + 100);
+    dp->channels[ONLP_DOM_CHANNEL_TX_POWER(0)].value = DOM_U16(a2 + 102);
+    dp->channels[ONLP_DOM_CHANNEL_RX_POWER(0)].value = DOM_U16(a2 + 104);
+}
+
+/* SFF-8636, upper page 03h at offset 128 */
+static void
+dom_sff8636_thresholds__(onlp_dom_port_t* dp, const uint8_t* page3)
+{
+    int l;
+    dp->lanes = 4;
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_TEMP, page3 + 128, 1);
+    dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_VCC, page3 + 144, 0);
+    /* The thresholds are shared by every lane. */
+    for(l = 0; l < 4; l++) {
+        dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_RX_POWER(l), page3 + 176, 0);
+        dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_BIAS(l), page3 + 184, 0);
+        dom_thresholds_decode__(dp->channels + ONLP_DOM_CHANNEL_TX_POWER(l), page3 + 192, 0);
+    }
+}
+
+/* SFF-8636, lower page */
+static void
+dom_sff8636_values__(onlp_dom_port_t* dp, const uint8_t* lower)
+{
+    int l;
+    dp->channels[ONLP_DOM_CHANNEL_TEMP].value = DOM_S16(lower + 22);
+    dp->channels[ONLP_DOM_CHANNEL_VCC].value = DOM_U16(lower + 26);
+    for(l = 0; l < 4; l++) {
+        dp->channels[ONLP_DOM_CHANNEL_RX_POWER(l)].value = DOM_U16(lower + 34 + 2*l);
+        dp->channels[ONLP_DOM_CHANNEL_BIAS(l)].value = DOM_U16(lower + 42 + 2*l);
+        dp->channels[ONLP_DOM_CHANNEL_TX_POWER(l)].value = DOM_U16(lower + 50 + 2*l);
+    }
+}
+
+static int
+dom_sff8636_page3_read__(int port, uint8_t* page3)
+{
+    return onlp_sfp_dev_page_read(port, 0x50, 3, page3 + 128);
+}
+
+/*
+ * Identify a newly inserted module and read its thresholds.
+ */
+static dom_type_t
+dom_port_identify__(int port, onlp_dom_port_t* dp)
+{
+    uint8_t* a0 = NULL;
+    uint8_t* a2 = NULL;
+    dom_type_t type = DOM_TYPE_UNSUPPORTED;
+
+    if(onlp_sfp_eeprom_read(port, &a0) < 0) {
+        return DOM_TYPE_NONE;
+    }
+
+    switch(a0[0])
+        {
+        case 0x03: /* SFP */
+            /*
+             * Byte 92: bit 6 is DOM implemented, bit 4 is external
+             * calibration, which is not supported here.
+             */
+            if((a0[92] & 0x40) && !(a0[92] & 0x10) &&
+               onlp_sfp_dom_read(port, &a2) >= 0) {
+                dom_sff8472_thresholds__(dp, a2);
+                dom_sff8472_values__(dp, a2);
+                type = DOM_TYPE_SFF8472;
+            }
+            break;
+
+        case 0x0C: /* QSFP */
+        case 0x0D: /* QSFP+ */
+        case 0x11: /* QSFP28 */
+            /* Byte 2 bit 2: flat memory, there is no page 03h. */
+            if(!(a0[2] & 0x04)) {
+                uint8_t page3[256] = { 0 };
+                if(dom_sff8636_page3_read__(port, page3) < 0) {
+                    type = DOM_TYPE_NONE;
+                    break;
+                }
+                dom_sff8636_thresholds__(dp, page3);
+                dom_sff8636_values__(dp, a0);
+                type = DOM_TYPE_SFF8636;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+    aim_free(a0);
+    aim_free(a2);
+    return type;
+}
+
+static int
+dom_port_values__(int port, dom_type_t type, onlp_dom_port_t* dp)
+{
+    uint8_t* data = NULL;
+    int rv;
+
+    switch(type)
+        {
+        case DOM_TYPE_SFF8472:
+            if((rv = onlp_sfp_dom_read(port, &data)) >= 0) {
+                dom_sff8472_values__(dp, data);
+            }
+            break;
+        case DOM_TYPE_SFF8636:
+            if((rv = onlp_sfp_eeprom_read(port, &data)) >= 0) {
+                dom_sff8636_values__(dp, data);
+            }
+            break;
+        default:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+    aim_free(data);
+    return rv;
+}
+
+/*
+ * The module behind a port was changed or rebound.
+ * Forget its type so the thresholds are read again.
+ */
+static void
+dom_invalidate__(const onlp_invalidate_t* inv, void* cookie)
+{
+    int p;
+
+    pthread_mutex_lock(&dom__.lock);
+    for(p = 0; p < ONLP_DOM_PORTS_MAX; p++) {
+        if(inv->id != ONLP_INVALIDATE_ID_ALL && inv->id != p) {
+            continue;
+        }
+        if(dom__.type[p] != DOM_TYPE_NONE && dom__.type[p] != DOM_TYPE_EXTERNAL) {
+            dom_port_store_locked__(p, NULL, 1, DOM_TYPE_NONE);
+        }
+    }
+    pthread_mutex_unlock(&dom__.lock);
+}
+
+static int
+dom_port_update__(int port, int present)
+{
+    onlp_dom_port_t dp;
+    dom_type_t type;
+    int rv = 0;
+
+    pthread_mutex_lock(&dom__.lock);
+    type = dom__.type[port];
+    pthread_mutex_unlock(&dom__.lock);
+
+    if(!present) {
+        if(type != DOM_TYPE_NONE && type != DOM_TYPE_EXTERNAL) {
+            pthread_mutex_lock(&dom__.lock);
+            dom_port_store_locked__(port, NULL, 1, DOM_TYPE_NONE);
+            pthread_mutex_unlock(&dom__.lock);
+        }
+        return 0;
+    }
+
+    memset(&dp, 0, sizeof(dp));
+
+    /* The hardware is read without holding the DOM lock. */
+    if(type == DOM_TYPE_NONE) {
+        type = dom_port_identify__(port, &dp);
+        if(type == DOM_TYPE_NONE) {
+            /* Try again next time. */
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        pthread_mutex_lock(&dom__.lock);
+        dom_port_store_locked__(port, &dp, 1, type);
+        pthread_mutex_unlock(&dom__.lock);
+    }
+    else if(type == DOM_TYPE_SFF8472 || type == DOM_TYPE_SFF8636) {
+        dp.lanes = 1;
+        if((rv = dom_port_values__(port, type, &dp)) >= 0) {
+            pthread_mutex_lock(&dom__.lock);
+            /* Values only, unless the module was removed meanwhile. */
+            if(dom__.type[port] == type) {
+                dp.lanes = dom__.lanes[port];
+                dom_port_store_locked__(port, &dp, 0, type);
+            }
+            pthread_mutex_unlock(&dom__.lock);
+        }
+    }
+    return rv;
+}
+
+int
+onlp_dom_health_port_update(int port)
+{
+    int present;
+
+    if(port < 0 || port >= ONLP_DOM_PORTS_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if((present = onlp_sfp_is_present(port)) < 0) {
+        return present;
+    }
+    return dom_port_update__(port, present);
+}
+
+int
+onlp_dom_health_update(void)
+{
+    onlp_sfp_bitmap_t ports, present;
+    int p, rv;
+
+    onlp_sfp_bitmap_t_init(&ports);
+    onlp_sfp_bitmap_t_init(&present);
+
+    if((rv = onlp_sfp_bitmap_get(&ports)) < 0) {
+        return rv;
+    }
+    if((rv = onlp_sfp_presence_bitmap_get(&present)) < 0) {
+        return rv;
+    }
+
+    for(p = 0; p < ONLP_DOM_PORTS_MAX; p++) {
+        if(AIM_BITMAP_GET(&ports, p)) {
+            dom_port_update__(p, AIM_BITMAP_GET(&present, p));
+        }
+    }
+    return 0;
+}
+
+int
+onlp_dom_health_port_set(int port, const onlp_dom_port_t* src)
+{
+    if(port < 0 || port >= ONLP_DOM_PORTS_MAX ||
+       (src && (src->lanes < 0 || src->lanes > ONLP_DOM_LANES_MAX))) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    pthread_mutex_lock(&dom__.lock);
+    dom_port_store_locked__(port, src, 1,
+                            (src && src->lanes) ? DOM_TYPE_EXTERNAL : DOM_TYPE_NONE);
+    pthread_mutex_unlock(&dom__.lock);
+    return 0;
+}
+
+int
+onlp_dom_health_port_get(int port, onlp_dom_port_t* rv)
+{
+    int c;
+
+    if(port < 0 || port >= ONLP_DOM_PORTS_MAX || rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&dom__.lock);
+    dom_init_locked__();
+    memset(rv, 0, sizeof(*rv));
+    rv->lanes = dom__.lanes[port];
+    for(c = 0; c < ONLP_DOM_CHANNELS; c++) {
+        int i = port * ONLP_DOM_CHANNELS + c;
+        onlp_dom_channel_t* ch = rv->channels + c;
+        ch->value = dom__.value[i];
+        ch->high_alarm = dom__.high_alarm[i];
+        ch->low_alarm = dom__.low_alarm[i];
+        ch->high_warning = dom__.high_warning[i];
+        ch->low_warning = dom__.low_warning[i];
+        ch->flags = dom__.flags[i];
+        ch->valid = (ch->high_alarm != DOM_HIGH_NONE);
+    }
+    pthread_mutex_unlock(&dom__.lock);
+    return 0;
+}
+
+void
+onlp_dom_health_t_init(onlp_dom_health_t* health)
+{
+    int c, s;
+    onlp_sfp_bitmap_t_init(&health->monitored);
+    for(c = 0; c < ONLP_DOM_CLASS_COUNT; c++) {
+        for(s = 0; s < ONLP_DOM_SEVERITY_COUNT; s++) {
+            onlp_sfp_bitmap_t_init(&health->flags[c][s]);
+            onlp_sfp_bitmap_t_init(&health->raised[c][s]);
+            onlp_sfp_bitmap_t_init(&health->cleared[c][s]);
+        }
+    }
+    health->changed = 0;
+    health->evaluations = 0;
+}
+
+/*
+ * Every comparison, one pass, no branches. Unmonitored channels
+ * have thresholds which can never be crossed.
+ */
+static void
+dom_compare__(int n)
+{
+    const int32_t* restrict v = dom__.value;
+    const int32_t* restrict ha = dom__.high_alarm;
+    const int32_t* restrict la = dom__.low_alarm;
+    const int32_t* restrict hw = dom__.high_warning;
+    const int32_t* restrict lw = dom__.low_warning;
+    uint8_t* restrict f = dom__.flags;
+    int i;
+
+    for(i = 0; i < n; i++) {
+        f[i] = (uint8_t)(((v[i] > ha[i]) << ONLP_DOM_SEVERITY_HIGH_ALARM) |
+                         ((v[i] < la[i]) << ONLP_DOM_SEVERITY_LOW_ALARM) |
+                         ((v[i] > hw[i]) << ONLP_DOM_SEVERITY_HIGH_WARNING) |
+                         ((v[i] < lw[i]) << ONLP_DOM_SEVERITY_LOW_WARNING));
+    }
+}
+
+int
+onlp_dom_health_evaluate(onlp_dom_health_t* health)
+{
+    int p, c;
+
+    if(health == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    onlp_dom_health_t_init(health);
+
+    pthread_mutex_lock(&dom__.lock);
+    dom_init_locked__();
+
+    dom_compare__(dom__.ports * ONLP_DOM_CHANNELS);
+
+    for(p = 0; p < dom__.ports; p++) {
+        const uint8_t* f = dom__.flags + p * ONLP_DOM_CHANNELS;
+        uint32_t prev = dom__.summary[p];
+        uint32_t cur = 0;
+        uint32_t bits;
+
+        for(c = 0; c < ONLP_DOM_CHANNELS; c++) {
+            cur |= (uint32_t)f[c] << (channel_class__[c] * ONLP_DOM_SEVERITY_COUNT);
+        }
+        dom__.summary[p] = cur;
+
+        if(dom__.lanes[p]) {
+            AIM_BITMAP_SET(&health->monitored, p);
+        }
+        if((cur | prev) == 0) {
+            continue;
+        }
+
+        for(bits = cur; bits; bits &= bits - 1) {
+            int b = __builtin_ctz(bits);
+            AIM_BITMAP_SET(&health->flags[b / ONLP_DOM_SEVERITY_COUNT][b % ONLP_DOM_SEVERITY_COUNT], p);
+        }
+        for(bits = cur & ~prev; bits; bits &= bits - 1) {
+            int b = __builtin_ctz(bits);
+            AIM_BITMAP_SET(&health->raised[b / ONLP_DOM_SEVERITY_COUNT][b % ONLP_DOM_SEVERITY_COUNT], p);
+        }
+        for(bits = prev & ~cur; bits; bits &= bits - 1) {
+            int b = __builtin_ctz(bits);
+            AIM_BITMAP_SET(&health->cleared[b / ONLP_DOM_SEVERITY_COUNT][b % ONLP_DOM_SEVERITY_COUNT], p);
+        }
+        if(cur != prev) {
+            health->changed++;
+        }
+    }
+
+    /* Ports beyond the monitored range may still have been flagged. */
+    for(; p < ONLP_DOM_PORTS_MAX; p++) {
+        uint32_t bits;
+        for(bits = dom__.summary[p]; bits; bits &= bits - 1) {
+            int b = __builtin_ctz(bits);
+            AIM_BITMAP_SET(&health->cleared[b / ONLP_DOM_SEVERITY_COUNT][b % ONLP_DOM_SEVERITY_COUNT], p);
+        }
+        if(dom__.summary[p]) {
+            dom__.summary[p] = 0;
+            health->changed++;
+        }
+    }
+
+    health->evaluations = ++dom__.evaluations;
+    pthread_mutex_unlock(&dom__.lock);
+    return 0;
+}
+
+void
+onlp_dom_health_show(aim_pvs_t* pvs)
+{
+    static const char* classes[ONLP_DOM_CLASS_COUNT] = {
+        "Temperature", "Vcc", "Bias", "Tx Power", "Rx Power",
+    };
+    static const char* severities[ONLP_DOM_SEVERITY_COUNT] = {
+        "High Alarm", "Low Alarm", "High Warning", "Low Warning",
+    };
+    onlp_dom_health_t health;
+    int c, s, p, any = 0;
+
+    /* The conditions from the last evaluation, without consuming its changes. */
+    onlp_dom_health_t_init(&health);
+    pthread_mutex_lock(&dom__.lock);
+    for(p = 0; p < ONLP_DOM_PORTS_MAX; p++) {
+        uint32_t bits;
+        if(dom__.lanes[p]) {
+            AIM_BITMAP_SET(&health.monitored, p);
+        }
+        for(bits = dom__.summary[p]; bits; bits &= bits - 1) {
+            int b = __builtin_ctz(bits);
+            AIM_BITMAP_SET(&health.flags[b / ONLP_DOM_SEVERITY_COUNT][b % ONLP_DOM_SEVERITY_COUNT], p);
+        }
+    }
+    pthread_mutex_unlock(&dom__.lock);
+
+    aim_printf(pvs, "DOM Monitored: %{aim_bitmap}\n", &health.monitored);
+    for(c = 0; c < ONLP_DOM_CLASS_COUNT; c++) {
+        for(s = 0; s < ONLP_DOM_SEVERITY_COUNT; s++) {
+            if(AIM_BITMAP_COUNT(&health.flags[c][s])) {
+                aim_printf(pvs, "  %s %s: %{aim_bitmap}\n", classes[c],
+                           severities[s], &health.flags[c][s]);
+                any = 1;
+            }
+        }
+    }
+    if(!any) {
+        aim_printf(pvs, "  No DOM alarms or warnings.\n");
+    }
+}
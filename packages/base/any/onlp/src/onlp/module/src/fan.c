@@ -26,6 +26,10 @@
 #include <onlp/platformi/fani.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+
+/* Initialize the fan subsystem on first use. */
+#define ONLP_LOCKED_API_INIT_HOOK(_api)                                 \
+    onlp_init_once(ONLP_INIT_PHASE_FAN, onlp_fan_init__, _api)
 #include "onlp_locks.h"
 #include "onlp_log.h"
 #include "onlp_json.h"
@@ -46,10 +50,16 @@
 
 
 static int
-onlp_fan_init_locked__(void)
+onlp_fan_init__(void)
 {
     return onlp_fani_init();
 }
+
+int
+onlp_fan_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_FAN, onlp_fan_init__, "onlp_fan_init");
+}
 ONLP_LOCKED_API0(onlp_fan_init)
 
 
@@ -84,7 +94,7 @@ onlp_fani_info_from_json__(cJSON* data, onlp_fan_info_t* fip, int errorcheck)
 
 #endif
 
-static int
+int
 onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
 {
     int rv;
@@ -119,7 +129,7 @@ onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
 }
 ONLP_LOCKED_API2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, fip);
 
-static int
+int
 onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
 {
     int rv = onlp_fani_status_get(oid, status);
@@ -135,7 +145,7 @@ onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
 }
 ONLP_LOCKED_API2(onlp_fan_status_get, onlp_oid_t, oid, uint32_t*, status);
 
-static int
+int
 onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
 {
     int rv = onlp_fani_hdr_get(oid, hdr);
@@ -0,0 +1,332 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/invalidate.h>
+#include <onlplib/uevent.h>
+#include <AIM/aim_printf.h>
+#include <limits.h>
+#include <pthread.h>
+#include "onlp_log.h"
+
+#define INVALIDATE_HANDLERS_MAX 16
+
+typedef struct invalidate_handler_s {
+    uint32_t classes;
+    onlp_invalidate_handler_f handler;
+    void* cookie;
+} invalidate_handler_t;
+
+typedef struct invalidate_binding_s {
+    /** The resolved devpath, if the device existed when bound */
+    char* devpath;
+    /** The device name, matched anywhere in the devpath */
+    char* name;
+    onlp_invalidate_class_t cls;
+    int id;
+} invalidate_binding_t;
+
+static struct {
+    pthread_mutex_t lock;
+
+    invalidate_handler_t handlers[INVALIDATE_HANDLERS_MAX];
+    int handler_count;
+
+    invalidate_binding_t* bindings;
+    int binding_count;
+    int binding_size;
+
+    int subscription;
+
+    /** Counters */
+    uint64_t events;
+    uint64_t invalidations[ONLP_INVALIDATE_CLASS_COUNT];
+} inv__ = { PTHREAD_MUTEX_INITIALIZER, .subscription = -1 };
+
+static const char* class_names__[ONLP_INVALIDATE_CLASS_COUNT] = {
+    "sys", "thermal", "fan", "psu", "led", "sfp",
+};
+
+int
+onlp_invalidate_register(uint32_t classes, onlp_invalidate_handler_f handler,
+                         void* cookie)
+{
+    int i, rv = 0;
+
+    if(handler == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&inv__.lock);
+    for(i = 0; i < inv__.handler_count; i++) {
+        if(inv__.handlers[i].handler == handler &&
+           inv__.handlers[i].cookie == cookie) {
+            /* Already registered (e.g. on re-initialization) */
+            inv__.handlers[i].classes = classes;
+            pthread_mutex_unlock(&inv__.lock);
+            return 0;
+        }
+    }
+    if(inv__.handler_count == INVALIDATE_HANDLERS_MAX) {
+        AIM_LOG_ERROR("No invalidation handlers available.");
+        rv = ONLP_STATUS_E_INTERNAL;
+    }
+    else {
+        invalidate_handler_t* h = inv__.handlers + inv__.handler_count++;
+        h->classes = classes;
+        h->handler = handler;
+        h->cookie = cookie;
+    }
+    pthread_mutex_unlock(&inv__.lock);
+    return rv;
+}
+
+int
+onlp_invalidate_unregister(onlp_invalidate_handler_f handler, void* cookie)
+{
+    int i;
+
+    pthread_mutex_lock(&inv__.lock);
+    for(i = 0; i < inv__.handler_count; i++) {
+        if(inv__.handlers[i].handler == handler &&
+           inv__.handlers[i].cookie == cookie) {
+            inv__.handlers[i] = inv__.handlers[--inv__.handler_count];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&inv__.lock);
+    return 0;
+}
+
+static int
+invalidate_dispatch__(onlp_invalidate_class_t cls, int id,
+                      const char* devpath, const char* reason)
+{
+    invalidate_handler_t handlers[INVALIDATE_HANDLERS_MAX];
+    onlp_invalidate_t inv;
+    int i, count = 0;
+
+    if(cls < 0 || cls >= ONLP_INVALIDATE_CLASS_COUNT) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&inv__.lock);
+    inv__.invalidations[cls]++;
+    for(i = 0; i < inv__.handler_count; i++) {
+        if(inv__.handlers[i].classes & ONLP_INVALIDATE_CLASS_FLAG(cls)) {
+            handlers[count++] = inv__.handlers[i];
+        }
+    }
+    pthread_mutex_unlock(&inv__.lock);
+
+    AIM_LOG_VERBOSE("invalidate %s %d (%s%s%s)", class_names__[cls], id,
+                    reason ? reason : "", devpath ? " " : "",
+                    devpath ? devpath : "");
+
+    inv.cls = cls;
+    inv.id = id;
+    inv.devpath = devpath;
+    inv.reason = reason;
+
+    /* Handlers are called without the lock. */
+    for(i = 0; i < count; i++) {
+        handlers[i].handler(&inv, handlers[i].cookie);
+    }
+    return 0;
+}
+
+int
+onlp_invalidate(onlp_invalidate_class_t cls, int id, const char* reason)
+{
+    return invalidate_dispatch__(cls, id, NULL, reason);
+}
+
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+
+/*
+ * Does the binding name appear as a component of the devpath?
+ */
+static int
+invalidate_name_match__(const char* devpath, const char* name)
+{
+    int len = strlen(name);
+    const char* p = devpath;
+
+    while((p = strstr(p, name))) {
+        if(p > devpath && p[-1] == '/' && (p[len] == 0 || p[len] == '/')) {
+            return 1;
+        }
+        p++;
+    }
+    return 0;
+}
+
+static int
+invalidate_binding_match__(const invalidate_binding_t* b, const char* devpath)
+{
+    if(b->devpath) {
+        int len = strlen(b->devpath);
+        return !strncmp(devpath, b->devpath, len) &&
+            (devpath[len] == 0 || devpath[len] == '/');
+    }
+    return invalidate_name_match__(devpath, b->name);
+}
+
+static void
+invalidate_uevent__(const onlp_uevent_t* ev, void* cookie)
+{
+    static const char* actions[] = {
+        "add", "remove", "bind", "unbind", "change", "move",
+    };
+    struct { onlp_invalidate_class_t cls; int id; } *matches;
+    int i, count = 0;
+
+    if(!strcmp(ev->action, "overrun")) {
+        /* Any binding may have been affected. */
+        for(i = 0; i < ONLP_INVALIDATE_CLASS_COUNT; i++) {
+            invalidate_dispatch__(i, ONLP_INVALIDATE_ID_ALL, NULL, ev->action);
+        }
+        return;
+    }
+
+    for(i = 0; i < AIM_ARRAYSIZE(actions); i++) {
+        if(!strcmp(ev->action, actions[i])) {
+            break;
+        }
+    }
+    if(i == AIM_ARRAYSIZE(actions)) {
+        return;
+    }
+
+    pthread_mutex_lock(&inv__.lock);
+    inv__.events++;
+    matches = aim_zmalloc((inv__.binding_count + 1) * sizeof(*matches));
+    for(i = 0; i < inv__.binding_count; i++) {
+        invalidate_binding_t* b = inv__.bindings + i;
+        if(invalidate_binding_match__(b, ev->devpath)) {
+            matches[count].cls = b->cls;
+            matches[count].id = b->id;
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&inv__.lock);
+
+    for(i = 0; i < count; i++) {
+        invalidate_dispatch__(matches[i].cls, matches[i].id,
+                              ev->devpath, ev->action);
+    }
+    aim_free(matches);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_UEVENT */
+
+int
+onlp_invalidate_bind(const char* path, onlp_invalidate_class_t cls, int id)
+{
+    char devpath[PATH_MAX];
+    const char* name;
+    invalidate_binding_t* b;
+
+    if(path == NULL || cls < 0 || cls >= ONLP_INVALIDATE_CLASS_COUNT) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if((name = strrchr(path, '/')) == NULL || name[1] == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    name++;
+
+    pthread_mutex_lock(&inv__.lock);
+    if(inv__.binding_count == inv__.binding_size) {
+        inv__.binding_size = inv__.binding_size ? inv__.binding_size * 2 : 32;
+        inv__.bindings = aim_realloc(inv__.bindings,
+                                     inv__.binding_size * sizeof(inv__.bindings[0]));
+    }
+    b = inv__.bindings + inv__.binding_count++;
+    memset(b, 0, sizeof(*b));
+    b->name = aim_strdup(name);
+    b->cls = cls;
+    b->id = id;
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+    if(onlp_uevent_devpath(path, devpath, sizeof(devpath)) == 0) {
+        b->devpath = aim_strdup(devpath);
+    }
+    if(inv__.subscription < 0) {
+        inv__.subscription = onlp_uevent_subscribe(NULL, NULL,
+                                                   invalidate_uevent__, NULL);
+    }
+#else
+    (void)devpath;
+#endif
+    pthread_mutex_unlock(&inv__.lock);
+    return 0;
+}
+
+int
+onlp_invalidate_unbind(const char* path)
+{
+    const char* name;
+    int i;
+
+    if(path == NULL || (name = strrchr(path, '/')) == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    name++;
+
+    pthread_mutex_lock(&inv__.lock);
+    for(i = 0; i < inv__.binding_count; ) {
+        invalidate_binding_t* b = inv__.bindings + i;
+        if(!strcmp(b->name, name)) {
+            aim_free(b->name);
+            aim_free(b->devpath);
+            *b = inv__.bindings[--inv__.binding_count];
+        }
+        else {
+            i++;
+        }
+    }
+    pthread_mutex_unlock(&inv__.lock);
+    return 0;
+}
+
+void
+onlp_invalidate_show(aim_pvs_t* pvs)
+{
+    int i;
+
+    pthread_mutex_lock(&inv__.lock);
+    aim_printf(pvs, "handlers=%d bindings=%d events=%llu\n",
+               inv__.handler_count, inv__.binding_count,
+               (unsigned long long)inv__.events);
+    for(i = 0; i < ONLP_INVALIDATE_CLASS_COUNT; i++) {
+        aim_printf(pvs, "  %-8s %llu\n", class_names__[i],
+                   (unsigned long long)inv__.invalidations[i]);
+    }
+    for(i = 0; i < inv__.binding_count; i++) {
+        invalidate_binding_t* b = inv__.bindings + i;
+        aim_printf(pvs, "  %s %d: %s\n", class_names__[b->cls], b->id,
+                   b->devpath ? b->devpath : b->name);
+    }
+    pthread_mutex_unlock(&inv__.lock);
+}
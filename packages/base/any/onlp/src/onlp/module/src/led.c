@@ -25,8 +25,14 @@
 #include <onlp/onlp.h>
 #include <onlp/oids.h>
 #include <onlp/led.h>
+#include <onlp/invalidate.h>
 #include <onlp/platformi/ledi.h>
+#include <OS/os_time.h>
 #include "onlp_int.h"
+
+/* Initialize the LED subsystem on first use. */
+#define ONLP_LOCKED_API_INIT_HOOK(_api)                                 \
+    onlp_init_once(ONLP_INIT_PHASE_LED, onlp_led_init__, _api)
 #include "onlp_locks.h"
 
 #define VALIDATE(_id)                           \
@@ -69,22 +75,152 @@ onlp_led_present__(onlp_oid_t id, onlp_led_info_t* info)
         }                                               \
     } while(0)
 
+#if ONLP_CONFIG_INCLUDE_LED_SHADOW == 1
+
+/*
+ * LED shadow.
+ *
+ * The caps and presence of each LED are read once and the last
+ * state written is remembered, so writes which would not change
+ * anything are skipped without touching the hardware.
+ *
+ * Another process may change an LED behind our back, so the
+ * last state written is only trusted for
+ * ONLP_CONFIG_LED_SHADOW_TIMEOUT.
+ *
+ * The shadow is only accessed with the API lock held.
+ */
+typedef struct onlp_led_shadow_s {
+    /** The caps and presence below are known */
+    int valid;
+    uint32_t caps;
+    /** Last written values, -1 if unknown */
+    int on;
+    int mode;
+    int character;
+    /** When they were written */
+    uint64_t time;
+} onlp_led_shadow_t;
+
+static onlp_led_shadow_t led_shadow__[ONLP_OID_TABLE_SIZE];
+
+static onlp_led_shadow_t*
+onlp_led_shadow__(onlp_oid_t id)
+{
+    uint32_t i = ONLP_OID_ID_GET(id);
+    return (i < AIM_ARRAYSIZE(led_shadow__)) ? led_shadow__ + i : NULL;
+}
+
+static void
+onlp_led_shadow_clear__(onlp_led_shadow_t* s)
+{
+    s->valid = 0;
+    s->on = s->mode = s->character = -1;
+}
+
+/* Forget the last written state once it is too old to trust. */
+static void
+onlp_led_shadow_expire__(onlp_led_shadow_t* s)
+{
+    if(ONLP_CONFIG_LED_SHADOW_TIMEOUT &&
+       os_time_monotonic() - s->time > ONLP_CONFIG_LED_SHADOW_TIMEOUT) {
+        s->on = s->mode = s->character = -1;
+    }
+}
+
+/*
+ * Returns the shadow entry for a present LED, reading the
+ * hardware only the first time.
+ */
 static int
-onlp_led_init_locked__(void)
+onlp_led_shadow_present__(onlp_oid_t id, onlp_led_shadow_t** rv)
+{
+    onlp_led_shadow_t* s = onlp_led_shadow__(id);
+    onlp_led_info_t info;
+    int r;
+
+    if(s && s->valid) {
+        *rv = s;
+        return ONLP_STATUS_OK;
+    }
+
+    if((r = onlp_led_present__(id, &info)) < 0) {
+        return r;
+    }
+
+    if(s == NULL) {
+        /* Out of range, use a one-off entry. */
+        static onlp_led_shadow_t scratch;
+        s = &scratch;
+        onlp_led_shadow_clear__(s);
+        s->caps = info.caps;
+    }
+    else {
+        /*
+         * The reported mode is what the hardware shows, which is not
+         * necessarily what was last written, so the first write for
+         * each LED always goes through.
+         */
+        onlp_led_shadow_clear__(s);
+        s->valid = 1;
+        s->caps = info.caps;
+    }
+    *rv = s;
+    return ONLP_STATUS_OK;
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_LED_SHADOW */
+
+static void
+onlp_led_invalidate__(const onlp_invalidate_t* inv, void* cookie)
+{
+    onlp_led_shadow_invalidate(inv->id == ONLP_INVALIDATE_ID_ALL ?
+                               0 : ONLP_LED_ID_CREATE(inv->id));
+}
+
+static int
+onlp_led_init__(void)
 {
+    onlp_invalidate_register(ONLP_INVALIDATE_CLASS_FLAG(ONLP_INVALIDATE_CLASS_LED),
+                             onlp_led_invalidate__, NULL);
     return onlp_ledi_init();
 }
+
+int
+onlp_led_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_LED, onlp_led_init__, "onlp_led_init");
+}
 ONLP_LOCKED_API0(onlp_led_init);
 
-static int
+int
 onlp_led_info_get_locked__(onlp_oid_t id, onlp_led_info_t* info)
 {
+    int rv;
     VALIDATE(id);
-    return onlp_ledi_info_get(id, info);
+    rv = onlp_ledi_info_get(id, info);
+#if ONLP_CONFIG_INCLUDE_LED_SHADOW == 1
+    if(rv >= 0) {
+        /* Refresh the caps and presence. */
+        onlp_led_shadow_t* s = onlp_led_shadow__(id);
+        if(s && !s->valid) {
+            onlp_led_shadow_clear__(s);
+        }
+        if(s) {
+            s->valid = (info->status & 0x1);
+            s->caps = info->caps;
+            if(s->mode >= 0 && s->mode != info->mode) {
+                /* Changed elsewhere. */
+                s->on = s->mode = s->character = -1;
+            }
+        }
+    }
+#endif
+    return rv;
 }
 ONLP_LOCKED_API2(onlp_led_info_get, onlp_oid_t, id, onlp_led_info_t*, info);
 
-static int
+int
 onlp_led_status_get_locked__(onlp_oid_t id, uint32_t* status)
 {
     int rv = onlp_ledi_status_get(id, status);
@@ -100,7 +236,7 @@ onlp_led_status_get_locked__(onlp_oid_t id, uint32_t* status)
 }
 ONLP_LOCKED_API2(onlp_led_status_get, onlp_oid_t, id, uint32_t*, status);
 
-static int
+int
 onlp_led_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
 {
     int rv = onlp_ledi_hdr_get(id, hdr);
@@ -116,6 +252,130 @@ onlp_led_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
 }
 ONLP_LOCKED_API2(onlp_led_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 
+#if ONLP_CONFIG_INCLUDE_LED_SHADOW == 1
+
+static int
+onlp_led_set_locked__(onlp_oid_t id, int on_or_off)
+{
+    onlp_led_shadow_t* s;
+    int rv;
+
+    VALIDATE(id);
+    if((rv = onlp_led_shadow_present__(id, &s)) < 0) {
+        return rv;
+    }
+    if(!(s->caps & ONLP_LED_CAPS_ON_OFF)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    on_or_off = !!on_or_off;
+    onlp_led_shadow_expire__(s);
+    if(s->on == on_or_off) {
+        return ONLP_STATUS_OK;
+    }
+
+    rv = onlp_ledi_set(id, on_or_off);
+    if(rv < 0) {
+        onlp_led_shadow_clear__(s);
+        return rv;
+    }
+    s->on = on_or_off;
+    s->time = os_time_monotonic();
+    /* What "on" looks like is up to the platform. */
+    s->mode = on_or_off ? -1 : ONLP_LED_MODE_OFF;
+    return rv;
+}
+ONLP_LOCKED_API2(onlp_led_set, onlp_oid_t, id, int, on_or_off);
+
+static int
+onlp_led_mode_set_locked__(onlp_oid_t id, onlp_led_mode_t mode)
+{
+    onlp_led_shadow_t* s;
+    int rv;
+
+    VALIDATE(id);
+    if((rv = onlp_led_shadow_present__(id, &s)) < 0) {
+        return rv;
+    }
+
+    /*
+     * The mode enumeration values always match
+     * the capability bit positions.
+     */
+    if(!(s->caps & (1 << mode))) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    onlp_led_shadow_expire__(s);
+    if(s->mode == mode) {
+        return ONLP_STATUS_OK;
+    }
+
+    rv = onlp_ledi_mode_set(id, mode);
+    if(rv < 0) {
+        onlp_led_shadow_clear__(s);
+        return rv;
+    }
+    s->mode = mode;
+    s->time = os_time_monotonic();
+    s->on = (mode != ONLP_LED_MODE_OFF);
+    return rv;
+}
+ONLP_LOCKED_API2(onlp_led_mode_set, onlp_oid_t, id, onlp_led_mode_t, mode);
+
+static int
+onlp_led_char_set_locked__(onlp_oid_t id, char c)
+{
+    onlp_led_shadow_t* s;
+    int rv;
+
+    VALIDATE(id);
+    if((rv = onlp_led_shadow_present__(id, &s)) < 0) {
+        return rv;
+    }
+    if(!(s->caps & ONLP_LED_CAPS_CHAR)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    onlp_led_shadow_expire__(s);
+    if(s->character == c) {
+        return ONLP_STATUS_OK;
+    }
+
+    rv = onlp_ledi_char_set(id, c);
+    if(rv < 0) {
+        onlp_led_shadow_clear__(s);
+        return rv;
+    }
+    s->character = c;
+    s->time = os_time_monotonic();
+    return rv;
+}
+ONLP_LOCKED_API2(onlp_led_char_set, onlp_oid_t, id, char, c);
+
+static int
+onlp_led_shadow_invalidate_locked__(onlp_oid_t id)
+{
+    int i;
+
+    if(id == 0) {
+        for(i = 0; i < AIM_ARRAYSIZE(led_shadow__); i++) {
+            onlp_led_shadow_clear__(led_shadow__ + i);
+        }
+    }
+    else {
+        onlp_led_shadow_t* s;
+        VALIDATE(id);
+        if((s = onlp_led_shadow__(id))) {
+            onlp_led_shadow_clear__(s);
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+ONLP_LOCKED_API1(onlp_led_shadow_invalidate, onlp_oid_t, id);
+
+#else
+
 static int
 onlp_led_set_locked__(onlp_oid_t id, int on_or_off)
 {
@@ -168,6 +428,37 @@ onlp_led_char_set_locked__(onlp_oid_t id, char c)
 }
 ONLP_LOCKED_API2(onlp_led_char_set, onlp_oid_t, id, char, c);
 
+static int
+onlp_led_shadow_invalidate_locked__(onlp_oid_t id)
+{
+    return ONLP_STATUS_OK;
+}
+ONLP_LOCKED_API1(onlp_led_shadow_invalidate, onlp_oid_t, id);
+
+#endif /* ONLP_CONFIG_INCLUDE_LED_SHADOW */
+
+static int
+onlp_led_mode_set_multi_locked__(const onlp_oid_t* ids,
+                                 const onlp_led_mode_t* modes, int count)
+{
+    int i, rv = ONLP_STATUS_OK;
+
+    if(ids == NULL || modes == NULL || count < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /* Apply everything, report the first failure. */
+    for(i = 0; i < count; i++) {
+        int r = onlp_led_mode_set_locked__(ids[i], modes[i]);
+        if(r < 0 && rv >= 0) {
+            rv = r;
+        }
+    }
+    return rv;
+}
+ONLP_LOCKED_API3(onlp_led_mode_set_multi, const onlp_oid_t*, ids,
+                 const onlp_led_mode_t*, modes, int, count);
+
 /************************************************************
  *
  * Debug and Show Functions
@@ -35,6 +35,20 @@
 #include <onlp/psu.h>
 #include <onlp/sys.h>
 
+#if ONLP_CONFIG_INCLUDE_LAZY_INIT == 1
+/* Status requests may touch every subsystem. */
+static void
+onlp_oid_init__(void)
+{
+    onlp_thermal_init_locked__();
+    onlp_fan_init_locked__();
+    onlp_psu_init_locked__();
+    onlp_led_init_locked__();
+}
+#define ONLP_LOCKED_API_INIT_HOOK(_api) onlp_oid_init__()
+#endif
+#include "onlp_locks.h"
+
 #define OID_TYPE_SHOWDUMP_DEFINE(_TYPE, _type)                          \
     static void                                                         \
     oid_type_##_TYPE##_dump__(onlp_oid_t oid, aim_pvs_t* pvs, uint32_t flags) \
@@ -229,3 +243,46 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
     }
     return ONLP_STATUS_OK;
 }
+
+static int
+oid_status_get_locked__(onlp_oid_t oid, uint32_t* status)
+{
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+        case ONLP_OID_TYPE_SYS:
+            *status = 1;
+            return ONLP_STATUS_OK;
+        case ONLP_OID_TYPE_THERMAL:
+            return onlp_thermal_status_get_locked__(oid, status);
+        case ONLP_OID_TYPE_FAN:
+            return onlp_fan_status_get_locked__(oid, status);
+        case ONLP_OID_TYPE_PSU:
+            return onlp_psu_status_get_locked__(oid, status);
+        case ONLP_OID_TYPE_LED:
+            return onlp_led_status_get_locked__(oid, status);
+        default:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+}
+
+static int
+onlp_oid_status_get_multi_locked__(const onlp_oid_t* oids, int n,
+                                   uint32_t* statuses)
+{
+    int i, failed = 0;
+
+    if(n < 0 || (n && (oids == NULL || statuses == NULL))) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    for(i = 0; i < n; i++) {
+        statuses[i] = 0;
+        if(oid_status_get_locked__(oids[i], statuses + i) < 0) {
+            statuses[i] = ONLP_OID_STATUS_FLAG_UNAVAILABLE;
+            failed++;
+        }
+    }
+    return failed;
+}
+ONLP_LOCKED_API3(onlp_oid_status_get_multi, const onlp_oid_t*, oids, int, n,
+                 uint32_t*, statuses);
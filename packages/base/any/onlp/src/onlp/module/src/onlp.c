@@ -32,15 +32,111 @@
 #include <onlp/fan.h>
 #include <onlp/thermal.h>
 
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include <AIM/aim_time.h>
+
 #include "onlp_int.h"
 #include "onlp_json.h"
 #include "onlp_locks.h"
 
+/**
+ * Startup trace.
+ *
+ * Each initialization phase runs at most once and records when it
+ * ran, how long it took, its result, and which API triggered it.
+ */
+typedef struct onlp_init_trace_s {
+    int done;
+    int lazy;
+    int rv;
+    uint64_t start;
+    uint64_t usecs;
+    const char* api;
+} onlp_init_trace_t;
+
+static onlp_init_trace_t init_trace__[ONLP_INIT_PHASE_COUNT];
+static pthread_mutex_t init_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t init_start__;
+static uint64_t init_usecs__;
+static int init_done__;
+
+static const char* init_phase_names__[ONLP_INIT_PHASE_COUNT] = {
+    "module",
+    "api-lock",
+    "config",
+    "sys",
+    "sfp",
+    "led",
+    "psu",
+    "fan",
+    "thermal",
+};
+
 int
-onlp_init(void)
+onlp_init_once(onlp_init_phase_t phase, int (*init)(void), const char* api)
+{
+    onlp_init_trace_t* t = init_trace__ + phase;
+
+    if(__atomic_load_n(&t->done, __ATOMIC_ACQUIRE)) {
+        return t->rv;
+    }
+
+    pthread_mutex_lock(&init_lock__);
+    if(!t->done) {
+        t->lazy = init_done__;
+        t->api = api;
+        t->start = aim_time_monotonic();
+        t->rv = init();
+        t->usecs = aim_time_monotonic() - t->start;
+        __atomic_store_n(&t->done, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&init_lock__);
+    return t->rv;
+}
+
+void
+onlp_init_reset(onlp_init_phase_t phase)
+{
+    pthread_mutex_lock(&init_lock__);
+    memset(init_trace__ + phase, 0, sizeof(init_trace__[0]));
+    pthread_mutex_unlock(&init_lock__);
+}
+
+static int
+onlp_module_init__(void)
 {
     extern void __onlp_module_init__(void);
     __onlp_module_init__();
+    return 0;
+}
+
+#if ONLP_CONFIG_INCLUDE_API_LOCK == 1
+static int
+onlp_api_lock_init__(void)
+{
+    onlp_api_lock_init();
+    return 0;
+}
+#endif
+
+static const char* config_file__;
+
+static int
+onlp_config_init__(void)
+{
+    onlp_json_init(config_file__);
+    return 0;
+}
+
+int
+onlp_init(void)
+{
+    init_start__ = aim_time_monotonic();
+    init_done__ = 0;
+
+    onlp_init_once(ONLP_INIT_PHASE_MODULE, onlp_module_init__, __func__);
 
     char* cfile;
 
@@ -49,28 +145,72 @@ onlp_init(void)
     }
 
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
-    onlp_api_lock_init();
+    onlp_init_once(ONLP_INIT_PHASE_API_LOCK, onlp_api_lock_init__, __func__);
 #endif
 
+    config_file__ = cfile;
+    onlp_init_once(ONLP_INIT_PHASE_CONFIG, onlp_config_init__, __func__);
 
-    onlp_json_init(cfile);
     onlp_sys_init();
+
+#if ONLP_CONFIG_INCLUDE_LAZY_INIT == 0
     onlp_sfp_init();
     onlp_led_init();
     onlp_psu_init();
     onlp_fan_init();
     onlp_thermal_init();
+#else
+    /*
+     * The remaining subsystems are initialized by the first
+     * API call which requires them.
+     */
+#endif
+
+    init_usecs__ = aim_time_monotonic() - init_start__;
+    init_done__ = 1;
     return 0;
 }
 
 int
 onlp_denit(void)
 {
+    int p;
+
+    onlp_sys_info_invalidate();
+
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
     onlp_api_lock_denit();
 #endif
 
     onlp_json_denit();
 
+    /* Everything but the module registration runs again on the next onlp_init() */
+    for(p = ONLP_INIT_PHASE_MODULE + 1; p < ONLP_INIT_PHASE_COUNT; p++) {
+        onlp_init_reset(p);
+    }
+
     return 0;
 }
+
+void
+onlp_init_trace_show(aim_pvs_t* pvs)
+{
+    int p;
+
+    aim_printf(pvs, "onlp_init(): %"PRIu64" usecs%s\n", init_usecs__,
+               ONLP_CONFIG_INCLUDE_LAZY_INIT ? " (lazy)" : "");
+    aim_printf(pvs, "  %-10s %-6s %12s %10s  %-28s %s\n",
+               "Phase", "Mode", "Start(us)", "Time(us)", "Trigger", "Status");
+
+    for(p = 0; p < ONLP_INIT_PHASE_COUNT; p++) {
+        onlp_init_trace_t* t = init_trace__ + p;
+        if(!t->done) {
+            aim_printf(pvs, "  %-10s %-6s %12s %10s  %-28s %s\n",
+                       init_phase_names__[p], "-", "-", "-", "-", "pending");
+            continue;
+        }
+        aim_printf(pvs, "  %-10s %-6s %12"PRIu64" %10"PRIu64"  %-28s %{onlp_status}\n",
+                   init_phase_names__[p], t->lazy ? "lazy" : "eager",
+                   t->start - init_start__, t->usecs, t->api, t->rv);
+    }
+}
@@ -0,0 +1,782 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * ONLP Microbenchmark and Load Suite.
+ *
+ * This is the entry point for the onlp-bench binary. It times
+ * the core and onlplib entry points against whatever platform
+ * library is currently installed (usually onlpie on development
+ * hosts) and reports the results as JSON.
+ *
+ ***********************************************************/
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/sys.h>
+#include <onlp/sfp.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include <onlp/thermal.h>
+#include <onlp/platformi/sysi.h>
+#include <onlplib/file.h>
+#include <onlplib/i2c.h>
+#include <onlplib/shlocks.h>
+#include <cjson/cJSON.h>
+#include <cjson_util/cjson_util.h>
+#include <AIM/aim.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "onlp_log.h"
+
+#define ONLP_BENCH_ITERATIONS_DEFAULT 1000
+#define ONLP_BENCH_MANIFEST "/etc/onl/rootfs/manifest.json"
+
+/**
+ * A single benchmark operation.
+ * Returns < 0 if the operation failed.
+ */
+typedef int (*onlp_bench_op_f)(void* cookie);
+
+/**
+ * Per-benchmark results.
+ */
+typedef struct onlp_bench_result_s {
+    /** Operation name */
+    const char* name;
+    /** Operations performed */
+    uint64_t ops;
+    /** Operations which returned an error */
+    uint64_t errors;
+    /** Total, minimum and maximum operation time in nanoseconds */
+    uint64_t ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    /** Read and write class syscalls issued during the run */
+    uint64_t syscr;
+    uint64_t syscw;
+} onlp_bench_result_t;
+
+static uint64_t
+onlp_bench_ns__(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/**
+ * Syscall accounting comes from /proc/self/io, which tracks
+ * read-class (syscr) and write-class (syscw) system calls.
+ */
+static int
+onlp_bench_syscalls__(uint64_t* syscr, uint64_t* syscw)
+{
+    char line[128];
+    FILE* fp = fopen("/proc/self/io", "r");
+
+    *syscr = *syscw = 0;
+    if(fp == NULL) {
+        return -1;
+    }
+    while(fgets(line, sizeof(line), fp)) {
+        unsigned long long v;
+        if(sscanf(line, "syscr: %llu", &v) == 1) {
+            *syscr = v;
+        }
+        else if(sscanf(line, "syscw: %llu", &v) == 1) {
+            *syscw = v;
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+/* Syscalls attributable to the accounting itself. */
+static uint64_t syscr_overhead__;
+static uint64_t syscw_overhead__;
+
+static void
+onlp_bench_calibrate__(void)
+{
+    uint64_t r0, w0, r1, w1;
+    onlp_bench_syscalls__(&r0, &w0);
+    onlp_bench_syscalls__(&r1, &w1);
+    syscr_overhead__ = r1 - r0;
+    syscw_overhead__ = w1 - w0;
+}
+
+static void
+onlp_bench_run__(onlp_bench_result_t* r, const char* name,
+                 onlp_bench_op_f op, void* cookie, int iterations)
+{
+    int i;
+    uint64_t r0, w0, r1, w1;
+
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    r->min_ns = (uint64_t)-1;
+
+    onlp_bench_syscalls__(&r0, &w0);
+    for(i = 0; i < iterations; i++) {
+        uint64_t t0 = onlp_bench_ns__();
+        int rv = op(cookie);
+        uint64_t dt = onlp_bench_ns__() - t0;
+
+        if(rv < 0) {
+            r->errors++;
+        }
+        r->ns += dt;
+        if(dt < r->min_ns) {
+            r->min_ns = dt;
+        }
+        if(dt > r->max_ns) {
+            r->max_ns = dt;
+        }
+        r->ops++;
+    }
+    onlp_bench_syscalls__(&r1, &w1);
+
+    r->syscr = (r1 - r0 > syscr_overhead__) ? r1 - r0 - syscr_overhead__ : 0;
+    r->syscw = (w1 - w0 > syscw_overhead__) ? w1 - w0 - syscw_overhead__ : 0;
+    if(r->ops == 0) {
+        r->min_ns = 0;
+    }
+}
+
+static void
+onlp_bench_result_json__(cJSON* results, onlp_bench_result_t* r)
+{
+    cJSON* cj = cJSON_CreateObject();
+    double ops = r->ops ? (double)r->ops : 1.0;
+
+    cJSON_AddStringToObject(cj, "name", r->name);
+    cJSON_AddNumberToObject(cj, "ops", r->ops);
+    cJSON_AddNumberToObject(cj, "errors", r->errors);
+    cJSON_AddNumberToObject(cj, "ns_per_op", r->ns / ops);
+    cJSON_AddNumberToObject(cj, "min_ns", r->min_ns);
+    cJSON_AddNumberToObject(cj, "max_ns", r->max_ns);
+    cJSON_AddNumberToObject(cj, "syscalls_per_op", (r->syscr + r->syscw) / ops);
+    cJSON_AddNumberToObject(cj, "syscr_per_op", r->syscr / ops);
+    cJSON_AddNumberToObject(cj, "syscw_per_op", r->syscw / ops);
+    cJSON_AddItemToArray(results, cj);
+}
+
+static void
+onlp_bench_skipped_json__(cJSON* results, const char* name, const char* reason)
+{
+    cJSON* cj = cJSON_CreateObject();
+    cJSON_AddStringToObject(cj, "name", name);
+    cJSON_AddStringToObject(cj, "skipped", reason);
+    cJSON_AddItemToArray(results, cj);
+}
+
+static void
+onlp_bench__(cJSON* results, const char* name, onlp_bench_op_f op,
+             void* cookie, int iterations)
+{
+    onlp_bench_result_t r;
+    onlp_bench_run__(&r, name, op, cookie, iterations);
+    onlp_bench_result_json__(results, &r);
+}
+
+
+/************************************************************
+ *
+ * onlplib file access
+ *
+ ***********************************************************/
+
+static int
+bench_file_read_int__(void* cookie)
+{
+    int v;
+    return onlp_file_read_int(&v, "%s", (char*)cookie);
+}
+
+static void
+onlp_bench_file__(cJSON* results, int iterations)
+{
+    char fname[] = "/tmp/onlp-bench.XXXXXX";
+    int fd = mkstemp(fname);
+
+    if(fd < 0) {
+        onlp_bench_skipped_json__(results, "onlp_file_read_int",
+                                  "temporary file creation failed");
+        return;
+    }
+    close(fd);
+    onlp_file_write_int(12345, "%s", fname);
+    onlp_bench__(results, "onlp_file_read_int", bench_file_read_int__,
+                 fname, iterations);
+    unlink(fname);
+}
+
+
+/************************************************************
+ *
+ * onlplib i2c access (against i2c-stub)
+ *
+ ***********************************************************/
+#if ONLPLIB_CONFIG_INCLUDE_I2C == 1
+
+typedef struct bench_i2c_s {
+    int bus;
+    uint8_t addr;
+    uint8_t data[256];
+} bench_i2c_t;
+
+static int
+bench_i2c_readb__(void* cookie)
+{
+    bench_i2c_t* b = (bench_i2c_t*)cookie;
+    return onlp_i2c_readb(b->bus, b->addr, 0, 0);
+}
+
+static int
+bench_i2c_readw__(void* cookie)
+{
+    bench_i2c_t* b = (bench_i2c_t*)cookie;
+    return onlp_i2c_readw(b->bus, b->addr, 0, 0);
+}
+
+static int
+bench_i2c_writeb__(void* cookie)
+{
+    bench_i2c_t* b = (bench_i2c_t*)cookie;
+    return onlp_i2c_writeb(b->bus, b->addr, 0, 0x5A, 0);
+}
+
+static int
+bench_i2c_read__(void* cookie)
+{
+    bench_i2c_t* b = (bench_i2c_t*)cookie;
+    return onlp_i2c_read(b->bus, b->addr, 0, sizeof(b->data), b->data, 0);
+}
+
+static int
+bench_i2c_block_read__(void* cookie)
+{
+    bench_i2c_t* b = (bench_i2c_t*)cookie;
+    return onlp_i2c_block_read(b->bus, b->addr, 0, sizeof(b->data), b->data,
+                               ONLP_I2C_F_USE_SMBUS_BLOCK_READ);
+}
+
+static void
+onlp_bench_i2c__(cJSON* results, int bus, int addr, int iterations)
+{
+    bench_i2c_t b;
+
+    if(bus < 0) {
+        onlp_bench_skipped_json__(results, "onlp_i2c",
+                                  "no i2c-stub bus specified (-b)");
+        return;
+    }
+
+    memset(&b, 0, sizeof(b));
+    b.bus = bus;
+    b.addr = addr;
+
+    onlp_bench__(results, "onlp_i2c_readb", bench_i2c_readb__, &b, iterations);
+    onlp_bench__(results, "onlp_i2c_readw", bench_i2c_readw__, &b, iterations);
+    onlp_bench__(results, "onlp_i2c_writeb", bench_i2c_writeb__, &b, iterations);
+    onlp_bench__(results, "onlp_i2c_read[256]", bench_i2c_read__, &b, iterations);
+    onlp_bench__(results, "onlp_i2c_block_read[256]", bench_i2c_block_read__,
+                 &b, iterations);
+}
+
+#else
+
+static void
+onlp_bench_i2c__(cJSON* results, int bus, int addr, int iterations)
+{
+    onlp_bench_skipped_json__(results, "onlp_i2c",
+                              "i2c support not available in this build");
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_I2C */
+
+
+/************************************************************
+ *
+ * SFP EEPROM access
+ *
+ ***********************************************************/
+
+typedef struct bench_ports_s {
+    int ports[256];
+    int count;
+    int next;
+} bench_ports_t;
+
+static int
+bench_sfp_eeprom_read__(void* cookie)
+{
+    bench_ports_t* p = (bench_ports_t*)cookie;
+    uint8_t* data = NULL;
+    int rv = onlp_sfp_eeprom_read(p->ports[p->next], &data);
+    aim_free(data);
+    p->next = (p->next + 1) % p->count;
+    return rv;
+}
+
+static int
+bench_sfp_presence_bitmap_get__(void* cookie)
+{
+    onlp_sfp_bitmap_t bmap;
+    onlp_sfp_bitmap_t_init(&bmap);
+    return onlp_sfp_presence_bitmap_get(&bmap);
+}
+
+static void
+onlp_bench_sfp__(cJSON* results, int iterations)
+{
+    int port;
+    bench_ports_t p;
+    onlp_sfp_bitmap_t bmap;
+
+    memset(&p, 0, sizeof(p));
+    onlp_sfp_bitmap_t_init(&bmap);
+    onlp_sfp_bitmap_get(&bmap);
+
+    if(AIM_BITMAP_COUNT(&bmap) == 0) {
+        onlp_bench_skipped_json__(results, "onlp_sfp", "no SFP ports");
+        return;
+    }
+
+    AIM_BITMAP_ITER(&bmap, port) {
+        if(onlp_sfp_is_present(port) == 1) {
+            p.ports[p.count++] = port;
+        }
+    }
+
+    onlp_bench__(results, "onlp_sfp_presence_bitmap_get",
+                 bench_sfp_presence_bitmap_get__, NULL, iterations);
+
+    if(p.count == 0) {
+        onlp_bench_skipped_json__(results, "onlp_sfp_eeprom_read",
+                                  "no SFPs present");
+        return;
+    }
+    onlp_bench__(results, "onlp_sfp_eeprom_read", bench_sfp_eeprom_read__,
+                 &p, iterations);
+}
+
+
+/************************************************************
+ *
+ * OID iteration and info retrieval.
+ *
+ ***********************************************************/
+
+typedef struct bench_oids_s {
+    onlp_oid_t oids[ONLP_OID_TABLE_SIZE*8];
+    int count;
+    int next;
+} bench_oids_t;
+
+static int
+bench_oid_noop__(onlp_oid_t oid, void* cookie)
+{
+    return 0;
+}
+
+static int
+bench_oid_collect__(onlp_oid_t oid, void* cookie)
+{
+    bench_oids_t* o = (bench_oids_t*)cookie;
+    if(o->count < AIM_ARRAYSIZE(o->oids)) {
+        o->oids[o->count++] = oid;
+    }
+    return 0;
+}
+
+static int
+bench_oid_iterate__(void* cookie)
+{
+    return onlp_oid_iterate(ONLP_OID_SYS, 0, bench_oid_noop__, NULL);
+}
+
+static int
+bench_sys_info_get__(void* cookie)
+{
+    onlp_sys_info_t si;
+    int rv = onlp_sys_info_get(&si);
+    if(rv >= 0) {
+        onlp_sys_info_free(&si);
+    }
+    return rv;
+}
+
+static onlp_oid_t
+bench_oid_next__(bench_oids_t* o)
+{
+    onlp_oid_t oid = o->oids[o->next];
+    o->next = (o->next + 1) % o->count;
+    return oid;
+}
+
+static int
+bench_thermal_info_get__(void* cookie)
+{
+    onlp_thermal_info_t ti;
+    return onlp_thermal_info_get(bench_oid_next__(cookie), &ti);
+}
+
+static int
+bench_fan_info_get__(void* cookie)
+{
+    onlp_fan_info_t fi;
+    return onlp_fan_info_get(bench_oid_next__(cookie), &fi);
+}
+
+static int
+bench_psu_info_get__(void* cookie)
+{
+    onlp_psu_info_t pi;
+    return onlp_psu_info_get(bench_oid_next__(cookie), &pi);
+}
+
+static int
+bench_led_info_get__(void* cookie)
+{
+    onlp_led_info_t li;
+    return onlp_led_info_get(bench_oid_next__(cookie), &li);
+}
+
+static void
+onlp_bench_info_type__(cJSON* results, const char* name, onlp_oid_type_t type,
+                       onlp_bench_op_f op, int iterations)
+{
+    bench_oids_t o;
+
+    memset(&o, 0, sizeof(o));
+    onlp_oid_iterate(ONLP_OID_SYS, type, bench_oid_collect__, &o);
+    if(o.count == 0) {
+        onlp_bench_skipped_json__(results, name, "no OIDs of this type");
+        return;
+    }
+    onlp_bench__(results, name, op, &o, iterations);
+}
+
+static void
+onlp_bench_oids__(cJSON* results, int iterations)
+{
+    onlp_bench__(results, "onlp_oid_iterate", bench_oid_iterate__,
+                 NULL, iterations);
+    onlp_bench__(results, "onlp_sys_info_get", bench_sys_info_get__,
+                 NULL, iterations);
+    onlp_bench_info_type__(results, "onlp_thermal_info_get",
+                           ONLP_OID_TYPE_THERMAL, bench_thermal_info_get__,
+                           iterations);
+    onlp_bench_info_type__(results, "onlp_fan_info_get",
+                           ONLP_OID_TYPE_FAN, bench_fan_info_get__,
+                           iterations);
+    onlp_bench_info_type__(results, "onlp_psu_info_get",
+                           ONLP_OID_TYPE_PSU, bench_psu_info_get__,
+                           iterations);
+    onlp_bench_info_type__(results, "onlp_led_info_get",
+                           ONLP_OID_TYPE_LED, bench_led_info_get__,
+                           iterations);
+}
+
+
+/************************************************************
+ *
+ * Global shlock contention.
+ *
+ * Each worker process takes and gives the global ONLP lock
+ * in a loop, optionally holding it for a fixed time, and
+ * reports its acquisition latency back to the parent.
+ *
+ ***********************************************************/
+
+typedef struct bench_lock_report_s {
+    uint64_t ops;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t elapsed_ns;
+} bench_lock_report_t;
+
+static void
+bench_lock_worker__(int start_fd, int report_fd, int iterations, int hold_us)
+{
+    int i;
+    char c;
+    bench_lock_report_t r;
+    uint64_t start;
+
+    memset(&r, 0, sizeof(r));
+
+    /* Wait for the start signal (parent closes the pipe). */
+    while(read(start_fd, &c, 1) > 0);
+
+    start = onlp_bench_ns__();
+    for(i = 0; i < iterations; i++) {
+        uint64_t t0 = onlp_bench_ns__();
+        onlp_shlock_global_take();
+        uint64_t dt = onlp_bench_ns__() - t0;
+        if(hold_us) {
+            usleep(hold_us);
+        }
+        onlp_shlock_global_give();
+
+        r.wait_ns += dt;
+        if(dt > r.max_wait_ns) {
+            r.max_wait_ns = dt;
+        }
+        r.ops++;
+    }
+    r.elapsed_ns = onlp_bench_ns__() - start;
+
+    if(write(report_fd, &r, sizeof(r)) != sizeof(r)) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+static void
+onlp_bench_contention__(cJSON* root, int procs, int iterations, int hold_us)
+{
+    int i;
+    int start[2], report[2];
+    pid_t* pids;
+    cJSON* cj;
+    cJSON* workers;
+    uint64_t ops = 0, wait_ns = 0, max_wait_ns = 0, elapsed_ns = 0;
+    int reported = 0;
+
+    if(pipe(start) < 0 || pipe(report) < 0) {
+        AIM_LOG_ERROR("pipe() failed: %{errno}", errno);
+        return;
+    }
+
+    pids = aim_zmalloc(sizeof(*pids)*procs);
+    for(i = 0; i < procs; i++) {
+        pids[i] = fork();
+        if(pids[i] == 0) {
+            close(start[1]);
+            close(report[0]);
+            bench_lock_worker__(start[0], report[1], iterations, hold_us);
+        }
+        if(pids[i] < 0) {
+            AIM_LOG_ERROR("fork() failed: %{errno}", errno);
+            break;
+        }
+    }
+    procs = i;
+
+    /* Release all workers at once. */
+    close(start[0]);
+    close(start[1]);
+    close(report[1]);
+
+    cj = cJSON_CreateObject();
+    workers = cJSON_CreateArray();
+
+    for(i = 0; i < procs; i++) {
+        bench_lock_report_t r;
+        if(read(report[0], &r, sizeof(r)) != sizeof(r)) {
+            break;
+        }
+        cJSON* w = cJSON_CreateObject();
+        cJSON_AddNumberToObject(w, "ops", r.ops);
+        cJSON_AddNumberToObject(w, "wait_ns_per_op", r.ops ? r.wait_ns / (double)r.ops : 0);
+        cJSON_AddNumberToObject(w, "max_wait_ns", r.max_wait_ns);
+        cJSON_AddNumberToObject(w, "elapsed_ns", r.elapsed_ns);
+        cJSON_AddItemToArray(workers, w);
+
+        ops += r.ops;
+        wait_ns += r.wait_ns;
+        if(r.max_wait_ns > max_wait_ns) {
+            max_wait_ns = r.max_wait_ns;
+        }
+        if(r.elapsed_ns > elapsed_ns) {
+            elapsed_ns = r.elapsed_ns;
+        }
+        reported++;
+    }
+    close(report[0]);
+
+    for(i = 0; i < procs; i++) {
+        waitpid(pids[i], NULL, 0);
+    }
+    aim_free(pids);
+
+    cJSON_AddStringToObject(cj, "name", "onlp_shlock_global");
+    cJSON_AddNumberToObject(cj, "processes", reported);
+    cJSON_AddNumberToObject(cj, "hold_us", hold_us);
+    cJSON_AddNumberToObject(cj, "ops", ops);
+    cJSON_AddNumberToObject(cj, "wait_ns_per_op", ops ? wait_ns / (double)ops : 0);
+    cJSON_AddNumberToObject(cj, "max_wait_ns", max_wait_ns);
+    cJSON_AddNumberToObject(cj, "ops_per_sec",
+                            elapsed_ns ? ops * 1e9 / elapsed_ns : 0);
+    cJSON_AddItemToObject(cj, "workers", workers);
+    cJSON_AddItemToObject(root, "contention", cj);
+}
+
+
+/************************************************************
+ *
+ * Main
+ *
+ ***********************************************************/
+
+static void
+onlp_bench_release__(cJSON* root)
+{
+    cJSON* manifest = NULL;
+    if(cjson_util_parse_file(ONLP_BENCH_MANIFEST, &manifest) >= 0 && manifest) {
+        cJSON* version = cJSON_DetachItemFromObject(manifest, "version");
+        if(version) {
+            cJSON_AddItemToObject(root, "release", version);
+        }
+        cJSON_Delete(manifest);
+    }
+}
+
+#define BENCH_F_FILE 0x1
+#define BENCH_F_I2C  0x2
+#define BENCH_F_SFP  0x4
+#define BENCH_F_OID  0x8
+#define BENCH_F_ALL  (BENCH_F_FILE | BENCH_F_I2C | BENCH_F_SFP | BENCH_F_OID)
+
+static aim_map_si_t bench_map__[] = {
+    { "file", BENCH_F_FILE },
+    { "i2c",  BENCH_F_I2C },
+    { "sfp",  BENCH_F_SFP },
+    { "oid",  BENCH_F_OID },
+    { "all",  BENCH_F_ALL },
+    { NULL, 0 }
+};
+
+static int
+onlp_bench_tests__(char* spec, uint32_t* tests)
+{
+    char* saveptr = NULL;
+    char* tok;
+
+    *tests = 0;
+    for(tok = strtok_r(spec, ",", &saveptr); tok;
+        tok = strtok_r(NULL, ",", &saveptr)) {
+        int v;
+        if(aim_map_si_s(&v, tok, bench_map__, 0) == 0) {
+            fprintf(stderr, "Unknown test '%s'\n", tok);
+            return -1;
+        }
+        *tests |= v;
+    }
+    return 0;
+}
+
+int
+onlp_bench_main(int argc, char* argv[])
+{
+    int c;
+    int help = 0;
+    int rv = 0;
+    int iterations = ONLP_BENCH_ITERATIONS_DEFAULT;
+    int bus = -1;
+    int addr = 0x50;
+    int procs = 0;
+    int hold_us = 0;
+    uint32_t tests = BENCH_F_ALL;
+    const char* ofile = NULL;
+
+    while( (c = getopt(argc, argv, "n:t:b:a:P:H:o:h")) != -1) {
+        switch(c)
+            {
+            case 'n': iterations = atoi(optarg); break;
+            case 't': if(onlp_bench_tests__(optarg, &tests) < 0) { help = 1; rv = 1; } break;
+            case 'b': bus = atoi(optarg); break;
+            case 'a': addr = strtol(optarg, NULL, 0); break;
+            case 'P': procs = atoi(optarg); break;
+            case 'H': hold_us = atoi(optarg); break;
+            case 'o': ofile = optarg; break;
+            case 'h': help = 1; rv = 0; break;
+            default: help = 1; rv = 1; break;
+            }
+    }
+
+    if(help || iterations <= 0) {
+        printf("Usage: %s [OPTIONS]\n", argv[0]);
+        printf("  -n <count>   Iterations per benchmark (default %d).\n",
+               ONLP_BENCH_ITERATIONS_DEFAULT);
+        printf("  -t <tests>   Comma separated list of file,i2c,sfp,oid,all (default all).\n");
+        printf("  -b <bus>     I2C bus for the onlp_i2c benchmarks (for example an i2c-stub bus).\n");
+        printf("  -a <addr>    I2C device address on that bus (default 0x50).\n");
+        printf("  -P <procs>   Run the global lock contention benchmark with <procs> processes.\n");
+        printf("  -H <usecs>   Lock hold time for the contention benchmark (default 0).\n");
+        printf("  -o <file>    Write the JSON results to <file> instead of stdout.\n");
+        return rv;
+    }
+
+    onlp_init();
+    onlp_bench_calibrate__();
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON* results = cJSON_CreateArray();
+    const char* platform = onlp_sysi_platform_get();
+
+    cJSON_AddNumberToObject(root, "version", 1);
+    cJSON_AddStringToObject(root, "platform", platform ? platform : "unknown");
+    cJSON_AddNumberToObject(root, "iterations", iterations);
+    onlp_bench_release__(root);
+
+    if(tests & BENCH_F_FILE) {
+        onlp_bench_file__(results, iterations);
+    }
+    if(tests & BENCH_F_I2C) {
+        onlp_bench_i2c__(results, bus, addr, iterations);
+    }
+    if(tests & BENCH_F_SFP) {
+        onlp_bench_sfp__(results, iterations);
+    }
+    if(tests & BENCH_F_OID) {
+        onlp_bench_oids__(results, iterations);
+    }
+    cJSON_AddItemToObject(root, "results", results);
+
+    if(procs > 0) {
+        onlp_bench_contention__(root, procs, iterations, hold_us);
+    }
+
+    char* out = cJSON_Print(root);
+    if(ofile) {
+        FILE* fp = fopen(ofile, "w");
+        if(fp == NULL) {
+            fprintf(stderr, "Could not open '%s': %s\n", ofile, strerror(errno));
+            rv = 1;
+        }
+        else {
+            fprintf(fp, "%s\n", out);
+            fclose(fp);
+        }
+    }
+    else {
+        printf("%s\n", out);
+    }
+    free(out);
+    cJSON_Delete(root);
+    return rv;
+}
@@ -134,6 +134,31 @@ onlp_config_settings_t onlp_config_settings[] =
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_PROFILING), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_PROFILING) },
 #else
 { ONLP_CONFIG_INCLUDE_API_PROFILING(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_LAZY_INIT
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_LAZY_INIT), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_LAZY_INIT) },
+#else
+{ ONLP_CONFIG_INCLUDE_LAZY_INIT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_THERMAL_CONTROL_RATE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_THERMAL_CONTROL_RATE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_THERMAL_CONTROL_RATE) },
+#else
+{ ONLP_CONFIG_THERMAL_CONTROL_RATE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_LED_SHADOW
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_LED_SHADOW), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_LED_SHADOW) },
+#else
+{ ONLP_CONFIG_INCLUDE_LED_SHADOW(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_LED_SHADOW_TIMEOUT
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_LED_SHADOW_TIMEOUT), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_LED_SHADOW_TIMEOUT) },
+#else
+{ ONLP_CONFIG_LED_SHADOW_TIMEOUT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGER_WORKERS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGER_WORKERS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGER_WORKERS) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGER_WORKERS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
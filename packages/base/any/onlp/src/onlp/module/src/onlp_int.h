@@ -29,6 +29,10 @@
 #include <onlp/onlp.h>
 #include <IOF/iof.h>
 #include <onlp/oids.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
 #include <cjson/cJSON.h>
 #include "onlp_json.h"
 
@@ -44,4 +48,54 @@ void onlp_oid_show_description(iof_t* iof, onlp_oid_hdr_t* hdr);
 /** Standard message when an OID is missing. */
 void onlp_oid_show_state_missing(iof_t* iof);
 
+/** Initialization phases recorded in the startup trace. */
+typedef enum onlp_init_phase_e {
+    ONLP_INIT_PHASE_MODULE,
+    ONLP_INIT_PHASE_API_LOCK,
+    ONLP_INIT_PHASE_CONFIG,
+    ONLP_INIT_PHASE_SYS,
+    ONLP_INIT_PHASE_SFP,
+    ONLP_INIT_PHASE_LED,
+    ONLP_INIT_PHASE_PSU,
+    ONLP_INIT_PHASE_FAN,
+    ONLP_INIT_PHASE_THERMAL,
+    ONLP_INIT_PHASE_COUNT,
+} onlp_init_phase_t;
+
+/**
+ * Run the given subsystem initializer once.
+ * The result of the first invocation is returned on subsequent calls.
+ * 'api' names the caller which triggered the initialization.
+ */
+int onlp_init_once(onlp_init_phase_t phase, int (*init)(void), const char* api);
+
+/** Allow the given phase to be initialized again. */
+void onlp_init_reset(onlp_init_phase_t phase);
+
+/**
+ * Implementations behind the public APIs, for callers which
+ * already hold the API lock.
+ */
+int onlp_sys_hdr_get_locked__(onlp_oid_hdr_t* hdr);
+
+int onlp_thermal_init_locked__(void);
+int onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info);
+int onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr);
+int onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status);
+
+int onlp_fan_init_locked__(void);
+int onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip);
+int onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr);
+int onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status);
+
+int onlp_psu_init_locked__(void);
+int onlp_psu_info_get_locked__(onlp_oid_t id, onlp_psu_info_t* info);
+int onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr);
+int onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status);
+
+int onlp_led_init_locked__(void);
+int onlp_led_info_get_locked__(onlp_oid_t id, onlp_led_info_t* info);
+int onlp_led_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr);
+int onlp_led_status_get_locked__(onlp_oid_t id, uint32_t* status);
+
 #endif /* __ONLP_INT_H__ */
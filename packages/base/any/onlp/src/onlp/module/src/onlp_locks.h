@@ -93,12 +93,25 @@ void onlp_api_unlock(void);
 
 #endif
 
+/**
+ * Subsystems which support lazy initialization define
+ * ONLP_LOCKED_API_INIT_HOOK(_api) before including this file.
+ * The hook is invoked with the API lock held, before the locked
+ * implementation is called.
+ */
+#if ONLP_CONFIG_INCLUDE_LAZY_INIT == 1 && defined(ONLP_LOCKED_API_INIT_HOOK)
+#define ONLP_API_INIT(_name) ONLP_LOCKED_API_INIT_HOOK(#_name)
+#else
+#define ONLP_API_INIT(_name)
+#endif
+
 #define ONLP_LOCKED_API0(_name)                            \
     int _name (void)                                       \
     {                                                      \
         ONLP_API_T0(_name);                                \
         ONLP_API_LOCK(#_name);                             \
         ONLP_API_T1(_name);                                \
+        ONLP_API_INIT(_name);                              \
         int _rv = ONLP_LOCKED_API_NAME(_name)();           \
         ONLP_API_UNLOCK();                                 \
         ONLP_API_T2(_name);                                \
@@ -111,6 +124,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                     \
         ONLP_API_LOCK(#_name);                                  \
         ONLP_API_T1(_name);                                     \
+        ONLP_API_INIT(_name);                                   \
         int _rv = ONLP_LOCKED_API_NAME(_name)(_v);              \
         ONLP_API_UNLOCK();                                      \
         ONLP_API_T2(_name);                                     \
@@ -123,6 +137,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2);               \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -135,6 +150,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);          \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -147,6 +163,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);     \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -159,6 +176,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5); \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -171,6 +189,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                      \
         ONLP_API_LOCK(#_name);                                   \
         ONLP_API_T1(_name);                                      \
+        ONLP_API_INIT(_name);                                    \
         ONLP_LOCKED_API_NAME(_name)();                           \
         ONLP_API_UNLOCK();                                       \
         ONLP_API_T2(_name);                                      \
@@ -182,6 +201,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                               \
         ONLP_API_LOCK(#_name);                            \
         ONLP_API_T1(_name);                               \
+        ONLP_API_INIT(_name);                             \
         ONLP_LOCKED_API_NAME(_name)(_v);                  \
         ONLP_API_UNLOCK();                                \
         ONLP_API_T2(_name);                               \
@@ -193,6 +213,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                       \
         ONLP_API_LOCK(#_name);                                    \
         ONLP_API_T1(_name);                                       \
+        ONLP_API_INIT(_name);                                     \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2);                   \
         ONLP_API_UNLOCK();                                        \
         ONLP_API_T2(_name);                                       \
@@ -204,6 +225,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);                    \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(name);                                              \
@@ -215,6 +237,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);               \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -226,6 +249,7 @@ void onlp_api_unlock(void);
         ONLP_API_T0(_name);                                             \
         ONLP_API_LOCK(#_name);                                          \
         ONLP_API_T1(_name);                                             \
+        ONLP_API_INIT(_name);                                           \
         ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);          \
         ONLP_API_UNLOCK();                                              \
         ONLP_API_T2(_name);                                             \
@@ -160,6 +160,12 @@ iterate_oids__(void)
                      iterate_oids_callback__, NULL);
 }
 
+static void
+init_trace_show__(void)
+{
+    onlp_init_trace_show(&aim_pvs_stdout);
+}
+
 
 
 
@@ -181,6 +187,7 @@ onlpdump_main(int argc, char* argv[])
     int l = 0;
     int M = 0;
     int b = 0;
+    int T = 0;
     char* pidfile = NULL;
     const char* O = NULL;
     const char* t = NULL;
@@ -199,7 +206,7 @@ onlpdump_main(int argc, char* argv[])
         }
     }
 
-    while( (c = getopt(argc, argv, "srehdojmyM:ipxlSt:O:bJ:")) != -1) {
+    while( (c = getopt(argc, argv, "srehdojmyM:ipxlSt:O:bJ:T")) != -1) {
         switch(c)
             {
             case 's': show=1; break;
@@ -220,6 +227,7 @@ onlpdump_main(int argc, char* argv[])
             case 'l': l=1; break;
             case 'b': b=1; break;
             case 'J': J = optarg; break;
+            case 'T': T=1; break;
             case 'y': show=1; showflags |= ONLP_OID_SHOW_YAML; break;
             default: help=1; rv = 1; break;
             }
@@ -245,6 +253,7 @@ onlpdump_main(int argc, char* argv[])
         printf("  -b   Decode SFP Inventory into SFF database entries.\n");
         printf("  -l   API Lock test.\n");
         printf("  -J   Decode ONIE JSON data.\n");
+        printf("  -T   Show initialization timings on exit.\n");
         return rv;
     }
 
@@ -280,6 +289,10 @@ onlpdump_main(int argc, char* argv[])
 
     onlp_init();
 
+    if(T) {
+        atexit(init_trace_show__);
+    }
+
     if(M) {
         platform_manager_daemon__(pidfile, argv);
         exit(0);
@@ -317,31 +330,31 @@ onlpdump_main(int argc, char* argv[])
     }
 
     if(o || x) {
-        onlp_sys_info_t si;
-        if(onlp_sys_info_get(&si) < 0) {
-            fprintf(stderr, "onlp_sys_info_get() failed.");
+        const onlp_sys_info_t* si;
+        if(onlp_sys_info_cache_get(&si) < 0) {
+            fprintf(stderr, "onlp_sys_info_cache_get() failed.");
             return 1;
         }
 
         if(o) {
             if(j) {
-                onlp_onie_show_json(&si.onie_info, &aim_pvs_stdout);
+                onlp_onie_show_json((onlp_onie_info_t*)&si->onie_info, &aim_pvs_stdout);
             }
             else {
-                onlp_onie_show(&si.onie_info, &aim_pvs_stdout);
+                onlp_onie_show((onlp_onie_info_t*)&si->onie_info, &aim_pvs_stdout);
             }
         }
 
         if(x) {
             if(j) {
-                onlp_platform_info_show_json(&si.platform_info, &aim_pvs_stdout);
+                onlp_platform_info_show_json((onlp_platform_info_t*)&si->platform_info, &aim_pvs_stdout);
             }
             else {
-                onlp_platform_info_show(&si.platform_info, &aim_pvs_stdout);
+                onlp_platform_info_show((onlp_platform_info_t*)&si->platform_info, &aim_pvs_stdout);
             }
         }
 
-        onlp_sys_info_free(&si);
+        onlp_sys_info_cache_put(si);
         return 0;
     }
 
@@ -364,6 +377,7 @@ onlpdump_main(int argc, char* argv[])
         sleep(600);
         printf("Stopping the platform manager.\n");
         onlp_sys_platform_manage_stop(1);
+        onlp_sys_platform_manage_show(&aim_pvs_stdout);
     }
 
     if(p) {
@@ -25,6 +25,9 @@
 #include <onlp/sys.h>
 #include <onlp/psu.h>
 #include <onlp/fan.h>
+#include <onlp/thermal.h>
+#include <onlp/led.h>
+#include <onlp/thermal_control.h>
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <timer_wheel/timer_wheel.h>
@@ -36,6 +39,17 @@
 #include <sys/eventfd.h>
 #include <errno.h>
 #include <pthread.h>
+#include <inttypes.h>
+
+/**
+ * Where a management callback runs.
+ */
+typedef enum management_exec_e {
+    /** On the platform manager thread. */
+    MANAGEMENT_EXEC_INLINE,
+    /** On a worker thread, so it cannot delay the other callbacks. */
+    MANAGEMENT_EXEC_WORKER,
+} management_exec_t;
 
 /**
  * Timer wheel callback entry.
@@ -53,11 +67,39 @@ typedef struct management_entry_s {
     /** The name of this callback (for debugging) */
     const char* name;
 
+    /** Where this callback runs */
+    management_exec_t exec;
+
+    /**
+     * Soft deadline in microseconds.
+     * Calls which take longer are logged and counted as overruns.
+     */
+    uint64_t deadline;
+
     /** The number of times this has been called. */
     int calls;
 
+    /** Nonzero while queued or running. A due callback is skipped. */
+    int running;
+    /** When the current call was started */
+    uint64_t started;
+    /** The current call has already been counted as an overrun */
+    int overrun;
+
+    /** Counters */
+    int skips;
+    int overruns;
+    int errors;
+
+    /** Call timing in microseconds */
+    uint64_t last_duration;
+    uint64_t max_duration;
+    uint64_t total_duration;
+
 } management_entry_t;
 
+#define MANAGEMENT_QUEUE_SIZE 16
+
 /**
  * Platform management control structure.
  */
@@ -67,10 +109,35 @@ typedef struct management_ctrl_s {
     int eventfd;
     pthread_t thread;
 
+    /** Protects the timer wheel, the entries, and the worker queue. */
+    pthread_mutex_t lock;
+
+    /**
+     * Serializes the worker callbacks. The platform management
+     * interfaces are not reentrant.
+     */
+    pthread_mutex_t manage_lock;
+
+    /** Worker pool */
+    pthread_cond_t cond;
+    int workers;
+    int stop;
+    pthread_t worker_threads[ONLP_CONFIG_PLATFORM_MANAGER_WORKERS + 1];
+
+    /** Entries waiting for a worker. Each entry is queued at most once. */
+    management_entry_t* queue[MANAGEMENT_QUEUE_SIZE];
+    int queue_head;
+    int queue_count;
+
 } management_ctrl_t;
 
 /* This is the global control state */
-static management_ctrl_t control__ = { NULL };
+static management_ctrl_t control__ = {
+    NULL,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .manage_lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
 
 
 /*
@@ -88,11 +155,23 @@ static int platform_fans_notify__(void);
 
 
 
+/*
+ * Runs the platform's thermal control policy in place
+ * of onlp_sysi_platform_manage_fans().
+ */
+static int platform_thermal_control__(void);
+
+
 /*
  * First Version : Static callback rates.
  * TODO: Allow individual platform callbacks to reregister
  * themselves at whatever rate they want.
+ *
+ * The fan and LED policies call into the platform and may block
+ * on slow devices, so they run on workers, one at a time. The PSU
+ * and fan status notifications stay on the platform manager thread.
  */
+#define MANAGEMENT_ENTRY_FANS 0
 static management_entry_t management_entries[] =
     {
         {
@@ -101,6 +180,8 @@ static management_entry_t management_entries[] =
             /* Every 10 seconds */
             10*1000*1000,
             "Fans",
+            MANAGEMENT_EXEC_WORKER,
+            5*1000*1000,
         },
         {
             { },
@@ -108,7 +189,8 @@ static management_entry_t management_entries[] =
             /* Every 2 seconds */
             2*1000*1000,
             "LEDs",
-
+            MANAGEMENT_EXEC_WORKER,
+            1*1000*1000,
         },
         {
             { },
@@ -116,6 +198,8 @@ static management_entry_t management_entries[] =
             /* Every second */
             1*1000*1000,
             "PSUs",
+            MANAGEMENT_EXEC_INLINE,
+            500*1000,
         },
         {
             { },
@@ -123,6 +207,8 @@ static management_entry_t management_entries[] =
             /* Every second */
             1*1000*1000,
             "Fans",
+            MANAGEMENT_EXEC_INLINE,
+            500*1000,
         }
     };
 
@@ -134,32 +220,230 @@ onlp_sys_platform_manage_init(void)
         int i;
         uint64_t now = os_time_monotonic();
 
+        /*
+         * The platform management callbacks are called directly,
+         * so the subsystems they drive must be initialized first.
+         */
+        onlp_thermal_init();
+        onlp_fan_init();
+        onlp_psu_init();
+        onlp_led_init();
+
         onlp_sysi_platform_manage_init();
+
+        if(onlp_thermal_control_init() >= 0) {
+            onlp_thermal_control_status_t st;
+            management_entry_t* e = management_entries + MANAGEMENT_ENTRY_FANS;
+            onlp_thermal_control_status_get(&st);
+            e->manage = platform_thermal_control__;
+            e->rate = st.rate;
+            e->name = "Thermal Control";
+        }
+
         control__.tw = timer_wheel_create(4, 512, now);
 
         for(i = 0; i < AIM_ARRAYSIZE(management_entries); i++) {
             management_entry_t* e = management_entries+i;
+            if(e->deadline == 0) {
+                e->deadline = e->rate;
+            }
             timer_wheel_insert(control__.tw,  &e->twe, now + e->rate);
         }
     }
 }
 
 
+/*
+ * Record a completed call. Called with the lock held.
+ */
+static void
+management_entry_done__(management_entry_t* e, int rv, uint64_t duration)
+{
+    e->calls++;
+    e->running = 0;
+    if(rv < 0) {
+        e->errors++;
+    }
+
+    e->last_duration = duration;
+    e->total_duration += duration;
+    if(duration > e->max_duration) {
+        e->max_duration = duration;
+    }
+
+    if(duration > e->deadline && !e->overrun) {
+        e->overruns++;
+        AIM_LOG_WARN("%s: took %" PRIu64 " ms (deadline %" PRIu64 " ms).",
+                     e->name, duration / 1000, e->deadline / 1000);
+    }
+}
+
+/*
+ * Run a callback. Called without the lock.
+ */
+static void
+management_entry_run__(management_entry_t* e)
+{
+    int rv = 0;
+    uint64_t start = os_time_monotonic();
+
+    if(e->manage) {
+        if(e->exec == MANAGEMENT_EXEC_WORKER) {
+            pthread_mutex_lock(&control__.manage_lock);
+            rv = e->manage();
+            pthread_mutex_unlock(&control__.manage_lock);
+        }
+        else {
+            rv = e->manage();
+        }
+    }
+
+    pthread_mutex_lock(&control__.lock);
+    management_entry_done__(e, rv, os_time_monotonic() - start);
+    pthread_mutex_unlock(&control__.lock);
+}
+
+static void*
+management_worker__(void* arg)
+{
+    char name[16];
+
+    snprintf(name, sizeof(name), "onlp.sys.pm.w%d", (int)(intptr_t)arg);
+    os_thread_name_set(name);
+
+    pthread_mutex_lock(&control__.lock);
+    for(;;) {
+        management_entry_t* e;
+
+        while(control__.queue_count == 0 && !control__.stop) {
+            pthread_cond_wait(&control__.cond, &control__.lock);
+        }
+        if(control__.queue_count == 0) {
+            break;
+        }
+
+        e = control__.queue[control__.queue_head];
+        control__.queue_head = (control__.queue_head + 1) % MANAGEMENT_QUEUE_SIZE;
+        control__.queue_count--;
+
+        pthread_mutex_unlock(&control__.lock);
+        management_entry_run__(e);
+        pthread_mutex_lock(&control__.lock);
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return NULL;
+}
+
+static void
+management_workers_start__(void)
+{
+    int i;
+
+    control__.stop = 0;
+    for(i = 0; i < ONLP_CONFIG_PLATFORM_MANAGER_WORKERS; i++) {
+        if(pthread_create(control__.worker_threads + i, NULL,
+                          management_worker__, (void*)(intptr_t)i) != 0) {
+            AIM_LOG_ERROR("worker pthread create failed.");
+            break;
+        }
+    }
+    pthread_mutex_lock(&control__.lock);
+    control__.workers = i;
+    pthread_mutex_unlock(&control__.lock);
+}
+
+static void
+management_workers_stop__(void)
+{
+    int i, workers;
+
+    pthread_mutex_lock(&control__.lock);
+    workers = control__.workers;
+    control__.workers = 0;
+    control__.stop = 1;
+    pthread_cond_broadcast(&control__.cond);
+    pthread_mutex_unlock(&control__.lock);
+
+    /* Waits for any callbacks still running. */
+    for(i = 0; i < workers; i++) {
+        pthread_join(control__.worker_threads[i], NULL);
+    }
+}
+
+
 void
 onlp_sys_platform_manage_now(void)
 {
     management_entry_t* e;
+    uint64_t now;
 
     onlp_sys_platform_manage_init();
 
+    pthread_mutex_lock(&control__.lock);
     while( (e = (management_entry_t*) timer_wheel_next(control__.tw,
-                                                       os_time_monotonic())) ) {
-        if(e->manage) {
-            e->manage();
+                                                       (now = os_time_monotonic()))) ) {
+        if(e->running) {
+            /* Still running from a previous period. */
+            e->skips++;
+            if(!e->overrun && now - e->started > e->deadline) {
+                e->overrun = 1;
+                e->overruns++;
+                AIM_LOG_WARN("%s: still running after %" PRIu64 " ms (deadline %" PRIu64 " ms).",
+                             e->name, (now - e->started) / 1000, e->deadline / 1000);
+            }
+        }
+        else {
+            e->running = 1;
+            e->started = now;
+            e->overrun = 0;
+
+            if(e->exec == MANAGEMENT_EXEC_WORKER && control__.workers > 0 &&
+               control__.queue_count < MANAGEMENT_QUEUE_SIZE) {
+                int tail = (control__.queue_head + control__.queue_count) %
+                    MANAGEMENT_QUEUE_SIZE;
+                control__.queue[tail] = e;
+                control__.queue_count++;
+                pthread_cond_signal(&control__.cond);
+            }
+            else {
+                pthread_mutex_unlock(&control__.lock);
+                management_entry_run__(e);
+                pthread_mutex_lock(&control__.lock);
+                now = os_time_monotonic();
+            }
         }
-        e->calls++;
-        timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
+        timer_wheel_insert(control__.tw, &e->twe, now + e->rate);
     }
+    pthread_mutex_unlock(&control__.lock);
+}
+
+void
+onlp_sys_platform_manage_show(aim_pvs_t* pvs)
+{
+    int i;
+
+    onlp_sys_platform_manage_init();
+
+    pthread_mutex_lock(&control__.lock);
+    aim_printf(pvs, "Workers: %d\n", control__.workers);
+    aim_printf(pvs, "%-16s %-6s %8s %8s %8s %6s %6s %6s %8s %8s %8s\n",
+               "Name", "Exec", "Rate", "Deadline", "Calls", "Skips", "Over", "Errors",
+               "Last", "Max", "Avg");
+    for(i = 0; i < AIM_ARRAYSIZE(management_entries); i++) {
+        management_entry_t* e = management_entries + i;
+        aim_printf(pvs, "%-16s %-6s %8" PRIu64 " %8" PRIu64 " %8d %6d %6d %6d %8" PRIu64 " %8" PRIu64 " %8" PRIu64 "%s\n",
+                   e->name,
+                   e->exec == MANAGEMENT_EXEC_WORKER ? "worker" : "inline",
+                   e->rate / 1000, e->deadline / 1000,
+                   e->calls, e->skips, e->overruns, e->errors,
+                   e->last_duration / 1000, e->max_duration / 1000,
+                   e->calls ? e->total_duration / e->calls / 1000 : 0,
+                   e->running ? " (running)" : "");
+    }
+    aim_printf(pvs, "(times in ms)\n");
+    pthread_mutex_unlock(&control__.lock);
+
+    onlp_thermal_control_show(pvs);
 }
 
 static void*
@@ -251,6 +535,8 @@ onlp_sys_platform_manage_start(int block)
         return -1;
     }
 
+    management_workers_start__();
+
     if(block) {
         onlp_sys_platform_manage_join();
     }
@@ -281,44 +567,59 @@ onlp_sys_platform_manage_join(void)
         pthread_join(control__.thread, NULL);
         close(control__.eventfd);
         control__.eventfd = -1;
+        management_workers_stop__();
     }
     return 0;
 }
 
 
+static int
+platform_thermal_control__(void)
+{
+    onlp_thermal_control_status_t st;
+    int rv = onlp_thermal_control_run();
+
+    /* Pick up any rate change for the next insertion. */
+    if(onlp_thermal_control_status_get(&st) >= 0 && st.rate) {
+        pthread_mutex_lock(&control__.lock);
+        management_entries[MANAGEMENT_ENTRY_FANS].rate = st.rate;
+        pthread_mutex_unlock(&control__.lock);
+    }
+    return rv;
+}
+
 static int
 platform_psus_notify__(void)
 {
     static onlp_oid_t psu_oid_table[ONLP_OID_TABLE_SIZE] = {0};
-    static onlp_psu_info_t psu_info_table[ONLP_OID_TABLE_SIZE];
+    static uint32_t psu_status_table[ONLP_OID_TABLE_SIZE];
+    static int psu_count = 0;
+    uint32_t statuses[ONLP_OID_TABLE_SIZE];
     int i = 0;
     static int flag[ONLP_OID_TABLE_SIZE] = {0};
 
     if(psu_oid_table[0] == 0) {
         /* We haven't retreived the system PSU oids yet. */
-        onlp_sys_info_t si;
+        onlp_oid_hdr_t hdr;
         onlp_oid_t* oidp;
 
-        if(onlp_sys_info_get(&si) < 0) {
-            AIM_LOG_ERROR("onlp_sys_info_get() failed.");
+        if(onlp_sys_hdr_get(&hdr) < 0) {
+            AIM_LOG_ERROR("onlp_sys_hdr_get() failed.");
             return -1;
         }
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, PSU) {
+        ONLP_OID_TABLE_ITER_TYPE(hdr.coids, oidp, PSU) {
             psu_oid_table[i++] = *oidp;
         }
-        /* free allocated memory */
-        onlp_sys_info_free(&si);
+        psu_count = i;
     }
 
-    for(i = 0; i < AIM_ARRAYSIZE(psu_oid_table); i++) {
-        onlp_psu_info_t pi;
-        int pid = ONLP_OID_ID_GET(psu_oid_table[i]);
+    /* Presence and failure only, not the full PSU information. */
+    onlp_oid_status_get_multi(psu_oid_table, psu_count, statuses);
 
-        if(psu_oid_table[i] == 0) {
-            break;
-        }
+    for(i = 0; i < psu_count; i++) {
+        int pid = ONLP_OID_ID_GET(psu_oid_table[i]);
 
-        if(onlp_psu_info_get(psu_oid_table[i], &pi) < 0) {
+        if(statuses[i] & ONLP_OID_STATUS_FLAG_UNAVAILABLE) {
             AIM_LOG_ERROR("Failure retreiving status of PSU ID %d",
                           pid);
             continue;
@@ -326,17 +627,17 @@ platform_psus_notify__(void)
 
         /* report initial failed state */
         if ( !flag[i] ) {
-            if ( !(pi.status & 0x1) ) {
+            if ( !(statuses[i] & 0x1) ) {
                 AIM_SYSLOG_WARN("PSU <id> is not present.",
                                 "The given PSU is not present.",
                                 "PSU %d is not present.", pid);
             }
-            if ( pi.status & ONLP_PSU_STATUS_FAILED ) {
+            if ( statuses[i] & ONLP_PSU_STATUS_FAILED ) {
                 AIM_SYSLOG_CRIT("PSU <id> has failed.",
                                 "The given PSU has failed.",
                                 "PSU %d has failed.", pid);
             }
-            if ((pi.status & 0x01) && !(pi.status & ONLP_PSU_STATUS_FAILED) && (pi.status & ONLP_PSU_STATUS_UNPLUGGED)) {
+            if ((statuses[i] & 0x01) && !(statuses[i] & ONLP_PSU_STATUS_FAILED) && (statuses[i] & ONLP_PSU_STATUS_UNPLUGGED)) {
                 AIM_SYSLOG_WARN("PSU <id> power cord not plugged.",
                                 "The given PSU does not have power cord plugged.",
                                 "PSU %d power cord not plugged.", pid);
@@ -347,9 +648,9 @@ platform_psus_notify__(void)
         /*
          * Log any presences or failure transitions.
          */
-        if(pi.status != psu_info_table[i].status) {
-            uint32_t new = pi.status;
-            uint32_t old = psu_info_table[i].status;
+        if(statuses[i] != psu_status_table[i]) {
+            uint32_t new = statuses[i];
+            uint32_t old = psu_status_table[i];
 
             if( !(old & 0x1) && (new & 0x1) ) {
                 /* PSU Inserted */
@@ -393,7 +694,7 @@ platform_psus_notify__(void)
                 }
             }
 
-            memcpy(psu_info_table+i, &pi, sizeof(pi));
+            psu_status_table[i] = statuses[i];
         }
     }
     return 0;
@@ -403,35 +704,34 @@ static int
 platform_fans_notify__(void)
 {
     static onlp_oid_t fan_oid_table[ONLP_OID_TABLE_SIZE] = {0};
-    static onlp_fan_info_t fan_info_table[ONLP_OID_TABLE_SIZE];
+    static uint32_t fan_status_table[ONLP_OID_TABLE_SIZE];
+    static int fan_count = 0;
+    uint32_t statuses[ONLP_OID_TABLE_SIZE];
     int i = 0;
     static int flag[ONLP_OID_TABLE_SIZE] = {0};
 
     if(fan_oid_table[0] == 0) {
         /* We haven't retreived the system FAN oids yet. */
-        onlp_sys_info_t si;
+        onlp_oid_hdr_t hdr;
         onlp_oid_t* oidp;
 
-        if(onlp_sys_info_get(&si) < 0) {
-            AIM_LOG_ERROR("onlp_sys_info_get() failed.");
+        if(onlp_sys_hdr_get(&hdr) < 0) {
+            AIM_LOG_ERROR("onlp_sys_hdr_get() failed.");
             return -1;
         }
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, FAN) {
+        ONLP_OID_TABLE_ITER_TYPE(hdr.coids, oidp, FAN) {
             fan_oid_table[i++] = *oidp;
         }
-        /* free allocated memory */
-        onlp_sys_info_free(&si);
+        fan_count = i;
     }
 
-    for(i = 0; i < AIM_ARRAYSIZE(fan_oid_table); i++) {
-        onlp_fan_info_t fi;
-        int fid = ONLP_OID_ID_GET(fan_oid_table[i]);
+    /* Presence and failure only, not the full FAN information. */
+    onlp_oid_status_get_multi(fan_oid_table, fan_count, statuses);
 
-        if(fan_oid_table[i] == 0) {
-            break;
-        }
+    for(i = 0; i < fan_count; i++) {
+        int fid = ONLP_OID_ID_GET(fan_oid_table[i]);
 
-        if(onlp_fan_info_get(fan_oid_table[i], &fi) < 0) {
+        if(statuses[i] & ONLP_OID_STATUS_FLAG_UNAVAILABLE) {
             AIM_LOG_ERROR("Failure retreiving status of FAN ID %d",
                           fid);
             continue;
@@ -439,12 +739,12 @@ platform_fans_notify__(void)
 
         /* report initial failed state */
         if ( !flag[i] ) {
-            if ( !(fi.status & 0x1) ) {
+            if ( !(statuses[i] & 0x1) ) {
                     AIM_SYSLOG_WARN("Fan <id> is not present.",
                                 "The given Fan is not present.",
                                 "Fan %d is not present.", fid);
             }
-            if ( fi.status & ONLP_FAN_STATUS_FAILED ) {
+            if ( statuses[i] & ONLP_FAN_STATUS_FAILED ) {
                     AIM_SYSLOG_CRIT("Fan <id> has failed.",
                                 "The given fan has failed.",
                                 "Fan %d has failed.", fid);
@@ -455,9 +755,9 @@ platform_fans_notify__(void)
         /*
          * Log any presences or failure transitions.
          */
-        if(fi.status != fan_info_table[i].status) {
-            uint32_t new = fi.status;
-            uint32_t old = fan_info_table[i].status;
+        if(statuses[i] != fan_status_table[i]) {
+            uint32_t new = statuses[i];
+            uint32_t old = fan_status_table[i];
 
             if( !(old & 0x1) && (new & 0x1) ) {
                 /* FAN Inserted */
@@ -484,7 +784,7 @@ platform_fans_notify__(void)
                                 "Fan %d has failed.", fid);
             }
 
-            memcpy(fan_info_table+i, &fi, sizeof(fi));
+            fan_status_table[i] = statuses[i];
         }
     }
     return 0;
@@ -28,6 +28,10 @@
 #include <onlp/psu.h>
 #include <onlp/platformi/psui.h>
 #include "onlp_int.h"
+
+/* Initialize the PSU subsystem on first use. */
+#define ONLP_LOCKED_API_INIT_HOOK(_api)                                 \
+    onlp_init_once(ONLP_INIT_PHASE_PSU, onlp_psu_init__, _api)
 #include "onlp_locks.h"
 
 #define VALIDATE(_id)                           \
@@ -46,13 +50,19 @@
 
 
 static int
-onlp_psu_init_locked__(void)
+onlp_psu_init__(void)
 {
     return onlp_psui_init();
 }
+
+int
+onlp_psu_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_PSU, onlp_psu_init__, "onlp_psu_init");
+}
 ONLP_LOCKED_API0(onlp_psu_init);
 
-static int
+int
 onlp_psu_info_get_locked__(onlp_oid_t id,  onlp_psu_info_t* info)
 {
     VALIDATE(id);
@@ -60,7 +70,7 @@ onlp_psu_info_get_locked__(onlp_oid_t id,  onlp_psu_info_t* info)
 }
 ONLP_LOCKED_API2(onlp_psu_info_get, onlp_oid_t, id, onlp_psu_info_t*, info);
 
-static int
+int
 onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
 {
     int rv = onlp_psui_status_get(id, status);
@@ -76,7 +86,7 @@ onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
 }
 ONLP_LOCKED_API2(onlp_psu_status_get, onlp_oid_t, id, uint32_t*, status);
 
-static int
+int
 onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
 {
     int rv = onlp_psui_hdr_get(id, hdr);
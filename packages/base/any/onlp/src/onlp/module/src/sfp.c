@@ -24,7 +24,12 @@
  ***********************************************************/
 #include <onlp/sfp.h>
 #include <onlp/platformi/sfpi.h>
+#include "onlp_int.h"
 #include "onlp_log.h"
+
+/* Initialize the SFP subsystem on first use. */
+#define ONLP_LOCKED_API_INIT_HOOK(_api)                                 \
+    onlp_init_once(ONLP_INIT_PHASE_SFP, onlp_sfp_init__, _api)
 #include "onlp_locks.h"
 
 /**
@@ -40,7 +45,7 @@ onlp_sfp_bitmap_t_init(onlp_sfp_bitmap_t* bmap)
 }
 
 static int
-onlp_sfp_init_locked__(void)
+onlp_sfp_init__(void)
 {
     onlp_sfp_bitmap_t_init(&sfpi_bitmap__);
 
@@ -67,6 +72,12 @@ onlp_sfp_init_locked__(void)
         return ONLP_STATUS_OK;
     }
 }
+
+static int
+onlp_sfp_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_SFP, onlp_sfp_init__, "onlp_sfp_init");
+}
 ONLP_LOCKED_API0(onlp_sfp_init)
 
 
@@ -83,7 +94,9 @@ ONLP_LOCKED_API1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
 static int
 onlp_sfp_denit_locked__(void)
 {
-    return onlp_sfpi_denit();
+    int rv = onlp_sfpi_denit();
+    onlp_init_reset(ONLP_INIT_PHASE_SFP);
+    return rv;
 }
 ONLP_LOCKED_API0(onlp_sfp_denit);
 
@@ -440,6 +453,33 @@ onlp_sfp_dev_read_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* rda
 }
 ONLP_LOCKED_API5(onlp_sfp_dev_read, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, rdata, int, size);
 
+int
+onlp_sfp_dev_page_read_locked__(int port, uint8_t devaddr, uint8_t page, uint8_t* rdata)
+{
+    int rv, i;
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+
+    if(rdata == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if((rv = onlp_sfpi_dev_writeb(port, devaddr, 127, page)) < 0) {
+        return rv;
+    }
+    rv = onlp_sfpi_dev_read(port, devaddr, 128, rdata, 128);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        for(i = 0; i < 128; i++) {
+            if((rv = onlp_sfpi_dev_readb(port, devaddr, 128 + i)) < 0) {
+                break;
+            }
+            rdata[i] = rv;
+        }
+    }
+    /* Drivers expect the module to be left on page 0. */
+    onlp_sfpi_dev_writeb(port, devaddr, 127, 0);
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+ONLP_LOCKED_API4(onlp_sfp_dev_page_read, int, port, uint8_t, devaddr, uint8_t, page, uint8_t*, rdata);
+
 int
 onlp_sfp_dev_write_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
 {
@@ -0,0 +1,221 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Bulk OID Snapshots.
+ *
+ ************************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/snapshot.h>
+#include <onlp/sys.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include "onlp_int.h"
+#include "onlp_log.h"
+
+#if ONLP_CONFIG_INCLUDE_LAZY_INIT == 1
+/* A snapshot touches every subsystem, initialize them all on first use. */
+static void
+onlp_snapshot_init__(void)
+{
+    onlp_thermal_init_locked__();
+    onlp_fan_init_locked__();
+    onlp_psu_init_locked__();
+    onlp_led_init_locked__();
+}
+#define ONLP_LOCKED_API_INIT_HOOK(_api) onlp_snapshot_init__()
+#endif
+#include "onlp_locks.h"
+
+typedef struct onlp_snapshot_ctx_s {
+    uint32_t types;
+    onlp_snapshot_entry_t* entries;
+    int size;
+    int count;
+} onlp_snapshot_ctx_t;
+
+#define SNAPSHOT_WANTED(_ctx, _oid)                                     \
+    ( (_ctx)->types == 0 ||                                             \
+      ((_ctx)->types & ONLP_SNAPSHOT_TYPE(ONLP_OID_TYPE_GET(_oid))) )
+
+static int
+snapshot_hdr_get__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
+{
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+        case ONLP_OID_TYPE_SYS: return onlp_sys_hdr_get_locked__(hdr);
+        case ONLP_OID_TYPE_THERMAL: return onlp_thermal_hdr_get_locked__(oid, hdr);
+        case ONLP_OID_TYPE_FAN: return onlp_fan_hdr_get_locked__(oid, hdr);
+        case ONLP_OID_TYPE_PSU: return onlp_psu_hdr_get_locked__(oid, hdr);
+        case ONLP_OID_TYPE_LED: return onlp_led_hdr_get_locked__(oid, hdr);
+        default: return ONLP_STATUS_E_UNSUPPORTED;
+        }
+}
+
+/*
+ * Fill the record for the given OID and return its header
+ * for the walk into its children.
+ */
+static int
+snapshot_entry_get__(onlp_oid_t oid, onlp_snapshot_entry_t* e, onlp_oid_hdr_t* hdr)
+{
+    int rv;
+
+    memset(e, 0, sizeof(*e));
+    e->oid = oid;
+
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+        case ONLP_OID_TYPE_THERMAL:
+            {
+                onlp_thermal_info_t ti;
+                rv = onlp_thermal_info_get_locked__(oid, &ti);
+                if(ONLP_SUCCESS(rv)) {
+                    *hdr = ti.hdr;
+                    e->status = ti.status;
+                    e->caps = ti.caps;
+                    e->u.thermal.mcelsius = ti.mcelsius;
+                    e->u.thermal.warning = ti.thresholds.warning;
+                    e->u.thermal.error = ti.thresholds.error;
+                    e->u.thermal.shutdown = ti.thresholds.shutdown;
+                }
+                break;
+            }
+        case ONLP_OID_TYPE_FAN:
+            {
+                onlp_fan_info_t fi;
+                rv = onlp_fan_info_get_locked__(oid, &fi);
+                if(ONLP_SUCCESS(rv)) {
+                    *hdr = fi.hdr;
+                    e->status = fi.status;
+                    e->caps = fi.caps;
+                    e->u.fan.rpm = fi.rpm;
+                    e->u.fan.percentage = fi.percentage;
+                    e->u.fan.mode = fi.mode;
+                }
+                break;
+            }
+        case ONLP_OID_TYPE_PSU:
+            {
+                onlp_psu_info_t pi;
+                rv = onlp_psu_info_get_locked__(oid, &pi);
+                if(ONLP_SUCCESS(rv)) {
+                    *hdr = pi.hdr;
+                    e->status = pi.status;
+                    e->caps = pi.caps;
+                    e->u.psu.mvin = pi.mvin;
+                    e->u.psu.mvout = pi.mvout;
+                    e->u.psu.miin = pi.miin;
+                    e->u.psu.miout = pi.miout;
+                    e->u.psu.mpin = pi.mpin;
+                    e->u.psu.mpout = pi.mpout;
+                }
+                break;
+            }
+        case ONLP_OID_TYPE_LED:
+            {
+                onlp_led_info_t li;
+                rv = onlp_led_info_get_locked__(oid, &li);
+                if(ONLP_SUCCESS(rv)) {
+                    *hdr = li.hdr;
+                    e->status = li.status;
+                    e->caps = li.caps;
+                    e->u.led.mode = li.mode;
+                    e->u.led.character = li.character;
+                }
+                break;
+            }
+        default:
+            rv = snapshot_hdr_get__(oid, hdr);
+            break;
+        }
+
+    e->rv = rv;
+    if(ONLP_SUCCESS(rv)) {
+        e->poid = hdr->poid;
+        aim_strlcpy(e->description, hdr->description, sizeof(e->description));
+    }
+    else {
+        /* Children are still walked if the header is available. */
+        rv = snapshot_hdr_get__(oid, hdr);
+    }
+    return rv;
+}
+
+static void
+snapshot_walk__(onlp_snapshot_ctx_t* ctx, onlp_oid_hdr_t* parent)
+{
+    onlp_oid_t* oidp;
+
+    ONLP_OID_TABLE_ITER(parent->coids, oidp) {
+        onlp_oid_hdr_t hdr;
+        int rv;
+
+        if(SNAPSHOT_WANTED(ctx, *oidp)) {
+            onlp_snapshot_entry_t scratch;
+            onlp_snapshot_entry_t* e = (ctx->count < ctx->size) ?
+                ctx->entries + ctx->count : &scratch;
+            rv = snapshot_entry_get__(*oidp, e, &hdr);
+            ctx->count++;
+        }
+        else {
+            rv = snapshot_hdr_get__(*oidp, &hdr);
+        }
+
+        if(ONLP_SUCCESS(rv)) {
+            snapshot_walk__(ctx, &hdr);
+        }
+    }
+}
+
+static int
+onlp_snapshot_get_locked__(onlp_oid_t root, uint32_t types,
+                           onlp_snapshot_entry_t* entries, int size, int* count)
+{
+    int rv;
+    onlp_oid_hdr_t hdr;
+    onlp_snapshot_ctx_t ctx;
+
+    if(count == NULL || (entries == NULL && size > 0)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(root == 0) {
+        root = ONLP_OID_SYS;
+    }
+
+    rv = snapshot_hdr_get__(root, &hdr);
+    if(ONLP_FAILURE(rv)) {
+        return rv;
+    }
+
+    ctx.types = types;
+    ctx.entries = entries;
+    ctx.size = size;
+    ctx.count = 0;
+    snapshot_walk__(&ctx, &hdr);
+
+    *count = ctx.count;
+    return ONLP_STATUS_OK;
+}
+ONLP_LOCKED_API5(onlp_snapshot_get, onlp_oid_t, root, uint32_t, types,
+                 onlp_snapshot_entry_t*, entries, int, size, int*, count);
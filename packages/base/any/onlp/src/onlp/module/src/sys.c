@@ -23,6 +23,7 @@
  *
  ***********************************************************/
 #include <onlp/sys.h>
+#include <onlp/invalidate.h>
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <AIM/aim.h>
@@ -70,8 +71,14 @@ platform_detect__(void)
     return platform_detect_fs__(1);
 }
 
+static void
+onlp_sys_invalidate__(const onlp_invalidate_t* inv, void* cookie)
+{
+    onlp_sys_info_invalidate();
+}
+
 static int
-onlp_sys_init_locked__(void)
+onlp_sys_init__(void)
 {
     int rv;
 
@@ -95,39 +102,89 @@ onlp_sys_init_locked__(void)
 
     /* If we get here, its all good */
     aim_free((char*)current_platform);
+    onlp_invalidate_register(ONLP_INVALIDATE_CLASS_FLAG(ONLP_INVALIDATE_CLASS_SYS),
+                             onlp_sys_invalidate__, NULL);
     rv = onlp_sysi_init();
     return rv;
 }
+
+static int
+onlp_sys_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_SYS, onlp_sys_init__, "onlp_sys_init");
+}
 ONLP_LOCKED_API0(onlp_sys_init);
 
+/*
+ * The ONIE data region is mapped once and reused for the
+ * lifetime of the process.
+ */
+static uint8_t* onie_map__ = NULL;
+
 static uint8_t*
 onie_data_get__(int* free)
 {
     void* pa;
     uint8_t* ma = NULL;
     int size;
+
+    *free = 0;
+
+    if(onie_map__) {
+        return onie_map__;
+    }
+
     if(onlp_sysi_onie_data_phys_addr_get(&pa) == 0) {
         ma = onlp_mmap((off_t)pa, 64*1024, "onie_data_get__");
-        *free = 0;
+        onie_map__ = ma;
     }
     else if(onlp_sysi_onie_data_get(&ma, &size) == 0) {
         *free = 1;
     }
     else {
         ma = NULL;
-        *free = 0;
     }
     return ma;
 }
 
-static int
-onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+/*
+ * The decoded ONIE and platform information do not change at runtime.
+ * They are read once and served from this cache until invalidated.
+ *
+ * Callers of onlp_sys_info_cache_get() use the cached structure
+ * after the API lock is released, so each generation is reference
+ * counted. The cache holds one reference to the current generation
+ * and each caller holds one until onlp_sys_info_cache_put().
+ * Invalidation only marks the cache stale. The next request builds a
+ * new generation, and the old one is freed with its last reference.
+ */
+typedef struct sys_info_gen_s {
+    /* Must be first, callers are given a pointer to it. */
+    onlp_sys_info_t info;
+    int refs;
+} sys_info_gen_t;
+
+static sys_info_gen_t* sys_info_gen__ = NULL;
+static int sys_info_stale__ = 1;
+
+static void
+sys_info_gen_put__(sys_info_gen_t* gen)
 {
-    if(rv == NULL) {
-        return -1;
+    if(gen && --gen->refs == 0) {
+        onlp_sys_info_free(&gen->info);
+        aim_free(gen);
     }
+}
 
-    memset(rv, 0, sizeof(*rv));
+static sys_info_gen_t*
+sys_info_cache__(void)
+{
+    if(sys_info_gen__ && !sys_info_stale__) {
+        return sys_info_gen__;
+    }
+
+    sys_info_gen_t* gen = aim_zmalloc(sizeof(*gen));
+    onlp_sys_info_t* rv = &gen->info;
 
     /**
      * Get the system ONIE information.
@@ -158,10 +215,69 @@ onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
      */
     onlp_sysi_platform_info_get(&rv->platform_info);
 
+    /* The cache's own reference */
+    gen->refs = 1;
+    sys_info_gen_put__(sys_info_gen__);
+    sys_info_gen__ = gen;
+    sys_info_stale__ = 0;
+    return gen;
+}
+
+static int
+onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+{
+    if(rv == NULL) {
+        return -1;
+    }
+
+    const onlp_sys_info_t* si = &sys_info_cache__()->info;
+
+    memset(rv, 0, sizeof(*rv));
+
+    /*
+     * The caller owns the returned structure, so the ONIE information is
+     * copied from the cache. The platform information is allocated
+     * by the platform and must be requested again.
+     */
+    onlp_onie_info_copy(&rv->onie_info, &si->onie_info);
+    onlp_sysi_oids_get(rv->hdr.coids, AIM_ARRAYSIZE(rv->hdr.coids));
+    onlp_sysi_platform_info_get(&rv->platform_info);
     return 0;
 }
 ONLP_LOCKED_API1(onlp_sys_info_get,onlp_sys_info_t*,rv);
 
+static int
+onlp_sys_info_cache_get_locked__(const onlp_sys_info_t** rv)
+{
+    if(rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    sys_info_gen_t* gen = sys_info_cache__();
+    gen->refs++;
+    *rv = &gen->info;
+    return 0;
+}
+ONLP_LOCKED_API1(onlp_sys_info_cache_get, const onlp_sys_info_t**, rv);
+
+static int
+onlp_sys_info_cache_put_locked__(const onlp_sys_info_t* info)
+{
+    if(info == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    sys_info_gen_put__((sys_info_gen_t*)info);
+    return 0;
+}
+ONLP_LOCKED_API1(onlp_sys_info_cache_put, const onlp_sys_info_t*, info);
+
+static int
+onlp_sys_info_invalidate_locked__(void)
+{
+    sys_info_stale__ = 1;
+    return 0;
+}
+ONLP_LOCKED_API0(onlp_sys_info_invalidate);
+
 void
 onlp_sys_info_free(onlp_sys_info_t* info)
 {
@@ -169,7 +285,7 @@ onlp_sys_info_free(onlp_sys_info_t* info)
     onlp_sysi_platform_info_free(&info->platform_info);
 }
 
-static int
+int
 onlp_sys_hdr_get_locked__(onlp_oid_hdr_t* hdr)
 {
     memset(hdr, 0, sizeof(*hdr));
@@ -183,7 +299,7 @@ onlp_sys_dump(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
 {
     int rv;
     iof_t iof;
-    onlp_sys_info_t si;
+    const onlp_sys_info_t* si;
 
     onlp_oid_dump_iof_init_default(&iof, pvs);
 
@@ -192,18 +308,17 @@ onlp_sys_dump(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
     }
 
     iof_push(&iof, "System Information:");
-    rv = onlp_sys_info_get(&si);
+    rv = onlp_sys_info_cache_get(&si);
     if(rv < 0) {
         onlp_oid_info_get_error(&iof, rv);
         iof_pop(&iof);
         return;
     }
     else {
-        onlp_onie_show(&si.onie_info, &iof.inherit);
+        onlp_onie_show((onlp_onie_info_t*)&si->onie_info, &iof.inherit);
         iof_pop(&iof);
     }
-    onlp_oid_table_dump(si.hdr.coids, pvs, flags);
-    onlp_sys_info_free(&si);
+    onlp_oid_table_dump((onlp_oid_t*)si->hdr.coids, pvs, flags);
 }
 
 void
@@ -211,7 +326,7 @@ onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
 {
     int rv;
     iof_t iof;
-    onlp_sys_info_t si;
+    const onlp_sys_info_t* si;
     int yaml;
 
     onlp_oid_show_iof_init_default(&iof, pvs, flags);
@@ -221,7 +336,7 @@ onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
         return;
     }
 
-    rv = onlp_sys_info_get(&si);
+    rv = onlp_sys_info_cache_get(&si);
     if(rv < 0) {
         onlp_oid_info_get_error(&iof, rv);
         return;
@@ -238,31 +353,32 @@ onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
        flags & ONLP_OID_SHOW_EXTENDED ||
        (flags & ONLP_OID_SHOW_RECURSE) == 0) {
         iof_push(&iof, "System Information:");
-        onlp_onie_show(&si.onie_info, &iof.inherit);
+        onlp_onie_show((onlp_onie_info_t*)&si->onie_info, &iof.inherit);
         iof_pop(&iof);
     }
 
     if(flags & ONLP_OID_SHOW_RECURSE) {
 
         onlp_oid_t* oidp;
+        onlp_oid_t* coids = (onlp_oid_t*)si->hdr.coids;
 
         /** Show all Chassis Fans */
         YPUSH("Fans:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, FAN) {
+        ONLP_OID_TABLE_ITER_TYPE(coids, oidp, FAN) {
             onlp_oid_show(*oidp, &iof.inherit, flags);
         }
         YPOP();
 
         /** Show all System Thermals */
         YPUSH("Thermals:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, THERMAL) {
+        ONLP_OID_TABLE_ITER_TYPE(coids, oidp, THERMAL) {
             onlp_oid_show(*oidp, &iof.inherit, flags);
         }
         YPOP();
 
         /** Show all PSUs */
         YPUSH("PSUs:");
-        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, PSU) {
+        ONLP_OID_TABLE_ITER_TYPE(coids, oidp, PSU) {
             onlp_oid_show(*oidp, &iof.inherit, flags);
         }
         YPOP();
@@ -270,13 +386,12 @@ onlp_sys_show(onlp_oid_t id, aim_pvs_t* pvs, uint32_t flags)
         if(flags & ONLP_OID_SHOW_EXTENDED) {
             /** Show all LEDs */
             YPUSH("LEDs:");
-            ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, LED) {
+            ONLP_OID_TABLE_ITER_TYPE(coids, oidp, LED) {
                 onlp_oid_show(*oidp, &iof.inherit, flags);
             }
             YPOP();
         }
     }
-    onlp_sys_info_free(&si);
 }
 
 int
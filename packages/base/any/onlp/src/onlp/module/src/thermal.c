@@ -26,6 +26,10 @@
 #include <onlp/platformi/thermali.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+
+/* Initialize the thermal subsystem on first use. */
+#define ONLP_LOCKED_API_INIT_HOOK(_api)                                 \
+    onlp_init_once(ONLP_INIT_PHASE_THERMAL, onlp_thermal_init__, _api)
 #include "onlp_locks.h"
 
 #define VALIDATE(_id)                           \
@@ -44,10 +48,16 @@
 
 
 static int
-onlp_thermal_init_locked__(void)
+onlp_thermal_init__(void)
 {
     return onlp_thermali_init();
 }
+
+int
+onlp_thermal_init_locked__(void)
+{
+    return onlp_init_once(ONLP_INIT_PHASE_THERMAL, onlp_thermal_init__, "onlp_thermal_init");
+}
 ONLP_LOCKED_API0(onlp_thermal_init);
 
 #if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
@@ -74,7 +84,7 @@ onlp_thermali_info_from_json__(cJSON* data, onlp_thermal_info_t* info, int error
 
 #endif
 
-static int
+int
 onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
 {
     int rv;
@@ -96,7 +106,7 @@ onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
 }
 ONLP_LOCKED_API2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
 
-static int
+int
 onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
 {
     int rv = onlp_thermali_status_get(id, status);
@@ -112,7 +122,7 @@ onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
 }
 ONLP_LOCKED_API2(onlp_thermal_status_get, onlp_oid_t, id, uint32_t*, status);
 
-static int
+int
 onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
 {
     int rv = onlp_thermali_hdr_get(id, hdr);
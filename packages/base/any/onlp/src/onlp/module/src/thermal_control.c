@@ -0,0 +1,488 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Thermal Control Engine
+ *
+ ***********************************************************/
+#include <onlp/thermal_control.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/platformi/sysi.h>
+#include <AIM/aim_printf.h>
+#include <OS/os_time.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "onlp_int.h"
+#include "onlp_log.h"
+
+typedef struct group_state_s {
+    /** The table in use, changes with airflow */
+    const onlp_thermal_control_step_t* table;
+    int table_size;
+    int step;
+
+    /** PID state */
+    double integral;
+    double error;
+    uint64_t time;
+} group_state_t;
+
+typedef struct sensor_s {
+    onlp_oid_t oid;
+    int mcelsius;
+    int valid;
+} sensor_t;
+
+static struct {
+    pthread_mutex_t lock;
+    int loaded;
+    const onlp_thermal_control_t* tc;
+
+    /** Every referenced sensor, read once per run. */
+    sensor_t sensors[ONLP_OID_TABLE_SIZE];
+    int sensor_count;
+
+    /** Sensor index for each group member */
+    int* members[ONLP_THERMAL_CONTROL_GROUP_MAX];
+
+    group_state_t groups[ONLP_THERMAL_CONTROL_GROUP_MAX];
+
+    /** Present fans at the last write */
+    uint64_t fans_present;
+
+    /** -1 until the first write */
+    int written;
+
+    onlp_thermal_control_status_t status;
+} control__ = { PTHREAD_MUTEX_INITIALIZER };
+
+static int
+sensor_index__(onlp_oid_t oid)
+{
+    int i;
+    for(i = 0; i < control__.sensor_count; i++) {
+        if(control__.sensors[i].oid == oid) {
+            return i;
+        }
+    }
+    if(i == AIM_ARRAYSIZE(control__.sensors)) {
+        return -1;
+    }
+    control__.sensors[i].oid = oid;
+    control__.sensor_count++;
+    return i;
+}
+
+/*
+ * Release a partially loaded policy. The control then stays
+ * disabled, as if the platform had no policy.
+ */
+static void
+thermal_control_unload__(void)
+{
+    int g;
+    for(g = 0; g < AIM_ARRAYSIZE(control__.members); g++) {
+        aim_free(control__.members[g]);
+        control__.members[g] = NULL;
+    }
+    control__.sensor_count = 0;
+    control__.tc = NULL;
+}
+
+static int
+thermal_control_load__(void)
+{
+    const onlp_thermal_control_t* tc = NULL;
+    int g, i, rv;
+
+    if(control__.loaded) {
+        return control__.tc ? 0 : ONLP_STATUS_E_UNSUPPORTED;
+    }
+    control__.loaded = 1;
+    control__.written = -1;
+
+    rv = onlp_sysi_thermal_control_get(&tc);
+    if(rv < 0 || tc == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(tc->group_count > ONLP_THERMAL_CONTROL_GROUP_MAX ||
+       tc->fan_count > 64) {
+        AIM_LOG_ERROR("The platform thermal control policy is too large.");
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    for(g = 0; g < tc->group_count; g++) {
+        const onlp_thermal_control_group_t* grp = tc->groups + g;
+        control__.members[g] = aim_zmalloc(sizeof(int) * (grp->thermal_count + 1));
+        for(i = 0; i < grp->thermal_count; i++) {
+            if((control__.members[g][i] = sensor_index__(grp->thermals[i])) < 0) {
+                AIM_LOG_ERROR("Too many thermal control sensors.");
+                thermal_control_unload__();
+                return ONLP_STATUS_E_PARAM;
+            }
+        }
+    }
+
+    control__.tc = tc;
+    control__.status.enabled = 1;
+    control__.status.rate = tc->rate ? tc->rate : ONLP_CONFIG_THERMAL_CONTROL_RATE;
+    control__.status.group_count = tc->group_count;
+    control__.status.reason = "none";
+    return 0;
+}
+
+int
+onlp_thermal_control_init(void)
+{
+    int rv;
+    pthread_mutex_lock(&control__.lock);
+    rv = thermal_control_load__();
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+static int
+group_aggregate__(int g, int* mcelsius)
+{
+    const onlp_thermal_control_group_t* grp = control__.tc->groups + g;
+    int i, count = 0;
+    int64_t sum = 0;
+    int max = 0;
+
+    for(i = 0; i < grp->thermal_count; i++) {
+        sensor_t* s = control__.sensors + control__.members[g][i];
+        if(!s->valid) {
+            if(grp->aggregate == ONLP_THERMAL_CONTROL_AGGREGATE_SUM) {
+                /* A partial sum reads low. Treat the group as failed. */
+                return 0;
+            }
+            continue;
+        }
+        if(count == 0 || s->mcelsius > max) {
+            max = s->mcelsius;
+        }
+        sum += s->mcelsius;
+        count++;
+    }
+
+    if(count) {
+        switch(grp->aggregate)
+            {
+            case ONLP_THERMAL_CONTROL_AGGREGATE_MAX: *mcelsius = max; break;
+            case ONLP_THERMAL_CONTROL_AGGREGATE_SUM: *mcelsius = sum; break;
+            case ONLP_THERMAL_CONTROL_AGGREGATE_AVERAGE: *mcelsius = sum / count; break;
+            }
+    }
+    return count;
+}
+
+static int
+group_table__(int g, int mcelsius, uint32_t airflow)
+{
+    const onlp_thermal_control_group_t* grp = control__.tc->groups + g;
+    group_state_t* gs = control__.groups + g;
+    const onlp_thermal_control_step_t* table = grp->table;
+    int size = grp->table_size;
+
+    if((airflow & ONLP_FAN_STATUS_B2F) && grp->table_b2f) {
+        table = grp->table_b2f;
+        size = grp->table_b2f_size;
+    }
+    if(table == NULL || size <= 0) {
+        return -1;
+    }
+
+    if(table != gs->table) {
+        /* First run or the airflow changed. Climb from the bottom. */
+        gs->table = table;
+        gs->table_size = size;
+        gs->step = 0;
+    }
+
+    /* One step per run, so a single reading cannot swing the fans. */
+    if(gs->step < size - 1 && mcelsius >= table[gs->step].mcelsius_up) {
+        gs->step++;
+    }
+    else if(gs->step > 0 && mcelsius <= table[gs->step].mcelsius_down) {
+        gs->step--;
+    }
+    return table[gs->step].percentage;
+}
+
+static int
+group_pid__(int g, int mcelsius, uint64_t now)
+{
+    const onlp_thermal_control_t* tc = control__.tc;
+    const onlp_thermal_control_pid_t* pid = &tc->groups[g].pid;
+    group_state_t* gs = control__.groups + g;
+    double e = (mcelsius - pid->setpoint) / 1000.0;
+    double dt = gs->time ? (now - gs->time) / 1000000.0 : 0;
+    double integral = gs->integral + e * dt;
+    double out;
+
+    out = pid->base + pid->kp * e + pid->ki * integral;
+    if(dt > 0) {
+        out += pid->kd * (e - gs->error) / dt;
+    }
+
+    /* Do not accumulate error while the output is saturated. */
+    if(out > tc->max_percentage) {
+        out = tc->max_percentage;
+    }
+    else if(out < tc->min_percentage) {
+        out = tc->min_percentage;
+    }
+    else {
+        gs->integral = integral;
+    }
+
+    gs->error = e;
+    gs->time = now;
+    return (int)(out + 0.5);
+}
+
+static void
+fans_write__(int percentage, uint64_t present)
+{
+    const onlp_thermal_control_t* tc = control__.tc;
+    int i, rv = 0;
+
+    if(tc->fan_set) {
+        rv = onlp_fan_percentage_set(tc->fan_set, percentage);
+    }
+    else {
+        for(i = 0; i < tc->fan_count; i++) {
+            if(present & (1ULL << i)) {
+                int r = onlp_fan_percentage_set(tc->fans[i], percentage);
+                if(r < 0) {
+                    rv = r;
+                }
+            }
+        }
+    }
+
+    if(rv < 0) {
+        AIM_LOG_ERROR("Setting fans to %d%% failed: %{onlp_status}",
+                      percentage, rv);
+        control__.status.errors++;
+        /* Try again next time. */
+        control__.written = -1;
+        return;
+    }
+
+    if(control__.written < 0) {
+        AIM_LOG_INFO("Fans %d%% (%s)", percentage, control__.status.reason);
+    }
+    else if(control__.written != percentage) {
+        AIM_LOG_INFO("Fans %d%% -> %d%% (%s)", control__.written,
+                     percentage, control__.status.reason);
+    }
+    control__.written = percentage;
+    control__.fans_present = present;
+    control__.status.writes++;
+}
+
+static int
+thermal_control_run__(void)
+{
+    const onlp_thermal_control_t* tc = control__.tc;
+    onlp_thermal_control_status_t* st = &control__.status;
+    uint64_t start = os_time_monotonic();
+    uint64_t present = 0;
+    uint32_t airflow = 0;
+    int failed = 0, missing = 0, sensor_failed = 0;
+    int percentage = tc->min_percentage;
+    int i, g;
+
+    st->reason = "normal";
+
+    /* Fans */
+    for(i = 0; i < tc->fan_count; i++) {
+        onlp_fan_info_t fi;
+        if(onlp_fan_info_get(tc->fans[i], &fi) < 0) {
+            failed++;
+            continue;
+        }
+        if(!(fi.status & ONLP_FAN_STATUS_PRESENT)) {
+            missing++;
+            continue;
+        }
+        present |= (1ULL << i);
+        if(fi.status & ONLP_FAN_STATUS_FAILED) {
+            failed++;
+        }
+        if(airflow == 0) {
+            airflow = fi.status & (ONLP_FAN_STATUS_F2B | ONLP_FAN_STATUS_B2F);
+        }
+    }
+
+    /* Each sensor is read once, however many groups use it. */
+    for(i = 0; i < control__.sensor_count; i++) {
+        sensor_t* s = control__.sensors + i;
+        onlp_thermal_info_t ti;
+        s->valid = (onlp_thermal_info_get(s->oid, &ti) >= 0 &&
+                    (ti.status & ONLP_THERMAL_STATUS_PRESENT) &&
+                    !(ti.status & ONLP_THERMAL_STATUS_FAILED));
+        if(s->valid) {
+            s->mcelsius = ti.mcelsius;
+        }
+        else {
+            sensor_failed++;
+        }
+    }
+
+    /* Groups */
+    for(g = 0; g < tc->group_count; g++) {
+        onlp_thermal_control_group_status_t* gst = st->groups + g;
+        int mcelsius = 0;
+
+        gst->sensors = group_aggregate__(g, &mcelsius);
+        gst->mcelsius = mcelsius;
+        gst->step = -1;
+
+        if(gst->sensors == 0) {
+            /* Nothing to go on. */
+            gst->percentage = tc->failsafe_percentage ?
+                tc->failsafe_percentage : tc->max_percentage;
+            st->reason = sensor_failed ? "sensor failed" : "no sensors";
+        }
+        else if(tc->groups[g].mode == ONLP_THERMAL_CONTROL_MODE_PID) {
+            gst->percentage = group_pid__(g, mcelsius, start);
+        }
+        else {
+            gst->percentage = group_table__(g, mcelsius, airflow);
+            gst->step = control__.groups[g].step;
+        }
+
+        if(gst->percentage > percentage) {
+            percentage = gst->percentage;
+        }
+    }
+
+    /* Failure policies */
+    if((tc->failsafe & ONLP_THERMAL_CONTROL_FAILSAFE_FAN_FAILED) && failed) {
+        percentage = tc->failsafe_percentage;
+        st->reason = "fan failed";
+    }
+    else if((tc->failsafe & ONLP_THERMAL_CONTROL_FAILSAFE_FAN_MISSING) && missing) {
+        percentage = tc->failsafe_percentage;
+        st->reason = "fan missing";
+    }
+    else if((tc->failsafe & ONLP_THERMAL_CONTROL_FAILSAFE_SENSOR_FAILED) && sensor_failed) {
+        percentage = tc->failsafe_percentage;
+        st->reason = "sensor failed";
+    }
+
+    if(percentage > tc->max_percentage) {
+        percentage = tc->max_percentage;
+    }
+    if(percentage < tc->min_percentage) {
+        percentage = tc->min_percentage;
+    }
+
+    /*
+     * Write only on change. A newly inserted fan has not seen the
+     * current value, so a change in presence also forces a write.
+     */
+    if(percentage != control__.written ||
+       (!tc->fan_set && (present & ~control__.fans_present))) {
+        fans_write__(percentage, present);
+    }
+    else {
+        control__.fans_present = present;
+    }
+    st->percentage = control__.written;
+
+    st->runs++;
+    st->last_run = start;
+    st->last_duration = os_time_monotonic() - start;
+    st->total_duration += st->last_duration;
+    if(st->last_duration > st->max_duration) {
+        st->max_duration = st->last_duration;
+    }
+    return 0;
+}
+
+int
+onlp_thermal_control_run(void)
+{
+    int rv;
+    pthread_mutex_lock(&control__.lock);
+    rv = thermal_control_load__();
+    if(rv >= 0) {
+        rv = thermal_control_run__();
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+int
+onlp_thermal_control_rate_set(uint64_t rate)
+{
+    if(rate == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    pthread_mutex_lock(&control__.lock);
+    control__.status.rate = rate;
+    pthread_mutex_unlock(&control__.lock);
+    return 0;
+}
+
+int
+onlp_thermal_control_status_get(onlp_thermal_control_status_t* status)
+{
+    if(status == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    pthread_mutex_lock(&control__.lock);
+    *status = control__.status;
+    pthread_mutex_unlock(&control__.lock);
+    return 0;
+}
+
+void
+onlp_thermal_control_show(aim_pvs_t* pvs)
+{
+    onlp_thermal_control_status_t st;
+    int g;
+
+    onlp_thermal_control_status_get(&st);
+    if(!st.enabled) {
+        aim_printf(pvs, "Thermal control: not provided by this platform.\n");
+        return;
+    }
+
+    aim_printf(pvs, "Thermal control:\n");
+    aim_printf(pvs, "  Fans: %d%% (%s)\n", st.percentage, st.reason);
+    for(g = 0; g < st.group_count; g++) {
+        onlp_thermal_control_group_status_t* gs = st.groups + g;
+        const char* name = control__.tc->groups[g].name;
+        aim_printf(pvs, "  %-16s %4d.%03d C  sensors=%d step=%d demand=%d%%\n",
+                   name ? name : "", gs->mcelsius / 1000, abs(gs->mcelsius % 1000),
+                   gs->sensors, gs->step, gs->percentage);
+    }
+    aim_printf(pvs, "  Rate: %"PRIu64" us  Runs: %"PRIu64"  Writes: %"PRIu64"  Errors: %"PRIu64"\n",
+               st.rate, st.runs, st.writes, st.errors);
+    aim_printf(pvs, "  Duration: last %"PRIu64" us  max %"PRIu64" us  avg %"PRIu64" us\n",
+               st.last_duration, st.max_duration,
+               st.runs ? st.total_duration / st.runs : 0);
+}
@@ -107,6 +107,40 @@ iter__(onlp_oid_t oid, void* cookie)
 #include <onlp/thermal.h>
 #include <onlp/oids.h>
 #include <onlp/sys.h>
+#include <onlp/dom_health.h>
+
+/**
+ * Test DOM thresholds.
+ * Thresholds are read from A2h (SFP) or upper page 03h (QSFP).
+ */
+void
+dom_health_test(void)
+{
+    onlp_dom_health_t health;
+    onlp_dom_port_t dp;
+    int port, c;
+
+    onlp_dom_health_t_init(&health);
+    if(onlp_dom_health_update() < 0) {
+        /* No SFP support on this platform. */
+        return;
+    }
+    TRY(onlp_dom_health_evaluate(&health));
+
+    AIM_BITMAP_ITER(&health.monitored, port) {
+        TRY(onlp_dom_health_port_get(port, &dp));
+        for(c = 0; c < ONLP_DOM_CHANNELS; c++) {
+            onlp_dom_channel_t* ch = dp.channels + c;
+            if(ch->valid &&
+               (ch->high_alarm < ch->high_warning ||
+                ch->high_warning < ch->low_warning ||
+                ch->low_warning < ch->low_alarm)) {
+                AIM_DIE("port %d channel %d: thresholds out of order", port, c);
+            }
+        }
+    }
+    onlp_dom_health_show(&aim_pvs_stdout);
+}
 
 int
 aim_main(int argc, char* argv[])
@@ -118,6 +152,7 @@ aim_main(int argc, char* argv[])
     onlp_platform_dump(&aim_pvs_stdout, ONLP_OID_DUMP_RECURSE);
     onlp_oid_iterate(0, 0, iter__, NULL);
     onlp_platform_show(&aim_pvs_stdout, ONLP_OID_SHOW_RECURSE|ONLP_OID_SHOW_EXTENDED);
+    TEST(dom_health_test());
 
     if(argv[1] && !strcmp("manage", argv[1])) {
         onlp_sys_platform_manage_start();
@@ -0,0 +1,268 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Platform Interface Trace Format.
+ *
+ * A trace is a header followed by a sequence of records.
+ * Each record describes a single call into the platform
+ * interface: the function, its integer arguments, its
+ * return value, its latency, and any output buffer it filled.
+ *
+ * Records are padded to ONLP_TRACE_RECORD_ALIGN bytes so the
+ * whole trace can be mapped and walked in place.
+ *
+ * Traces are written in host byte order and are only portable
+ * between builds which agree on the sizes recorded in the header.
+ *
+ ***********************************************************/
+#ifndef __ONLP_TRACE_H__
+#define __ONLP_TRACE_H__
+
+#include <onlp_trace/onlp_trace_config.h>
+#include <onlp/onlp.h>
+#include <onlp/sfp.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* <auto.start.enum(tag:trace).define> */
+/** onlp_trace_fn */
+typedef enum onlp_trace_fn_e {
+    ONLP_TRACE_FN_SYSI_PLATFORM_GET,
+    ONLP_TRACE_FN_SYSI_PLATFORM_SET,
+    ONLP_TRACE_FN_SYSI_INIT,
+    ONLP_TRACE_FN_SYSI_ONIE_DATA_PHYS_ADDR_GET,
+    ONLP_TRACE_FN_SYSI_ONIE_DATA_GET,
+    ONLP_TRACE_FN_SYSI_ONIE_INFO_GET,
+    ONLP_TRACE_FN_SYSI_OIDS_GET,
+    ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_INIT,
+    ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_FANS,
+    ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_LEDS,
+    ONLP_TRACE_FN_SYSI_PLATFORM_INFO_GET,
+    ONLP_TRACE_FN_FANI_INIT,
+    ONLP_TRACE_FN_FANI_INFO_GET,
+    ONLP_TRACE_FN_FANI_STATUS_GET,
+    ONLP_TRACE_FN_FANI_HDR_GET,
+    ONLP_TRACE_FN_FANI_RPM_SET,
+    ONLP_TRACE_FN_FANI_PERCENTAGE_SET,
+    ONLP_TRACE_FN_FANI_MODE_SET,
+    ONLP_TRACE_FN_FANI_DIR_SET,
+    ONLP_TRACE_FN_LEDI_INIT,
+    ONLP_TRACE_FN_LEDI_INFO_GET,
+    ONLP_TRACE_FN_LEDI_STATUS_GET,
+    ONLP_TRACE_FN_LEDI_HDR_GET,
+    ONLP_TRACE_FN_LEDI_SET,
+    ONLP_TRACE_FN_LEDI_MODE_SET,
+    ONLP_TRACE_FN_LEDI_CHAR_SET,
+    ONLP_TRACE_FN_PSUI_INIT,
+    ONLP_TRACE_FN_PSUI_INFO_GET,
+    ONLP_TRACE_FN_PSUI_STATUS_GET,
+    ONLP_TRACE_FN_PSUI_HDR_GET,
+    ONLP_TRACE_FN_THERMALI_INIT,
+    ONLP_TRACE_FN_THERMALI_INFO_GET,
+    ONLP_TRACE_FN_THERMALI_STATUS_GET,
+    ONLP_TRACE_FN_THERMALI_HDR_GET,
+    ONLP_TRACE_FN_SFPI_INIT,
+    ONLP_TRACE_FN_SFPI_BITMAP_GET,
+    ONLP_TRACE_FN_SFPI_IS_PRESENT,
+    ONLP_TRACE_FN_SFPI_PRESENCE_BITMAP_GET,
+    ONLP_TRACE_FN_SFPI_RX_LOS_BITMAP_GET,
+    ONLP_TRACE_FN_SFPI_EEPROM_READ,
+    ONLP_TRACE_FN_SFPI_DEV_READB,
+    ONLP_TRACE_FN_SFPI_DEV_WRITEB,
+    ONLP_TRACE_FN_SFPI_DEV_READW,
+    ONLP_TRACE_FN_SFPI_DEV_WRITEW,
+    ONLP_TRACE_FN_SFPI_DEV_READ,
+    ONLP_TRACE_FN_SFPI_DEV_WRITE,
+    ONLP_TRACE_FN_SFPI_DOM_READ,
+    ONLP_TRACE_FN_SFPI_POST_INSERT,
+    ONLP_TRACE_FN_SFPI_CONTROL_SUPPORTED,
+    ONLP_TRACE_FN_SFPI_CONTROL_SET,
+    ONLP_TRACE_FN_SFPI_CONTROL_GET,
+    ONLP_TRACE_FN_SFPI_PORT_MAP,
+    ONLP_TRACE_FN_SFPI_DENIT,
+    ONLP_TRACE_FN_LAST = ONLP_TRACE_FN_SFPI_DENIT,
+    ONLP_TRACE_FN_COUNT,
+    ONLP_TRACE_FN_INVALID = -1,
+} onlp_trace_fn_t;
+/* <auto.end.enum(tag:trace).define> */
+
+/** 'ONTR' */
+#define ONLP_TRACE_MAGIC 0x4F4E5452
+#define ONLP_TRACE_VERSION 2
+
+/** Trace file header. */
+typedef struct onlp_trace_header_s {
+    /** ONLP_TRACE_MAGIC */
+    uint32_t magic;
+    /** ONLP_TRACE_VERSION */
+    uint16_t version;
+    /** sizeof(onlp_trace_header_t) */
+    uint16_t size;
+    /** Wall clock time at which the trace was started (usecs) */
+    uint64_t start;
+
+    /* Sizes of the structures recorded as raw output buffers. */
+    uint16_t hdr_size;
+    uint16_t thermal_size;
+    uint16_t fan_size;
+    uint16_t psu_size;
+    uint16_t led_size;
+    uint16_t reserved[3];
+} onlp_trace_header_t;
+
+/** The record was made from within another platform call. */
+#define ONLP_TRACE_RECORD_F_NESTED 0x1
+
+/** Trace record header. */
+typedef struct onlp_trace_record_s {
+    /** Start of the call relative to the start of the trace (nsecs) */
+    uint64_t timestamp;
+    /** Duration of the call (nsecs) */
+    uint64_t latency;
+    /** Return value */
+    int32_t rv;
+    /** onlp_trace_fn_t */
+    uint16_t fn;
+    /** ONLP_TRACE_RECORD_F_* */
+    uint16_t flags;
+    /** Number of int32_t arguments following this header */
+    uint16_t argc;
+    uint16_t reserved;
+    /** Number of output bytes following the arguments */
+    uint32_t size;
+    /** Calling thread */
+    uint32_t tid;
+    uint32_t reserved2;
+} onlp_trace_record_t;
+
+#define ONLP_TRACE_RECORD_ALIGN 8
+
+/** Maximum number of arguments in a single record. */
+#define ONLP_TRACE_ARGS_MAX 4
+
+/** Arguments for the given record. */
+#define ONLP_TRACE_RECORD_ARGS(_r) \
+    ((int32_t*)((uint8_t*)(_r) + sizeof(onlp_trace_record_t)))
+
+/** Output buffer for the given record. */
+#define ONLP_TRACE_RECORD_DATA(_r) \
+    ((uint8_t*)(ONLP_TRACE_RECORD_ARGS(_r) + (_r)->argc))
+
+/** Total (padded) length of the given record. */
+#define ONLP_TRACE_RECORD_LENGTH(_r)                                     \
+    ( (sizeof(onlp_trace_record_t) + (_r)->argc*sizeof(int32_t) +       \
+       (_r)->size + ONLP_TRACE_RECORD_ALIGN - 1) &                      \
+      ~(ONLP_TRACE_RECORD_ALIGN - 1) )
+
+/** SFP bitmaps are recorded as packed bit arrays of this size. */
+#define ONLP_TRACE_BITMAP_SIZE 32
+
+/**
+ * @brief Initialize a trace header for the current build.
+ * @param hdr The header.
+ */
+void onlp_trace_header_init(onlp_trace_header_t* hdr);
+
+/**
+ * @brief Validate a trace header against the current build.
+ * @param hdr The header.
+ * @returns ONLP_STATUS_OK if the trace can be used by this build.
+ */
+int onlp_trace_header_validate(const onlp_trace_header_t* hdr);
+
+/**
+ * @brief Write a record to a trace.
+ * @param fp The trace file.
+ * @param r The record header. r->argc and r->size must be set.
+ * @param args r->argc arguments.
+ * @param data r->size bytes of output.
+ * @returns ONLP_STATUS_OK, or ONLP_STATUS_E_INTERNAL if the write failed.
+ */
+int onlp_trace_record_write(FILE* fp, const onlp_trace_record_t* r,
+                            const int32_t* args, const void* data);
+
+/**
+ * @brief Get the next record of a trace.
+ * @param data The trace, including its header.
+ * @param size The size of the trace.
+ * @param offset [in,out] The offset of the record, 0 for the first record.
+ * @returns The record, or NULL at the end of the trace. If *offset
+ * is not size, the trace is truncated or corrupt at *offset.
+ */
+const onlp_trace_record_t* onlp_trace_record_next(const uint8_t* data,
+                                                  size_t size,
+                                                  size_t* offset);
+
+/**
+ * @brief Monotonic timestamp in nanoseconds.
+ */
+uint64_t onlp_trace_now(void);
+
+/**
+ * @brief Pack an SFP bitmap for recording.
+ * @param dst Receives ONLP_TRACE_BITMAP_SIZE bytes.
+ * @param src The source bitmap.
+ */
+void onlp_trace_bitmap_pack(uint8_t* dst, onlp_sfp_bitmap_t* src);
+
+/**
+ * @brief Unpack a recorded SFP bitmap.
+ * @param dst The destination bitmap.
+ * @param src The packed bitmap.
+ * @param size The size of the packed bitmap.
+ */
+void onlp_trace_bitmap_unpack(onlp_sfp_bitmap_t* dst, const uint8_t* src, int size);
+
+/**
+ * @brief Determine the length of ONIE TlvInfo data.
+ * @param data The data.
+ * @returns The total length including the header, or -1 if the data is not TlvInfo.
+ */
+int onlp_trace_onie_data_size(const uint8_t* data);
+
+/******************************************************************************
+ *
+ * Enumeration Support Definitions.
+ *
+ * Please do not add additional code beyond this point.
+ *
+ *****************************************************************************/
+/* <auto.start.enum(tag:trace).supportheader> */
+/** Enum names. */
+const char* onlp_trace_fn_name(onlp_trace_fn_t e);
+
+/** Enum values. */
+int onlp_trace_fn_value(const char* str, onlp_trace_fn_t* e, int substr);
+
+/** Enum descriptions. */
+const char* onlp_trace_fn_desc(onlp_trace_fn_t e);
+
+/** validator */
+#define ONLP_TRACE_FN_VALID(_e) \
+    ( (0 <= (_e)) && ((_e) <= ONLP_TRACE_FN_SFPI_DENIT))
+
+/** onlp_trace_fn_map table. */
+extern aim_map_si_t onlp_trace_fn_map[];
+/** onlp_trace_fn_desc_map table. */
+extern aim_map_si_t onlp_trace_fn_desc_map[];
+/* <auto.end.enum(tag:trace).supportheader> */
+
+#endif /* __ONLP_TRACE_H__ */
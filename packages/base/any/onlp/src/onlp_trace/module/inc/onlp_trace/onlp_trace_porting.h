@@ -0,0 +1,132 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+
+/********************************************************//**
+ *
+ * @file
+ * @brief onlp_trace Porting Macros.
+ *
+ * @addtogroup onlp_trace-porting
+ * @{
+ *
+ ***********************************************************/
+#ifndef __ONLP_TRACE_PORTING_H__
+#define __ONLP_TRACE_PORTING_H__
+
+
+/* <auto.start.portingmacro(ALL).define> */
+#if ONLP_TRACE_CONFIG_PORTING_INCLUDE_STDLIB_HEADERS == 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <memory.h>
+#endif
+
+#ifndef ONLP_TRACE_MALLOC
+    #if defined(GLOBAL_MALLOC)
+        #define ONLP_TRACE_MALLOC GLOBAL_MALLOC
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_MALLOC malloc
+    #else
+        #error The macro ONLP_TRACE_MALLOC is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_FREE
+    #if defined(GLOBAL_FREE)
+        #define ONLP_TRACE_FREE GLOBAL_FREE
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_FREE free
+    #else
+        #error The macro ONLP_TRACE_FREE is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_MEMSET
+    #if defined(GLOBAL_MEMSET)
+        #define ONLP_TRACE_MEMSET GLOBAL_MEMSET
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_MEMSET memset
+    #else
+        #error The macro ONLP_TRACE_MEMSET is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_MEMCPY
+    #if defined(GLOBAL_MEMCPY)
+        #define ONLP_TRACE_MEMCPY GLOBAL_MEMCPY
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_MEMCPY memcpy
+    #else
+        #error The macro ONLP_TRACE_MEMCPY is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_STRNCPY
+    #if defined(GLOBAL_STRNCPY)
+        #define ONLP_TRACE_STRNCPY GLOBAL_STRNCPY
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_STRNCPY strncpy
+    #else
+        #error The macro ONLP_TRACE_STRNCPY is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_VSNPRINTF
+    #if defined(GLOBAL_VSNPRINTF)
+        #define ONLP_TRACE_VSNPRINTF GLOBAL_VSNPRINTF
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_VSNPRINTF vsnprintf
+    #else
+        #error The macro ONLP_TRACE_VSNPRINTF is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_SNPRINTF
+    #if defined(GLOBAL_SNPRINTF)
+        #define ONLP_TRACE_SNPRINTF GLOBAL_SNPRINTF
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_SNPRINTF snprintf
+    #else
+        #error The macro ONLP_TRACE_SNPRINTF is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_TRACE_STRLEN
+    #if defined(GLOBAL_STRLEN)
+        #define ONLP_TRACE_STRLEN GLOBAL_STRLEN
+    #elif ONLP_TRACE_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_TRACE_STRLEN strlen
+    #else
+        #error The macro ONLP_TRACE_STRLEN is required but cannot be defined.
+    #endif
+#endif
+
+/* <auto.end.portingmacro(ALL).define> */
+
+
+#endif /* __ONLP_TRACE_PORTING_H__ */
+/* @} */
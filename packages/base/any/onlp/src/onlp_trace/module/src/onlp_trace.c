@@ -0,0 +1,168 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp_trace/onlp_trace_config.h>
+#include <onlp_trace/onlp_trace.h>
+#include <onlp/oids.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include <sys/time.h>
+#include <time.h>
+#include "onlp_trace_log.h"
+
+void
+onlp_trace_header_init(onlp_trace_header_t* hdr)
+{
+    struct timeval tv;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = ONLP_TRACE_MAGIC;
+    hdr->version = ONLP_TRACE_VERSION;
+    hdr->size = sizeof(*hdr);
+
+    gettimeofday(&tv, NULL);
+    hdr->start = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+
+    hdr->hdr_size = sizeof(onlp_oid_hdr_t);
+    hdr->thermal_size = sizeof(onlp_thermal_info_t);
+    hdr->fan_size = sizeof(onlp_fan_info_t);
+    hdr->psu_size = sizeof(onlp_psu_info_t);
+    hdr->led_size = sizeof(onlp_led_info_t);
+}
+
+int
+onlp_trace_header_validate(const onlp_trace_header_t* hdr)
+{
+    onlp_trace_header_t local;
+
+    if(hdr->magic != ONLP_TRACE_MAGIC) {
+        AIM_LOG_ERROR("Bad trace magic 0x%x (wrong byte order?)", hdr->magic);
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(hdr->version != ONLP_TRACE_VERSION || hdr->size != sizeof(*hdr)) {
+        AIM_LOG_ERROR("Unsupported trace version %d.", hdr->version);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    onlp_trace_header_init(&local);
+    if(hdr->hdr_size != local.hdr_size ||
+       hdr->thermal_size != local.thermal_size ||
+       hdr->fan_size != local.fan_size ||
+       hdr->psu_size != local.psu_size ||
+       hdr->led_size != local.led_size) {
+        AIM_LOG_ERROR("The trace was recorded by an incompatible build.");
+        return ONLP_STATUS_E_PARAM;
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_trace_record_write(FILE* fp, const onlp_trace_record_t* r,
+                        const int32_t* args, const void* data)
+{
+    static const uint8_t pad[ONLP_TRACE_RECORD_ALIGN];
+    int len = ONLP_TRACE_RECORD_LENGTH(r);
+    int ok;
+
+    ok = fwrite(r, sizeof(*r), 1, fp) == 1;
+    if(r->argc) {
+        ok = ok && fwrite(args, sizeof(*args), r->argc, fp) == r->argc;
+    }
+    if(r->size) {
+        ok = ok && fwrite(data, 1, r->size, fp) == r->size;
+    }
+    len -= sizeof(*r) + r->argc*sizeof(*args) + r->size;
+    if(len) {
+        ok = ok && fwrite(pad, 1, len, fp) == len;
+    }
+    return ok ? ONLP_STATUS_OK : ONLP_STATUS_E_INTERNAL;
+}
+
+const onlp_trace_record_t*
+onlp_trace_record_next(const uint8_t* data, size_t size, size_t* offset)
+{
+    const onlp_trace_record_t* r;
+    size_t len;
+
+    if(*offset == 0) {
+        *offset = sizeof(onlp_trace_header_t);
+    }
+    if(*offset + sizeof(onlp_trace_record_t) > size) {
+        return NULL;
+    }
+
+    r = (const onlp_trace_record_t*)(data + *offset);
+    len = ONLP_TRACE_RECORD_LENGTH(r);
+    if(*offset + len > size ||
+       r->fn >= ONLP_TRACE_FN_COUNT || r->argc > ONLP_TRACE_ARGS_MAX) {
+        return NULL;
+    }
+
+    *offset += len;
+    return r;
+}
+
+uint64_t
+onlp_trace_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+onlp_trace_bitmap_pack(uint8_t* dst, onlp_sfp_bitmap_t* src)
+{
+    int p;
+    memset(dst, 0, ONLP_TRACE_BITMAP_SIZE);
+    AIM_BITMAP_ITER(src, p) {
+        if(p < ONLP_TRACE_BITMAP_SIZE*8) {
+            dst[p/8] |= 1 << (p%8);
+        }
+    }
+}
+
+void
+onlp_trace_bitmap_unpack(onlp_sfp_bitmap_t* dst, const uint8_t* src, int size)
+{
+    int p;
+    AIM_BITMAP_CLR_ALL(dst);
+    for(p = 0; p < size*8; p++) {
+        if(src[p/8] & (1 << (p%8))) {
+            AIM_BITMAP_SET(dst, p);
+        }
+    }
+}
+
+int
+onlp_trace_onie_data_size(const uint8_t* data)
+{
+    /* TlvInfo header: 8 byte id string, 1 byte version, 2 byte length. */
+    if(data == NULL || memcmp(data, "TlvInfo", 8)) {
+        return -1;
+    }
+    return 11 + ((data[9] << 8) | data[10]);
+}
@@ -0,0 +1,185 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+
+#include <onlp_trace/onlp_trace_config.h>
+#include <onlp_trace/onlp_trace.h>
+
+/* <auto.start.enum(ALL).source> */
+aim_map_si_t onlp_trace_fn_map[] =
+{
+    { "SYSI_PLATFORM_GET", ONLP_TRACE_FN_SYSI_PLATFORM_GET },
+    { "SYSI_PLATFORM_SET", ONLP_TRACE_FN_SYSI_PLATFORM_SET },
+    { "SYSI_INIT", ONLP_TRACE_FN_SYSI_INIT },
+    { "SYSI_ONIE_DATA_PHYS_ADDR_GET", ONLP_TRACE_FN_SYSI_ONIE_DATA_PHYS_ADDR_GET },
+    { "SYSI_ONIE_DATA_GET", ONLP_TRACE_FN_SYSI_ONIE_DATA_GET },
+    { "SYSI_ONIE_INFO_GET", ONLP_TRACE_FN_SYSI_ONIE_INFO_GET },
+    { "SYSI_OIDS_GET", ONLP_TRACE_FN_SYSI_OIDS_GET },
+    { "SYSI_PLATFORM_MANAGE_INIT", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_INIT },
+    { "SYSI_PLATFORM_MANAGE_FANS", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_FANS },
+    { "SYSI_PLATFORM_MANAGE_LEDS", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_LEDS },
+    { "SYSI_PLATFORM_INFO_GET", ONLP_TRACE_FN_SYSI_PLATFORM_INFO_GET },
+    { "FANI_INIT", ONLP_TRACE_FN_FANI_INIT },
+    { "FANI_INFO_GET", ONLP_TRACE_FN_FANI_INFO_GET },
+    { "FANI_STATUS_GET", ONLP_TRACE_FN_FANI_STATUS_GET },
+    { "FANI_HDR_GET", ONLP_TRACE_FN_FANI_HDR_GET },
+    { "FANI_RPM_SET", ONLP_TRACE_FN_FANI_RPM_SET },
+    { "FANI_PERCENTAGE_SET", ONLP_TRACE_FN_FANI_PERCENTAGE_SET },
+    { "FANI_MODE_SET", ONLP_TRACE_FN_FANI_MODE_SET },
+    { "FANI_DIR_SET", ONLP_TRACE_FN_FANI_DIR_SET },
+    { "LEDI_INIT", ONLP_TRACE_FN_LEDI_INIT },
+    { "LEDI_INFO_GET", ONLP_TRACE_FN_LEDI_INFO_GET },
+    { "LEDI_STATUS_GET", ONLP_TRACE_FN_LEDI_STATUS_GET },
+    { "LEDI_HDR_GET", ONLP_TRACE_FN_LEDI_HDR_GET },
+    { "LEDI_SET", ONLP_TRACE_FN_LEDI_SET },
+    { "LEDI_MODE_SET", ONLP_TRACE_FN_LEDI_MODE_SET },
+    { "LEDI_CHAR_SET", ONLP_TRACE_FN_LEDI_CHAR_SET },
+    { "PSUI_INIT", ONLP_TRACE_FN_PSUI_INIT },
+    { "PSUI_INFO_GET", ONLP_TRACE_FN_PSUI_INFO_GET },
+    { "PSUI_STATUS_GET", ONLP_TRACE_FN_PSUI_STATUS_GET },
+    { "PSUI_HDR_GET", ONLP_TRACE_FN_PSUI_HDR_GET },
+    { "THERMALI_INIT", ONLP_TRACE_FN_THERMALI_INIT },
+    { "THERMALI_INFO_GET", ONLP_TRACE_FN_THERMALI_INFO_GET },
+    { "THERMALI_STATUS_GET", ONLP_TRACE_FN_THERMALI_STATUS_GET },
+    { "THERMALI_HDR_GET", ONLP_TRACE_FN_THERMALI_HDR_GET },
+    { "SFPI_INIT", ONLP_TRACE_FN_SFPI_INIT },
+    { "SFPI_BITMAP_GET", ONLP_TRACE_FN_SFPI_BITMAP_GET },
+    { "SFPI_IS_PRESENT", ONLP_TRACE_FN_SFPI_IS_PRESENT },
+    { "SFPI_PRESENCE_BITMAP_GET", ONLP_TRACE_FN_SFPI_PRESENCE_BITMAP_GET },
+    { "SFPI_RX_LOS_BITMAP_GET", ONLP_TRACE_FN_SFPI_RX_LOS_BITMAP_GET },
+    { "SFPI_EEPROM_READ", ONLP_TRACE_FN_SFPI_EEPROM_READ },
+    { "SFPI_DEV_READB", ONLP_TRACE_FN_SFPI_DEV_READB },
+    { "SFPI_DEV_WRITEB", ONLP_TRACE_FN_SFPI_DEV_WRITEB },
+    { "SFPI_DEV_READW", ONLP_TRACE_FN_SFPI_DEV_READW },
+    { "SFPI_DEV_WRITEW", ONLP_TRACE_FN_SFPI_DEV_WRITEW },
+    { "SFPI_DEV_READ", ONLP_TRACE_FN_SFPI_DEV_READ },
+    { "SFPI_DEV_WRITE", ONLP_TRACE_FN_SFPI_DEV_WRITE },
+    { "SFPI_DOM_READ", ONLP_TRACE_FN_SFPI_DOM_READ },
+    { "SFPI_POST_INSERT", ONLP_TRACE_FN_SFPI_POST_INSERT },
+    { "SFPI_CONTROL_SUPPORTED", ONLP_TRACE_FN_SFPI_CONTROL_SUPPORTED },
+    { "SFPI_CONTROL_SET", ONLP_TRACE_FN_SFPI_CONTROL_SET },
+    { "SFPI_CONTROL_GET", ONLP_TRACE_FN_SFPI_CONTROL_GET },
+    { "SFPI_PORT_MAP", ONLP_TRACE_FN_SFPI_PORT_MAP },
+    { "SFPI_DENIT", ONLP_TRACE_FN_SFPI_DENIT },
+    { NULL, 0 }
+};
+
+aim_map_si_t onlp_trace_fn_desc_map[] =
+{
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_GET },
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_SET },
+    { "None", ONLP_TRACE_FN_SYSI_INIT },
+    { "None", ONLP_TRACE_FN_SYSI_ONIE_DATA_PHYS_ADDR_GET },
+    { "None", ONLP_TRACE_FN_SYSI_ONIE_DATA_GET },
+    { "None", ONLP_TRACE_FN_SYSI_ONIE_INFO_GET },
+    { "None", ONLP_TRACE_FN_SYSI_OIDS_GET },
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_INIT },
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_FANS },
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_MANAGE_LEDS },
+    { "None", ONLP_TRACE_FN_SYSI_PLATFORM_INFO_GET },
+    { "None", ONLP_TRACE_FN_FANI_INIT },
+    { "None", ONLP_TRACE_FN_FANI_INFO_GET },
+    { "None", ONLP_TRACE_FN_FANI_STATUS_GET },
+    { "None", ONLP_TRACE_FN_FANI_HDR_GET },
+    { "None", ONLP_TRACE_FN_FANI_RPM_SET },
+    { "None", ONLP_TRACE_FN_FANI_PERCENTAGE_SET },
+    { "None", ONLP_TRACE_FN_FANI_MODE_SET },
+    { "None", ONLP_TRACE_FN_FANI_DIR_SET },
+    { "None", ONLP_TRACE_FN_LEDI_INIT },
+    { "None", ONLP_TRACE_FN_LEDI_INFO_GET },
+    { "None", ONLP_TRACE_FN_LEDI_STATUS_GET },
+    { "None", ONLP_TRACE_FN_LEDI_HDR_GET },
+    { "None", ONLP_TRACE_FN_LEDI_SET },
+    { "None", ONLP_TRACE_FN_LEDI_MODE_SET },
+    { "None", ONLP_TRACE_FN_LEDI_CHAR_SET },
+    { "None", ONLP_TRACE_FN_PSUI_INIT },
+    { "None", ONLP_TRACE_FN_PSUI_INFO_GET },
+    { "None", ONLP_TRACE_FN_PSUI_STATUS_GET },
+    { "None", ONLP_TRACE_FN_PSUI_HDR_GET },
+    { "None", ONLP_TRACE_FN_THERMALI_INIT },
+    { "None", ONLP_TRACE_FN_THERMALI_INFO_GET },
+    { "None", ONLP_TRACE_FN_THERMALI_STATUS_GET },
+    { "None", ONLP_TRACE_FN_THERMALI_HDR_GET },
+    { "None", ONLP_TRACE_FN_SFPI_INIT },
+    { "None", ONLP_TRACE_FN_SFPI_BITMAP_GET },
+    { "None", ONLP_TRACE_FN_SFPI_IS_PRESENT },
+    { "None", ONLP_TRACE_FN_SFPI_PRESENCE_BITMAP_GET },
+    { "None", ONLP_TRACE_FN_SFPI_RX_LOS_BITMAP_GET },
+    { "None", ONLP_TRACE_FN_SFPI_EEPROM_READ },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_READB },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_WRITEB },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_READW },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_WRITEW },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_READ },
+    { "None", ONLP_TRACE_FN_SFPI_DEV_WRITE },
+    { "None", ONLP_TRACE_FN_SFPI_DOM_READ },
+    { "None", ONLP_TRACE_FN_SFPI_POST_INSERT },
+    { "None", ONLP_TRACE_FN_SFPI_CONTROL_SUPPORTED },
+    { "None", ONLP_TRACE_FN_SFPI_CONTROL_SET },
+    { "None", ONLP_TRACE_FN_SFPI_CONTROL_GET },
+    { "None", ONLP_TRACE_FN_SFPI_PORT_MAP },
+    { "None", ONLP_TRACE_FN_SFPI_DENIT },
+    { NULL, 0 }
+};
+
+const char*
+onlp_trace_fn_name(onlp_trace_fn_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlp_trace_fn_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlp_trace_fn'";
+    }
+}
+
+int
+onlp_trace_fn_value(const char* str, onlp_trace_fn_t* e, int substr)
+{
+    int i;
+    AIM_REFERENCE(substr);
+    if(aim_map_si_s(&i, str, onlp_trace_fn_map, 0)) {
+        /* Enum Found */
+        *e = i;
+        return 0;
+    }
+    else {
+        return -1;
+    }
+}
+
+const char*
+onlp_trace_fn_desc(onlp_trace_fn_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlp_trace_fn_desc_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlp_trace_fn'";
+    }
+}
+/* <auto.end.enum(ALL).source> */
+
@@ -0,0 +1,504 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Platform Interface Recorder.
+ *
+ ***********************************************************/
+#define _GNU_SOURCE
+#include <onlp_trace/onlp_trace_config.h>
+
+#if ONLP_TRACE_CONFIG_INCLUDE_RECORDER == 1
+
+/*
+ * This library is preloaded in front of the platform library
+ * (LD_PRELOAD=libonlp-trace-record.so). Each platform interface
+ * call is forwarded to the real implementation with dlsym(RTLD_NEXT)
+ * and recorded to the trace file named by ONLP_TRACE_FILE.
+ *
+ * Calls whose arguments cannot be serialized (ioctl, debug) and
+ * the free routines are not interposed.
+ */
+#include <onlp_trace/onlp_trace.h>
+#include <onlp/platformi/sysi.h>
+#include <onlp/platformi/fani.h>
+#include <onlp/platformi/ledi.h>
+#include <onlp/platformi/psui.h>
+#include <onlp/platformi/thermali.h>
+#include <onlp/platformi/sfpi.h>
+#include <onlplib/mmap.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "onlp_trace_log.h"
+
+static pthread_mutex_t record_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static FILE* record_fp__;
+static int record_failed__;
+static uint64_t record_start__;
+
+/* Nesting depth of the calling thread within the platform interface. */
+static __thread int record_depth__;
+
+static int
+record_open_locked__(void)
+{
+    onlp_trace_header_t hdr;
+    const char* fname;
+
+    if(record_fp__) {
+        return 0;
+    }
+    if(record_failed__) {
+        return -1;
+    }
+
+    fname = getenv(ONLP_TRACE_CONFIG_FILENAME_ENV);
+    if(fname == NULL) {
+        fname = ONLP_TRACE_CONFIG_FILENAME_DEFAULT;
+    }
+
+    if((record_fp__ = fopen(fname, "w")) == NULL) {
+        AIM_LOG_ERROR("Could not open trace file %s: %{errno}", fname, errno);
+        record_failed__ = 1;
+        return -1;
+    }
+
+    onlp_trace_header_init(&hdr);
+    record_start__ = onlp_trace_now();
+    fwrite(&hdr, sizeof(hdr), 1, record_fp__);
+    return 0;
+}
+
+static void
+record__(onlp_trace_fn_t fn, int rv, uint64_t t0,
+         const int32_t* args, int argc, const void* data, int size)
+{
+    onlp_trace_record_t r;
+
+    uint64_t t1 = onlp_trace_now();
+
+    memset(&r, 0, sizeof(r));
+    r.latency = t1 - t0;
+    r.rv = rv;
+    r.fn = fn;
+    r.flags = (record_depth__ > 1) ? ONLP_TRACE_RECORD_F_NESTED : 0;
+    r.argc = argc;
+    r.size = (data && size > 0) ? size : 0;
+    r.tid = syscall(SYS_gettid);
+
+    pthread_mutex_lock(&record_lock__);
+    if(record_open_locked__() == 0) {
+        r.timestamp = t0 - record_start__;
+        onlp_trace_record_write(record_fp__, &r, args, data);
+        /* Keep the trace usable if the process is killed. */
+        fflush(record_fp__);
+    }
+    pthread_mutex_unlock(&record_lock__);
+}
+
+static void*
+record_next__(const char* name)
+{
+    void* fp = dlsym(RTLD_NEXT, name);
+    if(fp == NULL) {
+        AIM_LOG_ERROR("Could not resolve %s: %s", name, dlerror());
+    }
+    return fp;
+}
+
+/*
+ * Resolve the next implementation of the current function.
+ */
+#define RECORD_NEXT(_name)                                              \
+    static __typeof__(&_name) next__ = NULL;                            \
+    if(next__ == NULL &&                                                \
+       (next__ = (__typeof__(&_name))record_next__(#_name)) == NULL) {  \
+        return ONLP_STATUS_E_UNSUPPORTED;                               \
+    }
+
+/*
+ * Forward the call and record the result.
+ */
+#define RECORD_CALL(_fn, _call, _args, _argc, _data, _size)             \
+    do {                                                                \
+        int rv__;                                                       \
+        uint64_t t0__;                                                  \
+        record_depth__++;                                               \
+        t0__ = onlp_trace_now();                                        \
+        rv__ = next__ _call;                                            \
+        record__(ONLP_TRACE_FN_##_fn, rv__, t0__, _args, _argc,         \
+                 (rv__ >= 0) ? (_data) : NULL, _size);                  \
+        record_depth__--;                                               \
+        return rv__;                                                    \
+    } while(0)
+
+#define RECORD_VOID(_name, _fn)                                         \
+    int _name(void)                                                     \
+    {                                                                   \
+        RECORD_NEXT(_name);                                             \
+        RECORD_CALL(_fn, (), NULL, 0, NULL, 0);                         \
+    }
+
+#define RECORD_OID_GET(_name, _fn, _type)                               \
+    int _name(onlp_oid_t id, _type* rv)                                 \
+    {                                                                   \
+        int32_t args[] = { id };                                        \
+        RECORD_NEXT(_name);                                             \
+        RECORD_CALL(_fn, (id, rv), args, 1, rv, sizeof(*rv));           \
+    }
+
+#define RECORD_OID_SET(_name, _fn, _type)                               \
+    int _name(onlp_oid_t id, _type value)                               \
+    {                                                                   \
+        int32_t args[] = { id, value };                                 \
+        RECORD_NEXT(_name);                                             \
+        RECORD_CALL(_fn, (id, value), args, 2, NULL, 0);                \
+    }
+
+/*
+ * sysi
+ */
+const char*
+onlp_sysi_platform_get(void)
+{
+    static __typeof__(&onlp_sysi_platform_get) next__ = NULL;
+    const char* rv;
+    uint64_t t0;
+
+    if(next__ == NULL) {
+        next__ = (__typeof__(&onlp_sysi_platform_get))record_next__(__func__);
+        if(next__ == NULL) {
+            return NULL;
+        }
+    }
+
+    record_depth__++;
+    t0 = onlp_trace_now();
+    rv = next__();
+    record__(ONLP_TRACE_FN_SYSI_PLATFORM_GET, rv ? 0 : ONLP_STATUS_E_INTERNAL,
+             t0, NULL, 0, rv, rv ? strlen(rv) + 1 : 0);
+    record_depth__--;
+    return rv;
+}
+
+int
+onlp_sysi_platform_set(const char* platform)
+{
+    RECORD_NEXT(onlp_sysi_platform_set);
+    /* The platform name is recorded in place of the output buffer. */
+    RECORD_CALL(SYSI_PLATFORM_SET, (platform), NULL, 0,
+                platform, platform ? strlen(platform) + 1 : 0);
+}
+
+RECORD_VOID(onlp_sysi_init, SYSI_INIT);
+
+int
+onlp_sysi_onie_data_phys_addr_get(void** pa)
+{
+    static void* mapped_pa = NULL;
+    static uint8_t* data = NULL;
+    int size = 0;
+    int rv;
+    uint64_t t0;
+
+    RECORD_NEXT(onlp_sysi_onie_data_phys_addr_get);
+
+    record_depth__++;
+    t0 = onlp_trace_now();
+    rv = next__(pa);
+    if(rv >= 0) {
+        /*
+         * The replay library cannot provide a physical address,
+         * so the EEPROM contents are recorded instead.
+         */
+        if(data == NULL || mapped_pa != *pa) {
+            data = onlp_mmap((off_t)*pa, 64*1024, "onlp_trace");
+            mapped_pa = *pa;
+        }
+        size = onlp_trace_onie_data_size(data);
+    }
+    record__(ONLP_TRACE_FN_SYSI_ONIE_DATA_PHYS_ADDR_GET, rv, t0, NULL, 0,
+             (size > 0) ? data : NULL, size);
+    record_depth__--;
+    return rv;
+}
+
+int
+onlp_sysi_onie_data_get(uint8_t** data, int* size)
+{
+    int rv;
+    int len = 0;
+    uint64_t t0;
+
+    RECORD_NEXT(onlp_sysi_onie_data_get);
+
+    record_depth__++;
+    t0 = onlp_trace_now();
+    rv = next__(data, size);
+    if(rv >= 0 && *data) {
+        /* Not all platforms report the size. */
+        len = onlp_trace_onie_data_size(*data);
+        if(len < 0 && size) {
+            len = *size;
+        }
+    }
+    record__(ONLP_TRACE_FN_SYSI_ONIE_DATA_GET, rv, t0, NULL, 0,
+             (rv >= 0) ? *data : NULL, len);
+    record_depth__--;
+    return rv;
+}
+
+int
+onlp_sysi_onie_info_get(onlp_onie_info_t* onie)
+{
+    RECORD_NEXT(onlp_sysi_onie_info_get);
+    /* Only the result is recorded. */
+    RECORD_CALL(SYSI_ONIE_INFO_GET, (onie), NULL, 0, NULL, 0);
+}
+
+int
+onlp_sysi_oids_get(onlp_oid_t* table, int max)
+{
+    int32_t args[] = { max };
+    RECORD_NEXT(onlp_sysi_oids_get);
+    RECORD_CALL(SYSI_OIDS_GET, (table, max), args, 1,
+                table, max*sizeof(*table));
+}
+
+RECORD_VOID(onlp_sysi_platform_manage_init, SYSI_PLATFORM_MANAGE_INIT);
+RECORD_VOID(onlp_sysi_platform_manage_fans, SYSI_PLATFORM_MANAGE_FANS);
+RECORD_VOID(onlp_sysi_platform_manage_leds, SYSI_PLATFORM_MANAGE_LEDS);
+
+int
+onlp_sysi_platform_info_get(onlp_platform_info_t* pi)
+{
+    int rv;
+    int len = 0;
+    char* buf = NULL;
+    uint64_t t0;
+
+    RECORD_NEXT(onlp_sysi_platform_info_get);
+
+    record_depth__++;
+    t0 = onlp_trace_now();
+    rv = next__(pi);
+    if(rv >= 0) {
+        /* Recorded as two consecutive strings. */
+        const char* c = pi->cpld_versions ? pi->cpld_versions : "";
+        const char* o = pi->other_versions ? pi->other_versions : "";
+        len = strlen(c) + strlen(o) + 2;
+        buf = aim_zmalloc(len);
+        strcpy(buf, c);
+        strcpy(buf + strlen(c) + 1, o);
+    }
+    record__(ONLP_TRACE_FN_SYSI_PLATFORM_INFO_GET, rv, t0, NULL, 0, buf, len);
+    aim_free(buf);
+    record_depth__--;
+    return rv;
+}
+
+/*
+ * fani
+ */
+RECORD_VOID(onlp_fani_init, FANI_INIT);
+RECORD_OID_GET(onlp_fani_info_get, FANI_INFO_GET, onlp_fan_info_t);
+RECORD_OID_GET(onlp_fani_status_get, FANI_STATUS_GET, uint32_t);
+RECORD_OID_GET(onlp_fani_hdr_get, FANI_HDR_GET, onlp_oid_hdr_t);
+RECORD_OID_SET(onlp_fani_rpm_set, FANI_RPM_SET, int);
+RECORD_OID_SET(onlp_fani_percentage_set, FANI_PERCENTAGE_SET, int);
+RECORD_OID_SET(onlp_fani_mode_set, FANI_MODE_SET, onlp_fan_mode_t);
+RECORD_OID_SET(onlp_fani_dir_set, FANI_DIR_SET, onlp_fan_dir_t);
+
+/*
+ * ledi
+ */
+RECORD_VOID(onlp_ledi_init, LEDI_INIT);
+RECORD_OID_GET(onlp_ledi_info_get, LEDI_INFO_GET, onlp_led_info_t);
+RECORD_OID_GET(onlp_ledi_status_get, LEDI_STATUS_GET, uint32_t);
+RECORD_OID_GET(onlp_ledi_hdr_get, LEDI_HDR_GET, onlp_oid_hdr_t);
+RECORD_OID_SET(onlp_ledi_set, LEDI_SET, int);
+RECORD_OID_SET(onlp_ledi_mode_set, LEDI_MODE_SET, onlp_led_mode_t);
+RECORD_OID_SET(onlp_ledi_char_set, LEDI_CHAR_SET, char);
+
+/*
+ * psui
+ */
+RECORD_VOID(onlp_psui_init, PSUI_INIT);
+RECORD_OID_GET(onlp_psui_info_get, PSUI_INFO_GET, onlp_psu_info_t);
+RECORD_OID_GET(onlp_psui_status_get, PSUI_STATUS_GET, uint32_t);
+RECORD_OID_GET(onlp_psui_hdr_get, PSUI_HDR_GET, onlp_oid_hdr_t);
+
+/*
+ * thermali
+ */
+RECORD_VOID(onlp_thermali_init, THERMALI_INIT);
+RECORD_OID_GET(onlp_thermali_info_get, THERMALI_INFO_GET, onlp_thermal_info_t);
+RECORD_OID_GET(onlp_thermali_status_get, THERMALI_STATUS_GET, uint32_t);
+RECORD_OID_GET(onlp_thermali_hdr_get, THERMALI_HDR_GET, onlp_oid_hdr_t);
+
+/*
+ * sfpi
+ */
+RECORD_VOID(onlp_sfpi_init, SFPI_INIT);
+RECORD_VOID(onlp_sfpi_denit, SFPI_DENIT);
+
+#define RECORD_BITMAP_GET(_name, _fn)                                   \
+    int _name(onlp_sfp_bitmap_t* bmap)                                  \
+    {                                                                   \
+        uint8_t packed[ONLP_TRACE_BITMAP_SIZE];                         \
+        int rv;                                                         \
+        uint64_t t0;                                                    \
+        RECORD_NEXT(_name);                                             \
+        record_depth__++;                                               \
+        t0 = onlp_trace_now();                                          \
+        rv = next__(bmap);                                              \
+        if(rv >= 0) {                                                   \
+            onlp_trace_bitmap_pack(packed, bmap);                       \
+        }                                                               \
+        record__(ONLP_TRACE_FN_##_fn, rv, t0, NULL, 0,                  \
+                 (rv >= 0) ? packed : NULL, sizeof(packed));            \
+        record_depth__--;                                               \
+        return rv;                                                      \
+    }
+
+RECORD_BITMAP_GET(onlp_sfpi_bitmap_get, SFPI_BITMAP_GET);
+RECORD_BITMAP_GET(onlp_sfpi_presence_bitmap_get, SFPI_PRESENCE_BITMAP_GET);
+RECORD_BITMAP_GET(onlp_sfpi_rx_los_bitmap_get, SFPI_RX_LOS_BITMAP_GET);
+
+int
+onlp_sfpi_is_present(int port)
+{
+    int32_t args[] = { port };
+    RECORD_NEXT(onlp_sfpi_is_present);
+    RECORD_CALL(SFPI_IS_PRESENT, (port), args, 1, NULL, 0);
+}
+
+int
+onlp_sfpi_eeprom_read(int port, uint8_t data[256])
+{
+    int32_t args[] = { port };
+    RECORD_NEXT(onlp_sfpi_eeprom_read);
+    RECORD_CALL(SFPI_EEPROM_READ, (port, data), args, 1, data, 256);
+}
+
+int
+onlp_sfpi_dom_read(int port, uint8_t data[256])
+{
+    int32_t args[] = { port };
+    RECORD_NEXT(onlp_sfpi_dom_read);
+    RECORD_CALL(SFPI_DOM_READ, (port, data), args, 1, data, 256);
+}
+
+int
+onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+{
+    int32_t args[] = { port, devaddr, addr };
+    RECORD_NEXT(onlp_sfpi_dev_readb);
+    RECORD_CALL(SFPI_DEV_READB, (port, devaddr, addr), args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_writeb(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
+{
+    int32_t args[] = { port, devaddr, addr, value };
+    RECORD_NEXT(onlp_sfpi_dev_writeb);
+    RECORD_CALL(SFPI_DEV_WRITEB, (port, devaddr, addr, value), args, 4, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
+{
+    int32_t args[] = { port, devaddr, addr };
+    RECORD_NEXT(onlp_sfpi_dev_readw);
+    RECORD_CALL(SFPI_DEV_READW, (port, devaddr, addr), args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
+{
+    int32_t args[] = { port, devaddr, addr, value };
+    RECORD_NEXT(onlp_sfpi_dev_writew);
+    RECORD_CALL(SFPI_DEV_WRITEW, (port, devaddr, addr, value), args, 4, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
+{
+    int32_t args[] = { port, devaddr, addr, size };
+    RECORD_NEXT(onlp_sfpi_dev_read);
+    RECORD_CALL(SFPI_DEV_READ, (port, devaddr, addr, rdata, size), args, 4,
+                rdata, size);
+}
+
+int
+onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
+{
+    int32_t args[] = { port, devaddr, addr, size };
+    RECORD_NEXT(onlp_sfpi_dev_write);
+    RECORD_CALL(SFPI_DEV_WRITE, (port, devaddr, addr, data, size), args, 4,
+                NULL, 0);
+}
+
+int
+onlp_sfpi_post_insert(int port, sff_info_t* info)
+{
+    int32_t args[] = { port };
+    RECORD_NEXT(onlp_sfpi_post_insert);
+    RECORD_CALL(SFPI_POST_INSERT, (port, info), args, 1, NULL, 0);
+}
+
+int
+onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int* rv)
+{
+    int32_t args[] = { port, control };
+    RECORD_NEXT(onlp_sfpi_control_supported);
+    RECORD_CALL(SFPI_CONTROL_SUPPORTED, (port, control, rv), args, 2,
+                rv, sizeof(*rv));
+}
+
+int
+onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
+{
+    int32_t args[] = { port, control, value };
+    RECORD_NEXT(onlp_sfpi_control_set);
+    RECORD_CALL(SFPI_CONTROL_SET, (port, control, value), args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value)
+{
+    int32_t args[] = { port, control };
+    RECORD_NEXT(onlp_sfpi_control_get);
+    RECORD_CALL(SFPI_CONTROL_GET, (port, control, value), args, 2,
+                value, sizeof(*value));
+}
+
+int
+onlp_sfpi_port_map(int port, int* rport)
+{
+    int32_t args[] = { port };
+    RECORD_NEXT(onlp_sfpi_port_map);
+    RECORD_CALL(SFPI_PORT_MAP, (port, rport), args, 1, rport, sizeof(*rport));
+}
+
+#endif /* ONLP_TRACE_CONFIG_INCLUDE_RECORDER */
@@ -0,0 +1,604 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Trace Replay Platform.
+ *
+ ***********************************************************/
+#include <onlp_trace/onlp_trace_config.h>
+
+#if ONLP_TRACE_CONFIG_INCLUDE_REPLAY == 1
+
+/*
+ * A platform implementation which serves the results recorded
+ * in a trace file (ONLP_TRACE_FILE).
+ *
+ * Calls are matched against recorded calls with the same function
+ * and arguments. Repeated calls cycle through the matching records
+ * in the order they were recorded. Setters only match on the target
+ * (oid, port, control) so new values may be written.
+ *
+ * In realtime mode (the default) each call takes at least as long as
+ * the recorded call. In fast mode (ONLP_TRACE_REPLAY_MODE=fast) results
+ * are returned immediately.
+ */
+#include <onlp_trace/onlp_trace.h>
+#include <onlp/platformi/sysi.h>
+#include <onlp/platformi/fani.h>
+#include <onlp/platformi/ledi.h>
+#include <onlp/platformi/psui.h>
+#include <onlp/platformi/thermali.h>
+#include <onlp/platformi/sfpi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "onlp_trace_log.h"
+
+typedef struct replay_key_s {
+    struct replay_key_s* next;
+    onlp_trace_fn_t fn;
+    int argc;
+    int32_t args[ONLP_TRACE_ARGS_MAX];
+
+    const onlp_trace_record_t** records;
+    int count;
+    int allocated;
+    int cursor;
+} replay_key_t;
+
+#define REPLAY_BUCKETS 1024
+
+typedef struct replay_ctrl_s {
+    const char* fname;
+    uint8_t* data;
+    size_t size;
+    int fast;
+    int records;
+    int counts[ONLP_TRACE_FN_COUNT];
+    replay_key_t* buckets[REPLAY_BUCKETS];
+} replay_ctrl_t;
+
+static replay_ctrl_t replay_ctrl__;
+static pthread_once_t replay_once__ = PTHREAD_ONCE_INIT;
+static pthread_mutex_t replay_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Number of leading arguments used to match a call.
+ * Zero means all arguments are used.
+ */
+static const int replay_match_argc__[ONLP_TRACE_FN_COUNT] = {
+    [ONLP_TRACE_FN_FANI_RPM_SET] = 1,
+    [ONLP_TRACE_FN_FANI_PERCENTAGE_SET] = 1,
+    [ONLP_TRACE_FN_FANI_MODE_SET] = 1,
+    [ONLP_TRACE_FN_FANI_DIR_SET] = 1,
+    [ONLP_TRACE_FN_LEDI_SET] = 1,
+    [ONLP_TRACE_FN_LEDI_MODE_SET] = 1,
+    [ONLP_TRACE_FN_LEDI_CHAR_SET] = 1,
+    [ONLP_TRACE_FN_SFPI_DEV_WRITEB] = 3,
+    [ONLP_TRACE_FN_SFPI_DEV_WRITEW] = 3,
+    [ONLP_TRACE_FN_SFPI_DEV_WRITE] = 3,
+    [ONLP_TRACE_FN_SFPI_CONTROL_SET] = 2,
+};
+
+static int
+replay_match_argc_get__(onlp_trace_fn_t fn, int argc)
+{
+    int m = replay_match_argc__[fn];
+    if(m == 0 || m > argc) {
+        m = argc;
+    }
+    return (m > ONLP_TRACE_ARGS_MAX) ? ONLP_TRACE_ARGS_MAX : m;
+}
+
+static unsigned int
+replay_hash__(onlp_trace_fn_t fn, const int32_t* args, int argc)
+{
+    unsigned int h = fn;
+    int i;
+    for(i = 0; i < argc; i++) {
+        h = h*31 + (uint32_t)args[i];
+    }
+    return h % REPLAY_BUCKETS;
+}
+
+static replay_key_t*
+replay_key_find__(onlp_trace_fn_t fn, const int32_t* args, int argc, int create)
+{
+    replay_key_t* k;
+    unsigned int h;
+
+    argc = replay_match_argc_get__(fn, argc);
+    h = replay_hash__(fn, args, argc);
+
+    for(k = replay_ctrl__.buckets[h]; k; k = k->next) {
+        if(k->fn == fn && k->argc == argc &&
+           !memcmp(k->args, args, argc*sizeof(*args))) {
+            return k;
+        }
+    }
+
+    if(create) {
+        k = aim_zmalloc(sizeof(*k));
+        k->fn = fn;
+        k->argc = argc;
+        memcpy(k->args, args, argc*sizeof(*args));
+        k->next = replay_ctrl__.buckets[h];
+        replay_ctrl__.buckets[h] = k;
+    }
+    return k;
+}
+
+static void
+replay_key_add__(const onlp_trace_record_t* r)
+{
+    replay_key_t* k = replay_key_find__(r->fn, ONLP_TRACE_RECORD_ARGS(r),
+                                        r->argc, 1);
+    if(k->count == k->allocated) {
+        k->allocated = k->allocated ? k->allocated*2 : 8;
+        k->records = aim_realloc(k->records,
+                                 k->allocated*sizeof(*k->records));
+    }
+    k->records[k->count++] = r;
+}
+
+static void
+replay_load__(void)
+{
+    const onlp_trace_header_t* hdr;
+    const onlp_trace_record_t* r;
+    const char* mode;
+    struct stat st;
+    size_t offset;
+    int fd;
+
+    replay_ctrl__.fname = getenv(ONLP_TRACE_CONFIG_FILENAME_ENV);
+    if(replay_ctrl__.fname == NULL) {
+        replay_ctrl__.fname = ONLP_TRACE_CONFIG_FILENAME_DEFAULT;
+    }
+
+    mode = getenv(ONLP_TRACE_CONFIG_REPLAY_MODE_ENV);
+    replay_ctrl__.fast = (mode && !strcmp(mode, "fast"));
+
+    if((fd = open(replay_ctrl__.fname, O_RDONLY)) < 0) {
+        AIM_LOG_ERROR("Could not open trace file %s: %{errno}",
+                      replay_ctrl__.fname, errno);
+        return;
+    }
+
+    if(fstat(fd, &st) < 0 || st.st_size < sizeof(*hdr)) {
+        AIM_LOG_ERROR("Trace file %s is empty.", replay_ctrl__.fname);
+        close(fd);
+        return;
+    }
+
+    replay_ctrl__.data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(replay_ctrl__.data == MAP_FAILED) {
+        AIM_LOG_ERROR("Could not map trace file %s: %{errno}",
+                      replay_ctrl__.fname, errno);
+        replay_ctrl__.data = NULL;
+        return;
+    }
+    replay_ctrl__.size = st.st_size;
+
+    hdr = (const onlp_trace_header_t*)replay_ctrl__.data;
+    if(onlp_trace_header_validate(hdr) < 0) {
+        munmap(replay_ctrl__.data, replay_ctrl__.size);
+        replay_ctrl__.data = NULL;
+        return;
+    }
+
+    offset = 0;
+    while((r = onlp_trace_record_next(replay_ctrl__.data,
+                                      replay_ctrl__.size, &offset))) {
+        /*
+         * Nested calls were made by the platform itself and
+         * are reproduced by replaying the outer call.
+         */
+        if(!(r->flags & ONLP_TRACE_RECORD_F_NESTED)) {
+            replay_key_add__(r);
+            replay_ctrl__.counts[r->fn]++;
+            replay_ctrl__.records++;
+        }
+    }
+    if(offset != replay_ctrl__.size) {
+        AIM_LOG_WARN("Trace file %s is truncated at offset %zu.",
+                     replay_ctrl__.fname, offset);
+    }
+
+    AIM_LOG_INFO("Loaded %d records from %s (%s mode)",
+                 replay_ctrl__.records, replay_ctrl__.fname,
+                 replay_ctrl__.fast ? "fast" : "realtime");
+}
+
+/*
+ * Find the next record for the given call.
+ */
+static const onlp_trace_record_t*
+replay_next__(onlp_trace_fn_t fn, const int32_t* args, int argc)
+{
+    const onlp_trace_record_t* r = NULL;
+    replay_key_t* k;
+
+    pthread_once(&replay_once__, replay_load__);
+
+    pthread_mutex_lock(&replay_lock__);
+    k = replay_key_find__(fn, args, argc, 0);
+    if(k && k->count) {
+        r = k->records[k->cursor];
+        k->cursor = (k->cursor + 1) % k->count;
+    }
+    pthread_mutex_unlock(&replay_lock__);
+    return r;
+}
+
+/*
+ * Hold the caller for the recorded latency.
+ */
+static void
+replay_delay__(const onlp_trace_record_t* r, uint64_t t0)
+{
+    uint64_t elapsed;
+    struct timespec ts;
+
+    if(replay_ctrl__.fast || r == NULL) {
+        return;
+    }
+
+    elapsed = onlp_trace_now() - t0;
+    if(elapsed < r->latency) {
+        uint64_t remaining = r->latency - elapsed;
+        ts.tv_sec = remaining / 1000000000;
+        ts.tv_nsec = remaining % 1000000000;
+        while(nanosleep(&ts, &ts) < 0 && errno == EINTR);
+    }
+}
+
+/*
+ * Replay a call, copying the recorded output buffer (if any) into data.
+ */
+static int
+replay__(onlp_trace_fn_t fn, const int32_t* args, int argc,
+         void* data, int size)
+{
+    uint64_t t0 = onlp_trace_now();
+    const onlp_trace_record_t* r = replay_next__(fn, args, argc);
+    int rv;
+
+    if(r == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    rv = r->rv;
+    if(rv >= 0 && data && size > 0) {
+        int len = (r->size < size) ? r->size : size;
+        memcpy(data, ONLP_TRACE_RECORD_DATA(r), len);
+        if(len < size) {
+            memset((uint8_t*)data + len, 0, size - len);
+        }
+    }
+    replay_delay__(r, t0);
+    return rv;
+}
+
+#define REPLAY_VOID(_name, _fn)                                         \
+    int _name(void)                                                     \
+    {                                                                   \
+        return replay__(ONLP_TRACE_FN_##_fn, NULL, 0, NULL, 0);         \
+    }
+
+#define REPLAY_OID_GET(_name, _fn, _type)                               \
+    int _name(onlp_oid_t id, _type* rv)                                 \
+    {                                                                   \
+        int32_t args[] = { id };                                        \
+        return replay__(ONLP_TRACE_FN_##_fn, args, 1, rv, sizeof(*rv)); \
+    }
+
+#define REPLAY_OID_SET(_name, _fn, _type)                               \
+    int _name(onlp_oid_t id, _type value)                               \
+    {                                                                   \
+        int32_t args[] = { id, value };                                 \
+        return replay__(ONLP_TRACE_FN_##_fn, args, 2, NULL, 0);         \
+    }
+
+/*
+ * sysi
+ */
+const char*
+onlp_sysi_platform_get(void)
+{
+    const onlp_trace_record_t* r =
+        replay_next__(ONLP_TRACE_FN_SYSI_PLATFORM_GET, NULL, 0);
+    if(r && r->size && ONLP_TRACE_RECORD_DATA(r)[r->size-1] == 0) {
+        return (const char*)ONLP_TRACE_RECORD_DATA(r);
+    }
+    return "onlp-replay";
+}
+
+int
+onlp_sysi_platform_set(const char* platform)
+{
+    /* The replay library will impersonate any platform. */
+    return ONLP_STATUS_OK;
+}
+
+REPLAY_VOID(onlp_sysi_init, SYSI_INIT);
+
+int
+onlp_sysi_onie_data_phys_addr_get(void** pa)
+{
+    /* Recorded EEPROM contents are served by onlp_sysi_onie_data_get() */
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+int
+onlp_sysi_onie_data_get(uint8_t** data, int* size)
+{
+    uint64_t t0 = onlp_trace_now();
+    const onlp_trace_record_t* r;
+
+    r = replay_next__(ONLP_TRACE_FN_SYSI_ONIE_DATA_GET, NULL, 0);
+    if(r == NULL) {
+        r = replay_next__(ONLP_TRACE_FN_SYSI_ONIE_DATA_PHYS_ADDR_GET, NULL, 0);
+    }
+    if(r == NULL || r->rv < 0 || r->size == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    *data = aim_zmalloc(r->size);
+    memcpy(*data, ONLP_TRACE_RECORD_DATA(r), r->size);
+    *size = r->size;
+    replay_delay__(r, t0);
+    return ONLP_STATUS_OK;
+}
+
+void
+onlp_sysi_onie_data_free(uint8_t* data)
+{
+    aim_free(data);
+}
+
+int
+onlp_sysi_oids_get(onlp_oid_t* table, int max)
+{
+    int32_t args[] = { max };
+    return replay__(ONLP_TRACE_FN_SYSI_OIDS_GET, args, 1,
+                    table, max*sizeof(*table));
+}
+
+REPLAY_VOID(onlp_sysi_platform_manage_init, SYSI_PLATFORM_MANAGE_INIT);
+REPLAY_VOID(onlp_sysi_platform_manage_fans, SYSI_PLATFORM_MANAGE_FANS);
+REPLAY_VOID(onlp_sysi_platform_manage_leds, SYSI_PLATFORM_MANAGE_LEDS);
+
+int
+onlp_sysi_platform_info_get(onlp_platform_info_t* pi)
+{
+    uint64_t t0 = onlp_trace_now();
+    const onlp_trace_record_t* r =
+        replay_next__(ONLP_TRACE_FN_SYSI_PLATFORM_INFO_GET, NULL, 0);
+    const char* s;
+
+    if(r == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if(r->rv >= 0 && r->size >= 2 && ONLP_TRACE_RECORD_DATA(r)[r->size-1] == 0) {
+        s = (const char*)ONLP_TRACE_RECORD_DATA(r);
+        pi->cpld_versions = s[0] ? aim_strdup(s) : NULL;
+        s += strlen(s) + 1;
+        pi->other_versions = s[0] ? aim_strdup(s) : NULL;
+    }
+    replay_delay__(r, t0);
+    return r->rv;
+}
+
+void
+onlp_sysi_platform_info_free(onlp_platform_info_t* pi)
+{
+    aim_free(pi->cpld_versions);
+    aim_free(pi->other_versions);
+}
+
+int
+onlp_sysi_debug(aim_pvs_t* pvs, int argc, char** argv)
+{
+    int i;
+
+    pthread_once(&replay_once__, replay_load__);
+
+    aim_printf(pvs, "trace: %s\n", replay_ctrl__.fname);
+    aim_printf(pvs, "mode: %s\n", replay_ctrl__.fast ? "fast" : "realtime");
+    aim_printf(pvs, "records: %d\n", replay_ctrl__.records);
+    for(i = 0; i < ONLP_TRACE_FN_COUNT; i++) {
+        if(replay_ctrl__.counts[i]) {
+            aim_printf(pvs, "  %{onlp_trace_fn}: %d\n", i, replay_ctrl__.counts[i]);
+        }
+    }
+    return 0;
+}
+
+/*
+ * fani
+ */
+REPLAY_VOID(onlp_fani_init, FANI_INIT);
+REPLAY_OID_GET(onlp_fani_info_get, FANI_INFO_GET, onlp_fan_info_t);
+REPLAY_OID_GET(onlp_fani_status_get, FANI_STATUS_GET, uint32_t);
+REPLAY_OID_GET(onlp_fani_hdr_get, FANI_HDR_GET, onlp_oid_hdr_t);
+REPLAY_OID_SET(onlp_fani_rpm_set, FANI_RPM_SET, int);
+REPLAY_OID_SET(onlp_fani_percentage_set, FANI_PERCENTAGE_SET, int);
+REPLAY_OID_SET(onlp_fani_mode_set, FANI_MODE_SET, onlp_fan_mode_t);
+REPLAY_OID_SET(onlp_fani_dir_set, FANI_DIR_SET, onlp_fan_dir_t);
+
+/*
+ * ledi
+ */
+REPLAY_VOID(onlp_ledi_init, LEDI_INIT);
+REPLAY_OID_GET(onlp_ledi_info_get, LEDI_INFO_GET, onlp_led_info_t);
+REPLAY_OID_GET(onlp_ledi_status_get, LEDI_STATUS_GET, uint32_t);
+REPLAY_OID_GET(onlp_ledi_hdr_get, LEDI_HDR_GET, onlp_oid_hdr_t);
+REPLAY_OID_SET(onlp_ledi_set, LEDI_SET, int);
+REPLAY_OID_SET(onlp_ledi_mode_set, LEDI_MODE_SET, onlp_led_mode_t);
+REPLAY_OID_SET(onlp_ledi_char_set, LEDI_CHAR_SET, char);
+
+/*
+ * psui
+ */
+REPLAY_VOID(onlp_psui_init, PSUI_INIT);
+REPLAY_OID_GET(onlp_psui_info_get, PSUI_INFO_GET, onlp_psu_info_t);
+REPLAY_OID_GET(onlp_psui_status_get, PSUI_STATUS_GET, uint32_t);
+REPLAY_OID_GET(onlp_psui_hdr_get, PSUI_HDR_GET, onlp_oid_hdr_t);
+
+/*
+ * thermali
+ */
+REPLAY_VOID(onlp_thermali_init, THERMALI_INIT);
+REPLAY_OID_GET(onlp_thermali_info_get, THERMALI_INFO_GET, onlp_thermal_info_t);
+REPLAY_OID_GET(onlp_thermali_status_get, THERMALI_STATUS_GET, uint32_t);
+REPLAY_OID_GET(onlp_thermali_hdr_get, THERMALI_HDR_GET, onlp_oid_hdr_t);
+
+/*
+ * sfpi
+ */
+REPLAY_VOID(onlp_sfpi_init, SFPI_INIT);
+REPLAY_VOID(onlp_sfpi_denit, SFPI_DENIT);
+
+#define REPLAY_BITMAP_GET(_name, _fn)                                   \
+    int _name(onlp_sfp_bitmap_t* bmap)                                  \
+    {                                                                   \
+        uint8_t packed[ONLP_TRACE_BITMAP_SIZE];                         \
+        int rv = replay__(ONLP_TRACE_FN_##_fn, NULL, 0,                 \
+                          packed, sizeof(packed));                      \
+        if(rv >= 0) {                                                   \
+            onlp_trace_bitmap_unpack(bmap, packed, sizeof(packed));     \
+        }                                                               \
+        return rv;                                                      \
+    }
+
+REPLAY_BITMAP_GET(onlp_sfpi_bitmap_get, SFPI_BITMAP_GET);
+REPLAY_BITMAP_GET(onlp_sfpi_presence_bitmap_get, SFPI_PRESENCE_BITMAP_GET);
+REPLAY_BITMAP_GET(onlp_sfpi_rx_los_bitmap_get, SFPI_RX_LOS_BITMAP_GET);
+
+int
+onlp_sfpi_is_present(int port)
+{
+    int32_t args[] = { port };
+    return replay__(ONLP_TRACE_FN_SFPI_IS_PRESENT, args, 1, NULL, 0);
+}
+
+int
+onlp_sfpi_eeprom_read(int port, uint8_t data[256])
+{
+    int32_t args[] = { port };
+    return replay__(ONLP_TRACE_FN_SFPI_EEPROM_READ, args, 1, data, 256);
+}
+
+int
+onlp_sfpi_dom_read(int port, uint8_t data[256])
+{
+    int32_t args[] = { port };
+    return replay__(ONLP_TRACE_FN_SFPI_DOM_READ, args, 1, data, 256);
+}
+
+int
+onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+{
+    int32_t args[] = { port, devaddr, addr };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_READB, args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_writeb(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
+{
+    int32_t args[] = { port, devaddr, addr, value };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_WRITEB, args, 4, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
+{
+    int32_t args[] = { port, devaddr, addr };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_READW, args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
+{
+    int32_t args[] = { port, devaddr, addr, value };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_WRITEW, args, 4, NULL, 0);
+}
+
+int
+onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
+{
+    int32_t args[] = { port, devaddr, addr, size };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_READ, args, 4, rdata, size);
+}
+
+int
+onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
+{
+    int32_t args[] = { port, devaddr, addr, size };
+    return replay__(ONLP_TRACE_FN_SFPI_DEV_WRITE, args, 4, NULL, 0);
+}
+
+int
+onlp_sfpi_post_insert(int port, sff_info_t* info)
+{
+    int32_t args[] = { port };
+    return replay__(ONLP_TRACE_FN_SFPI_POST_INSERT, args, 1, NULL, 0);
+}
+
+int
+onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int* rv)
+{
+    int32_t args[] = { port, control };
+    return replay__(ONLP_TRACE_FN_SFPI_CONTROL_SUPPORTED, args, 2,
+                    rv, sizeof(*rv));
+}
+
+int
+onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
+{
+    int32_t args[] = { port, control, value };
+    return replay__(ONLP_TRACE_FN_SFPI_CONTROL_SET, args, 3, NULL, 0);
+}
+
+int
+onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value)
+{
+    int32_t args[] = { port, control };
+    return replay__(ONLP_TRACE_FN_SFPI_CONTROL_GET, args, 2,
+                    value, sizeof(*value));
+}
+
+int
+onlp_sfpi_port_map(int port, int* rport)
+{
+    int32_t args[] = { port };
+    return replay__(ONLP_TRACE_FN_SFPI_PORT_MAP, args, 1,
+                    rport, sizeof(*rport));
+}
+
+int __onlp_platform_version__ = 1;
+
+#endif /* ONLP_TRACE_CONFIG_INCLUDE_REPLAY */
@@ -0,0 +1,8 @@
+###############################################################################
+#
+# onlp_trace Unit Test Makefile.
+#
+###############################################################################
+UMODULE := onlp_trace
+UMODULE_SUBDIR := $(dir $(lastword $(MAKEFILE_LIST)))
+include $(BUILDER)/utest.mk
@@ -0,0 +1,211 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp_trace/onlp_trace_config.h>
+#include <onlp_trace/onlp_trace.h>
+#include <onlp/fan.h>
+#include <onlp/platformi/fani.h>
+#include <onlp/platformi/sfpi.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <AIM/aim.h>
+
+/* Longer than the 32 bit latency of trace version 1 could hold. */
+#define SLOW_LATENCY (6ULL * 1000000000)
+
+static void
+bitmap_init__(onlp_sfp_bitmap_t* bmap)
+{
+    AIM_BITMAP_INIT(bmap, 255);
+    AIM_BITMAP_CLR_ALL(bmap);
+}
+
+typedef struct expect_s {
+    onlp_trace_fn_t fn;
+    int rv;
+    uint64_t latency;
+    int argc;
+    int32_t args[ONLP_TRACE_ARGS_MAX];
+    const void* data;
+    int size;
+} expect_t;
+
+/**
+ * Record the expected calls as the recorder does.
+ */
+static void
+record__(FILE* fp, const expect_t* e, int count)
+{
+    onlp_trace_header_t hdr;
+    onlp_trace_record_t r;
+    int i;
+
+    onlp_trace_header_init(&hdr);
+    AIM_TRUE_OR_DIE(fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+
+    for(i = 0; i < count; i++) {
+        memset(&r, 0, sizeof(r));
+        r.timestamp = i * SLOW_LATENCY;
+        r.latency = e[i].latency;
+        r.rv = e[i].rv;
+        r.fn = e[i].fn;
+        r.argc = e[i].argc;
+        r.size = e[i].size;
+        AIM_TRUE_OR_DIE(onlp_trace_record_write(fp, &r, e[i].args,
+                                                e[i].data) == 0);
+    }
+    AIM_TRUE_OR_DIE(fflush(fp) == 0);
+}
+
+/**
+ * Walk the trace and compare each record with the expected calls.
+ */
+static void
+walk__(const uint8_t* data, size_t size, const expect_t* e, int count)
+{
+    const onlp_trace_record_t* r;
+    size_t offset = 0;
+    int i = 0;
+
+    AIM_TRUE_OR_DIE(onlp_trace_header_validate((const onlp_trace_header_t*)data) == 0);
+
+    while((r = onlp_trace_record_next(data, size, &offset))) {
+        AIM_TRUE_OR_DIE(i < count, "too many records");
+        AIM_TRUE_OR_DIE(r->fn == e[i].fn && r->rv == e[i].rv,
+                        "record %d: fn %d rv %d", i, r->fn, r->rv);
+        AIM_TRUE_OR_DIE(r->latency == e[i].latency,
+                        "record %d: latency %llu", i,
+                        (unsigned long long)r->latency);
+        AIM_TRUE_OR_DIE(r->argc == e[i].argc &&
+                        !memcmp(ONLP_TRACE_RECORD_ARGS(r), e[i].args,
+                                e[i].argc*sizeof(int32_t)),
+                        "record %d: arguments differ", i);
+        AIM_TRUE_OR_DIE(r->size == e[i].size &&
+                        !memcmp(ONLP_TRACE_RECORD_DATA(r), e[i].data, e[i].size),
+                        "record %d: data differs", i);
+        i++;
+    }
+    AIM_TRUE_OR_DIE(i == count, "%d of %d records", i, count);
+    AIM_TRUE_OR_DIE(offset == size, "trailing data at offset %zu", offset);
+
+    /* A truncated trace ends at the last complete record. */
+    offset = 0;
+    for(i = 0; onlp_trace_record_next(data, size - 1, &offset); i++);
+    AIM_TRUE_OR_DIE(i == count - 1 && offset != size - 1,
+                    "truncated trace not detected");
+}
+
+#if ONLP_TRACE_CONFIG_INCLUDE_REPLAY == 1
+/**
+ * Replay the calls through the platform interface.
+ */
+static void
+replay__(const char* fname, const onlp_fan_info_t* fi,
+         const onlp_sfp_bitmap_t* present)
+{
+    onlp_fan_info_t rfi;
+    onlp_sfp_bitmap_t bmap;
+    uint64_t t0;
+    int p;
+
+    setenv(ONLP_TRACE_CONFIG_FILENAME_ENV, fname, 1);
+    setenv(ONLP_TRACE_CONFIG_REPLAY_MODE_ENV, "fast", 1);
+
+    t0 = onlp_trace_now();
+    AIM_TRUE_OR_DIE(onlp_fani_info_get(fi->hdr.id, &rfi) == 0);
+    AIM_TRUE_OR_DIE(!memcmp(&rfi, fi, sizeof(rfi)), "fan info differs");
+    AIM_TRUE_OR_DIE(onlp_fani_percentage_set(fi->hdr.id, 40) ==
+                    ONLP_STATUS_E_UNSUPPORTED);
+    AIM_TRUE_OR_DIE(onlp_trace_now() - t0 < SLOW_LATENCY,
+                    "fast mode waited for the recorded latency");
+
+    bitmap_init__(&bmap);
+    AIM_TRUE_OR_DIE(onlp_sfpi_presence_bitmap_get(&bmap) == 0);
+    for(p = 0; p < 255; p++) {
+        AIM_TRUE_OR_DIE(AIM_BITMAP_GET(&bmap, p) == AIM_BITMAP_GET(present, p),
+                        "presence bitmap differs at port %d", p);
+    }
+}
+#endif
+
+int aim_main(int argc, char* argv[])
+{
+    char fname[] = "/tmp/onlp_trace_utest.XXXXXX";
+    const char* platform = "x86-64-utest";
+    onlp_fan_info_t fi;
+    onlp_sfp_bitmap_t present;
+    uint8_t packed[ONLP_TRACE_BITMAP_SIZE];
+    uint8_t* data;
+    long size;
+    FILE* fp;
+    int fd;
+
+    memset(&fi, 0, sizeof(fi));
+    fi.hdr.id = ONLP_FAN_ID_CREATE(1);
+    fi.status = ONLP_FAN_STATUS_PRESENT | ONLP_FAN_STATUS_F2B;
+    fi.rpm = 12345;
+    fi.percentage = 50;
+
+    bitmap_init__(&present);
+    AIM_BITMAP_SET(&present, 3);
+    AIM_BITMAP_SET(&present, 47);
+    onlp_trace_bitmap_pack(packed, &present);
+
+    expect_t expect[] = {
+        { ONLP_TRACE_FN_SYSI_PLATFORM_GET, 0, 1000, 0, { 0 },
+          platform, strlen(platform) + 1 },
+        { ONLP_TRACE_FN_FANI_INFO_GET, 0, SLOW_LATENCY, 1, { fi.hdr.id },
+          &fi, sizeof(fi) },
+        { ONLP_TRACE_FN_FANI_PERCENTAGE_SET, ONLP_STATUS_E_UNSUPPORTED,
+          SLOW_LATENCY, 2, { fi.hdr.id, 40 }, NULL, 0 },
+        { ONLP_TRACE_FN_SFPI_PRESENCE_BITMAP_GET, 0, 2000, 0, { 0 },
+          packed, sizeof(packed) },
+    };
+    int count = AIM_ARRAYSIZE(expect);
+
+    fd = mkstemp(fname);
+    AIM_TRUE_OR_DIE(fd >= 0 && (fp = fdopen(fd, "w+b")) != NULL);
+
+    record__(fp, expect, count);
+
+    AIM_TRUE_OR_DIE(fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) > 0);
+    data = aim_zmalloc(size);
+    rewind(fp);
+    AIM_TRUE_OR_DIE(fread(data, 1, size, fp) == size);
+    fclose(fp);
+
+    walk__(data, size, expect, count);
+    aim_free(data);
+
+#if ONLP_TRACE_CONFIG_INCLUDE_REPLAY == 1
+    replay__(fname, &fi, &present);
+#endif
+
+    unlink(fname);
+    printf("onlp_trace Utest Passed\n");
+    return 0;
+}
@@ -28,7 +28,12 @@
 /* <--auto.start.xmacro(ALL).define> */
 /* <auto.end.xmacro(ALL).define> */
 
-/* <--auto.start.xenum(ALL).define> */
+/* <auto.start.xenum(ALL).define> */
+#ifdef ONLPIE_ENUMERATION_ENTRY
+ONLPIE_ENUMERATION_ENTRY(onlpie_op, "")
+ONLPIE_ENUMERATION_ENTRY(onlpie_port_type, "")
+#undef ONLPIE_ENUMERATION_ENTRY
+#endif
 /* <auto.end.xenum(ALL).define> */
 
 
@@ -114,6 +114,26 @@
 #define ONLPIE_CONFIG_INCLUDE_UCLI 0
 #endif
 
+/**
+ * ONLPIE_CONFIG_SPEC_FILENAME
+ *
+ * The synthetic platform specification file. */
+
+
+#ifndef ONLPIE_CONFIG_SPEC_FILENAME
+#define ONLPIE_CONFIG_SPEC_FILENAME "/etc/onlpie.json"
+#endif
+
+/**
+ * ONLPIE_CONFIG_SPEC_ENV
+ *
+ * The environment variable which overrides the specification file. */
+
+
+#ifndef ONLPIE_CONFIG_SPEC_ENV
+#define ONLPIE_CONFIG_SPEC_ENV "ONLPIE_SPEC"
+#endif
+
 
 
 /**
@@ -38,45 +38,32 @@ onlp_fani_init(void)
  * Get the fan information.
  */
 
-/* Static fan information */
-onlp_fan_info_t finfo[] = {
-    { }, /* Not used */
-    {
-        { ONLP_FAN_ID_CREATE(1), "Chassis Fan 1", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        9000,
-        100,
-        ONLP_FAN_MODE_MAX,
-        "FAN1Model",
-        "FAN1SerialNumber",
-    },
-    {
-        { ONLP_FAN_ID_CREATE(2), "Chassis Fan 2", 0 },
-        0x0,
-    },
-    {
-        { ONLP_FAN_ID_CREATE(3), "PSU-1 Fan 1", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        5004,
-        50,
-        ONLP_FAN_MODE_NORMAL,
-    },
-    {
-        { ONLP_FAN_ID_CREATE(3), "PSU-1 Fan 2", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        5020,
-        50,
-        ONLP_FAN_MODE_NORMAL,
-    },
-};
-
 int
 onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
 {
-    *info = finfo[ONLP_OID_ID_GET(id)];
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->fans, id);
+
+    if(index < 0) {
+        return index;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_FAN));
+
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    ONLPIE_SNPRINTF(info->hdr.description, sizeof(info->hdr.description),
+                    "Chassis Fan %d", index);
+
+    if(spec->fans.present[index]) {
+        info->status = ONLP_FAN_STATUS_PRESENT | ONLP_FAN_STATUS_F2B;
+        info->caps = ONLP_FAN_CAPS_F2B | ONLP_FAN_CAPS_SET_PERCENTAGE |
+            ONLP_FAN_CAPS_GET_RPM | ONLP_FAN_CAPS_GET_PERCENTAGE;
+        info->percentage = spec->fan_percentage[index];
+        info->rpm = info->percentage * 200;
+        info->mode = ONLP_FAN_MODE_NORMAL;
+        ONLPIE_SNPRINTF(info->model, sizeof(info->model), "FAN%dModel", index);
+        ONLPIE_SNPRINTF(info->serial, sizeof(info->serial), "FAN%dSerialNumber", index);
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -106,7 +93,18 @@ onlp_fani_rpm_set(onlp_oid_t id, int rpm)
 int
 onlp_fani_percentage_set(onlp_oid_t id, int p)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->fans, id);
+
+    if(index < 0) {
+        return index;
+    }
+    if(p < 0 || p > 100) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_FAN_SET));
+    spec->fan_percentage[index] = p;
+    return ONLP_STATUS_OK;
 }
 
 /*
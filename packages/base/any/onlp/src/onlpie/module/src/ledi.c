@@ -24,6 +24,11 @@
 #include <onlp/platformi/ledi.h>
 #include "onlpie_int.h"
 
+#define ONLPIE_LED_CAPS                                                 \
+    (ONLP_LED_CAPS_ON_OFF | ONLP_LED_CAPS_GREEN |                       \
+     ONLP_LED_CAPS_GREEN_BLINKING | ONLP_LED_CAPS_ORANGE |              \
+     ONLP_LED_CAPS_ORANGE_BLINKING)
+
 /*
  * This function will be called prior to any other onlp_ledi_* functions.
  */
@@ -36,25 +41,30 @@ onlp_ledi_init(void)
 /*
  * Get the information for the given LED OID.
  */
-static onlp_led_info_t linfo[] =
-    {
-        { }, /* Not used */
-        {
-            { ONLP_LED_ID_CREATE(1), "Chassis LED 1", 0 },
-            0x1,
-            ONLP_LED_CAPS_ON_OFF | ONLP_LED_CAPS_RED | ONLP_LED_CAPS_RED_BLINKING,
-            ONLP_LED_MODE_RED
-        },
-        {
-            { ONLP_LED_ID_CREATE(2), "Chassis LED 2", 0 },
-            0x0,
-        },
-    };
-
 int
 onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
 {
-    *info = linfo[ONLP_OID_ID_GET(id)];
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->leds, id);
+
+    if(index < 0) {
+        return index;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_LED));
+
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    ONLPIE_SNPRINTF(info->hdr.description, sizeof(info->hdr.description),
+                    "Chassis LED %d", index);
+
+    if(spec->leds.present[index]) {
+        info->status = ONLP_LED_STATUS_PRESENT;
+        info->caps = ONLPIE_LED_CAPS;
+        info->mode = spec->led_mode[index];
+        if(info->mode != ONLP_LED_MODE_OFF) {
+            info->status |= ONLP_LED_STATUS_ON;
+        }
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -70,7 +80,7 @@ onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
 int
 onlp_ledi_set(onlp_oid_t id, int on_or_off)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    return onlp_ledi_mode_set(id, on_or_off ? ONLP_LED_MODE_GREEN : ONLP_LED_MODE_OFF);
 }
 
 /*
@@ -82,7 +92,19 @@ onlp_ledi_set(onlp_oid_t id, int on_or_off)
 int
 onlp_ledi_mode_set(onlp_oid_t id, onlp_led_mode_t mode)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->leds, id);
+
+    if(index < 0) {
+        return index;
+    }
+    if(mode != ONLP_LED_MODE_OFF && mode != ONLP_LED_MODE_ON &&
+       !(ONLPIE_LED_CAPS & (1 << mode))) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_LED_SET));
+    spec->led_mode[index] = mode;
+    return ONLP_STATUS_OK;
 }
 
 /*
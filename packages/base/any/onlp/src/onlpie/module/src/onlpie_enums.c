@@ -24,7 +24,137 @@
  ***********************************************************/
 
 #include <onlpie/onlpie_config.h>
+#include "onlpie_int.h"
 
-/* <--auto.start.enum(ALL).source> */
+/* <auto.start.enum(ALL).source> */
+aim_map_si_t onlpie_op_map[] =
+{
+    { "SYS", ONLPIE_OP_SYS },
+    { "THERMAL", ONLPIE_OP_THERMAL },
+    { "FAN", ONLPIE_OP_FAN },
+    { "FAN_SET", ONLPIE_OP_FAN_SET },
+    { "PSU", ONLPIE_OP_PSU },
+    { "LED", ONLPIE_OP_LED },
+    { "LED_SET", ONLPIE_OP_LED_SET },
+    { "SFP_PRESENCE", ONLPIE_OP_SFP_PRESENCE },
+    { "SFP_EEPROM", ONLPIE_OP_SFP_EEPROM },
+    { "SFP_DOM", ONLPIE_OP_SFP_DOM },
+    { "SFP_DEV", ONLPIE_OP_SFP_DEV },
+    { "SFP_CONTROL", ONLPIE_OP_SFP_CONTROL },
+    { NULL, 0 }
+};
+
+aim_map_si_t onlpie_op_desc_map[] =
+{
+    { "None", ONLPIE_OP_SYS },
+    { "None", ONLPIE_OP_THERMAL },
+    { "None", ONLPIE_OP_FAN },
+    { "None", ONLPIE_OP_FAN_SET },
+    { "None", ONLPIE_OP_PSU },
+    { "None", ONLPIE_OP_LED },
+    { "None", ONLPIE_OP_LED_SET },
+    { "None", ONLPIE_OP_SFP_PRESENCE },
+    { "None", ONLPIE_OP_SFP_EEPROM },
+    { "None", ONLPIE_OP_SFP_DOM },
+    { "None", ONLPIE_OP_SFP_DEV },
+    { "None", ONLPIE_OP_SFP_CONTROL },
+    { NULL, 0 }
+};
+
+const char*
+onlpie_op_name(onlpie_op_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlpie_op_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlpie_op'";
+    }
+}
+
+int
+onlpie_op_value(const char* str, onlpie_op_t* e, int substr)
+{
+    int i;
+    AIM_REFERENCE(substr);
+    if(aim_map_si_s(&i, str, onlpie_op_map, 0)) {
+        /* Enum Found */
+        *e = i;
+        return 0;
+    }
+    else {
+        return -1;
+    }
+}
+
+const char*
+onlpie_op_desc(onlpie_op_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlpie_op_desc_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlpie_op'";
+    }
+}
+
+aim_map_si_t onlpie_port_type_map[] =
+{
+    { "SFP", ONLPIE_PORT_TYPE_SFP },
+    { "QSFP", ONLPIE_PORT_TYPE_QSFP },
+    { "QSFP28", ONLPIE_PORT_TYPE_QSFP28 },
+    { "QSFP_DD", ONLPIE_PORT_TYPE_QSFP_DD },
+    { NULL, 0 }
+};
+
+aim_map_si_t onlpie_port_type_desc_map[] =
+{
+    { "None", ONLPIE_PORT_TYPE_SFP },
+    { "None", ONLPIE_PORT_TYPE_QSFP },
+    { "None", ONLPIE_PORT_TYPE_QSFP28 },
+    { "None", ONLPIE_PORT_TYPE_QSFP_DD },
+    { NULL, 0 }
+};
+
+const char*
+onlpie_port_type_name(onlpie_port_type_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlpie_port_type_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlpie_port_type'";
+    }
+}
+
+int
+onlpie_port_type_value(const char* str, onlpie_port_type_t* e, int substr)
+{
+    int i;
+    AIM_REFERENCE(substr);
+    if(aim_map_si_s(&i, str, onlpie_port_type_map, 0)) {
+        /* Enum Found */
+        *e = i;
+        return 0;
+    }
+    else {
+        return -1;
+    }
+}
+
+const char*
+onlpie_port_type_desc(onlpie_port_type_t e)
+{
+    const char* name;
+    if(aim_map_si_i(&name, e, onlpie_port_type_desc_map, 0)) {
+        return name;
+    }
+    else {
+        return "-invalid value for enum type 'onlpie_port_type'";
+    }
+}
 /* <auto.end.enum(ALL).source> */
 
@@ -27,6 +27,182 @@
 #define __ONLPIE_INT_H__
 
 #include <onlpie/onlpie_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/sfp.h>
+#include <onlp/led.h>
+
+/* <auto.start.enum(tag:onlpie).define> */
+/** onlpie_op */
+typedef enum onlpie_op_e {
+    ONLPIE_OP_SYS,
+    ONLPIE_OP_THERMAL,
+    ONLPIE_OP_FAN,
+    ONLPIE_OP_FAN_SET,
+    ONLPIE_OP_PSU,
+    ONLPIE_OP_LED,
+    ONLPIE_OP_LED_SET,
+    ONLPIE_OP_SFP_PRESENCE,
+    ONLPIE_OP_SFP_EEPROM,
+    ONLPIE_OP_SFP_DOM,
+    ONLPIE_OP_SFP_DEV,
+    ONLPIE_OP_SFP_CONTROL,
+    ONLPIE_OP_LAST = ONLPIE_OP_SFP_CONTROL,
+    ONLPIE_OP_COUNT,
+    ONLPIE_OP_INVALID = -1,
+} onlpie_op_t;
+
+/** onlpie_port_type */
+typedef enum onlpie_port_type_e {
+    ONLPIE_PORT_TYPE_SFP,
+    ONLPIE_PORT_TYPE_QSFP,
+    ONLPIE_PORT_TYPE_QSFP28,
+    ONLPIE_PORT_TYPE_QSFP_DD,
+    ONLPIE_PORT_TYPE_LAST = ONLPIE_PORT_TYPE_QSFP_DD,
+    ONLPIE_PORT_TYPE_COUNT,
+    ONLPIE_PORT_TYPE_INVALID = -1,
+} onlpie_port_type_t;
+/* <auto.end.enum(tag:onlpie).define> */
+
+/**
+ * Synthetic platform specification.
+ *
+ * The specification is read from ONLPIE_CONFIG_SPEC_FILENAME
+ * (or the file named by ONLPIE_CONFIG_SPEC_ENV):
+ *
+ * {
+ *     "thermals" : 8,
+ *     "fans" : { "count" : 6, "absent" : [ 6 ] },
+ *     "psus" : 2,
+ *     "leds" : 4,
+ *     "ports" : {
+ *         "base" : 1, "count" : 128, "type" : "qsfp28",
+ *         "present" : "all", "rx_los" : [ 3, 4 ]
+ *     },
+ *     "latency" : { "sfp_eeprom" : 2000, "thermal" : 150 },
+ *     "errors" : { "sfp_eeprom" : 0.001 },
+ *     "seed" : 1
+ * }
+ *
+ * Latencies are in microseconds. Error rates are the probability
+ * that an operation fails with ONLP_STATUS_E_INTERNAL. Without a
+ * specification the example platform is simulated.
+ */
+typedef struct onlpie_oid_spec_s {
+    /** Number of objects */
+    int count;
+    /** Per-object presence, indexed by OID id (1..count) */
+    uint8_t* present;
+} onlpie_oid_spec_t;
+
+typedef struct onlpie_port_s {
+    int present;
+    int rx_los;
+    int controls[ONLP_SFP_CONTROL_COUNT];
+    /** Device 0x50 */
+    uint8_t eeprom[256];
+    /** Device 0x51 */
+    uint8_t dom[256];
+    /** Device 0x50 upper page 03h, selected by writing 3 to byte 127 */
+    uint8_t page3[128];
+} onlpie_port_t;
+
+typedef struct onlpie_spec_s {
+    onlpie_oid_spec_t thermals;
+    onlpie_oid_spec_t fans;
+    onlpie_oid_spec_t psus;
+    onlpie_oid_spec_t leds;
+
+    int port_base;
+    int port_count;
+    onlpie_port_type_t port_type;
+    /** Indexed by (port - port_base) */
+    onlpie_port_t* ports;
+
+    /** Per-operation latency (usecs) */
+    uint32_t latency[ONLPIE_OP_COUNT];
+    /** Per-operation error rate (0..1) */
+    double errors[ONLPIE_OP_COUNT];
+    unsigned int seed;
+
+    /** Current fan percentages, indexed by fan id */
+    int* fan_percentage;
+    /** Current LED modes, indexed by LED id */
+    onlp_led_mode_t* led_mode;
+} onlpie_spec_t;
+
+/**
+ * @brief Get the platform specification.
+ * @note The specification is loaded on first use.
+ */
+onlpie_spec_t* onlpie_spec_get(void);
+
+/**
+ * @brief Simulate the cost of an operation.
+ * @param op The operation.
+ * @returns ONLP_STATUS_E_INTERNAL if an error was injected.
+ */
+int onlpie_op(onlpie_op_t op);
+
+/**
+ * @brief Validate an OID against its specification.
+ * @param spec The object specification.
+ * @param id The OID.
+ * @returns The object index or ONLP_STATUS_E_INVALID.
+ */
+int onlpie_oid_index(onlpie_oid_spec_t* spec, onlp_oid_t id);
+
+/**
+ * @brief Get the simulated port state.
+ * @param port The port number.
+ * @returns The port or NULL if the port is not valid.
+ */
+onlpie_port_t* onlpie_port_get(int port);
+
+/******************************************************************************
+ *
+ * Enumeration Support Definitions.
+ *
+ * Please do not add additional code beyond this point.
+ *
+ *****************************************************************************/
+/* <auto.start.enum(tag:onlpie).supportheader> */
+/** Enum names. */
+const char* onlpie_op_name(onlpie_op_t e);
+
+/** Enum values. */
+int onlpie_op_value(const char* str, onlpie_op_t* e, int substr);
+
+/** Enum descriptions. */
+const char* onlpie_op_desc(onlpie_op_t e);
+
+/** validator */
+#define ONLPIE_OP_VALID(_e) \
+    ( (0 <= (_e)) && ((_e) <= ONLPIE_OP_SFP_CONTROL))
+
+/** onlpie_op_map table. */
+extern aim_map_si_t onlpie_op_map[];
+/** onlpie_op_desc_map table. */
+extern aim_map_si_t onlpie_op_desc_map[];
+
+/** Enum names. */
+const char* onlpie_port_type_name(onlpie_port_type_t e);
+
+/** Enum values. */
+int onlpie_port_type_value(const char* str, onlpie_port_type_t* e, int substr);
+
+/** Enum descriptions. */
+const char* onlpie_port_type_desc(onlpie_port_type_t e);
+
+/** validator */
+#define ONLPIE_PORT_TYPE_VALID(_e) \
+    ( (0 <= (_e)) && ((_e) <= ONLPIE_PORT_TYPE_QSFP_DD))
+
+/** onlpie_port_type_map table. */
+extern aim_map_si_t onlpie_port_type_map[];
+/** onlpie_port_type_desc_map table. */
+extern aim_map_si_t onlpie_port_type_desc_map[];
+/* <auto.end.enum(tag:onlpie).supportheader> */
 
 
 #endif /* __ONLPIE_INT_H__ */
@@ -25,6 +25,7 @@
 
 #include <onlpie/onlpie_config.h>
 
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 static int
@@ -37,46 +37,36 @@ onlp_psui_init(void)
 /*
  * Get all information about the given PSU oid.
  */
-static onlp_psu_info_t pinfo[] =
-    {
-        { }, /* Not used */
-        {
-            {
-                ONLP_PSU_ID_CREATE(1), "PSU-1", 0,
-                /* This PSU has 2 fans */
-                { ONLP_FAN_ID_CREATE(3), ONLP_FAN_ID_CREATE(4) }
-            },
-            "ONLPIE PSU MODEL (AC)", "ONLPIE PSU SN",
-            0x1,
-            ONLP_PSU_CAPS_AC | ONLP_PSU_CAPS_VIN | ONLP_PSU_CAPS_VOUT | ONLP_PSU_CAPS_IIN,
-            241100,
-            122200,
-            23300,
-            3440,
-            0,
-            0,
-        },
-        {
-            { ONLP_PSU_ID_CREATE(2), "PSU-2", 0 },
-            "", "",
-            0,
-        },
-        {
-            { ONLP_PSU_ID_CREATE(3), "PSU-3", 0 },
-            "ONLPIE PSU MODEL (DC)", "ONLPIE PSU SN",
-            0x1,
-            ONLP_PSU_CAPS_DC48,
-            48100,
-            12200,
-            2300
-        },
-    };
-
-
 int
 onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
 {
-    *info = pinfo[ONLP_OID_ID_GET(id)];
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->psus, id);
+
+    if(index < 0) {
+        return index;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_PSU));
+
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    ONLPIE_SNPRINTF(info->hdr.description, sizeof(info->hdr.description),
+                    "PSU-%d", index);
+
+    if(spec->psus.present[index]) {
+        ONLPIE_STRNCPY(info->model, "ONLPIE PSU MODEL (AC)", sizeof(info->model));
+        ONLPIE_SNPRINTF(info->serial, sizeof(info->serial), "ONLPIE PSU SN %d", index);
+        info->status = ONLP_PSU_STATUS_PRESENT;
+        info->caps = ONLP_PSU_CAPS_AC | ONLP_PSU_CAPS_VIN | ONLP_PSU_CAPS_VOUT |
+            ONLP_PSU_CAPS_IIN | ONLP_PSU_CAPS_IOUT | ONLP_PSU_CAPS_PIN |
+            ONLP_PSU_CAPS_POUT;
+        info->mvin = 230000;
+        info->mvout = 12000;
+        info->miin = 1500;
+        info->miout = 25000;
+        info->mpin = 345000;
+        info->mpout = 300000;
+    }
     return ONLP_STATUS_OK;
 }
 
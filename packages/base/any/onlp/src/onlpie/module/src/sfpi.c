@@ -22,6 +22,7 @@
  *
  ***********************************************************/
 #include <onlp/platformi/sfpi.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 /*
@@ -53,11 +54,13 @@ onlp_sfpi_init(void)
 int
 onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 {
-    /* We simulate 4 SFP ports -- 17, 18, 19, and 20 */
-    AIM_BITMAP_SET(bmap, 17);
-    AIM_BITMAP_SET(bmap, 18);
-    AIM_BITMAP_SET(bmap, 19);
-    AIM_BITMAP_SET(bmap, 20);
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int i;
+
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_PRESENCE));
+    for(i = 0; i < spec->port_count; i++) {
+        AIM_BITMAP_SET(bmap, spec->port_base + i);
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -72,27 +75,60 @@ onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 int
 onlp_sfpi_is_present(int port)
 {
-    /* In this example only ports 17 and 19 have SFPs inserted */
-    if(port == 17 || port == 19) {
-        return 1;
+    onlpie_port_t* p = onlpie_port_get(port);
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
     }
-    return 0;
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_PRESENCE));
+    return p->present;
 }
 
 int
 onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int i;
+
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_PRESENCE));
     AIM_BITMAP_CLR_ALL(dst);
-    AIM_BITMAP_SET(dst, 17);
-    AIM_BITMAP_SET(dst, 19);
+    for(i = 0; i < spec->port_count; i++) {
+        if(spec->ports[i].present) {
+            AIM_BITMAP_SET(dst, spec->port_base + i);
+        }
+    }
     return ONLP_STATUS_OK;
 }
 
 int
 onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int i;
+
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_PRESENCE));
     AIM_BITMAP_CLR_ALL(dst);
-    AIM_BITMAP_SET(dst, 19);
+    for(i = 0; i < spec->port_count; i++) {
+        if(spec->ports[i].present && spec->ports[i].rx_los) {
+            AIM_BITMAP_SET(dst, spec->port_base + i);
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * Return the simulated port if a module is inserted.
+ */
+static int
+port_present__(int port, onlpie_port_t** rp)
+{
+    onlpie_port_t* p = onlpie_port_get(port);
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(!p->present) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    *rp = p;
     return ONLP_STATUS_OK;
 }
 
@@ -103,14 +139,187 @@ onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
-    if(port == 17 || port == 19) {
-        /* These ports have SFPs inserted in this example */
-        return ONLP_STATUS_OK;
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_present__(port, &p));
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_EEPROM));
+    memcpy(data, p->eeprom, sizeof(p->eeprom));
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * This function reads the SFPs diagnostic data.
+ * This is device 0x51 for SFP/SFP+ and the lower page of
+ * device 0x50 for QSFP and QSFP-DD modules.
+ */
+int
+onlp_sfpi_dom_read(int port, uint8_t data[256])
+{
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_present__(port, &p));
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_DOM));
+    memcpy(data, p->dom, sizeof(p->dom));
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * Direct access to the module's devices.
+ */
+static int
+port_dev__(int port, uint8_t devaddr, onlpie_port_t** rp)
+{
+    ONLP_IF_ERROR_RETURN(port_present__(port, rp));
+    if(devaddr != 0x50 && devaddr != 0x51) {
+        return ONLP_STATUS_E_PARAM;
     }
-    else {
-        /* These ports have no SFPs inserted. */
-        return ONLP_STATUS_E_MISSING;
+    return onlpie_op(ONLPIE_OP_SFP_DEV);
+}
+
+/*
+ * The byte at a device address. Upper page 03h of device 0x50
+ * replaces upper page 00h while it is selected.
+ */
+static uint8_t*
+port_byte__(onlpie_port_t* p, uint8_t devaddr, int addr)
+{
+    if(devaddr == 0x51) {
+        return p->dom + addr;
+    }
+    if(addr >= 128 && p->eeprom[127] == 3) {
+        return p->page3 + (addr - 128);
+    }
+    return p->eeprom + addr;
+}
+
+int
+onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+{
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    return *port_byte__(p, devaddr, addr);
+}
+
+int
+onlp_sfpi_dev_writeb(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
+{
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    *port_byte__(p, devaddr, addr) = value;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
+{
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    if(addr == 255) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    /* SMBus words are little endian. */
+    return *port_byte__(p, devaddr, addr) |
+        (*port_byte__(p, devaddr, addr+1) << 8);
+}
+
+int
+onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
+{
+    onlpie_port_t* p;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    if(addr == 255) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    *port_byte__(p, devaddr, addr) = value & 0xFF;
+    *port_byte__(p, devaddr, addr+1) = value >> 8;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
+{
+    onlpie_port_t* p;
+    int i;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    if(size < 0 || addr + size > 256) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(i = 0; i < size; i++) {
+        rdata[i] = *port_byte__(p, devaddr, addr + i);
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
+{
+    onlpie_port_t* p;
+    int i;
+    ONLP_IF_ERROR_RETURN(port_dev__(port, devaddr, &p));
+    if(size < 0 || addr + size > 256) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(i = 0; i < size; i++) {
+        *port_byte__(p, devaddr, addr + i) = data[i];
     }
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * The simulated ports support the common module controls.
+ * RX_LOS reflects the specification. All others are simply stored.
+ */
+static int
+control_supported__(onlp_sfp_control_t control)
+{
+    switch(control)
+        {
+        case ONLP_SFP_CONTROL_RESET_STATE:
+        case ONLP_SFP_CONTROL_RX_LOS:
+        case ONLP_SFP_CONTROL_TX_DISABLE:
+        case ONLP_SFP_CONTROL_LP_MODE:
+            return 1;
+        default:
+            return 0;
+        }
+}
+
+int
+onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int* rv)
+{
+    if(onlpie_port_get(port) == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    *rv = control_supported__(control);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
+{
+    onlpie_port_t* p = onlpie_port_get(port);
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(!control_supported__(control) || control == ONLP_SFP_CONTROL_RX_LOS) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_CONTROL));
+    p->controls[control] = value;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value)
+{
+    onlpie_port_t* p = onlpie_port_get(port);
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(!control_supported__(control)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SFP_CONTROL));
+    *value = (control == ONLP_SFP_CONTROL_RX_LOS) ? p->rx_los : p->controls[control];
+    return ONLP_STATUS_OK;
 }
 
 /*
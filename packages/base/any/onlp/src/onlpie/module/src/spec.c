@@ -0,0 +1,544 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlpie/onlpie_config.h>
+#include <cjson_util/cjson_util.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <ctype.h>
+#include "onlpie_int.h"
+#include "onlpie_log.h"
+
+static onlpie_spec_t spec__;
+static pthread_once_t spec_once__ = PTHREAD_ONCE_INIT;
+
+static onlpie_port_t*
+port_get__(int port)
+{
+    if(port < spec__.port_base || port >= spec__.port_base + spec__.port_count) {
+        return NULL;
+    }
+    return spec__.ports + (port - spec__.port_base);
+}
+
+static void
+oid_spec_init__(onlpie_oid_spec_t* os, int count)
+{
+    int i;
+    os->count = count;
+    os->present = aim_zmalloc(count+1);
+    for(i = 1; i <= count; i++) {
+        os->present[i] = 1;
+    }
+}
+
+/*
+ * "name" : <count>
+ * "name" : { "count" : <count>, "absent" : [ <id>, ... ] }
+ */
+static void
+oid_spec_parse__(cJSON* root, const char* name, onlpie_oid_spec_t* os)
+{
+    cJSON* item = cJSON_GetObjectItem(root, name);
+    cJSON* absent;
+    int count;
+    int i;
+
+    if(item == NULL) {
+        return;
+    }
+
+    if(item->type == cJSON_Number) {
+        count = item->valueint;
+    }
+    else if(cjson_util_lookup_int(item, &count, "count") < 0) {
+        AIM_LOG_ERROR("%s: missing count", name);
+        return;
+    }
+
+    /* All objects must fit in the system OID table. */
+    if(count < 0 || count >= ONLP_OID_TABLE_SIZE) {
+        AIM_LOG_ERROR("%s: invalid count %d", name, count);
+        return;
+    }
+
+    aim_free(os->present);
+    oid_spec_init__(os, count);
+
+    if(item->type == cJSON_Object &&
+       cjson_util_lookup(item, &absent, "absent") == 0 &&
+       absent->type == cJSON_Array) {
+        for(i = 0; i < cJSON_GetArraySize(absent); i++) {
+            int id = cJSON_GetArrayItem(absent, i)->valueint;
+            if(id >= 1 && id <= count) {
+                os->present[id] = 0;
+            }
+        }
+    }
+}
+
+static int
+op_parse__(const char* name, onlpie_op_t* op)
+{
+    char upper[32];
+    int i;
+
+    for(i = 0; name[i] && i < sizeof(upper)-1; i++) {
+        upper[i] = toupper(name[i]);
+    }
+    upper[i] = 0;
+    return onlpie_op_value(upper, op, 0);
+}
+
+/*
+ * "latency" : { "<op>" : <usecs>, ... }
+ * "errors" : { "<op>" : <rate>, ... }
+ */
+static void
+op_spec_parse__(cJSON* root)
+{
+    cJSON* obj;
+    cJSON* c;
+    onlpie_op_t op;
+
+    if((obj = cJSON_GetObjectItem(root, "latency"))) {
+        for(c = obj->child; c; c = c->next) {
+            if(op_parse__(c->string, &op) < 0) {
+                AIM_LOG_ERROR("latency: unknown operation '%s'", c->string);
+                continue;
+            }
+            spec__.latency[op] = c->valueint;
+        }
+    }
+
+    if((obj = cJSON_GetObjectItem(root, "errors"))) {
+        for(c = obj->child; c; c = c->next) {
+            if(op_parse__(c->string, &op) < 0) {
+                AIM_LOG_ERROR("errors: unknown operation '%s'", c->string);
+                continue;
+            }
+            spec__.errors[op] = c->valuedouble;
+        }
+    }
+}
+
+/*
+ * "ports" : { "base" : <port>, "count" : <count>, "type" : <type>,
+ *             "present" : "all" | <count> | [ <port>, ... ],
+ *             "rx_los" : [ <port>, ... ] }
+ */
+static void
+port_spec_parse__(cJSON* root)
+{
+    cJSON* ports = cJSON_GetObjectItem(root, "ports");
+    cJSON* item;
+    char* type;
+    int base = 0;
+    int count = 0;
+    int i;
+
+    if(ports == NULL) {
+        return;
+    }
+
+    cjson_util_lookup_int(ports, &base, "base");
+    cjson_util_lookup_int(ports, &count, "count");
+
+    /* The SFP bitmap limits the number of ports. */
+    if(base < 0 || count < 0 || base + count > 256) {
+        AIM_LOG_ERROR("ports: invalid range %d..%d", base, base + count - 1);
+        return;
+    }
+
+    spec__.port_base = base;
+    spec__.port_count = count;
+    spec__.port_type = ONLPIE_PORT_TYPE_SFP;
+
+    if(cjson_util_lookup_string(ports, &type, "type") == 0) {
+        char upper[32];
+        for(i = 0; type[i] && i < sizeof(upper)-1; i++) {
+            upper[i] = (type[i] == '-') ? '_' : toupper(type[i]);
+        }
+        upper[i] = 0;
+        if(onlpie_port_type_value(upper, &spec__.port_type, 0) < 0) {
+            AIM_LOG_ERROR("ports: unknown type '%s'", type);
+        }
+    }
+
+    aim_free(spec__.ports);
+    spec__.ports = aim_zmalloc(sizeof(onlpie_port_t)*(count ? count : 1));
+
+    if((item = cJSON_GetObjectItem(ports, "present")) == NULL) {
+        /* Default to all ports populated. */
+        for(i = 0; i < count; i++) {
+            spec__.ports[i].present = 1;
+        }
+    }
+    else if(item->type == cJSON_String && !strcmp(item->valuestring, "all")) {
+        for(i = 0; i < count; i++) {
+            spec__.ports[i].present = 1;
+        }
+    }
+    else if(item->type == cJSON_Number) {
+        for(i = 0; i < count && i < item->valueint; i++) {
+            spec__.ports[i].present = 1;
+        }
+    }
+    else if(item->type == cJSON_Array) {
+        for(i = 0; i < cJSON_GetArraySize(item); i++) {
+            onlpie_port_t* p = port_get__(cJSON_GetArrayItem(item, i)->valueint);
+            if(p) {
+                p->present = 1;
+            }
+        }
+    }
+
+    if((item = cJSON_GetObjectItem(ports, "rx_los")) && item->type == cJSON_Array) {
+        for(i = 0; i < cJSON_GetArraySize(item); i++) {
+            onlpie_port_t* p = port_get__(cJSON_GetArrayItem(item, i)->valueint);
+            if(p) {
+                p->rx_los = 1;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ *
+ * Synthetic module EEPROM contents.
+ *
+ *****************************************************************************/
+
+static void
+sff_string__(uint8_t* dst, int size, const char* fmt, int arg)
+{
+    char s[32];
+    int len = snprintf(s, sizeof(s), fmt, arg);
+    memset(dst, ' ', size);
+    memcpy(dst, s, (len < size) ? len : size);
+}
+
+static uint8_t
+sff_checksum__(const uint8_t* data, int start, int end)
+{
+    uint8_t sum = 0;
+    int i;
+    for(i = start; i <= end; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static void
+sff_u16__(uint8_t* dst, uint16_t value)
+{
+    dst[0] = value >> 8;
+    dst[1] = value & 0xFF;
+}
+
+/* SFF-8472 A0h and A2h */
+static void
+eeprom_sfp__(onlpie_port_t* p, int port)
+{
+    uint8_t* e = p->eeprom;
+    uint8_t* d = p->dom;
+
+    e[0] = 0x03;                  /* SFP/SFP+ */
+    e[1] = 0x04;
+    e[2] = 0x07;                  /* LC */
+    e[3] = 0x10;                  /* 10GBASE-SR */
+    e[11] = 0x06;                 /* 64B/66B */
+    e[12] = 0x67;                 /* 10.3Gbps */
+    sff_string__(e+20, 16, "ONLPIE", 0);
+    sff_string__(e+40, 16, "ONLPIE-SFP-SR", 0);
+    sff_string__(e+56, 4, "A", 0);
+    sff_u16__(e+60, 850);         /* Wavelength */
+    e[63] = sff_checksum__(e, 0, 62);
+    e[65] = 0x1A;                 /* LOS, TX_FAULT, TX_DISABLE */
+    sff_string__(e+68, 16, "SFP%08d", port);
+    sff_string__(e+84, 8, "260101", 0);
+    e[92] = 0x68;                 /* DDM, internally calibrated */
+    e[93] = 0xF0;
+    e[94] = 0x08;                 /* SFF-8472 rev 12.0 */
+    e[95] = sff_checksum__(e, 64, 94);
+
+    /* Thresholds */
+    sff_u16__(d+0, 0x5F00);       /* Temp high alarm 95C */
+    sff_u16__(d+2, 0xF600);       /* Temp low alarm -10C */
+    sff_u16__(d+4, 0x5A00);       /* Temp high warning 90C */
+    sff_u16__(d+6, 0xFB00);       /* Temp low warning -5C */
+    d[95] = sff_checksum__(d, 0, 94);
+
+    /* Diagnostics */
+    sff_u16__(d+96, (30 + port % 16) << 8);
+    sff_u16__(d+98, 33000);       /* 3.3V */
+    sff_u16__(d+100, 3000);       /* 6mA */
+    sff_u16__(d+102, 5000);       /* 0.5mW */
+    sff_u16__(d+104, 4000);       /* 0.4mW */
+}
+
+/* SFF-8636 lower page and upper page 00h */
+static void
+eeprom_qsfp__(onlpie_port_t* p, int port, int qsfp28)
+{
+    uint8_t* e = p->eeprom;
+    int i;
+
+    e[0] = qsfp28 ? 0x11 : 0x0D;
+    e[1] = qsfp28 ? 0x07 : 0x00;
+
+    /* Diagnostics */
+    sff_u16__(e+22, (30 + port % 16) << 8);
+    sff_u16__(e+26, 33000);
+    for(i = 0; i < 4; i++) {
+        sff_u16__(e+34+i*2, 4000);
+        sff_u16__(e+42+i*2, 3000);
+        sff_u16__(e+50+i*2, 5000);
+    }
+
+    e[128] = e[0];
+    e[130] = 0x0C;                /* MPO */
+    if(qsfp28) {
+        e[131] = 0x80;            /* Extended compliance */
+        e[140] = 0xFF;
+        e[192] = 0x02;            /* 100GBASE-SR4 */
+        e[222] = 0x67;            /* 25.78Gbps */
+    }
+    else {
+        e[131] = 0x04;            /* 40GBASE-SR4 */
+        e[140] = 0x67;
+    }
+    e[139] = 0x05;                /* 64B/66B */
+    e[146] = 0x32;                /* OM3 100m */
+    sff_string__(e+148, 16, "ONLPIE", 0);
+    sff_string__(e+168, 16, qsfp28 ? "ONLPIE-QSFP28-SR4" : "ONLPIE-QSFP-SR4", 0);
+    sff_string__(e+184, 2, "A", 0);
+    sff_u16__(e+186, 850*20);
+    e[191] = sff_checksum__(e, 128, 190);
+    sff_string__(e+196, 16, "QSFP%08d", port);
+    sff_string__(e+212, 8, "260101", 0);
+    e[220] = 0x0C;                /* Temperature, Vcc monitoring */
+    e[223] = sff_checksum__(e, 192, 222);
+
+    /* Diagnostics live in the lower page. */
+    memcpy(p->dom, p->eeprom, sizeof(p->dom));
+
+    /* Thresholds, upper page 03h bytes 128-199 */
+    e = p->page3;
+    sff_u16__(e+0, 75 << 8);
+    sff_u16__(e+2, (uint16_t)(-5 * 256));
+    sff_u16__(e+4, 70 << 8);
+    sff_u16__(e+6, 0);
+    sff_u16__(e+16, 36300);
+    sff_u16__(e+18, 29700);
+    sff_u16__(e+20, 34650);
+    sff_u16__(e+22, 31350);
+    for(i = 48; i < 72; i += 8) {
+        /* RX power, bias, TX power */
+        int bias = (i == 56);
+        sff_u16__(e+i, bias ? 7500 : 21900);
+        sff_u16__(e+i+2, bias ? 500 : 200);
+        sff_u16__(e+i+4, bias ? 6000 : 17400);
+        sff_u16__(e+i+6, bias ? 1000 : 400);
+    }
+}
+
+/* CMIS lower page and upper page 00h */
+static void
+eeprom_qsfp_dd__(onlpie_port_t* p, int port)
+{
+    uint8_t* e = p->eeprom;
+
+    e[0] = 0x18;                  /* QSFP-DD */
+    e[1] = 0x40;                  /* CMIS 4.0 */
+    e[3] = 0x03 << 1;             /* ModuleReady */
+    sff_u16__(e+14, (30 + port % 16) << 8);
+    sff_u16__(e+16, 33000);
+
+    e[128] = 0x18;
+    sff_string__(e+129, 16, "ONLPIE", 0);
+    sff_string__(e+148, 16, "ONLPIE-QSFPDD-SR8", 0);
+    sff_string__(e+164, 2, "A", 0);
+    sff_string__(e+166, 16, "QSFPDD%08d", port);
+    sff_string__(e+182, 8, "260101", 0);
+    e[203] = 0x0C;                /* MPO */
+    e[222] = sff_checksum__(e, 128, 221);
+
+    memcpy(p->dom, p->eeprom, sizeof(p->dom));
+}
+
+static void
+eeprom_init__(void)
+{
+    int i;
+    for(i = 0; i < spec__.port_count; i++) {
+        onlpie_port_t* p = spec__.ports + i;
+        int port = spec__.port_base + i;
+        switch(spec__.port_type)
+            {
+            case ONLPIE_PORT_TYPE_QSFP:
+                eeprom_qsfp__(p, port, 0);
+                break;
+            case ONLPIE_PORT_TYPE_QSFP28:
+                eeprom_qsfp__(p, port, 1);
+                break;
+            case ONLPIE_PORT_TYPE_QSFP_DD:
+                eeprom_qsfp_dd__(p, port);
+                break;
+            default:
+                eeprom_sfp__(p, port);
+                break;
+            }
+    }
+}
+
+/*
+ * The example platform, used when no specification is provided.
+ */
+static void
+oid_spec_default__(void)
+{
+    aim_free(spec__.thermals.present);
+    aim_free(spec__.fans.present);
+    aim_free(spec__.psus.present);
+    aim_free(spec__.leds.present);
+
+    oid_spec_init__(&spec__.thermals, 2);
+    spec__.thermals.present[2] = 0;
+    oid_spec_init__(&spec__.fans, 2);
+    spec__.fans.present[2] = 0;
+    oid_spec_init__(&spec__.psus, 3);
+    spec__.psus.present[2] = 0;
+    oid_spec_init__(&spec__.leds, 2);
+    spec__.leds.present[2] = 0;
+}
+
+static void
+spec_default__(void)
+{
+    oid_spec_default__();
+
+    /* 4 SFP ports -- 17, 18, 19, and 20. Only 17 and 19 are populated. */
+    spec__.port_base = 17;
+    spec__.port_count = 4;
+    spec__.port_type = ONLPIE_PORT_TYPE_SFP;
+    spec__.ports = aim_zmalloc(sizeof(onlpie_port_t)*4);
+    spec__.ports[0].present = 1;
+    spec__.ports[2].present = 1;
+    spec__.ports[2].rx_los = 1;
+}
+
+static void
+spec_load__(void)
+{
+    const char* fname;
+    cJSON* root = NULL;
+    int i;
+
+    spec_default__();
+
+    fname = getenv(ONLPIE_CONFIG_SPEC_ENV);
+    if(fname == NULL) {
+        fname = ONLPIE_CONFIG_SPEC_FILENAME;
+    }
+
+    if(access(fname, R_OK) == 0) {
+        if(cjson_util_parse_file(fname, &root) < 0 || root == NULL) {
+            AIM_LOG_ERROR("Could not parse platform specification %s", fname);
+        }
+        else {
+            oid_spec_parse__(root, "thermals", &spec__.thermals);
+            oid_spec_parse__(root, "fans", &spec__.fans);
+            oid_spec_parse__(root, "psus", &spec__.psus);
+            oid_spec_parse__(root, "leds", &spec__.leds);
+            i = spec__.thermals.count + spec__.fans.count +
+                spec__.psus.count + spec__.leds.count;
+            /* All objects must fit in the system OID table together. */
+            if(i >= ONLP_OID_TABLE_SIZE) {
+                AIM_LOG_ERROR("%s: %d objects do not fit in the OID table (maximum %d). Using the default objects.",
+                              fname, i, ONLP_OID_TABLE_SIZE - 1);
+                oid_spec_default__();
+            }
+            port_spec_parse__(root);
+            op_spec_parse__(root);
+            cjson_util_lookup_int(root, (int*)&spec__.seed, "seed");
+            cJSON_Delete(root);
+        }
+    }
+
+    eeprom_init__();
+
+    spec__.fan_percentage = aim_zmalloc(sizeof(int)*(spec__.fans.count+1));
+    for(i = 1; i <= spec__.fans.count; i++) {
+        spec__.fan_percentage[i] = 50;
+    }
+    spec__.led_mode = aim_zmalloc(sizeof(onlp_led_mode_t)*(spec__.leds.count+1));
+    for(i = 1; i <= spec__.leds.count; i++) {
+        spec__.led_mode[i] = ONLP_LED_MODE_GREEN;
+    }
+}
+
+onlpie_spec_t*
+onlpie_spec_get(void)
+{
+    pthread_once(&spec_once__, spec_load__);
+    return &spec__;
+}
+
+int
+onlpie_op(onlpie_op_t op)
+{
+    onlpie_spec_t* spec = onlpie_spec_get();
+
+    if(spec->latency[op]) {
+        usleep(spec->latency[op]);
+    }
+
+    /*
+     * The seed is shared by all callers without locking.
+     * This only affects the reproducibility of concurrent runs.
+     */
+    if(spec->errors[op] > 0 &&
+       rand_r(&spec->seed) < spec->errors[op] * RAND_MAX) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlpie_oid_index(onlpie_oid_spec_t* os, onlp_oid_t id)
+{
+    int index = ONLP_OID_ID_GET(id);
+    if(index < 1 || index > os->count) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    return index;
+}
+
+onlpie_port_t*
+onlpie_port_get(int port)
+{
+    onlpie_spec_get();
+    return port_get__(port);
+}
@@ -24,6 +24,7 @@
  ***********************************************************/
 #include <onlp/platformi/sysi.h>
 #include <onlplib/crc32.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 
@@ -161,26 +162,24 @@ onlp_sysi_platform_manage(void)
 int
 onlp_sysi_oids_get(onlp_oid_t* table, int max)
 {
+    onlpie_spec_t* spec = onlpie_spec_get();
     onlp_oid_t* e = table;
-    memset(table, 0, max*sizeof(onlp_oid_t));
+    int i;
 
-    /* This example supports 2 Thermal sensors on the chassis */
-    *e++ = ONLP_THERMAL_ID_CREATE(1);
-    *e++ = ONLP_THERMAL_ID_CREATE(2);
+    memset(table, 0, max*sizeof(onlp_oid_t));
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_SYS));
 
-    /* 3 PSUs */
-    *e++ = ONLP_PSU_ID_CREATE(1);
-    *e++ = ONLP_PSU_ID_CREATE(2);
-    *e++ = ONLP_PSU_ID_CREATE(3);
+#define ONLPIE_OID_ADD(_create, _count)                         \
+    for(i = 1; i <= (_count) && (e - table) < max; i++) {       \
+        *e++ = _create(i);                                      \
+    }
 
-    /* 2 Fans */
-    *e++ = ONLP_FAN_ID_CREATE(1);
-    *e++ = ONLP_FAN_ID_CREATE(2);
+    ONLPIE_OID_ADD(ONLP_THERMAL_ID_CREATE, spec->thermals.count);
+    ONLPIE_OID_ADD(ONLP_PSU_ID_CREATE, spec->psus.count);
+    ONLPIE_OID_ADD(ONLP_FAN_ID_CREATE, spec->fans.count);
+    ONLPIE_OID_ADD(ONLP_LED_ID_CREATE, spec->leds.count);
 
-    /* 2 LEDs */
-    *e++ = ONLP_LED_ID_CREATE(1);
-    *e++ = ONLP_LED_ID_CREATE(2);
+#undef ONLPIE_OID_ADD
 
     return 0;
 }
-
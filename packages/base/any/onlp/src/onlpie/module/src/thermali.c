@@ -23,6 +23,7 @@
  *
  ***********************************************************/
 #include <onlp/platformi/thermali.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 /*
@@ -49,15 +50,26 @@ onlp_thermali_init(void)
 int
 onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* rv)
 {
-    /* Static values */
-    onlp_thermal_info_t info[] = {
-        { }, /* Not used */
-        { { ONLP_THERMAL_ID_CREATE(1), "Chassis Thermal Sensor 1", 0}, 0x1,
-          ONLP_THERMAL_CAPS_ALL,
-          23100, { 35000, 50000, 60000 }, },
-        { { ONLP_THERMAL_ID_CREATE(2), "Chassis Thermal Sensor 2", 0}, 0x0, 0 }
-    };
-    *rv = info[ONLP_OID_ID_GET(id)];
+    onlpie_spec_t* spec = onlpie_spec_get();
+    int index = onlpie_oid_index(&spec->thermals, id);
 
+    if(index < 0) {
+        return index;
+    }
+    ONLP_IF_ERROR_RETURN(onlpie_op(ONLPIE_OP_THERMAL));
+
+    memset(rv, 0, sizeof(*rv));
+    rv->hdr.id = id;
+    ONLPIE_SNPRINTF(rv->hdr.description, sizeof(rv->hdr.description),
+                    "Chassis Thermal Sensor %d", index);
+
+    if(spec->thermals.present[index]) {
+        rv->status = ONLP_THERMAL_STATUS_PRESENT;
+        rv->caps = ONLP_THERMAL_CAPS_ALL;
+        rv->mcelsius = 23100 + (index % 16) * 1000;
+        rv->thresholds.warning = 55000;
+        rv->thresholds.error = 65000;
+        rv->thresholds.shutdown = 75000;
+    }
     return ONLP_STATUS_OK;
 }
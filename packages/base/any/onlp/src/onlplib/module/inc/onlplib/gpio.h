@@ -26,6 +26,7 @@
 #define __ONLP_GPIO_H__
 
 #include <onlplib/onlplib_config.h>
+#include <AIM/aim_bitmap.h>
 
 typedef enum onlp_gpio_direction_e {
     ONLP_GPIO_DIRECTION_NONE,
@@ -57,5 +58,225 @@ int onlp_gpio_set(int gpio, int v);
  */
 int onlp_gpio_get(int gpio, int* rv);
 
+#if ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV == 1
+
+/**
+ * GPIO character device support.
+ *
+ * Lines are requested from /dev/gpiochipN as a group and stay
+ * requested until released, so getting or setting every line in
+ * the group is a single ioctl() on the group's handle.
+ *
+ * Chips may be named by device path ("/dev/gpiochip2"), by device
+ * name ("gpiochip2") or by label ("pca9535").
+ */
+
+/** The maximum number of lines in one group (GPIOHANDLES_MAX). */
+#define ONLP_GPIO_LINES_MAX 64
+
+typedef struct onlp_gpio_lines_s {
+    /** Line handle */
+    int fd;
+    /** Number of lines */
+    int count;
+    /** Line offsets on the chip */
+    uint32_t offsets[ONLP_GPIO_LINES_MAX];
+    /** Last values written, bit N is line N */
+    uint64_t values;
+} onlp_gpio_lines_t;
+
+/**
+ * @brief Find the gpiochip device for the given name or label.
+ * @param chip The chip name, path or label.
+ * @param path [out] Receives the device path.
+ * @param size The size of path.
+ */
+int onlp_gpio_chip_find(const char* chip, char* path, int size);
+
+/**
+ * @brief Translate a legacy (sysfs) GPIO number.
+ * @param gpio The global gpio number.
+ * @param path [out] Receives the gpiochip device path.
+ * @param size The size of path.
+ * @param offset [out] Receives the line offset on that chip.
+ */
+int onlp_gpio_line_lookup(int gpio, char* path, int size, uint32_t* offset);
+
+/**
+ * @brief Request a group of lines.
+ * @param lines The group.
+ * @param chip The chip name, path or label.
+ * @param offsets The line offsets.
+ * @param count The number of lines.
+ * @param dir The direction. LOW and HIGH request outputs with that
+ * initial value.
+ * @param consumer The consumer label (optional).
+ */
+int onlp_gpio_lines_request(onlp_gpio_lines_t* lines, const char* chip,
+                            const uint32_t* offsets, int count,
+                            onlp_gpio_direction_t dir, const char* consumer);
+
+/**
+ * @brief Read every line in the group.
+ * @param lines The group.
+ * @param values [out] Bit N receives the value of line N.
+ */
+int onlp_gpio_lines_get(onlp_gpio_lines_t* lines, uint64_t* values);
+
+/**
+ * @brief Set lines in an output group.
+ * @param lines The group.
+ * @param mask The lines to change.
+ * @param values Bit N is the new value of line N.
+ * @note Lines outside of mask keep their last written value.
+ */
+int onlp_gpio_lines_set(onlp_gpio_lines_t* lines, uint64_t mask, uint64_t values);
+
+/**
+ * @brief Release a group of lines.
+ */
+void onlp_gpio_lines_release(onlp_gpio_lines_t* lines);
+
+
+/** Edge selection for line events. */
+#define ONLP_GPIO_EDGE_RISING  (1 << 0)
+#define ONLP_GPIO_EDGE_FALLING (1 << 1)
+#define ONLP_GPIO_EDGE_BOTH    (ONLP_GPIO_EDGE_RISING | ONLP_GPIO_EDGE_FALLING)
+
+typedef struct onlp_gpio_events_s {
+    /** Pollable descriptor, readable when any line has an event */
+    int fd;
+    /** Number of lines */
+    int count;
+    /** Per-line event descriptors */
+    int fds[ONLP_GPIO_LINES_MAX];
+} onlp_gpio_events_t;
+
+typedef struct onlp_gpio_event_s {
+    /** Index of the line within the group */
+    int line;
+    /** ONLP_GPIO_EDGE_RISING or ONLP_GPIO_EDGE_FALLING */
+    int edge;
+    /** Kernel timestamp in nanoseconds */
+    uint64_t timestamp;
+} onlp_gpio_event_t;
+
+/**
+ * @brief Request edge events on a group of input lines.
+ * @param events The group.
+ * @param chip The chip name, path or label.
+ * @param offsets The line offsets.
+ * @param count The number of lines.
+ * @param edges ONLP_GPIO_EDGE_* flags.
+ * @param consumer The consumer label (optional).
+ * @note events->fd can be added to a poll() or select() set.
+ */
+int onlp_gpio_events_request(onlp_gpio_events_t* events, const char* chip,
+                             const uint32_t* offsets, int count,
+                             int edges, const char* consumer);
+
+/**
+ * @brief Read pending events.
+ * @param events The group.
+ * @param ev [out] Receives the events.
+ * @param max The size of ev.
+ * @param timeout_ms Wait up to this long for the first event. 0 does
+ * not wait and -1 waits forever.
+ * @returns The number of events read or a negative error.
+ */
+int onlp_gpio_events_read(onlp_gpio_events_t* events, onlp_gpio_event_t* ev,
+                          int max, int timeout_ms);
+
+/**
+ * @brief Read the current value of every line in an event group.
+ * @param events The group.
+ * @param values [out] Bit N receives the value of line N.
+ */
+int onlp_gpio_events_values_get(onlp_gpio_events_t* events, uint64_t* values);
+
+/**
+ * @brief Release an event group.
+ */
+void onlp_gpio_events_release(onlp_gpio_events_t* events);
+
+
+/**
+ * Port to line mapping.
+ *
+ * SFPI drivers describe which line carries a signal for each port.
+ * The ports are grouped by chip and each chip is requested once, so
+ * reading every port is one ioctl per chip.
+ */
+typedef struct onlp_gpio_port_line_s {
+    /** Port number */
+    int port;
+    /** Chip name, path or label */
+    const char* chip;
+    /** Line offset on the chip */
+    uint32_t offset;
+    /** The signal is asserted when the line is low */
+    int active_low;
+} onlp_gpio_port_line_t;
+
+typedef struct onlp_gpio_ports_s {
+    /** One line group per chip */
+    onlp_gpio_lines_t* groups;
+    int ngroups;
+    /** Per map entry: port, group and line index */
+    struct {
+        int port;
+        int group;
+        int line;
+        int active_low;
+    } *map;
+    int count;
+} onlp_gpio_ports_t;
+
+/**
+ * @brief Request the lines for a port map.
+ * @param ports The port set.
+ * @param map The port map.
+ * @param count The number of map entries.
+ * @param dir The direction of every line.
+ * @param consumer The consumer label (optional).
+ */
+int onlp_gpio_ports_init(onlp_gpio_ports_t* ports,
+                         const onlp_gpio_port_line_t* map, int count,
+                         onlp_gpio_direction_t dir, const char* consumer);
+
+/**
+ * @brief Read the signal for every port.
+ * @param ports The port set.
+ * @param bitmap [out] Bits are set for ports where the signal is asserted.
+ * Bits for unmapped ports are not changed.
+ */
+int onlp_gpio_ports_get(onlp_gpio_ports_t* ports, aim_bitmap_hdr_t* bitmap);
+
+/**
+ * @brief Assert or deassert the signal for a set of ports.
+ * @param ports The port set.
+ * @param mask The ports to change.
+ * @param values Set for ports which should be asserted.
+ */
+int onlp_gpio_ports_set(onlp_gpio_ports_t* ports, aim_bitmap_hdr_t* mask,
+                        aim_bitmap_hdr_t* values);
+
+/**
+ * @brief Read the signal for one port.
+ */
+int onlp_gpio_port_get(onlp_gpio_ports_t* ports, int port, int* value);
+
+/**
+ * @brief Set the signal for one port.
+ */
+int onlp_gpio_port_set(onlp_gpio_ports_t* ports, int port, int value);
+
+/**
+ * @brief Release the lines for a port map.
+ */
+void onlp_gpio_ports_release(onlp_gpio_ports_t* ports);
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV */
+
 
 #endif /* __ONLP_GPIO_H__ */
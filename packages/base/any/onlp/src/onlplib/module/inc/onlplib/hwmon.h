@@ -0,0 +1,198 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * hwmon device access.
+ *
+ * A hwmon device is enumerated once when it is opened. The device
+ * directory and every channel attribute stay open, so reading a
+ * channel is a single pread() with no path lookup.
+ *
+ * The device is watched for kernel remove events. A device which
+ * has been removed is enumerated again on its next access, so
+ * re-probed drivers and renumbered hwmonN directories are followed.
+ *
+ * A device is not locked. Callers sharing one between threads
+ * must serialize access to it.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_HWMON_H__
+#define __ONLPLIB_HWMON_H__
+
+#include <onlplib/onlplib_config.h>
+#include <onlp/onlp.h>
+#include <onlp/thermal.h>
+#include <limits.h>
+
+typedef enum onlp_hwmon_type_e {
+    ONLP_HWMON_TYPE_TEMP,
+    ONLP_HWMON_TYPE_FAN,
+    ONLP_HWMON_TYPE_PWM,
+    ONLP_HWMON_TYPE_IN,
+    ONLP_HWMON_TYPE_CURR,
+    ONLP_HWMON_TYPE_POWER,
+    ONLP_HWMON_TYPE_COUNT,
+} onlp_hwmon_type_t;
+
+/** The maximum number of channels in one device. */
+#define ONLP_HWMON_CHANNELS_MAX 64
+
+typedef struct onlp_hwmon_channel_s {
+    onlp_hwmon_type_t type;
+    /** The attribute index (temp<index>_input) */
+    int index;
+    /** The attribute descriptor */
+    int fd;
+    /** The last value read */
+    int value;
+    /** The status of the last read */
+    int status;
+} onlp_hwmon_channel_t;
+
+typedef struct onlp_hwmon_stats_s {
+    /** Number of times the device was enumerated again */
+    uint64_t reopens;
+    /** Number of onlp_hwmon_read_all() passes */
+    uint64_t passes;
+    /** Attribute reads and failed reads */
+    uint64_t reads;
+    uint64_t errors;
+    /** Pass timing in nanoseconds */
+    uint64_t last_ns;
+    uint64_t max_ns;
+    uint64_t total_ns;
+} onlp_hwmon_stats_t;
+
+typedef struct onlp_hwmon_s {
+    /** The path or name the device was opened with */
+    char source[PATH_MAX];
+    int by_name;
+    /** uevent subscription */
+    int subscription;
+    /** Set when the device has been removed */
+    volatile int stale;
+
+    /** The hwmon directory */
+    char path[PATH_MAX];
+    int dirfd;
+    /** The contents of the name attribute */
+    char name[32];
+
+    /** Channels, ordered by type and index */
+    int count;
+    onlp_hwmon_channel_t channels[ONLP_HWMON_CHANNELS_MAX];
+
+    onlp_hwmon_stats_t stats;
+} onlp_hwmon_t;
+
+/**
+ * @brief Open a hwmon device.
+ * @param rv [out] Receives the device.
+ * @param fmt The hwmon directory, or a device directory containing
+ * a hwmon/hwmonN subdirectory.
+ */
+int onlp_hwmon_open(onlp_hwmon_t** rv, const char* fmt, ...);
+
+/**
+ * @brief Open the hwmon device with the given name attribute.
+ * @param rv [out] Receives the device.
+ * @param name The name (e.g. "coretemp").
+ */
+int onlp_hwmon_find(onlp_hwmon_t** rv, const char* name);
+
+/**
+ * @brief Close a hwmon device.
+ */
+void onlp_hwmon_close(onlp_hwmon_t* dev);
+
+/**
+ * @brief Get the channel number of an attribute.
+ * @param dev The device.
+ * @param type The attribute type.
+ * @param index The attribute index.
+ * @returns The channel number, or ONLP_STATUS_E_MISSING.
+ */
+int onlp_hwmon_channel(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index);
+
+/**
+ * @brief Read every channel of a device.
+ * @param dev The device.
+ * @param out [out] Optional. Receives the value of each channel,
+ * indexed by channel number.
+ * @param size The number of entries in out.
+ * @returns The number of channels read successfully.
+ */
+int onlp_hwmon_read_all(onlp_hwmon_t* dev, int* out, int size);
+
+/**
+ * @brief Read a single attribute.
+ * @param dev The device.
+ * @param type The attribute type.
+ * @param index The attribute index.
+ * @param value [out] Receives the value.
+ */
+int onlp_hwmon_read(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                    int* value);
+
+/**
+ * @brief Get the value from the last onlp_hwmon_read_all().
+ * @param dev The device.
+ * @param type The attribute type.
+ * @param index The attribute index.
+ * @param value [out] Receives the value.
+ */
+int onlp_hwmon_value_get(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                         int* value);
+
+/**
+ * @brief Get the highest value of a type from the last onlp_hwmon_read_all().
+ * @param dev The device.
+ * @param type The attribute type.
+ * @param value [out] Receives the value.
+ */
+int onlp_hwmon_value_max(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int* value);
+
+/**
+ * @brief Write a writable attribute (pwmN).
+ * @param dev The device.
+ * @param type The attribute type.
+ * @param index The attribute index.
+ * @param value The value.
+ */
+int onlp_hwmon_write(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                     int value);
+
+/**
+ * @brief Read a temperature into a thermal info structure.
+ * @param dev The device.
+ * @param index The temp attribute index.
+ * @param info [out] Receives mcelsius and status.
+ * @note Follows onlplib_thermal_read_file(). A missing device
+ * clears the present status.
+ */
+int onlp_hwmon_thermal_info_get(onlp_hwmon_t* dev, int index,
+                                onlp_thermal_info_t* info);
+
+/**
+ * @brief Show the channels and timing of a device.
+ */
+void onlp_hwmon_show(onlp_hwmon_t* dev, aim_pvs_t* pvs);
+
+#endif /* __ONLPLIB_HWMON_H__ */
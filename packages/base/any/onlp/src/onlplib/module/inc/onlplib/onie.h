@@ -90,6 +90,12 @@ int onlp_onie_decode_file(onlp_onie_info_t* rv, const char* file);
  */
 void onlp_onie_info_free(onlp_onie_info_t* info);
 
+/**
+ * Copy an ONIE info structure.
+ * The destination must be released with onlp_onie_info_free().
+ */
+int onlp_onie_info_copy(onlp_onie_info_t* dst, const onlp_onie_info_t* src);
+
 /**
  * Show the contents of an ONIE info structure.
  */
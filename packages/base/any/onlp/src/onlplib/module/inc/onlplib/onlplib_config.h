@@ -165,6 +165,26 @@
 #define ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS 0
 #endif
 
+/**
+ * ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV
+ *
+ * Include GPIO character device (/dev/gpiochipN) support. Requires userspace kernel headers (linux-libc-dev) from 4.8 or later. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV
+#define ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV 0
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_UEVENT
+ *
+ * Include the kernel uevent listener. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_UEVENT
+#define ONLPLIB_CONFIG_INCLUDE_UEVENT 1
+#endif
+
 
 
 /**
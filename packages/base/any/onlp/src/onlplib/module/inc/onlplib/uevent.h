@@ -0,0 +1,123 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Kernel uevent listener.
+ *
+ * A single thread receives kernel uevents from the
+ * NETLINK_KOBJECT_UEVENT socket and passes each one to the
+ * subscribers whose subsystem and devpath prefix match.
+ *
+ * The thread is started by the first subscription.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_UEVENT_H__
+#define __ONLPLIB_UEVENT_H__
+
+#include <onlplib/onlplib_config.h>
+#include <onlp/onlp.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+
+/** The maximum number of environment variables kept per event. */
+#define ONLP_UEVENT_ENV_MAX 32
+
+/** The maximum number of subscriptions. */
+#define ONLP_UEVENT_SUBSCRIPTIONS_MAX 64
+
+typedef struct onlp_uevent_s {
+    /**
+     * add, remove, change, move, bind, unbind...
+     * "overrun" when events have been lost. It is passed to
+     * every subscriber with a devpath of "/".
+     */
+    const char* action;
+    /** The device path relative to /sys (e.g. /devices/...) */
+    const char* devpath;
+    /** The subsystem, or NULL */
+    const char* subsystem;
+    /** The driver (bind and unbind), or NULL */
+    const char* driver;
+    uint64_t seqnum;
+
+    /** All KEY=VALUE pairs */
+    const char* env[ONLP_UEVENT_ENV_MAX];
+    int env_count;
+} onlp_uevent_t;
+
+/**
+ * Subscriber callback.
+ * Called on the listener thread. The event is only valid
+ * for the duration of the call.
+ */
+typedef void (*onlp_uevent_handler_f)(const onlp_uevent_t* event, void* cookie);
+
+/**
+ * @brief Subscribe to uevents.
+ * @param subsystem Only events from this subsystem, or NULL for all.
+ * @param devpath Only events whose devpath starts with this prefix,
+ * or NULL for all. Paths under /sys and symlinks (such as
+ * /sys/bus/i2c/devices/N-00XX) are resolved when subscribing.
+ * @param handler The callback.
+ * @param cookie Passed to the callback.
+ * @returns A subscription id, or an error.
+ */
+int onlp_uevent_subscribe(const char* subsystem, const char* devpath,
+                          onlp_uevent_handler_f handler, void* cookie);
+
+/**
+ * @brief Cancel a subscription.
+ * @param id The subscription id.
+ * @note The handler is not running when this returns, unless it
+ * is called from the handler itself.
+ */
+int onlp_uevent_unsubscribe(int id);
+
+/**
+ * @brief Get the value of an event variable.
+ * @param event The event.
+ * @param key The variable name.
+ * @returns The value, or NULL.
+ */
+const char* onlp_uevent_get(const onlp_uevent_t* event, const char* key);
+
+/**
+ * @brief Resolve a sysfs path to the devpath used in uevents.
+ * @param path A path under /sys, or a devpath.
+ * @param rv Receives the devpath.
+ * @param size The size of rv.
+ */
+int onlp_uevent_devpath(const char* path, char* rv, int size);
+
+/**
+ * @brief Stop the listener thread.
+ * @note Subscriptions are kept and the thread restarts
+ * with the next subscription.
+ */
+void onlp_uevent_stop(void);
+
+/**
+ * @brief Show the listener state and counters.
+ */
+void onlp_uevent_show(aim_pvs_t* pvs);
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_UEVENT */
+
+#endif /* __ONLPLIB_UEVENT_H__ */
@@ -88,3 +88,566 @@ onlp_gpio_get(int gpio, int* v)
     return onlp_file_read_int(v, SYS_CLASS_GPIO_PATH "/value", gpio);
 }
 
+
+#if ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV == 1
+
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <linux/version.h>
+#if LINUX_VERSION_CODE < KERNEL_VERSION(4,8,0)
+#error "ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV needs linux-libc-dev 4.8 or later."
+#endif
+#include <linux/gpio.h>
+#include <poll.h>
+
+#define SYS_CLASS_GPIOCHIP_PATH "/sys/class/gpio/gpiochip%d"
+
+static int
+gpio_chip_label_match__(const char* path, const char* label)
+{
+    struct gpiochip_info info;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    int rv = 0;
+    if(fd >= 0) {
+        if(ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0) {
+            rv = !strncmp(info.label, label, sizeof(info.label));
+        }
+        close(fd);
+    }
+    return rv;
+}
+
+int
+onlp_gpio_chip_find(const char* chip, char* path, int size)
+{
+    DIR* dir;
+    struct dirent* de;
+
+    if(chip == NULL || path == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(chip[0] == '/') {
+        ONLPLIB_SNPRINTF(path, size, "%s", chip);
+        return (access(path, R_OK) == 0) ? 0 : ONLP_STATUS_E_MISSING;
+    }
+
+    if(!strncmp(chip, "gpiochip", 8)) {
+        ONLPLIB_SNPRINTF(path, size, "/dev/%s", chip);
+        if(access(path, R_OK) == 0) {
+            return 0;
+        }
+    }
+
+    /* Search by label */
+    if((dir = opendir("/dev")) == NULL) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    while((de = readdir(dir))) {
+        if(strncmp(de->d_name, "gpiochip", 8)) {
+            continue;
+        }
+        ONLPLIB_SNPRINTF(path, size, "/dev/%s", de->d_name);
+        if(gpio_chip_label_match__(path, chip)) {
+            closedir(dir);
+            return 0;
+        }
+    }
+    closedir(dir);
+    AIM_LOG_ERROR("gpio chip '%s' not found.", chip);
+    return ONLP_STATUS_E_MISSING;
+}
+
+int
+onlp_gpio_line_lookup(int gpio, char* path, int size, uint32_t* offset)
+{
+    DIR* dir;
+    struct dirent* de;
+    int rv = ONLP_STATUS_E_MISSING;
+
+    /*
+     * Legacy numbers are <chip base> + <offset>. The sysfs class still
+     * reports each chip's base and size even when nothing is exported.
+     */
+    if((dir = opendir("/sys/class/gpio")) == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    while((de = readdir(dir))) {
+        int n, base, ngpio;
+        if(sscanf(de->d_name, "gpiochip%d", &n) != 1) {
+            continue;
+        }
+        if(onlp_file_read_int(&base, SYS_CLASS_GPIOCHIP_PATH "/base", n) < 0 ||
+           onlp_file_read_int(&ngpio, SYS_CLASS_GPIOCHIP_PATH "/ngpio", n) < 0) {
+            continue;
+        }
+        if(gpio >= base && gpio < base + ngpio) {
+            char* label = NULL;
+            /* The sysfs chip number is not the character device number. */
+            if(onlp_file_read_str(&label, SYS_CLASS_GPIOCHIP_PATH "/label", n) >= 0) {
+                rv = onlp_gpio_chip_find(label, path, size);
+                aim_free(label);
+            }
+            if(rv >= 0) {
+                *offset = gpio - base;
+            }
+            break;
+        }
+    }
+    closedir(dir);
+    return rv;
+}
+
+int
+onlp_gpio_lines_request(onlp_gpio_lines_t* lines, const char* chip,
+                        const uint32_t* offsets, int count,
+                        onlp_gpio_direction_t dir, const char* consumer)
+{
+    struct gpiohandle_request req;
+    char path[64];
+    int fd, i, rv;
+
+    if(lines == NULL || offsets == NULL || count <= 0 ||
+       count > ONLP_GPIO_LINES_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if((rv = onlp_gpio_chip_find(chip, path, sizeof(path))) < 0) {
+        return rv;
+    }
+
+    memset(&req, 0, sizeof(req));
+    for(i = 0; i < count; i++) {
+        req.lineoffsets[i] = offsets[i];
+    }
+    req.lines = count;
+    ONLPLIB_SNPRINTF(req.consumer_label, sizeof(req.consumer_label), "%s",
+                     consumer ? consumer : "onlp");
+
+    switch(dir)
+        {
+        case ONLP_GPIO_DIRECTION_NONE: break;
+        case ONLP_GPIO_DIRECTION_IN: req.flags = GPIOHANDLE_REQUEST_INPUT; break;
+        case ONLP_GPIO_DIRECTION_OUT:
+        case ONLP_GPIO_DIRECTION_LOW: req.flags = GPIOHANDLE_REQUEST_OUTPUT; break;
+        case ONLP_GPIO_DIRECTION_HIGH:
+            req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+            memset(req.default_values, 1, count);
+            break;
+        default:
+            return ONLP_STATUS_E_PARAM;
+        }
+
+    if((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("open(%s): %{errno}", path, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    rv = ioctl(fd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+    close(fd);
+    if(rv < 0) {
+        AIM_LOG_ERROR("%s: requesting %d lines failed: %{errno}",
+                      path, count, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    lines->fd = req.fd;
+    lines->count = count;
+    memcpy(lines->offsets, offsets, count * sizeof(offsets[0]));
+    lines->values = (dir == ONLP_GPIO_DIRECTION_HIGH) ?
+        ((count == 64) ? ~0ULL : ((1ULL << count) - 1)) : 0;
+    return 0;
+}
+
+int
+onlp_gpio_lines_get(onlp_gpio_lines_t* lines, uint64_t* values)
+{
+    struct gpiohandle_data data;
+    int i;
+
+    if(lines == NULL || lines->fd < 0 || values == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(ioctl(lines->fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+        AIM_LOG_ERROR("gpio line read failed: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *values = 0;
+    for(i = 0; i < lines->count; i++) {
+        if(data.values[i]) {
+            *values |= (1ULL << i);
+        }
+    }
+    return 0;
+}
+
+int
+onlp_gpio_lines_set(onlp_gpio_lines_t* lines, uint64_t mask, uint64_t values)
+{
+    struct gpiohandle_data data;
+    uint64_t v;
+    int i;
+
+    if(lines == NULL || lines->fd < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /* The kernel sets every line in the handle, so merge with the last values. */
+    v = (lines->values & ~mask) | (values & mask);
+    memset(&data, 0, sizeof(data));
+    for(i = 0; i < lines->count; i++) {
+        data.values[i] = (v >> i) & 1;
+    }
+    if(ioctl(lines->fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+        AIM_LOG_ERROR("gpio line write failed: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    lines->values = v;
+    return 0;
+}
+
+void
+onlp_gpio_lines_release(onlp_gpio_lines_t* lines)
+{
+    if(lines && lines->fd >= 0) {
+        close(lines->fd);
+        lines->fd = -1;
+        lines->count = 0;
+    }
+}
+
+
+void
+onlp_gpio_events_release(onlp_gpio_events_t* events)
+{
+    int i;
+    if(events == NULL) {
+        return;
+    }
+    for(i = 0; i < events->count; i++) {
+        if(events->fds[i] >= 0) {
+            close(events->fds[i]);
+        }
+    }
+    if(events->fd >= 0) {
+        close(events->fd);
+    }
+    events->fd = -1;
+    events->count = 0;
+}
+
+int
+onlp_gpio_events_request(onlp_gpio_events_t* events, const char* chip,
+                         const uint32_t* offsets, int count,
+                         int edges, const char* consumer)
+{
+    char path[64];
+    int fd, i, rv;
+
+    if(events == NULL || offsets == NULL || count <= 0 ||
+       count > ONLP_GPIO_LINES_MAX || (edges & ONLP_GPIO_EDGE_BOTH) == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if((rv = onlp_gpio_chip_find(chip, path, sizeof(path))) < 0) {
+        return rv;
+    }
+
+    memset(events, 0, sizeof(*events));
+    events->fd = epoll_create1(EPOLL_CLOEXEC);
+    if(events->fd < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    if((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("open(%s): %{errno}", path, errno);
+        onlp_gpio_events_release(events);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    /* The v1 interface has one event descriptor per line. */
+    for(i = 0; i < count; i++) {
+        struct gpioevent_request req;
+        struct epoll_event ev;
+
+        memset(&req, 0, sizeof(req));
+        req.lineoffset = offsets[i];
+        req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+        req.eventflags =
+            ((edges & ONLP_GPIO_EDGE_RISING) ? GPIOEVENT_REQUEST_RISING_EDGE : 0) |
+            ((edges & ONLP_GPIO_EDGE_FALLING) ? GPIOEVENT_REQUEST_FALLING_EDGE : 0);
+        ONLPLIB_SNPRINTF(req.consumer_label, sizeof(req.consumer_label), "%s",
+                         consumer ? consumer : "onlp");
+
+        if(ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &req) < 0) {
+            AIM_LOG_ERROR("%s: requesting events on line %u failed: %{errno}",
+                          path, offsets[i], errno);
+            break;
+        }
+        events->fds[events->count++] = req.fd;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if(epoll_ctl(events->fd, EPOLL_CTL_ADD, req.fd, &ev) < 0) {
+            break;
+        }
+    }
+    close(fd);
+
+    if(i != count) {
+        onlp_gpio_events_release(events);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+int
+onlp_gpio_events_read(onlp_gpio_events_t* events, onlp_gpio_event_t* ev,
+                      int max, int timeout_ms)
+{
+    struct epoll_event ready[ONLP_GPIO_LINES_MAX];
+    int n, i, count = 0;
+
+    if(events == NULL || events->fd < 0 || ev == NULL || max <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    n = epoll_wait(events->fd, ready, AIM_ARRAYSIZE(ready), timeout_ms);
+    if(n < 0) {
+        return (errno == EINTR) ? 0 : ONLP_STATUS_E_INTERNAL;
+    }
+
+    for(i = 0; i < n && count < max; i++) {
+        int line = ready[i].data.u32;
+        struct gpioevent_data data[16];
+        int want = max - count;
+        ssize_t len;
+        int j;
+
+        if(want > AIM_ARRAYSIZE(data)) {
+            want = AIM_ARRAYSIZE(data);
+        }
+        /* Event descriptors return whole records only. */
+        len = read(events->fds[line], data, want * sizeof(data[0]));
+        if(len < 0) {
+            continue;
+        }
+        for(j = 0; j < len / (ssize_t)sizeof(data[0]); j++) {
+            ev[count].line = line;
+            ev[count].edge = (data[j].id == GPIOEVENT_EVENT_RISING_EDGE) ?
+                ONLP_GPIO_EDGE_RISING : ONLP_GPIO_EDGE_FALLING;
+            ev[count].timestamp = data[j].timestamp;
+            count++;
+        }
+    }
+    return count;
+}
+
+int
+onlp_gpio_events_values_get(onlp_gpio_events_t* events, uint64_t* values)
+{
+    int i;
+
+    if(events == NULL || events->fd < 0 || values == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    *values = 0;
+    for(i = 0; i < events->count; i++) {
+        struct gpiohandle_data data;
+        if(ioctl(events->fds[i], GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        if(data.values[0]) {
+            *values |= (1ULL << i);
+        }
+    }
+    return 0;
+}
+
+
+void
+onlp_gpio_ports_release(onlp_gpio_ports_t* ports)
+{
+    int i;
+    if(ports == NULL) {
+        return;
+    }
+    for(i = 0; i < ports->ngroups; i++) {
+        onlp_gpio_lines_release(ports->groups + i);
+    }
+    aim_free(ports->groups);
+    aim_free(ports->map);
+    memset(ports, 0, sizeof(*ports));
+}
+
+int
+onlp_gpio_ports_init(onlp_gpio_ports_t* ports,
+                     const onlp_gpio_port_line_t* map, int count,
+                     onlp_gpio_direction_t dir, const char* consumer)
+{
+    const char** chips;
+    int i, g, rv = 0;
+
+    if(ports == NULL || map == NULL || count <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(ports, 0, sizeof(*ports));
+    ports->map = aim_zmalloc(count * sizeof(ports->map[0]));
+    ports->groups = aim_zmalloc(count * sizeof(ports->groups[0]));
+    chips = aim_zmalloc(count * sizeof(chips[0]));
+    ports->count = count;
+
+    /* Group the entries by chip. */
+    for(i = 0; i < count; i++) {
+        for(g = 0; g < ports->ngroups; g++) {
+            if(!strcmp(chips[g], map[i].chip) &&
+               ports->groups[g].count < ONLP_GPIO_LINES_MAX) {
+                break;
+            }
+        }
+        if(g == ports->ngroups) {
+            chips[g] = map[i].chip;
+            ports->ngroups++;
+        }
+        ports->map[i].port = map[i].port;
+        ports->map[i].group = g;
+        ports->map[i].line = ports->groups[g].count;
+        ports->map[i].active_low = map[i].active_low;
+        ports->groups[g].offsets[ports->groups[g].count++] = map[i].offset;
+    }
+
+    /* Request each group. */
+    for(g = 0; g < ports->ngroups; g++) {
+        onlp_gpio_lines_t* lines = ports->groups + g;
+        uint32_t offsets[ONLP_GPIO_LINES_MAX];
+        int n = lines->count;
+
+        memcpy(offsets, lines->offsets, n * sizeof(offsets[0]));
+        lines->count = 0;
+        lines->fd = -1;
+        if(rv < 0) {
+            continue;
+        }
+        rv = onlp_gpio_lines_request(lines, chips[g], offsets, n, dir, consumer);
+    }
+    aim_free(chips);
+
+    if(rv < 0) {
+        onlp_gpio_ports_release(ports);
+    }
+    return rv;
+}
+
+int
+onlp_gpio_ports_get(onlp_gpio_ports_t* ports, aim_bitmap_hdr_t* bitmap)
+{
+    uint64_t values[ONLP_GPIO_LINES_MAX];
+    uint64_t* v = values;
+    int i, rv;
+
+    if(ports == NULL || bitmap == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(ports->ngroups > AIM_ARRAYSIZE(values)) {
+        v = aim_zmalloc(ports->ngroups * sizeof(v[0]));
+    }
+
+    /* One read per chip. */
+    for(i = 0; i < ports->ngroups; i++) {
+        if((rv = onlp_gpio_lines_get(ports->groups + i, v + i)) < 0) {
+            goto done;
+        }
+    }
+
+    for(i = 0; i < ports->count; i++) {
+        int p = ports->map[i].port;
+        int b = (v[ports->map[i].group] >> ports->map[i].line) & 1;
+        if(p >= 0 && p <= bitmap->maxbit) {
+            aim_bitmap_mod(bitmap, p, b ^ !!ports->map[i].active_low);
+        }
+    }
+    rv = 0;
+
+ done:
+    if(v != values) {
+        aim_free(v);
+    }
+    return rv;
+}
+
+int
+onlp_gpio_ports_set(onlp_gpio_ports_t* ports, aim_bitmap_hdr_t* mask,
+                    aim_bitmap_hdr_t* values)
+{
+    int g, i, rv;
+
+    if(ports == NULL || mask == NULL || values == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /* One write per chip with changes. */
+    for(g = 0; g < ports->ngroups; g++) {
+        uint64_t m = 0, v = 0;
+        for(i = 0; i < ports->count; i++) {
+            int p = ports->map[i].port;
+            if(ports->map[i].group != g || p < 0 ||
+               p > mask->maxbit || p > values->maxbit ||
+               !aim_bitmap_get(mask, p)) {
+                continue;
+            }
+            m |= (1ULL << ports->map[i].line);
+            if(!!aim_bitmap_get(values, p) ^ !!ports->map[i].active_low) {
+                v |= (1ULL << ports->map[i].line);
+            }
+        }
+        if(m && (rv = onlp_gpio_lines_set(ports->groups + g, m, v)) < 0) {
+            return rv;
+        }
+    }
+    return 0;
+}
+
+int
+onlp_gpio_port_get(onlp_gpio_ports_t* ports, int port, int* value)
+{
+    int i, rv;
+    uint64_t v;
+
+    if(ports == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(i = 0; i < ports->count; i++) {
+        if(ports->map[i].port == port) {
+            rv = onlp_gpio_lines_get(ports->groups + ports->map[i].group, &v);
+            if(rv < 0) {
+                return rv;
+            }
+            *value = ((v >> ports->map[i].line) & 1) ^ !!ports->map[i].active_low;
+            return 0;
+        }
+    }
+    return ONLP_STATUS_E_PARAM;
+}
+
+int
+onlp_gpio_port_set(onlp_gpio_ports_t* ports, int port, int value)
+{
+    int i;
+
+    if(ports == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(i = 0; i < ports->count; i++) {
+        if(ports->map[i].port == port) {
+            uint64_t bit = 1ULL << ports->map[i].line;
+            return onlp_gpio_lines_set(ports->groups + ports->map[i].group, bit,
+                                       (!!value ^ !!ports->map[i].active_low) ? bit : 0);
+        }
+    }
+    return ONLP_STATUS_E_PARAM;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV */
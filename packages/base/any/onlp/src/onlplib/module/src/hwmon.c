@@ -0,0 +1,661 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/hwmon.h>
+#include <onlplib/file.h>
+#include <onlplib/uevent.h>
+#include <AIM/aim_printf.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include "onlplib_log.h"
+
+#define SYS_CLASS_HWMON_PATH "/sys/class/hwmon"
+
+/*
+ * Attribute names, by type.
+ * Power channels without an input attribute use the average.
+ */
+static const struct {
+    const char* prefix;
+    const char* suffix;
+    const char* alternate;
+} hwmon_attrs__[ONLP_HWMON_TYPE_COUNT] = {
+    [ONLP_HWMON_TYPE_TEMP]  = { "temp",  "_input", NULL },
+    [ONLP_HWMON_TYPE_FAN]   = { "fan",   "_input", NULL },
+    [ONLP_HWMON_TYPE_PWM]   = { "pwm",   "",       NULL },
+    [ONLP_HWMON_TYPE_IN]    = { "in",    "_input", NULL },
+    [ONLP_HWMON_TYPE_CURR]  = { "curr",  "_input", NULL },
+    [ONLP_HWMON_TYPE_POWER] = { "power", "_input", "_average" },
+};
+
+static uint64_t
+hwmon_ns__(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Parse an attribute name.
+ * Returns the type, or -1. *alternate is set when the name
+ * matches the alternate suffix.
+ */
+static int
+hwmon_attr_parse__(const char* name, int* index, int* alternate)
+{
+    int t;
+    for(t = 0; t < ONLP_HWMON_TYPE_COUNT; t++) {
+        const char* p = name;
+        const char* s;
+        int len = strlen(hwmon_attrs__[t].prefix);
+        int i = 0;
+
+        if(strncmp(p, hwmon_attrs__[t].prefix, len)) {
+            continue;
+        }
+        p += len;
+        if(*p < '0' || *p > '9') {
+            continue;
+        }
+        while(*p >= '0' && *p <= '9') {
+            i = i*10 + (*p++ - '0');
+        }
+        s = hwmon_attrs__[t].alternate;
+        if(!strcmp(p, hwmon_attrs__[t].suffix)) {
+            *alternate = 0;
+        }
+        else if(s && !strcmp(p, s)) {
+            *alternate = 1;
+        }
+        else {
+            continue;
+        }
+        *index = i;
+        return t;
+    }
+    return -1;
+}
+
+static int
+hwmon_channel_compare__(const void* a, const void* b)
+{
+    const onlp_hwmon_channel_t* ca = a;
+    const onlp_hwmon_channel_t* cb = b;
+    if(ca->type != cb->type) {
+        return ca->type - cb->type;
+    }
+    return ca->index - cb->index;
+}
+
+static int
+hwmon_channel_find__(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index)
+{
+    int lo = 0, hi = dev->count - 1;
+    onlp_hwmon_channel_t key = { .type = type, .index = index };
+
+    /* Channels are sorted once enumeration is complete. */
+    while(lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = hwmon_channel_compare__(&key, dev->channels + mid);
+        if(c == 0) {
+            return mid;
+        }
+        if(c < 0) {
+            hi = mid - 1;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return ONLP_STATUS_E_MISSING;
+}
+
+/*
+ * Read an integer attribute at offset 0.
+ * sysfs regenerates the attribute on every read from the start.
+ */
+static int
+hwmon_pread__(int fd, int* value)
+{
+    char buf[32];
+    char* end;
+    long v;
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+
+    if(len <= 0) {
+        if(len < 0 && (errno == ENODEV || errno == ENOENT || errno == ENXIO)) {
+            return ONLP_STATUS_E_MISSING;
+        }
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    buf[len] = 0;
+    v = strtol(buf, &end, 0);
+    if(end == buf) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *value = v;
+    return 0;
+}
+
+static int
+hwmon_enumerate__(onlp_hwmon_t* dev)
+{
+    DIR* dir;
+    struct dirent* de;
+    int fd;
+
+    /* fdopendir() takes ownership of its descriptor. */
+    if((fd = dup(dev->dirfd)) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    if((dir = fdopendir(fd)) == NULL) {
+        close(fd);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    while((de = readdir(dir))) {
+        int index, alternate, type, c, cfd;
+        onlp_hwmon_channel_t* ch;
+
+        if((type = hwmon_attr_parse__(de->d_name, &index, &alternate)) < 0) {
+            continue;
+        }
+
+        /* The list is unsorted here. */
+        for(c = 0; c < dev->count; c++) {
+            if(dev->channels[c].type == type && dev->channels[c].index == index) {
+                break;
+            }
+        }
+        if(c < dev->count) {
+            if(alternate) {
+                continue;
+            }
+            /* Prefer the input over the alternate, once it is open. */
+        }
+        else if(dev->count == ONLP_HWMON_CHANNELS_MAX) {
+            AIM_LOG_WARN("%s: more than %d channels, %s ignored.",
+                         dev->path, ONLP_HWMON_CHANNELS_MAX, de->d_name);
+            continue;
+        }
+
+        cfd = -1;
+        if(type == ONLP_HWMON_TYPE_PWM) {
+            cfd = openat(dev->dirfd, de->d_name, O_RDWR | O_CLOEXEC);
+        }
+        if(cfd < 0) {
+            cfd = openat(dev->dirfd, de->d_name, O_RDONLY | O_CLOEXEC);
+        }
+        if(cfd < 0) {
+            /* Keep the alternate, if any. */
+            AIM_LOG_ERROR("%s/%s: %{errno}", dev->path, de->d_name, errno);
+            continue;
+        }
+
+        if(c < dev->count) {
+            close(dev->channels[c].fd);
+        }
+        else {
+            c = dev->count++;
+        }
+
+        ch = dev->channels + c;
+        ch->type = type;
+        ch->index = index;
+        ch->status = ONLP_STATUS_E_MISSING;
+        ch->fd = cfd;
+    }
+    closedir(dir);
+
+    qsort(dev->channels, dev->count, sizeof(dev->channels[0]),
+          hwmon_channel_compare__);
+    return 0;
+}
+
+static int
+hwmon_is_hwmon__(const char* path)
+{
+    char name[PATH_MAX];
+    ONLPLIB_SNPRINTF(name, sizeof(name), "%s/name", path);
+    return access(name, R_OK) == 0;
+}
+
+/*
+ * Resolve a device directory to its hwmon directory.
+ * i2c devices have a name attribute of their own, so the hwmon
+ * subdirectory is checked first.
+ */
+static int
+hwmon_resolve__(const char* path, char* rv, int size)
+{
+    char sub[PATH_MAX];
+    DIR* dir;
+    struct dirent* de;
+
+    ONLPLIB_SNPRINTF(sub, sizeof(sub), "%s/hwmon", path);
+    if((dir = opendir(sub))) {
+        while((de = readdir(dir))) {
+            if(!strncmp(de->d_name, "hwmon", 5)) {
+                ONLPLIB_SNPRINTF(rv, size, "%s/%s", sub, de->d_name);
+                if(hwmon_is_hwmon__(rv)) {
+                    closedir(dir);
+                    return 0;
+                }
+            }
+        }
+        closedir(dir);
+    }
+
+    if(hwmon_is_hwmon__(path)) {
+        ONLPLIB_SNPRINTF(rv, size, "%s", path);
+        return 0;
+    }
+    return ONLP_STATUS_E_MISSING;
+}
+
+static int
+hwmon_find__(const char* name, char* rv, int size)
+{
+    DIR* dir;
+    struct dirent* de;
+
+    if((dir = opendir(SYS_CLASS_HWMON_PATH)) == NULL) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    while((de = readdir(dir))) {
+        char* str = NULL;
+        int match;
+
+        if(de->d_name[0] == '.') {
+            continue;
+        }
+        if(onlp_file_read_str(&str, SYS_CLASS_HWMON_PATH "/%s/name",
+                              de->d_name) < 0) {
+            continue;
+        }
+        match = !strcmp(str, name);
+        aim_free(str);
+        if(match) {
+            closedir(dir);
+            ONLPLIB_SNPRINTF(rv, size, SYS_CLASS_HWMON_PATH "/%s", de->d_name);
+            return 0;
+        }
+    }
+    closedir(dir);
+    return ONLP_STATUS_E_MISSING;
+}
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+static void
+hwmon_uevent__(const onlp_uevent_t* event, void* cookie)
+{
+    onlp_hwmon_t* dev = cookie;
+    if(!strcmp(event->action, "remove") || !strcmp(event->action, "overrun")) {
+        dev->stale = 1;
+    }
+}
+#endif
+
+static void
+hwmon_unload__(onlp_hwmon_t* dev)
+{
+    int c;
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+    if(dev->subscription >= 0) {
+        onlp_uevent_unsubscribe(dev->subscription);
+        dev->subscription = -1;
+    }
+#endif
+    for(c = 0; c < dev->count; c++) {
+        close(dev->channels[c].fd);
+    }
+    dev->count = 0;
+    if(dev->dirfd >= 0) {
+        close(dev->dirfd);
+        dev->dirfd = -1;
+    }
+}
+
+static int
+hwmon_load__(onlp_hwmon_t* dev)
+{
+    char path[PATH_MAX];
+    int fd, len, rv;
+
+    if(dev->by_name) {
+        rv = hwmon_find__(dev->source, path, sizeof(path));
+    }
+    else {
+        ONLPLIB_SNPRINTF(path, sizeof(path), "%s", dev->source);
+        rv = 0;
+    }
+    if(rv < 0 || hwmon_resolve__(path, dev->path, sizeof(dev->path)) < 0) {
+        AIM_LOG_VERBOSE("%s: no hwmon device.", dev->source);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if((dev->dirfd = open(dev->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("%s: %{errno}", dev->path, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    if((fd = openat(dev->dirfd, "name", O_RDONLY | O_CLOEXEC)) >= 0) {
+        len = pread(fd, dev->name, sizeof(dev->name) - 1, 0);
+        close(fd);
+        if(len > 0) {
+            dev->name[len] = 0;
+            if(dev->name[len-1] == '\n') {
+                dev->name[len-1] = 0;
+            }
+        }
+    }
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+    /* Failure only means removal will not be noticed. */
+    dev->subscription = onlp_uevent_subscribe(NULL, dev->path, hwmon_uevent__, dev);
+#endif
+
+    if(hwmon_enumerate__(dev) < 0) {
+        hwmon_unload__(dev);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+/*
+ * Enumerate the device again if it has been removed.
+ */
+static int
+hwmon_check__(onlp_hwmon_t* dev)
+{
+    int rv;
+
+    if(!dev->stale) {
+        return 0;
+    }
+    dev->stale = 0;
+    hwmon_unload__(dev);
+    if((rv = hwmon_load__(dev)) < 0) {
+        /* Try again on the next access. */
+        dev->stale = 1;
+        return rv;
+    }
+    dev->stats.reopens++;
+    return 0;
+}
+
+static int
+hwmon_open__(onlp_hwmon_t** rv, const char* source, int by_name)
+{
+    onlp_hwmon_t* dev;
+    int r;
+
+    dev = aim_zmalloc(sizeof(*dev));
+    dev->dirfd = -1;
+    dev->subscription = -1;
+    dev->by_name = by_name;
+    ONLPLIB_SNPRINTF(dev->source, sizeof(dev->source), "%s", source);
+
+    if((r = hwmon_load__(dev)) < 0) {
+        aim_free(dev);
+        return r;
+    }
+
+    *rv = dev;
+    return 0;
+}
+
+int
+onlp_hwmon_open(onlp_hwmon_t** rv, const char* fmt, ...)
+{
+    char path[PATH_MAX];
+    va_list vargs;
+
+    if(rv == NULL || fmt == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    va_start(vargs, fmt);
+    ONLPLIB_VSNPRINTF(path, sizeof(path), fmt, vargs);
+    va_end(vargs);
+
+    return hwmon_open__(rv, path, 0);
+}
+
+int
+onlp_hwmon_find(onlp_hwmon_t** rv, const char* name)
+{
+    if(rv == NULL || name == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    return hwmon_open__(rv, name, 1);
+}
+
+void
+onlp_hwmon_close(onlp_hwmon_t* dev)
+{
+    if(dev) {
+        hwmon_unload__(dev);
+        aim_free(dev);
+    }
+}
+
+int
+onlp_hwmon_channel(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index)
+{
+    if(dev == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    return hwmon_channel_find__(dev, type, index);
+}
+
+int
+onlp_hwmon_read_all(onlp_hwmon_t* dev, int* out, int size)
+{
+    int c, count = 0;
+    uint64_t start, ns;
+
+    if(dev == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    hwmon_check__(dev);
+
+    start = hwmon_ns__();
+    for(c = 0; c < dev->count; c++) {
+        onlp_hwmon_channel_t* ch = dev->channels + c;
+        ch->status = hwmon_pread__(ch->fd, &ch->value);
+        if(ch->status < 0) {
+            dev->stats.errors++;
+        }
+        else {
+            count++;
+        }
+        if(out && c < size) {
+            out[c] = ch->value;
+        }
+    }
+    ns = hwmon_ns__() - start;
+
+    dev->stats.passes++;
+    dev->stats.reads += dev->count;
+    dev->stats.last_ns = ns;
+    dev->stats.total_ns += ns;
+    if(ns > dev->stats.max_ns) {
+        dev->stats.max_ns = ns;
+    }
+    return count;
+}
+
+int
+onlp_hwmon_read(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                int* value)
+{
+    int c;
+    onlp_hwmon_channel_t* ch;
+
+    if(dev == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    hwmon_check__(dev);
+    if((c = hwmon_channel_find__(dev, type, index)) < 0) {
+        return c;
+    }
+    ch = dev->channels + c;
+    dev->stats.reads++;
+    if((ch->status = hwmon_pread__(ch->fd, &ch->value)) < 0) {
+        dev->stats.errors++;
+        return ch->status;
+    }
+    *value = ch->value;
+    return 0;
+}
+
+int
+onlp_hwmon_value_get(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                     int* value)
+{
+    int c;
+
+    if(dev == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if((c = hwmon_channel_find__(dev, type, index)) < 0) {
+        return c;
+    }
+    if(dev->channels[c].status < 0) {
+        return dev->channels[c].status;
+    }
+    *value = dev->channels[c].value;
+    return 0;
+}
+
+int
+onlp_hwmon_value_max(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int* value)
+{
+    int c, rv = ONLP_STATUS_E_MISSING;
+
+    if(dev == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(c = 0; c < dev->count; c++) {
+        onlp_hwmon_channel_t* ch = dev->channels + c;
+        if(ch->type != type || ch->status < 0) {
+            continue;
+        }
+        if(rv < 0 || ch->value > *value) {
+            *value = ch->value;
+            rv = 0;
+        }
+    }
+    return rv;
+}
+
+int
+onlp_hwmon_write(onlp_hwmon_t* dev, onlp_hwmon_type_t type, int index,
+                 int value)
+{
+    char buf[32];
+    int c, len;
+
+    if(dev == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    hwmon_check__(dev);
+    if((c = hwmon_channel_find__(dev, type, index)) < 0) {
+        return c;
+    }
+    len = ONLPLIB_SNPRINTF(buf, sizeof(buf), "%d\n", value);
+    if(pwrite(dev->channels[c].fd, buf, len, 0) != len) {
+        if(errno == EBADF) {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+        AIM_LOG_ERROR("%s: write %s%d: %{errno}", dev->path,
+                      hwmon_attrs__[type].prefix, index, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+int
+onlp_hwmon_thermal_info_get(onlp_hwmon_t* dev, int index,
+                            onlp_thermal_info_t* info)
+{
+    int rv;
+
+    if(dev == NULL || info == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    rv = onlp_hwmon_read(dev, ONLP_HWMON_TYPE_TEMP, index, &info->mcelsius);
+    if(rv == ONLP_STATUS_E_MISSING) {
+        /* Absent */
+        info->status = 0;
+        return 0;
+    }
+    if(rv < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    info->status |= ONLP_THERMAL_STATUS_PRESENT;
+    return 0;
+}
+
+void
+onlp_hwmon_show(onlp_hwmon_t* dev, aim_pvs_t* pvs)
+{
+    int c;
+
+    if(dev == NULL) {
+        return;
+    }
+
+    aim_printf(pvs, "%s (%s): %d channels\n", dev->name, dev->path, dev->count);
+    for(c = 0; c < dev->count; c++) {
+        onlp_hwmon_channel_t* ch = dev->channels + c;
+        if(ch->status < 0) {
+            aim_printf(pvs, "  %s%d: %{onlp_status}\n",
+                       hwmon_attrs__[ch->type].prefix, ch->index, ch->status);
+        }
+        else {
+            aim_printf(pvs, "  %s%d: %d\n",
+                       hwmon_attrs__[ch->type].prefix, ch->index, ch->value);
+        }
+    }
+    aim_printf(pvs, "  passes=%llu reads=%llu errors=%llu\n",
+               (unsigned long long)dev->stats.passes,
+               (unsigned long long)dev->stats.reads,
+               (unsigned long long)dev->stats.errors);
+    if(dev->stats.passes) {
+        aim_printf(pvs, "  pass: last=%lluns max=%lluns avg=%lluns\n",
+                   (unsigned long long)dev->stats.last_ns,
+                   (unsigned long long)dev->stats.max_ns,
+                   (unsigned long long)(dev->stats.total_ns / dev->stats.passes));
+    }
+}
@@ -343,6 +343,48 @@ onlp_onie_info_free(onlp_onie_info_t* info)
     }
 }
 
+static char*
+strdup__(const char* s)
+{
+    return s ? aim_strdup(s) : NULL;
+}
+
+int
+onlp_onie_info_copy(onlp_onie_info_t* dst, const onlp_onie_info_t* src)
+{
+    list_links_t* cur;
+
+    if(dst == NULL || src == NULL) {
+        return -1;
+    }
+
+    memcpy(dst, src, sizeof(*dst));
+
+    dst->product_name = strdup__(src->product_name);
+    dst->part_number = strdup__(src->part_number);
+    dst->serial_number = strdup__(src->serial_number);
+    dst->manufacture_date = strdup__(src->manufacture_date);
+    dst->label_revision = strdup__(src->label_revision);
+    dst->platform_name = strdup__(src->platform_name);
+    dst->onie_version = strdup__(src->onie_version);
+    dst->manufacturer = strdup__(src->manufacturer);
+    dst->country_code = strdup__(src->country_code);
+    dst->vendor = strdup__(src->vendor);
+    dst->diag_version = strdup__(src->diag_version);
+    dst->service_tag = strdup__(src->service_tag);
+    dst->_hdr_id_string = strdup__(src->_hdr_id_string);
+
+    list_init(&dst->vx_list);
+    LIST_FOREACH((list_head_t*)&src->vx_list, cur) {
+        onlp_onie_vx_t* svx = container_of(cur, links, onlp_onie_vx_t);
+        onlp_onie_vx_t* dvx = aim_zmalloc(sizeof(*dvx));
+        memcpy(dvx->data, svx->data, sizeof(dvx->data));
+        dvx->size = svx->size;
+        list_push(&dst->vx_list, &dvx->links);
+    }
+    return 0;
+}
+
 void
 onlp_onie_show(onlp_onie_info_t* info, aim_pvs_t* pvs)
 {
@@ -89,6 +89,16 @@ onlplib_config_settings_t onlplib_config_settings[] =
     { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS) },
 #else
 { ONLPLIB_CONFIG_INCLUDE_I2C_SMBUS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_GPIO_CDEV(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_UEVENT
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_UEVENT), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_UEVENT) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_UEVENT(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
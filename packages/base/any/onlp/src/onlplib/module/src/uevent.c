@@ -0,0 +1,442 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/uevent.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_UEVENT == 1
+
+#include <AIM/aim_printf.h>
+#include <OS/os_thread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/netlink.h>
+#include "onlplib_log.h"
+
+#define UEVENT_BUFFER_SIZE 8192
+#define UEVENT_RCVBUF (1024*1024)
+
+typedef struct uevent_subscription_s {
+    int active;
+    char subsystem[32];
+    char devpath[PATH_MAX];
+    int devpath_len;
+    onlp_uevent_handler_f handler;
+    void* cookie;
+} uevent_subscription_t;
+
+typedef struct uevent_ctrl_s {
+    pthread_mutex_t lock;
+
+    /** Signalled when a dispatch completes */
+    pthread_cond_t cond;
+    /** The subscription being dispatched, or -1 */
+    int dispatching;
+
+    int sock;
+    int eventfd;
+    pthread_t thread;
+    int running;
+
+    uevent_subscription_t subscriptions[ONLP_UEVENT_SUBSCRIPTIONS_MAX];
+
+    /** Counters */
+    uint64_t events;
+    uint64_t dispatched;
+    uint64_t dropped;
+    uint64_t overruns;
+} uevent_ctrl_t;
+
+static uevent_ctrl_t ctrl__ = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .dispatching = -1,
+    .sock = -1,
+    .eventfd = -1,
+};
+
+int
+onlp_uevent_devpath(const char* path, char* rv, int size)
+{
+    char real[PATH_MAX];
+
+    if(path == NULL || rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(!strncmp(path, "/sys/", 5)) {
+        /* Device links must be resolved to match the event devpath. */
+        if(realpath(path, real) == NULL) {
+            return ONLP_STATUS_E_MISSING;
+        }
+        ONLPLIB_SNPRINTF(rv, size, "%s", real + 4);
+    }
+    else {
+        ONLPLIB_SNPRINTF(rv, size, "%s", path);
+    }
+    return 0;
+}
+
+const char*
+onlp_uevent_get(const onlp_uevent_t* event, const char* key)
+{
+    int i;
+    int len = strlen(key);
+
+    for(i = 0; i < event->env_count; i++) {
+        if(!strncmp(event->env[i], key, len) && event->env[i][len] == '=') {
+            return event->env[i] + len + 1;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Parse a kernel message:
+ *   action@devpath\0KEY=VALUE\0KEY=VALUE\0...
+ */
+static int
+uevent_parse__(char* buf, int len, onlp_uevent_t* ev)
+{
+    char* p = buf;
+    char* end = buf + len;
+    const char* s;
+
+    memset(ev, 0, sizeof(*ev));
+
+    /* The header is repeated in ACTION and DEVPATH. */
+    if(memchr(buf, '@', strnlen(buf, len)) == NULL) {
+        return -1;
+    }
+    p += strlen(p) + 1;
+
+    while(p < end && *p) {
+        if(ev->env_count < ONLP_UEVENT_ENV_MAX) {
+            ev->env[ev->env_count++] = p;
+        }
+        p += strlen(p) + 1;
+    }
+
+    ev->action = onlp_uevent_get(ev, "ACTION");
+    ev->devpath = onlp_uevent_get(ev, "DEVPATH");
+    ev->subsystem = onlp_uevent_get(ev, "SUBSYSTEM");
+    ev->driver = onlp_uevent_get(ev, "DRIVER");
+    if((s = onlp_uevent_get(ev, "SEQNUM"))) {
+        ev->seqnum = strtoull(s, NULL, 10);
+    }
+    return (ev->action && ev->devpath) ? 0 : -1;
+}
+
+static int
+uevent_match__(const uevent_subscription_t* sub, const onlp_uevent_t* ev)
+{
+    if(!sub->active) {
+        return 0;
+    }
+    if(ev->subsystem == NULL && !strcmp(ev->action, "overrun")) {
+        /* Lost events may have matched any subscription. */
+        return 1;
+    }
+    if(sub->subsystem[0] &&
+       (ev->subsystem == NULL || strcmp(sub->subsystem, ev->subsystem))) {
+        return 0;
+    }
+    if(sub->devpath_len) {
+        /* Match the device and everything below it. */
+        if(strncmp(ev->devpath, sub->devpath, sub->devpath_len)) {
+            return 0;
+        }
+        if(ev->devpath[sub->devpath_len] != 0 &&
+           ev->devpath[sub->devpath_len] != '/' &&
+           sub->devpath[sub->devpath_len-1] != '/') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void
+uevent_dispatch__(const onlp_uevent_t* ev)
+{
+    int i;
+
+    pthread_mutex_lock(&ctrl__.lock);
+    ctrl__.events++;
+    for(i = 0; i < ONLP_UEVENT_SUBSCRIPTIONS_MAX; i++) {
+        uevent_subscription_t* sub = ctrl__.subscriptions + i;
+        onlp_uevent_handler_f handler;
+        void* cookie;
+
+        if(!uevent_match__(sub, ev)) {
+            continue;
+        }
+        handler = sub->handler;
+        cookie = sub->cookie;
+        ctrl__.dispatching = i;
+        ctrl__.dispatched++;
+
+        /* Handlers may subscribe or unsubscribe. */
+        pthread_mutex_unlock(&ctrl__.lock);
+        handler(ev, cookie);
+        pthread_mutex_lock(&ctrl__.lock);
+
+        ctrl__.dispatching = -1;
+        pthread_cond_broadcast(&ctrl__.cond);
+    }
+    pthread_mutex_unlock(&ctrl__.lock);
+}
+
+static void*
+uevent_thread__(void* arg)
+{
+    static char buf[UEVENT_BUFFER_SIZE];
+    struct pollfd fds[2];
+
+    os_thread_name_set("onlp.uevent");
+
+    fds[0].fd = ctrl__.sock;
+    fds[0].events = POLLIN;
+    fds[1].fd = ctrl__.eventfd;
+    fds[1].events = POLLIN;
+
+    for(;;) {
+        struct sockaddr_nl sa;
+        socklen_t salen = sizeof(sa);
+        onlp_uevent_t ev;
+        ssize_t len;
+
+        if(poll(fds, 2, -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            AIM_LOG_ERROR("uevent poll: %{errno}", errno);
+            break;
+        }
+        if(fds[1].revents) {
+            break;
+        }
+
+        len = recvfrom(ctrl__.sock, buf, sizeof(buf) - 1, MSG_DONTWAIT,
+                       (struct sockaddr*)&sa, &salen);
+        if(len < 0) {
+            if(errno == ENOBUFS) {
+                /*
+                 * Events were lost. Subscribers can only recover by
+                 * treating this as a change to everything.
+                 */
+                AIM_LOG_WARN("uevent receive buffer overrun.");
+                pthread_mutex_lock(&ctrl__.lock);
+                ctrl__.overruns++;
+                pthread_mutex_unlock(&ctrl__.lock);
+                memset(&ev, 0, sizeof(ev));
+                ev.action = "overrun";
+                ev.devpath = "/";
+                uevent_dispatch__(&ev);
+            }
+            continue;
+        }
+        buf[len] = 0;
+
+        /* Only accept messages from the kernel. */
+        if(sa.nl_pid != 0 || uevent_parse__(buf, len, &ev) < 0) {
+            pthread_mutex_lock(&ctrl__.lock);
+            ctrl__.dropped++;
+            pthread_mutex_unlock(&ctrl__.lock);
+            continue;
+        }
+        uevent_dispatch__(&ev);
+    }
+    return NULL;
+}
+
+/* Called with the lock held. */
+static int
+uevent_start__(void)
+{
+    struct sockaddr_nl sa;
+    int size = UEVENT_RCVBUF;
+
+    if(ctrl__.running) {
+        return 0;
+    }
+
+    ctrl__.sock = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+                         NETLINK_KOBJECT_UEVENT);
+    if(ctrl__.sock < 0) {
+        AIM_LOG_ERROR("uevent socket: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    setsockopt(ctrl__.sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    /* Kernel events only */
+    sa.nl_groups = 1;
+    if(bind(ctrl__.sock, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
+        AIM_LOG_ERROR("uevent bind: %{errno}", errno);
+        goto error;
+    }
+
+    if((ctrl__.eventfd = eventfd(0, EFD_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("uevent eventfd: %{errno}", errno);
+        goto error;
+    }
+
+    if(pthread_create(&ctrl__.thread, NULL, uevent_thread__, NULL) != 0) {
+        AIM_LOG_ERROR("uevent pthread create failed.");
+        goto error;
+    }
+    ctrl__.running = 1;
+    return 0;
+
+ error:
+    close(ctrl__.sock);
+    ctrl__.sock = -1;
+    if(ctrl__.eventfd >= 0) {
+        close(ctrl__.eventfd);
+        ctrl__.eventfd = -1;
+    }
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+int
+onlp_uevent_subscribe(const char* subsystem, const char* devpath,
+                      onlp_uevent_handler_f handler, void* cookie)
+{
+    char path[PATH_MAX] = { 0 };
+    int i, rv;
+
+    if(handler == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(devpath) {
+        if((rv = onlp_uevent_devpath(devpath, path, sizeof(path))) < 0) {
+            return rv;
+        }
+    }
+
+    pthread_mutex_lock(&ctrl__.lock);
+    for(i = 0; i < ONLP_UEVENT_SUBSCRIPTIONS_MAX; i++) {
+        if(!ctrl__.subscriptions[i].active) {
+            break;
+        }
+    }
+    if(i == ONLP_UEVENT_SUBSCRIPTIONS_MAX) {
+        pthread_mutex_unlock(&ctrl__.lock);
+        AIM_LOG_ERROR("No uevent subscriptions available.");
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    if((rv = uevent_start__()) < 0) {
+        pthread_mutex_unlock(&ctrl__.lock);
+        return rv;
+    }
+
+    uevent_subscription_t* sub = ctrl__.subscriptions + i;
+    memset(sub, 0, sizeof(*sub));
+    if(subsystem) {
+        ONLPLIB_SNPRINTF(sub->subsystem, sizeof(sub->subsystem), "%s", subsystem);
+    }
+    ONLPLIB_SNPRINTF(sub->devpath, sizeof(sub->devpath), "%s", path);
+    sub->devpath_len = strlen(path);
+    sub->handler = handler;
+    sub->cookie = cookie;
+    sub->active = 1;
+    pthread_mutex_unlock(&ctrl__.lock);
+    return i;
+}
+
+int
+onlp_uevent_unsubscribe(int id)
+{
+    if(id < 0 || id >= ONLP_UEVENT_SUBSCRIPTIONS_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&ctrl__.lock);
+    ctrl__.subscriptions[id].active = 0;
+    if(!pthread_equal(pthread_self(), ctrl__.thread)) {
+        while(ctrl__.dispatching == id) {
+            pthread_cond_wait(&ctrl__.cond, &ctrl__.lock);
+        }
+    }
+    pthread_mutex_unlock(&ctrl__.lock);
+    return 0;
+}
+
+void
+onlp_uevent_stop(void)
+{
+    uint64_t one = 1;
+    pthread_t thread;
+
+    pthread_mutex_lock(&ctrl__.lock);
+    if(!ctrl__.running) {
+        pthread_mutex_unlock(&ctrl__.lock);
+        return;
+    }
+    ctrl__.running = 0;
+    thread = ctrl__.thread;
+    if(write(ctrl__.eventfd, &one, sizeof(one)) != sizeof(one)) {
+        AIM_LOG_ERROR("uevent eventfd write: %{errno}", errno);
+    }
+    pthread_mutex_unlock(&ctrl__.lock);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&ctrl__.lock);
+    close(ctrl__.sock);
+    close(ctrl__.eventfd);
+    ctrl__.sock = ctrl__.eventfd = -1;
+    pthread_mutex_unlock(&ctrl__.lock);
+}
+
+void
+onlp_uevent_show(aim_pvs_t* pvs)
+{
+    int i;
+
+    pthread_mutex_lock(&ctrl__.lock);
+    aim_printf(pvs, "uevent listener: %s\n", ctrl__.running ? "running" : "stopped");
+    aim_printf(pvs, "  events=%llu dispatched=%llu dropped=%llu overruns=%llu\n",
+               (unsigned long long)ctrl__.events,
+               (unsigned long long)ctrl__.dispatched,
+               (unsigned long long)ctrl__.dropped,
+               (unsigned long long)ctrl__.overruns);
+    for(i = 0; i < ONLP_UEVENT_SUBSCRIPTIONS_MAX; i++) {
+        uevent_subscription_t* sub = ctrl__.subscriptions + i;
+        if(sub->active) {
+            aim_printf(pvs, "  %2d: subsystem=%s devpath=%s\n", i,
+                       sub->subsystem[0] ? sub->subsystem : "*",
+                       sub->devpath_len ? sub->devpath : "*");
+        }
+    }
+    pthread_mutex_unlock(&ctrl__.lock);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_UEVENT */
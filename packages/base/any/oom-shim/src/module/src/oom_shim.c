@@ -39,106 +39,308 @@ void __oom_shim_module_init__(void) {
     onlp_init();
 }
 
-/*Gets the portlist of the SFP ports on the switch*/
+#define OOM_PAGE_SELECT 127
+#define OOM_PAGE_BASE 128
+#define OOM_ADDRESS_SPACE 256
+
+/*
+ * The last page selected on each port and device address.
+ * Page 0 is only selected again after another page has been,
+ * so the page select byte is never written on a device (such as
+ * SFP A0h) which has not been asked for an upper page.
+ */
+static uint8_t page_selected__[MAXPORTS][2];
+
+static int
+oom_port_num__(oom_port_t* port)
+{
+    int port_num;
+
+    if(port == NULL || port->handle == NULL) {
+        return -EINVAL;
+    }
+    port_num = (int)(uintptr_t)port->handle - 1;
+    if(port_num < 0 || port_num >= MAXPORTS) {
+        return -EINVAL;
+    }
+    return port_num;
+}
+
+/* Map an ONLP status to a negative errno. */
+static int
+oom_errno__(int rv)
+{
+    switch(rv)
+        {
+        case ONLP_STATUS_E_UNSUPPORTED: return -EOPNOTSUPP;
+        case ONLP_STATUS_E_MISSING: return -ENODEV;
+        case ONLP_STATUS_E_INVALID:
+        case ONLP_STATUS_E_PARAM: return -EINVAL;
+        default: return -EIO;
+        }
+}
+
+static int
+oom_page_select__(int port, uint8_t devaddr, int page)
+{
+    uint8_t* selected = &page_selected__[port][devaddr & 1];
+    int rv;
+
+    /*
+     * Other pages are always selected, in case the module has
+     * been replaced since the last access.
+     */
+    if(page == 0 && *selected == 0) {
+        return 0;
+    }
+    rv = onlp_sfp_dev_writeb(port, devaddr, OOM_PAGE_SELECT, page);
+    if(rv < 0) {
+        return rv;
+    }
+    *selected = page;
+    return 0;
+}
+
+/*
+ * Validate the address and range and select the page if the
+ * range includes the upper half of the address space.
+ */
+static int
+oom_memory_prepare__(oom_port_t* port, int address, int page,
+                     int offset, int len, uint8_t* data, uint8_t* devaddr)
+{
+    int port_num = oom_port_num__(port);
+    int rv;
+
+    if(port_num < 0) {
+        return port_num;
+    }
+    if(data == NULL || len < 0 || offset < 0 ||
+       offset + len > OOM_ADDRESS_SPACE ||
+       address < 0 || address > 0xFF || page < 0 || page > 0xFF) {
+        return -EINVAL;
+    }
+
+    *devaddr = address >> 1;
+    if(offset + len > OOM_PAGE_BASE) {
+        if((rv = oom_page_select__(port_num, *devaddr, page)) < 0) {
+            return oom_errno__(rv);
+        }
+    }
+    return port_num;
+}
+
+/* Gets the portlist of the SFP ports on the switch */
 int oom_get_portlist(oom_port_t portlist[], int listsize){
-    
-    int port,i=0;
-    oom_port_t* pptr;
-    
 
+    int port, i = 0, count;
+    int rv;
+    oom_port_t* pptr;
     onlp_sfp_bitmap_t bitmap;
+    onlp_sfp_bitmap_t present;
+
     onlp_sfp_bitmap_t_init(&bitmap);
-    onlp_sfp_bitmap_get(&bitmap);
-   
+    if((rv = onlp_sfp_bitmap_get(&bitmap)) < 0) {
+        return oom_errno__(rv);
+    }
+    count = AIM_BITMAP_COUNT(&bitmap);
+
     if ((portlist == NULL) && (listsize == 0)){ /* asking # of ports */
-        if(AIM_BITMAP_COUNT(&bitmap) == 0){
-            return 0;
-        }
-        else
-            return AIM_BITMAP_COUNT(&bitmap);
+        return count;
+    }
+    if (portlist == NULL || count > listsize) {
+        return -ENOMEM;
     }
 
+    /* Presence of every port in one call. */
+    onlp_sfp_bitmap_t_init(&present);
+    rv = onlp_sfp_presence_bitmap_get(&present);
+
     AIM_BITMAP_ITER(&bitmap, port){
-        int rv;
-        
-        pptr = &portlist[i];
-        pptr->handle = (void *)(uintptr_t)port+1;
-        pptr->oom_class = OOM_PORT_CLASS_SFF; 
-        sprintf(pptr->name, "port%d", port+1);
-        i++;
-        
-        rv = onlp_sfp_is_present(port);
-        if(rv == 0){
-            /* aim_printf(&aim_pvs_stdout, "module %d is not present\n", port);*/
-            pptr->oom_class = OOM_PORT_CLASS_UNKNOWN;
-            continue;
+        pptr = &portlist[i++];
+        pptr->handle = (void *)(uintptr_t)(port+1);
+        snprintf(pptr->name, sizeof(pptr->name), "port%d", port+1);
+
+        if(rv < 0) {
+            /* No presence bitmap, ask the port. */
+            int p = onlp_sfp_is_present(port);
+            if(p < 0) {
+                aim_printf(&aim_pvs_stdout, "%4d  Error %{onlp_status}\n", port, p);
+            }
+            pptr->oom_class = (p > 0) ? OOM_PORT_CLASS_SFF : OOM_PORT_CLASS_UNKNOWN;
+        }
+        else {
+            pptr->oom_class = AIM_BITMAP_GET(&present, port) ?
+                OOM_PORT_CLASS_SFF : OOM_PORT_CLASS_UNKNOWN;
         }
 
-        if(rv < 0){
-            aim_printf(&aim_pvs_stdout, "%4d  Error %{onlp_status}\n", port, rv);
-            pptr->oom_class = OOM_PORT_CLASS_UNKNOWN;
-            continue;
+        if(port < MAXPORTS && pptr->oom_class == OOM_PORT_CLASS_UNKNOWN) {
+            /* A new module starts on page 0. */
+            page_selected__[port][0] = page_selected__[port][1] = 0;
         }
     }
     return 0;
 }
 
 
-int oom_get_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
+/*
+ * Page 0 through the whole EEPROM and DOM interfaces, for
+ * platforms without device read support.
+ */
+static int
+oom_page0_read__(int port_num, uint8_t devaddr, int offset, int len, uint8_t* data)
+{
+    uint8_t* buf = NULL;
     int rv;
-    unsigned int port_num; 
-    uint8_t* idprom = NULL;
-
-    port_num = (unsigned int)(uintptr_t)port->handle;
-    port_num -= 1;
-
-    if (offset >= 256)
-        return -1;  /* out of range */
-
-    /** 
-     * place holder implementation until onlp_sfp_eeprom_read() 
-     * can be improved to handle partial page gets
-     **/
-
-    if (address == 0xa0) {
-        rv = onlp_sfp_eeprom_read(port_num, &idprom);
-    } else if (address == 0xa2) {
-        rv = onlp_sfp_dom_read(port_num, &idprom);
-    } else {
-        aim_printf(&aim_pvs_stdout, "Error invalid address: 0x%02x\n", address);
-        return -EINVAL;
-    }
+
+    switch(devaddr)
+        {
+        case 0x50: rv = onlp_sfp_eeprom_read(port_num, &buf); break;
+        case 0x51: rv = onlp_sfp_dom_read(port_num, &buf); break;
+        default: return ONLP_STATUS_E_UNSUPPORTED;
+        }
 
     if(rv < 0) {
-        aim_printf(&aim_pvs_stdout, "Error reading eeprom: %{onlp_status}\n");
-        return -1;
+        return rv;
     }
-    memcpy(data, &idprom[offset], len); 
-    aim_free(idprom);
-    
+    /* The buffer holds the whole 256 byte page. */
+    memcpy(data, buf + offset, len);
+    aim_free(buf);
     return 0;
 }
 
-int oom_get_function(oom_port_t* port, oom_functions_t function, int* rv){
-    //not implemented
-    return -1;
-}
+int oom_get_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
+    int rv, i;
+    int port_num;
+    uint8_t devaddr;
 
-int oom_get_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
-    //not implemented
-    return -1;
+    port_num = oom_memory_prepare__(port, address, page, offset, len, data, &devaddr);
+    if(port_num < 0) {
+        return port_num;
+    }
+    if(len == 0) {
+        return 0;
+    }
+
+    rv = onlp_sfp_dev_read(port_num, devaddr, offset, data, len);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED &&
+       (page == 0 || offset + len <= OOM_PAGE_BASE)) {
+        rv = oom_page0_read__(port_num, devaddr, offset, len, data);
+    }
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        /* No ranged access on this platform. */
+        for(i = 0; i < len; i++) {
+            if((rv = onlp_sfp_dev_readb(port_num, devaddr, offset + i)) < 0) {
+                break;
+            }
+            data[i] = rv;
+        }
+    }
+    if(rv < 0) {
+        return oom_errno__(rv);
+    }
+    return len;
 }
 
 int oom_set_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
-    //not implemented
-    return -1;
+    int rv, i;
+    int port_num;
+    uint8_t devaddr;
+
+    port_num = oom_memory_prepare__(port, address, page, offset, len, data, &devaddr);
+    if(port_num < 0) {
+        return port_num;
+    }
+    if(len == 0) {
+        return 0;
+    }
+
+    rv = onlp_sfp_dev_write(port_num, devaddr, offset, data, len);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        for(i = 0; i < len; i++) {
+            if((rv = onlp_sfp_dev_writeb(port_num, devaddr, offset + i, data[i])) < 0) {
+                break;
+            }
+        }
+    }
+    if(rv < 0) {
+        return oom_errno__(rv);
+    }
+    if(offset <= OOM_PAGE_SELECT && offset + len > OOM_PAGE_SELECT) {
+        /* The caller wrote the page select itself. */
+        page_selected__[port_num][devaddr & 1] = data[OOM_PAGE_SELECT - offset];
+    }
+    return len;
+}
+
+static onlp_sfp_control_t
+oom_function_control__(oom_functions_t function)
+{
+    switch(function)
+        {
+        case OOM_FUNCTIONS_TX_FAULT: return ONLP_SFP_CONTROL_TX_FAULT;
+        case OOM_FUNCTIONS_TX_DISABLE: return ONLP_SFP_CONTROL_TX_DISABLE;
+        case OOM_FUNCTIONS_RXLOSS_OF_SIG: return ONLP_SFP_CONTROL_RX_LOS;
+        default: return ONLP_SFP_CONTROL_INVALID;
+        }
+}
+
+int oom_get_function(oom_port_t* port, oom_functions_t function, int* rv){
+    int port_num = oom_port_num__(port);
+    onlp_sfp_control_t control;
+    int value, status;
+
+    if(port_num < 0) {
+        return port_num;
+    }
+    if(rv == NULL) {
+        return -EINVAL;
+    }
+
+    if(function == OOM_FUNCTIONS_MODULE_ABSENT) {
+        if((status = onlp_sfp_is_present(port_num)) < 0) {
+            return oom_errno__(status);
+        }
+        *rv = !status;
+        return 0;
+    }
+
+    /* RS0 and RS1 are not exposed by ONLP. */
+    if((control = oom_function_control__(function)) == ONLP_SFP_CONTROL_INVALID) {
+        return -EOPNOTSUPP;
+    }
+    if((status = onlp_sfp_control_get(port_num, control, &value)) < 0) {
+        return oom_errno__(status);
+    }
+    *rv = !!value;
+    return 0;
 }
 
 int oom_set_function(oom_port_t* port, oom_functions_t function, int value){
-    //not implemented
-    return -1;
+    int port_num = oom_port_num__(port);
+    int status;
+
+    if(port_num < 0) {
+        return port_num;
+    }
+
+    /* TX disable is the only writable function. */
+    if(function != OOM_FUNCTIONS_TX_DISABLE) {
+        return -EOPNOTSUPP;
+    }
+    if((status = onlp_sfp_control_set(port_num, ONLP_SFP_CONTROL_TX_DISABLE, !!value)) < 0) {
+        return oom_errno__(status);
+    }
+    return 0;
+}
+
+/*
+ * CFP modules are accessed over MDIO, which ONLP does not expose.
+ */
+int oom_get_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
+    return -EOPNOTSUPP;
 }
+
 int oom_set_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
-    //not implemented
-    return -1;
+    return -EOPNOTSUPP;
 }
@@ -30,6 +30,8 @@
 #include <linux/ipmi.h>
 #include <linux/ipmi_smi.h>
 #include <linux/platform_device.h>
+#include <linux/spinlock.h>
+#include <linux/list.h>
 
 #define DRVNAME "as5916_54xks_sfp"
 #define ACCTON_IPMI_NETFN       0x34
@@ -40,6 +42,11 @@
 #define IPMI_TIMEOUT		    (5 * HZ)
 #define IPMI_ERR_RETRY_TIMES    1
 #define IPMI_DATA_MAX_LEN       128
+#define IPMI_STATUS_ALL         0x20 /* Selector of the all ports status command, see status_all_cmd */
+#define IPMI_CC_INVALID_CMD     0xC1 /* Completion codes of BMC firmware */
+#define IPMI_CC_INVALID_FIELD   0xCC /* without IPMI_STATUS_ALL */
+#define IPMI_STATUS_ALL_MAX_FAILURES    3
+#define IPMI_STATUS_ALL_RETRY_INTERVAL  (60 * HZ)
 
 #define SFP_EEPROM_SIZE         768
 #define QSFP_EEPROM_SIZE        640
@@ -47,6 +54,8 @@
 #define NUM_OF_SFP              48
 #define NUM_OF_QSFP             6
 #define NUM_OF_PORT             (NUM_OF_SFP + NUM_OF_QSFP)
+#define SFP_STATUS_BITMAP_LEN   DIV_ROUND_UP(NUM_OF_SFP, 8)
+#define QSFP_STATUS_BITMAP_LEN  DIV_ROUND_UP(NUM_OF_QSFP, 8)
 
 #define PHY_FORMAT "module_phy_%d"
 #define NUM_OF_PHY_REGISTERS    32
@@ -76,27 +85,30 @@ static int as5916_54xks_sfp_probe(struct platform_device *pdev);
 static int as5916_54xks_sfp_remove(struct platform_device *pdev);
 static ssize_t show_all(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t show_port(struct device *dev, struct device_attribute *da, char *buf);
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_present(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_txdisable(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_txfault(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_rxlos(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_present(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_txdisable(void);
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_reset(void);
+static int as5916_54xks_update_status(unsigned long signals);
+
+/* One outstanding IPMI request, matched to its response by msgid */
+struct ipmi_request {
+	struct list_head   list;
+	long               msgid;
+	struct completion  done;
+
+	void            *rx_msg_data;
+	unsigned short   rx_msg_len;
+	unsigned char    rx_result;
+	int              rx_recv_type;
+};
 
 struct ipmi_data {
-	struct completion   read_complete;
 	struct ipmi_addr	address;
 	ipmi_user_t         user;
 	int                 interface;
 
-	struct kernel_ipmi_msg tx_message;
-	long                   tx_msgid;
+	spinlock_t          lock;    /* Protects tx_msgid and pending */
+	long                tx_msgid;
+	struct list_head    pending; /* Requests waiting for a response */
 
-	void            *rx_msg_data;
-	unsigned short   rx_msg_len;
-	unsigned char    rx_result;
-	int              rx_recv_type;
+	unsigned char    rx_result;  /* Result of the last ipmi_send_message() */
 
 	struct ipmi_user_hndl ipmi_hndlrs;
 };
@@ -114,6 +126,8 @@ enum module_status {
     QSFP_LPMODE,
     NUM_OF_QSFP_STATUS,
 
+    NUM_OF_STATUS = NUM_OF_SFP_STATUS + NUM_OF_QSFP_STATUS,
+
     PRESENT_ALL = 0,
     RXLOS_ALL,
     SFP_PHY_SET
@@ -141,6 +155,9 @@ struct as5916_54xks_sfp_data {
     struct mutex     update_lock;
     struct ipmi_data ipmi;
     struct ipmi_sfp_resp_data ipmi_resp;
+    char status_all_disabled;          /* IPMI_STATUS_ALL is not used until status_all_retry */
+    unsigned long status_all_retry;    /* In jiffies */
+    int  status_all_failures;          /* Consecutive IPMI_STATUS_ALL failures */
     unsigned char ipmi_tx_data[3];
     struct bin_attribute eeprom[NUM_OF_PORT*2]; /* eeprom data */
     struct bin_attribute phy_reg[NUM_OF_SFP]; /* phy register data */
@@ -539,7 +556,8 @@ static int init_ipmi_data(struct ipmi_data *ipmi, int iface,
 {
 	int err;
 
-	init_completion(&ipmi->read_complete);
+	spin_lock_init(&ipmi->lock);
+	INIT_LIST_HEAD(&ipmi->pending);
 
 	/* Initialize IPMI address */
 	ipmi->address.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
@@ -547,9 +565,7 @@ static int init_ipmi_data(struct ipmi_data *ipmi, int iface,
 	ipmi->address.data[0] = 0;
 	ipmi->interface = iface;
 
-	/* Initialize message buffers */
 	ipmi->tx_msgid = 0;
-	ipmi->tx_message.netfn = ACCTON_IPMI_NETFN;
 
     ipmi->ipmi_hndlrs.ipmi_recv_hndl = ipmi_msg_handler;
 
@@ -565,40 +581,55 @@ static int init_ipmi_data(struct ipmi_data *ipmi, int iface,
 	return 0;
 }
 
-/* Send an IPMI command */
-static int _ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
-                                     unsigned char *tx_data, unsigned short tx_len,
-                                     unsigned char *rx_data, unsigned short rx_len)
+static void ipmi_request_init(struct ipmi_request *req,
+                              unsigned char *rx_data, unsigned short rx_len)
 {
-	int err;
+    INIT_LIST_HEAD(&req->list);
+    init_completion(&req->done);
+    req->msgid        = 0;
+    req->rx_msg_data  = rx_data;
+    req->rx_msg_len   = rx_len;
+    req->rx_result    = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
+    req->rx_recv_type = 0;
+}
 
-    ipmi->tx_message.cmd      = cmd;
-    ipmi->tx_message.data     = tx_data;
-    ipmi->tx_message.data_len = tx_len;
-    ipmi->rx_msg_data         = rx_data;
-    ipmi->rx_msg_len          = rx_len;
+/* Queue an IPMI command without waiting for the response.
+ * Several requests may be outstanding at once, each one must be
+ * followed by ipmi_wait_message().
+ */
+static int ipmi_submit_message(struct ipmi_data *ipmi, struct ipmi_request *req,
+                               unsigned char cmd, unsigned char *tx_data,
+                               unsigned short tx_len)
+{
+	struct kernel_ipmi_msg tx_message;
+	unsigned long flags;
+	int err;
 
 	err = ipmi_validate_addr(&ipmi->address, sizeof(ipmi->address));
 	if (err)
 		goto addr_err;
 
-	ipmi->tx_msgid++;
-	err = ipmi_request_settime(ipmi->user, &ipmi->address, ipmi->tx_msgid,
-				   &ipmi->tx_message, ipmi, 0, 0, 0);
+    tx_message.netfn    = ACCTON_IPMI_NETFN;
+    tx_message.cmd      = cmd;
+    tx_message.data     = tx_data;
+    tx_message.data_len = tx_len;
+
+    spin_lock_irqsave(&ipmi->lock, flags);
+    req->msgid = ++ipmi->tx_msgid;
+    list_add_tail(&req->list, &ipmi->pending);
+    spin_unlock_irqrestore(&ipmi->lock, flags);
+
+	err = ipmi_request_settime(ipmi->user, &ipmi->address, req->msgid,
+				   &tx_message, ipmi, 0, 0, 0);
 	if (err)
 		goto ipmi_req_err;
 
-    err = wait_for_completion_timeout(&ipmi->read_complete, IPMI_TIMEOUT);
-	if (!err)
-		goto ipmi_timeout_err;
-
 	return 0;
 
-ipmi_timeout_err:
-    err = -ETIMEDOUT;
-    dev_err(&data->pdev->dev, "request_timeout=%x\n", err);
-    return err;
 ipmi_req_err:
+    spin_lock_irqsave(&ipmi->lock, flags);
+    list_del_init(&req->list);
+    spin_unlock_irqrestore(&ipmi->lock, flags);
 	dev_err(&data->pdev->dev, "request_settime=%x\n", err);
 	return err;
 addr_err:
@@ -606,6 +637,48 @@ addr_err:
 	return err;
 }
 
+/* Wait for the response to a request queued by ipmi_submit_message() */
+static int ipmi_wait_message(struct ipmi_data *ipmi, struct ipmi_request *req)
+{
+    unsigned long flags;
+    int completed;
+
+    if (wait_for_completion_timeout(&req->done, IPMI_TIMEOUT))
+        return 0;
+
+    /* The handler fills and completes the request under the lock, so
+     * either it is done with the request or it will never see it.
+     */
+    spin_lock_irqsave(&ipmi->lock, flags);
+    completed = list_empty(&req->list);
+    list_del_init(&req->list);
+    spin_unlock_irqrestore(&ipmi->lock, flags);
+
+    if (completed)
+        return 0;
+
+    dev_err(&data->pdev->dev, "request_timeout msgid=%lx\n", req->msgid);
+    return -ETIMEDOUT;
+}
+
+/* Send an IPMI command */
+static int _ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
+                                     unsigned char *tx_data, unsigned short tx_len,
+                                     unsigned char *rx_data, unsigned short rx_len)
+{
+    struct ipmi_request req;
+    int err;
+
+    ipmi_request_init(&req, rx_data, rx_len);
+
+    err = ipmi_submit_message(ipmi, &req, cmd, tx_data, tx_len);
+    if (!err)
+        err = ipmi_wait_message(ipmi, &req);
+
+    ipmi->rx_result = err ? IPMI_UNKNOWN_ERR_COMPLETION_CODE : req.rx_result;
+    return err;
+}
+
 /* Send an IPMI command with retry */
 static int ipmi_send_message(struct ipmi_data *ipmi, unsigned char cmd,
                                      unsigned char *tx_data, unsigned short tx_len,
@@ -636,297 +709,243 @@ static void ipmi_msg_handler(struct ipmi_recv_msg *msg, void *user_msg_data)
 {
 	unsigned short rx_len;
 	struct ipmi_data *ipmi = user_msg_data;
+	struct ipmi_request *req = NULL, *pos;
+	unsigned long flags;
+
+	spin_lock_irqsave(&ipmi->lock, flags);
+	list_for_each_entry(pos, &ipmi->pending, list) {
+		if (pos->msgid == msg->msgid) {
+			req = pos;
+			break;
+		}
+	}
 
-	if (msg->msgid != ipmi->tx_msgid) {
-		dev_err(&data->pdev->dev, "Mismatch between received msgid "
-			"(%02x) and transmitted msgid (%02x)!\n",
-			(int)msg->msgid,
-			(int)ipmi->tx_msgid);
+	if (!req) {
+		spin_unlock_irqrestore(&ipmi->lock, flags);
+		dev_err(&data->pdev->dev, "Received msgid (%02x) matches no "
+			"outstanding request\n", (int)msg->msgid);
 		ipmi_free_recv_msg(msg);
 		return;
 	}
 
-	ipmi->rx_recv_type = msg->recv_type;
+	list_del_init(&req->list);
+
+	req->rx_recv_type = msg->recv_type;
 	if (msg->msg.data_len > 0)
-		ipmi->rx_result = msg->msg.data[0];
+		req->rx_result = msg->msg.data[0];
 	else
-		ipmi->rx_result = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
+		req->rx_result = IPMI_UNKNOWN_ERR_COMPLETION_CODE;
 
 	if (msg->msg.data_len > 1) {
 		rx_len = msg->msg.data_len - 1;
-		if (ipmi->rx_msg_len < rx_len)
-			rx_len = ipmi->rx_msg_len;
-		ipmi->rx_msg_len = rx_len;
-		memcpy(ipmi->rx_msg_data, msg->msg.data + 1, ipmi->rx_msg_len);
+		if (req->rx_msg_len < rx_len)
+			rx_len = req->rx_msg_len;
+		req->rx_msg_len = rx_len;
+		memcpy(req->rx_msg_data, msg->msg.data + 1, req->rx_msg_len);
 	} else
-		ipmi->rx_msg_len = 0;
+		req->rx_msg_len = 0;
+
+	complete(&req->done);
+	spin_unlock_irqrestore(&ipmi->lock, flags);
 
 	ipmi_free_recv_msg(msg);
-	complete(&ipmi->read_complete);
 }
 
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_present(void)
-{
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.sfp_last_updated[SFP_PRESENT] + HZ) && 
-        data->ipmi_resp.sfp_valid[SFP_PRESENT]) {
-        return data;
-    }
-
-    data->ipmi_resp.sfp_valid[SFP_PRESENT] = 0;
-
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x10;
-    status = ipmi_send_message(&data->ipmi, IPMI_SFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.sfp_resp[SFP_PRESENT], 
-                                sizeof(data->ipmi_resp.sfp_resp[SFP_PRESENT]));
-    if (unlikely(status != 0)) {
-        goto exit;
-    }
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
+/* IPMI_STATUS_ALL is not part of the documented BMC command set, and
+ * released BMC firmware may not implement it. Use it only with firmware
+ * known to support it, the per signal requests are used otherwise.
+ */
+static bool status_all_cmd = false;
+module_param(status_all_cmd, bool, S_IRUGO);
+MODULE_PARM_DESC(status_all_cmd, "Use the all ports status command of the BMC (default disabled)");
+
+/* Bits of the signals mask of as5916_54xks_update_status() */
+#define SFP_STATUS(s)   BIT(s)
+#define QSFP_STATUS(s)  BIT(NUM_OF_SFP_STATUS + (s))
+
+struct ipmi_status_desc {
+    unsigned char cmd;
+    unsigned char selector;
+    unsigned long interval; /* In jiffies */
+};
 
-    data->ipmi_resp.sfp_last_updated[SFP_PRESENT] = jiffies;
-    data->ipmi_resp.sfp_valid[SFP_PRESENT] = 1;
+/* SFP signals first, then QSFP signals */
+static const struct ipmi_status_desc status_desc[NUM_OF_STATUS] = {
+    [SFP_PRESENT]                      = { IPMI_SFP_READ_CMD,  0x10, HZ     },
+    [SFP_TXDISABLE]                    = { IPMI_SFP_READ_CMD,  0x01, HZ * 5 },
+    [SFP_TXFAULT]                      = { IPMI_SFP_READ_CMD,  0x12, HZ * 5 },
+    [SFP_RXLOS]                        = { IPMI_SFP_READ_CMD,  0x13, HZ * 5 },
+    [NUM_OF_SFP_STATUS+QSFP_PRESENT]   = { IPMI_QSFP_READ_CMD, 0x10, HZ     },
+    [NUM_OF_SFP_STATUS+QSFP_TXDISABLE] = { IPMI_QSFP_READ_CMD, 0x01, HZ * 5 },
+    [NUM_OF_SFP_STATUS+QSFP_RESET]     = { IPMI_QSFP_READ_CMD, 0x11, HZ * 5 },
+    [NUM_OF_SFP_STATUS+QSFP_LPMODE]    = { IPMI_QSFP_READ_CMD, 0x12, HZ * 5 },
+};
 
-exit:
-    return data;
-}
+struct ipmi_status_slot {
+    char          *valid;
+    unsigned long *last_updated;
+    unsigned char *resp;
+    unsigned short len;
+};
 
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_txdisable(void)
+static void get_status_slot(int index, struct ipmi_status_slot *slot)
 {
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.sfp_last_updated[SFP_TXDISABLE] + HZ * 5) && 
-        data->ipmi_resp.sfp_valid[SFP_TXDISABLE]) {
-        return data;
-    }
-
-    data->ipmi_resp.sfp_valid[SFP_TXDISABLE] = 0;
+    struct ipmi_sfp_resp_data *resp = &data->ipmi_resp;
 
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x01;
-    status = ipmi_send_message(&data->ipmi, IPMI_SFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.sfp_resp[SFP_TXDISABLE], 
-                                sizeof(data->ipmi_resp.sfp_resp[SFP_TXDISABLE]));
-    if (unlikely(status != 0)) {
-        goto exit;
+    if (index < NUM_OF_SFP_STATUS) {
+        slot->valid        = &resp->sfp_valid[index];
+        slot->last_updated = &resp->sfp_last_updated[index];
+        slot->resp         = resp->sfp_resp[index];
+        slot->len          = sizeof(resp->sfp_resp[index]);
     }
-
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
+    else {
+        index -= NUM_OF_SFP_STATUS;
+        slot->valid        = &resp->qsfp_valid[index];
+        slot->last_updated = &resp->qsfp_last_updated[index];
+        slot->resp         = resp->qsfp_resp[index];
+        slot->len          = sizeof(resp->qsfp_resp[index]);
     }
-
-    data->ipmi_resp.sfp_last_updated[SFP_TXDISABLE] = jiffies;
-    data->ipmi_resp.sfp_valid[SFP_TXDISABLE] = 1;
-
-exit:
-    return data;
 }
 
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_txfault(void)
+/* Set IPMI_STATUS_ALL aside for IPMI_STATUS_ALL_RETRY_INTERVAL when the
+ * BMC does not know it, or after IPMI_STATUS_ALL_MAX_FAILURES failures
+ * in a row. A single bad response only falls back for that update.
+ */
+static void as5916_54xks_status_all_failed(unsigned char rx_result)
 {
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.sfp_last_updated[SFP_TXFAULT] + HZ * 5) && 
-        data->ipmi_resp.sfp_valid[SFP_TXFAULT]) {
-        return data;
-    }
-
-    data->ipmi_resp.sfp_valid[SFP_TXFAULT] = 0;
-
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x12;
-    status = ipmi_send_message(&data->ipmi, IPMI_SFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.sfp_resp[SFP_TXFAULT], 
-                                sizeof(data->ipmi_resp.sfp_resp[SFP_TXFAULT]));
-    if (unlikely(status != 0)) {
-        goto exit;
+    if (rx_result != IPMI_CC_INVALID_CMD && rx_result != IPMI_CC_INVALID_FIELD &&
+        ++data->status_all_failures < IPMI_STATUS_ALL_MAX_FAILURES) {
+        return;
     }
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    data->ipmi_resp.sfp_last_updated[SFP_TXFAULT] = jiffies;
-    data->ipmi_resp.sfp_valid[SFP_TXFAULT] = 1;
-
-exit:
-    return data;
+    dev_info_once(&data->pdev->dev, "All ports status command failed (%02x), "
+                  "using per signal requests\n", rx_result);
+    data->status_all_failures = 0;
+    data->status_all_disabled = 1;
+    data->status_all_retry = jiffies + IPMI_STATUS_ALL_RETRY_INTERVAL;
 }
 
-static struct as5916_54xks_sfp_data *as5916_54xks_sfp_update_rxlos(void)
+/* Fetch every status signal of every port with one IPMI_STATUS_ALL
+ * request. The response holds one bitmap per signal, in status_desc
+ * order, with bit N of each bitmap set for port N+1.
+ */
+static int as5916_54xks_update_status_all(void)
 {
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.sfp_last_updated[SFP_RXLOS] + HZ * 5) && 
-        data->ipmi_resp.sfp_valid[SFP_RXLOS]) {
-        return data;
-    }
-
-    data->ipmi_resp.sfp_valid[SFP_RXLOS] = 0;
-
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x13;
-    status = ipmi_send_message(&data->ipmi, IPMI_SFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.sfp_resp[SFP_RXLOS], 
-                                sizeof(data->ipmi_resp.sfp_resp[SFP_RXLOS]));
+    unsigned char rx[NUM_OF_SFP_STATUS * SFP_STATUS_BITMAP_LEN +
+                     NUM_OF_QSFP_STATUS * QSFP_STATUS_BITMAP_LEN];
+    unsigned char tx = IPMI_STATUS_ALL;
+    struct ipmi_status_slot slot;
+    struct ipmi_request req;
+    unsigned char *bitmap = rx;
+    int i, port, status;
+
+    ipmi_request_init(&req, rx, sizeof(rx));
+    status = ipmi_submit_message(&data->ipmi, &req, IPMI_SFP_READ_CMD, &tx, 1);
+    if (!status)
+        status = ipmi_wait_message(&data->ipmi, &req);
     if (unlikely(status != 0)) {
-        goto exit;
+        as5916_54xks_status_all_failed(req.rx_result);
+        return status;
     }
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
-    }
-
-    data->ipmi_resp.sfp_last_updated[SFP_RXLOS] = jiffies;
-    data->ipmi_resp.sfp_valid[SFP_RXLOS] = 1;
-
-exit:
-    return data;
-}
-
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_present(void)
-{
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.qsfp_last_updated[QSFP_PRESENT] + HZ) && 
-        data->ipmi_resp.qsfp_valid[QSFP_PRESENT]) {
-        return data;
+    if (req.rx_result != 0 || req.rx_msg_len < sizeof(rx)) {
+        as5916_54xks_status_all_failed(req.rx_result);
+        return -EOPNOTSUPP;
     }
+    data->status_all_failures = 0;
 
-    data->ipmi_resp.qsfp_valid[QSFP_PRESENT] = 0;
+    for (i = 0; i < NUM_OF_STATUS; i++) {
+        get_status_slot(i, &slot);
 
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x10;
-    status = ipmi_send_message(&data->ipmi, IPMI_QSFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.qsfp_resp[QSFP_PRESENT], 
-                                sizeof(data->ipmi_resp.qsfp_resp[QSFP_PRESENT]));
-    if (unlikely(status != 0)) {
-        goto exit;
-    }
+        for (port = 0; port < slot.len; port++)
+            slot.resp[port] = !!(bitmap[port / 8] & BIT(port % 8));
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
+        bitmap += (i < NUM_OF_SFP_STATUS) ? SFP_STATUS_BITMAP_LEN : QSFP_STATUS_BITMAP_LEN;
+        *slot.last_updated = jiffies;
+        *slot.valid = 1;
     }
 
-    data->ipmi_resp.qsfp_last_updated[QSFP_PRESENT] = jiffies;
-    data->ipmi_resp.qsfp_valid[QSFP_PRESENT] = 1;
-
-exit:
-    return data;
+    return 0;
 }
 
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_txdisable(void)
+/* Refresh the requested signals of the shared status snapshot, a mask of
+ * SFP_STATUS() and QSFP_STATUS() bits. Returns 0 if all of them are valid.
+ *
+ * With status_all_cmd, the stale signals are fetched with one
+ * IPMI_STATUS_ALL exchange, which refreshes the other signals as well at
+ * no extra cost. Otherwise, or if that exchange fails or times out, one
+ * request per stale requested signal is queued and the responses are
+ * collected together.
+ */
+static int as5916_54xks_update_status(unsigned long signals)
 {
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.qsfp_last_updated[QSFP_TXDISABLE] + HZ * 5) && 
-        data->ipmi_resp.qsfp_valid[QSFP_TXDISABLE]) {
-        return data;
-    }
-
-    data->ipmi_resp.qsfp_valid[QSFP_TXDISABLE] = 0;
+    struct ipmi_request req[NUM_OF_STATUS];
+    unsigned char tx[NUM_OF_STATUS];
+    struct ipmi_status_slot slot;
+    unsigned long stale = 0;
+    int i, status, error = 0;
+
+    for (i = 0; i < NUM_OF_STATUS; i++) {
+        if (!(signals & BIT(i))) {
+            continue;
+        }
 
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x01;
-    status = ipmi_send_message(&data->ipmi, IPMI_QSFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.qsfp_resp[QSFP_TXDISABLE], 
-                                sizeof(data->ipmi_resp.qsfp_resp[QSFP_TXDISABLE]));
-    if (unlikely(status != 0)) {
-        goto exit;
-    }
+        get_status_slot(i, &slot);
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
+        if (!*slot.valid || !time_before(jiffies, *slot.last_updated + status_desc[i].interval)) {
+            stale |= BIT(i);
+            *slot.valid = 0;
+        }
     }
 
-    data->ipmi_resp.qsfp_last_updated[QSFP_TXDISABLE] = jiffies;
-    data->ipmi_resp.qsfp_valid[QSFP_TXDISABLE] = 1;
-
-exit:
-    return data;
-}
-
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_reset(void)
-{
-    int status = 0;
-
-    if (time_before(jiffies, data->ipmi_resp.qsfp_last_updated[QSFP_RESET] + HZ * 5) && 
-        data->ipmi_resp.qsfp_valid[QSFP_RESET]) {
-        return data;
+    if (!stale) {
+        return 0;
     }
 
-    data->ipmi_resp.qsfp_valid[QSFP_RESET] = 0;
-
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x11;
-    status = ipmi_send_message(&data->ipmi, IPMI_QSFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.qsfp_resp[QSFP_RESET], 
-                                sizeof(data->ipmi_resp.qsfp_resp[QSFP_RESET]));
-    if (unlikely(status != 0)) {
-        goto exit;
-    }
+    if (status_all_cmd) {
+        if (data->status_all_disabled && time_after_eq(jiffies, data->status_all_retry)) {
+            /* The BMC firmware may have been upgraded, ask again */
+            data->status_all_disabled = 0;
+        }
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
+        if (!data->status_all_disabled && as5916_54xks_update_status_all() == 0) {
+            return 0;
+        }
     }
 
-    data->ipmi_resp.qsfp_last_updated[QSFP_RESET] = jiffies;
-    data->ipmi_resp.qsfp_valid[QSFP_RESET] = 1;
-
-exit:
-    return data;
-}
+    for (i = 0; i < NUM_OF_STATUS; i++) {
+        if (!(stale & BIT(i))) {
+            continue;
+        }
 
-static struct as5916_54xks_sfp_data *as5916_54xks_qsfp_update_lpmode(void)
-{
-    int status = 0;
+        get_status_slot(i, &slot);
+        ipmi_request_init(&req[i], slot.resp, slot.len);
+        tx[i] = status_desc[i].selector;
 
-    if (time_before(jiffies, data->ipmi_resp.qsfp_last_updated[QSFP_LPMODE] + HZ * 5) && 
-        data->ipmi_resp.qsfp_valid[QSFP_LPMODE]) {
-        return data;
+        status = ipmi_submit_message(&data->ipmi, &req[i], status_desc[i].cmd, &tx[i], 1);
+        if (unlikely(status != 0)) {
+            stale &= ~BIT(i);
+            error = -EIO;
+        }
     }
 
-    data->ipmi_resp.qsfp_valid[QSFP_LPMODE] = 0;
+    for (i = 0; i < NUM_OF_STATUS; i++) {
+        if (!(stale & BIT(i))) {
+            continue;
+        }
 
-    /* Get status from ipmi */
-    data->ipmi_tx_data[0] = 0x12;
-    status = ipmi_send_message(&data->ipmi, IPMI_QSFP_READ_CMD, 
-                                data->ipmi_tx_data, 1,
-                                data->ipmi_resp.qsfp_resp[QSFP_LPMODE], 
-                                sizeof(data->ipmi_resp.qsfp_resp[QSFP_LPMODE]));
-    if (unlikely(status != 0)) {
-        goto exit;
-    }
+        status = ipmi_wait_message(&data->ipmi, &req[i]);
+        if (unlikely(status != 0 || req[i].rx_result != 0)) {
+            error = -EIO;
+            continue;
+        }
 
-    if (unlikely(data->ipmi.rx_result != 0)) {
-        status = -EIO;
-        goto exit;
+        get_status_slot(i, &slot);
+        *slot.last_updated = jiffies;
+        *slot.valid = 1;
     }
 
-    data->ipmi_resp.qsfp_last_updated[QSFP_LPMODE] = jiffies;
-    data->ipmi_resp.qsfp_valid[QSFP_LPMODE] = 1;
-
-exit:
-    return data;
+    return error;
 }
 
 static ssize_t show_all(struct device *dev, struct device_attribute *da, char *buf)
@@ -940,14 +959,7 @@ static ssize_t show_all(struct device *dev, struct device_attribute *da, char *b
         {
             mutex_lock(&data->update_lock);
             
-            data = as5916_54xks_sfp_update_present();
-            if (!data->ipmi_resp.sfp_valid[SFP_PRESENT]) {
-                mutex_unlock(&data->update_lock);
-                return -EIO;
-            }
-
-            data = as5916_54xks_qsfp_update_present();
-            if (!data->ipmi_resp.qsfp_valid[QSFP_PRESENT]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_PRESENT) | QSFP_STATUS(QSFP_PRESENT)) != 0) {
                 mutex_unlock(&data->update_lock);
                 return -EIO;
             }
@@ -980,8 +992,7 @@ static ssize_t show_all(struct device *dev, struct device_attribute *da, char *b
         {
             mutex_lock(&data->update_lock);
 
-            data = as5916_54xks_sfp_update_rxlos();
-            if (!data->ipmi_resp.sfp_valid[SFP_RXLOS]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_RXLOS)) != 0) {
                 mutex_unlock(&data->update_lock);
                 return -EIO;
             }
@@ -1069,8 +1080,7 @@ static ssize_t show_sfp(struct device *dev, struct device_attribute *da, char *b
 		case SFP47_PRESENT:
         case SFP48_PRESENT:
         {
-            data = as5916_54xks_sfp_update_present();
-            if (!data->ipmi_resp.sfp_valid[SFP_PRESENT]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_PRESENT)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1127,8 +1137,7 @@ static ssize_t show_sfp(struct device *dev, struct device_attribute *da, char *b
 		case SFP47_TXDISABLE:
         case SFP48_TXDISABLE:
         {
-            data = as5916_54xks_sfp_update_txdisable();
-            if (!data->ipmi_resp.sfp_valid[SFP_TXDISABLE]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_TXDISABLE)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1185,8 +1194,7 @@ static ssize_t show_sfp(struct device *dev, struct device_attribute *da, char *b
 		case SFP47_TXFAULT:
         case SFP48_TXFAULT:
         {
-            data = as5916_54xks_sfp_update_txfault();
-            if (!data->ipmi_resp.sfp_valid[SFP_TXFAULT]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_TXFAULT)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1243,8 +1251,7 @@ static ssize_t show_sfp(struct device *dev, struct device_attribute *da, char *b
 		case SFP47_RXLOS:
         case SFP48_RXLOS:
         {
-            data = as5916_54xks_sfp_update_rxlos();
-            if (!data->ipmi_resp.sfp_valid[SFP_RXLOS]) {
+            if (as5916_54xks_update_status(SFP_STATUS(SFP_RXLOS)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1323,8 +1330,7 @@ static ssize_t show_qsfp(struct device *dev, struct device_attribute *da, char *
 		case QSFP53_PRESENT:
         case QSFP54_PRESENT:
         {
-            data = as5916_54xks_qsfp_update_present();
-            if (!data->ipmi_resp.qsfp_valid[QSFP_PRESENT]) {
+            if (as5916_54xks_update_status(QSFP_STATUS(QSFP_PRESENT)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1339,8 +1345,7 @@ static ssize_t show_qsfp(struct device *dev, struct device_attribute *da, char *
 		case QSFP53_TXDISABLE:
 		case QSFP54_TXDISABLE:
         {
-            data = as5916_54xks_qsfp_update_txdisable();
-            if (!data->ipmi_resp.qsfp_valid[QSFP_TXDISABLE]) {
+            if (as5916_54xks_update_status(QSFP_STATUS(QSFP_TXDISABLE)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1355,8 +1360,7 @@ static ssize_t show_qsfp(struct device *dev, struct device_attribute *da, char *
 		case QSFP53_RESET:
 		case QSFP54_RESET:
         {
-            data = as5916_54xks_qsfp_update_reset();
-            if (!data->ipmi_resp.qsfp_valid[QSFP_RESET]) {
+            if (as5916_54xks_update_status(QSFP_STATUS(QSFP_RESET)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1371,8 +1375,7 @@ static ssize_t show_qsfp(struct device *dev, struct device_attribute *da, char *
 		case QSFP53_LPMODE:
 		case QSFP54_LPMODE:
         {
-            data = as5916_54xks_qsfp_update_lpmode();
-            if (!data->ipmi_resp.qsfp_valid[QSFP_LPMODE]) {
+            if (as5916_54xks_update_status(QSFP_STATUS(QSFP_LPMODE)) != 0) {
                 error = -EIO;
                 goto exit;
             }
@@ -1403,8 +1406,7 @@ static ssize_t set_qsfp_txdisable(struct device *dev, struct device_attribute *d
 
     mutex_lock(&data->update_lock);
 
-    data = as5916_54xks_qsfp_update_present();
-    if (!data->ipmi_resp.qsfp_valid[QSFP_PRESENT]) {
+    if (as5916_54xks_update_status(QSFP_STATUS(QSFP_PRESENT)) != 0) {
         status = -EIO;
         goto exit;
     }
@@ -1708,8 +1710,7 @@ static int as5916_54xks_sfp_is_port_present(u8 port)
     mutex_lock(&data->update_lock);
 
     if (port <= NUM_OF_SFP) {
-        data = as5916_54xks_sfp_update_present();
-        if (!data->ipmi_resp.sfp_valid[SFP_PRESENT]) {
+        if (as5916_54xks_update_status(SFP_STATUS(SFP_PRESENT)) != 0) {
             mutex_unlock(&data->update_lock);
             return -EIO;
         }
@@ -1719,8 +1720,7 @@ static int as5916_54xks_sfp_is_port_present(u8 port)
     else { /* QSFP */
         port -= NUM_OF_SFP;
         
-        data = as5916_54xks_qsfp_update_present();
-        if (!data->ipmi_resp.qsfp_valid[QSFP_PRESENT]) {
+        if (as5916_54xks_update_status(QSFP_STATUS(QSFP_PRESENT)) != 0) {
             mutex_unlock(&data->update_lock);
             return -EIO;
         }
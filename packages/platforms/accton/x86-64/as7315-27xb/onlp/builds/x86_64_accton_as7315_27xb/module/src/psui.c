@@ -80,6 +80,52 @@ get_DCorAC_cap(char *model)
     return ONLP_PSU_CAPS_AC;
 }
 
+/*
+ * Presence and power good only, without the PMBus reads.
+ */
+static int
+psu_status_get__(int pid, uint32_t* status)
+{
+    int val = 0;
+    int zid = pid - 1;
+    int bus = eeprom_cfg[zid][0];
+    int offset = eeprom_cfg[zid][1];
+
+    *status = 0;
+
+    /* Get the present state */
+    if (onlp_file_read_int(&val, PSU_SYSFS_PATH"psu_present", bus, offset) < 0) {
+        AIM_LOG_ERROR("Unable to read status from (%s""psu%d_present)\r\n", PSU_SYSFS_PATH, pid);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    if (val != PSU_STATUS_PRESENT) {
+        return ONLP_STATUS_OK;
+    }
+    *status |= ONLP_PSU_STATUS_PRESENT;
+
+    /* Get power good status */
+    if (onlp_file_read_int(&val, PSU_SYSFS_PATH"psu_power_good", bus, offset) < 0) {
+        AIM_LOG_ERROR("Unable to read status from (%s""psu%d_power_good)\r\n", PSU_SYSFS_PATH, pid);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    if (val != PSU_STATUS_POWER_GOOD) {
+        *status |= ONLP_PSU_STATUS_FAILED;
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_psui_status_get(onlp_oid_t id, uint32_t* rv)
+{
+    int pid = ONLP_OID_ID_GET(id);
+
+    VALIDATE(id);
+    if (pid >= AIM_ARRAYSIZE(pinfo) || pid == 0) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    return psu_status_get__(pid, rv);
+}
+
 int
 onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
 {
@@ -98,36 +144,17 @@ onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
     memset(info, 0, sizeof(onlp_psu_info_t));
     *info = pinfo[pid]; /* Set the onlp_oid_hdr_t */
 
-    bus = eeprom_cfg[zid][0];
-    offset = eeprom_cfg[zid][1];
-    /* Get the present state */
-    ret = onlp_file_read_int(&val, PSU_SYSFS_PATH"psu_present", bus, offset);
+    ret = psu_status_get__(pid, &info->status);
     if (ret < 0) {
-        AIM_LOG_ERROR("Unable to read status from (%s""psu%d_present)\r\n", PSU_SYSFS_PATH, pid);
-        return ONLP_STATUS_E_INTERNAL;
+        return ret;
     }
-
-    if (val != PSU_STATUS_PRESENT) {
-        info->status &= ~ONLP_PSU_STATUS_PRESENT;
+    if (!(info->status & ONLP_PSU_STATUS_PRESENT) ||
+        (info->status & ONLP_PSU_STATUS_FAILED)) {
         return ONLP_STATUS_OK;
     }
-    info->status |= ONLP_PSU_STATUS_PRESENT;
 
-    /* Get power good status */
-    ret = onlp_file_read_int(&val, PSU_SYSFS_PATH"psu_power_good", bus, offset);
-    if (ret < 0) {
-        AIM_LOG_ERROR("Unable to read status from (%s""psu%d_power_good)\r\n", PSU_SYSFS_PATH, pid);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-
-    if (val != PSU_STATUS_POWER_GOOD) {
-        info->status |=  ONLP_PSU_STATUS_FAILED;
-        return ONLP_STATUS_OK;
-    }
-
-    if (info->status & ONLP_PSU_STATUS_FAILED) {
-        return ONLP_STATUS_OK;
-    }
+    bus = eeprom_cfg[zid][0];
+    offset = eeprom_cfg[zid][1];
 
     /* Read serial */
     string = NULL;
@@ -26,6 +26,7 @@
 #include <onlp/platformi/sfpi.h>
 #include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <onlp/invalidate.h>
 #include "x86_64_accton_as7315_27xb_int.h"
 #include "x86_64_accton_as7315_27xb_log.h"
 
@@ -40,7 +41,8 @@ enum port_type {
 #define NUM_QSFP    3
 #define NUM_PORT    (NUM_SFP+NUM_QSFP)
 #define SIDE_BAND_PATH                  "/sys/bus/i2c/devices/%d-00%02x/"
-#define PORT_EEPROM_FORMAT              "/sys/bus/i2c/devices/%d-0050/eeprom"
+#define PORT_DEVICE_FORMAT              "/sys/bus/i2c/devices/%d-0050"
+#define PORT_EEPROM_FORMAT              PORT_DEVICE_FORMAT "/eeprom"
 
 const int PORT_NUM[PORT_TYPE_MAX] = {NUM_SFP, NUM_QSFP};
 const int SB_CFG[PORT_TYPE_MAX][2] = {{8, 0x63}, {7, 0x64}};
@@ -69,10 +71,26 @@ static int port_to_index(int port)
 }
 
 
+/* SFP: 26~49. QSFP: 21,22,23 for 100G port, from left to right. */
+static int port_to_bus(int port)
+{
+    if (get_port_type(port) == PORT_TYPE_QSFP)
+        return 21 + (port - NUM_SFP);
+    else
+        return 26 + (port%NUM_SFP);
+}
+
 int
 onlp_sfpi_init(void)
 {
-    /* Called at initialization time */
+    char path[64];
+    int port;
+
+    /* Module changes invalidate the cached state of the port. */
+    for (port = 0; port < NUM_PORT; port++) {
+        snprintf(path, sizeof(path), PORT_DEVICE_FORMAT, port_to_bus(port));
+        onlp_invalidate_bind(path, ONLP_INVALIDATE_CLASS_SFP, port);
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -217,7 +235,6 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
      */
     int type, bus;
     int size = 0;
-    int bus_start[]= {26, 21}; /*26~49. QSFP:21,22,23 for 100G port, from left to right. */
 
     type = get_port_type(port);
     if (type < 0)
@@ -225,14 +242,7 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
         return ONLP_STATUS_E_INTERNAL;
     }
 
-
-    if (type == PORT_TYPE_QSFP) {
-        bus = bus_start[type];
-        bus += port - NUM_SFP;
-    }
-    else {
-        bus = bus_start[type] + (port%NUM_SFP);
-    }
+    bus = port_to_bus(port);
 
     memset(data, 0, 256);
     if(onlp_file_read(data, 256, &size, PORT_EEPROM_FORMAT, bus) != ONLP_STATUS_OK) {
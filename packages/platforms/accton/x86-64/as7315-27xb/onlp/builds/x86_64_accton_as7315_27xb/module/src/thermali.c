@@ -25,6 +25,7 @@
  ***********************************************************/
 #include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <onlplib/hwmon.h>
 #include <onlp/platformi/thermali.h>
 #include "platform_lib.h"
 
@@ -47,28 +48,30 @@ enum onlp_thermal_id
         }                                       \
     } while(0)
 
-static char* cpu_coretemp_files[] =
-{
-    "/sys/devices/platform/coretemp.0/hwmon/hwmon1/temp10_input",
-    "/sys/devices/platform/coretemp.0/hwmon/hwmon1/temp14_input",
-    "/sys/devices/platform/coretemp.0/hwmon/hwmon1/temp1_input",
-    "/sys/devices/platform/coretemp.0/hwmon/hwmon1/temp4_input",
-    "/sys/devices/platform/coretemp.0/hwmon/hwmon1/temp8_input",
-    NULL,
-};
-
 static char* board_devfiles__[] =  /* must map with onlp_thermal_id */
 {
     NULL,
     NULL,                  /* CPU_CORE files */
-    "/sys/bus/i2c/devices/51-0049*temp1_input",
-    "/sys/bus/i2c/devices/52-004a*temp1_input",
-    "/sys/bus/i2c/devices/53-004c*temp1_input",
+    NULL,                  /* LM75s, see board_hwmon_paths__ */
+    NULL,
+    NULL,
     "/sys/bus/i2c/devices/13-005b/psu_temp1_input",
     "/sys/bus/i2c/devices/12-0058/psu_temp1_input",
 };
 
+static char* board_hwmon_paths__[] =  /* must map with onlp_thermal_id */
+{
+    NULL,
+    "/sys/devices/platform/coretemp.0",
+    "/sys/bus/i2c/devices/51-0049",
+    "/sys/bus/i2c/devices/52-004a",
+    "/sys/bus/i2c/devices/53-004c",
+    NULL,
+    NULL,
+};
 
+/* Opened on first use and kept open. */
+static onlp_hwmon_t* board_hwmon__[AIM_ARRAYSIZE(board_hwmon_paths__)];
 
 /* Static values */
 static onlp_thermal_info_t tinfo[] = {
@@ -108,6 +111,27 @@ onlp_thermali_init(void)
     return ONLP_STATUS_OK;
 }
 
+static onlp_hwmon_t*
+onlp_thermali_hwmon(int tid)
+{
+    if(board_hwmon__[tid] == NULL) {
+        onlp_hwmon_open(&board_hwmon__[tid], "%s", board_hwmon_paths__[tid]);
+    }
+    return board_hwmon__[tid];
+}
+
+static int
+onlp_thermali_read_cpu_core(onlp_thermal_info_t* info)
+{
+    onlp_hwmon_t* dev = onlp_thermali_hwmon(THERMAL_CPU_CORE);
+    if(dev == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    /* Every core is read in one pass. */
+    onlp_hwmon_read_all(dev, NULL, 0);
+    return onlp_hwmon_value_max(dev, ONLP_HWMON_TYPE_TEMP, &info->mcelsius);
+}
+
 static int
 onlp_thermali_read_devfile(int tid, onlp_thermal_info_t* info)
 {
@@ -117,7 +141,14 @@ onlp_thermali_read_devfile(int tid, onlp_thermal_info_t* info)
 static int
 onlp_thermali_read_mainboard(int tid, onlp_thermal_info_t* info)
 {
-    if (tid >= THERMAL_1_ON_MAIN_BROAD || tid <= THERMAL_1_ON_PSU2) {
+    if (tid >= THERMAL_1_ON_MAIN_BROAD && tid <= THERMAL_3_ON_MAIN_BROAD) {
+        onlp_hwmon_t* dev = onlp_thermali_hwmon(tid);
+        if(dev == NULL) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        return onlp_hwmon_read(dev, ONLP_HWMON_TYPE_TEMP, 1, &info->mcelsius);
+    }
+    if (tid >= THERMAL_1_ON_PSU1 && tid <= THERMAL_1_ON_PSU2) {
         return  onlp_thermali_read_devfile(tid, info);
     }
 
@@ -148,7 +179,7 @@ onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* info)
     /* Set the onlp_oid_hdr_t and capabilities */
     *info = tinfo[tid];
     if(tid == THERMAL_CPU_CORE) {
-        rv = onlp_file_read_int_max(&info->mcelsius, cpu_coretemp_files);
+        rv = onlp_thermali_read_cpu_core(info);
     } else {
         rv = onlp_thermali_read_mainboard(tid, info);
     }
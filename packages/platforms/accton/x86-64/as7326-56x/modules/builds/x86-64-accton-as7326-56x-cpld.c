@@ -33,6 +33,7 @@
 #include <linux/stat.h>
 #include <linux/hwmon-sysfs.h>
 #include <linux/delay.h>
+#include "accton_cpld_regmap.h"
 
 #define I2C_RW_RETRY_COUNT				10
 #define I2C_RW_RETRY_INTERVAL			60 /* ms */
@@ -55,6 +56,87 @@ struct as7326_56x_cpld_data {
     enum cpld_type   type;
     struct device   *hwmon_dev;
     struct mutex     update_lock;
+    struct accton_cpld *cpld;
+};
+
+/* Port signal layout. CPLD2 serves ports 1-30 and CPLD1 ports 31-58.
+ * On CPLD1, ports 49-56 are QSFP and only report presence.
+ */
+static const struct accton_cpld_bank cpld2_present[] = {
+    ACCTON_CPLD_BANK(0x0f, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x10, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x11, 0, 8, 16),
+    ACCTON_CPLD_BANK(0x12, 0, 6, 24),
+};
+static const struct accton_cpld_bank cpld2_tx_fault[] = {
+    ACCTON_CPLD_BANK(0x03, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x04, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x05, 0, 8, 16),
+    ACCTON_CPLD_BANK(0x06, 0, 6, 24),
+};
+static const struct accton_cpld_bank cpld2_tx_disable[] = {
+    ACCTON_CPLD_BANK(0x07, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x08, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x09, 0, 8, 16),
+    ACCTON_CPLD_BANK(0x0a, 0, 6, 24),
+};
+static const struct accton_cpld_bank cpld2_rx_los[] = {
+    ACCTON_CPLD_BANK(0x0b, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x0c, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x0d, 0, 8, 16),
+    ACCTON_CPLD_BANK(0x0e, 0, 6, 24),
+};
+
+static const struct accton_cpld_bank cpld1_present[] = {
+    ACCTON_CPLD_BANK(0x10, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x11, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x12, 0, 2, 16),
+    ACCTON_CPLD_BANK(0x13, 0, 8, 18),
+    ACCTON_CPLD_BANK(0x12, 2, 2, 26),
+};
+static const struct accton_cpld_bank cpld1_tx_fault[] = {
+    ACCTON_CPLD_BANK(0x1a, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x1b, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x1c, 0, 2, 16),
+    ACCTON_CPLD_BANK(0x1c, 2, 2, 26),
+};
+static const struct accton_cpld_bank cpld1_tx_disable[] = {
+    ACCTON_CPLD_BANK(0x14, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x15, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x16, 0, 2, 16),
+    ACCTON_CPLD_BANK(0x16, 2, 2, 26),
+};
+static const struct accton_cpld_bank cpld1_rx_los[] = {
+    ACCTON_CPLD_BANK(0x17, 0, 8,  0),
+    ACCTON_CPLD_BANK(0x18, 0, 8,  8),
+    ACCTON_CPLD_BANK(0x19, 0, 2, 16),
+    ACCTON_CPLD_BANK(0x19, 2, 2, 26),
+};
+
+static const struct accton_cpld_layout as7326_56x_cpld_layouts[] = {
+    [as7326_56x_cpld1] = {
+        .port_base = 31,
+        .nports    = 28,
+        .signals   = {
+            [ACCTON_CPLD_PRESENT]    = ACCTON_CPLD_SIGNAL(cpld1_present, 1),
+            [ACCTON_CPLD_TX_FAULT]   = ACCTON_CPLD_SIGNAL(cpld1_tx_fault, 0),
+            [ACCTON_CPLD_TX_DISABLE] = ACCTON_CPLD_SIGNAL(cpld1_tx_disable, 0),
+            [ACCTON_CPLD_RX_LOS]     = ACCTON_CPLD_SIGNAL(cpld1_rx_los, 0),
+        },
+    },
+    [as7326_56x_cpld2] = {
+        .port_base = 1,
+        .nports    = 30,
+        .signals   = {
+            [ACCTON_CPLD_PRESENT]    = ACCTON_CPLD_SIGNAL(cpld2_present, 1),
+            [ACCTON_CPLD_TX_FAULT]   = ACCTON_CPLD_SIGNAL(cpld2_tx_fault, 0),
+            [ACCTON_CPLD_TX_DISABLE] = ACCTON_CPLD_SIGNAL(cpld2_tx_disable, 0),
+            [ACCTON_CPLD_RX_LOS]     = ACCTON_CPLD_SIGNAL(cpld2_rx_los, 0),
+        },
+    },
+    [as7326_56x_cpld3] = {
+        .nports    = 0,
+    },
 };
 
 static const struct i2c_device_id as7326_56x_cpld_id[] = {
@@ -303,6 +385,7 @@ static ssize_t show_version(struct device *dev, struct device_attribute *da,
              char *buf);
 static int as7326_56x_cpld_read_internal(struct i2c_client *client, u8 reg);
 static int as7326_56x_cpld_write_internal(struct i2c_client *client, u8 reg, u8 value);
+static int as7326_56x_cpld_update_bits_internal(struct i2c_client *client, u8 reg, u8 mask, u8 value);
 
 /* transceiver attributes */
 #define DECLARE_TRANSCEIVER_PRESENT_SENSOR_DEVICE_ATTR(index) \
@@ -600,119 +683,39 @@ static int string_byte_sep(char *out, int bits, u64 bytes)
     return 0;
 }
 
-static ssize_t show_present_all(struct device *dev, struct device_attribute *da,
+static ssize_t show_bitmap(struct device *dev, enum accton_cpld_signal signal,
              char *buf)
 {
     int i, status;
-    u64 values = 0, num;
+    u64 values = 0;
+    u8 bitmap[8] = {0};
     struct i2c_client *client = to_i2c_client(dev);
     struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
 
-    if (data->type == as7326_56x_cpld2) {
-        u8 byte;
-        u8 regs[] = {0x0F, 0x10, 0x11, 0x12};
-
-        mutex_lock(&data->update_lock);
-        for (i = 0; i < ARRAY_SIZE(regs); i++) {
-            status = as7326_56x_cpld_read_internal(client, regs[i]);
-        
-            if (status < 0) {
-                goto exit;
-            }
-            byte= (u64)status;
-            byte= ~byte;
-            values |= (byte)<<(i*8);
-        }
-        mutex_unlock(&data->update_lock);
-
-        /* Return values for port 1~30 in order */
-        num = 30;
-        values &= (1<<num)-1;
+    /* Port order matches the packed bitmap, lowest port first */
+    status = accton_cpld_bitmap_get(data->cpld, signal, bitmap, sizeof(bitmap));
+    if (status < 0) {
+        return status;
     }
-    else { /* as7326_56x_cpld1 */
-        u8 regs[] = {0x10, 0x11, 0x12, 0x13};
-        u8 bytes[4] = {0};
-
-        mutex_lock(&data->update_lock);
-        for (i = 0; i < ARRAY_SIZE(regs); i++) {
-            status = as7326_56x_cpld_read_internal(client, regs[i]);
-            if (status < 0) {
-                goto exit;
-            }
-            bytes[i] = (u8)status;
-            bytes[i] = ~bytes[i];
-        }
-        mutex_unlock(&data->update_lock);
 
-        /* Return values of port 31 -> 58 in order */
-        values = bytes[0] | (bytes[1]<<8) | ((bytes[2]&0x3)<<16) | ((bytes[3])<<18) | 
-                (((bytes[2]&0xC) >> 2)<<26);
-        num = 28;
-        values &= (1<<num)-1;
+    for (i = 0; i < status; i++) {
+        values |= (u64)bitmap[i] << (i*8);
     }
-    string_byte_sep(buf, num, values);
+
+    string_byte_sep(buf, as7326_56x_cpld_layouts[data->type].nports, values);
     return sprintf(buf, "%s", buf);
-exit:
-    mutex_unlock(&data->update_lock);
-    return status;
 }
 
-static ssize_t show_rxlos_all(struct device *dev, struct device_attribute *da,
+static ssize_t show_present_all(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    int i, status;
-    u64 values = 0, num;
-    struct i2c_client *client = to_i2c_client(dev);
-    struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
-
-    if (data->type == as7326_56x_cpld2) {
-        u8 byte;
-        u8 regs[] = {0x0B, 0x0C, 0x0D, 0x0E};
-
-        mutex_lock(&data->update_lock);
-        for (i = 0; i < ARRAY_SIZE(regs); i++) {
-            status = as7326_56x_cpld_read_internal(client, regs[i]);
-        
-            if (status < 0) {
-                goto exit;
-            }
-            byte= (u64)status;
-            values |= (byte)<<(i*8);
-        }
-        mutex_unlock(&data->update_lock);
-
-        /* Return values for port 1~30 in order */
-        num = 30;
-        values &= (1<<num)-1;
-
-    }
-    else { /* as7326_56x_cpld1 */
-        u8 regs[] = {0x17, 0x18, 0x19};
-        u8 bytes[4] = {0};
-
-        mutex_lock(&data->update_lock);
-        for (i = 0; i < ARRAY_SIZE(regs); i++) {
-            status = as7326_56x_cpld_read_internal(client, regs[i]);
-        
-            if (status < 0) {
-                goto exit;
-            }
-            bytes[i] = (u8)status;
-        }
-        mutex_unlock(&data->update_lock);
-
-        /* Return values of port 31 -> 58 in order */
-        values = bytes[0] | (bytes[1]<<8) | ((bytes[2]&0x3)<<16) |
-                (((bytes[2]&0xC) >> 2)<<26);
+    return show_bitmap(dev, ACCTON_CPLD_PRESENT, buf);
+}
 
-        num = 28;
-        values &= (1<<num)-1;
-    }
-    string_byte_sep(buf, num, values);
-    return sprintf(buf, "%s", buf);
-exit:
-    mutex_unlock(&data->update_lock);
-    return status;
+static ssize_t show_rxlos_all(struct device *dev, struct device_attribute *da,
+             char *buf)
+{
+    return show_bitmap(dev, ACCTON_CPLD_RX_LOS, buf);
 }
 
 static ssize_t show_status(struct device *dev, struct device_attribute *da,
@@ -804,7 +807,6 @@ static ssize_t set_tx_disable(struct device *dev, struct device_attribute *da,
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
 	struct i2c_client *client = to_i2c_client(dev);
-	struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
 	long disable;
 	int status;
     u8 reg = 0, mask = 0;
@@ -831,32 +833,13 @@ static ssize_t set_tx_disable(struct device *dev, struct device_attribute *da,
 		return 0;
 	}
 
-    /* Read current status */
-    mutex_lock(&data->update_lock);
-	status = as7326_56x_cpld_read_internal(client, reg);
+	/* Go through regmap so this is serialized with the bitmap setters */
+	status = as7326_56x_cpld_update_bits_internal(client, reg, mask, disable ? mask : 0);
 	if (unlikely(status < 0)) {
-		goto exit;
-	}
-
-	/* Update tx_disable status */
-	if (disable) {
-		status |= mask;
-	}
-	else {
-		status &= ~mask;
-	}
-
-        status = as7326_56x_cpld_write_internal(client, reg, status);
-	if (unlikely(status < 0)) {
-		goto exit;
+		return status;
 	}
-    
-    mutex_unlock(&data->update_lock);
-    return count;
 
-exit:
-	mutex_unlock(&data->update_lock);
-	return status;
+	return count;
 }
 
 static ssize_t access(struct device *dev, struct device_attribute *da,
@@ -983,16 +966,24 @@ static int as7326_56x_cpld_probe(struct i2c_client *client,
         break;
     }
 
+    data->cpld = accton_cpld_register(client, &as7326_56x_cpld_layouts[data->type]);
+    if (IS_ERR(data->cpld)) {
+        ret = PTR_ERR(data->cpld);
+        goto exit_free;
+    }
+
     if (group) {
         ret = sysfs_create_group(&client->dev.kobj, group);
         if (ret) {
-            goto exit_free;
+            goto exit_unregister;
         }
     }
 
     as7326_56x_cpld_add_client(client);
     return 0;
 
+exit_unregister:
+    accton_cpld_unregister(data->cpld);
 exit_free:
     kfree(data);
 exit:
@@ -1025,6 +1016,7 @@ static int as7326_56x_cpld_remove(struct i2c_client *client)
         sysfs_remove_group(&client->dev.kobj, group);
     }
 
+    accton_cpld_unregister(data->cpld);
     kfree(data);
 
     return 0;
@@ -1032,10 +1024,11 @@ static int as7326_56x_cpld_remove(struct i2c_client *client)
 
 static int as7326_56x_cpld_read_internal(struct i2c_client *client, u8 reg)
 {
+	struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
 	int status = 0, retry = I2C_RW_RETRY_COUNT;
 
 	while (retry) {
-		status = i2c_smbus_read_byte_data(client, reg);
+		status = accton_cpld_reg_read(data->cpld, reg);
 		if (unlikely(status < 0)) {
 			msleep(I2C_RW_RETRY_INTERVAL);
 			retry--;
@@ -1050,10 +1043,30 @@ static int as7326_56x_cpld_read_internal(struct i2c_client *client, u8 reg)
 
 static int as7326_56x_cpld_write_internal(struct i2c_client *client, u8 reg, u8 value)
 {
+	struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
+	int status = 0, retry = I2C_RW_RETRY_COUNT;
+
+	while (retry) {
+		status = accton_cpld_reg_write(data->cpld, reg, value);
+		if (unlikely(status < 0)) {
+			msleep(I2C_RW_RETRY_INTERVAL);
+			retry--;
+			continue;
+		}
+
+		break;
+	}
+
+    return status;
+}
+
+static int as7326_56x_cpld_update_bits_internal(struct i2c_client *client, u8 reg, u8 mask, u8 value)
+{
+	struct as7326_56x_cpld_data *data = i2c_get_clientdata(client);
 	int status = 0, retry = I2C_RW_RETRY_COUNT;
 
 	while (retry) {
-		status = i2c_smbus_write_byte_data(client, reg, value);
+		status = accton_cpld_reg_update_bits(data->cpld, reg, mask, value);
 		if (unlikely(status < 0)) {
 			msleep(I2C_RW_RETRY_INTERVAL);
 			retry--;
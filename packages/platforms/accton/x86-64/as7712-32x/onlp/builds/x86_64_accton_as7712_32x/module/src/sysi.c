@@ -23,9 +23,6 @@
  *
  *
  ***********************************************************/
-#include <unistd.h>
-#include <fcntl.h>
-
 #include <onlplib/file.h>
 #include <onlp/platformi/sysi.h>
 #include <onlp/platformi/ledi.h>
@@ -129,28 +126,21 @@ onlp_sysi_oids_get(onlp_oid_t* table, int max)
     return 0;
 }
 
-typedef struct fan_ctrl_policy {
-   int duty_cycle;
-   int temp_down_adjust; /* The boundary temperature to down adjust fan speed */
-   int temp_up_adjust;   /* The boundary temperature to up adjust fan speed */
-} fan_ctrl_policy_t;
-
-fan_ctrl_policy_t  fan_ctrl_policy_f2b[] = {
-{32,      0, 174000},
-{38, 170000, 182000},
-{50, 178000, 190000},
-{63, 186000,      0}
+static const onlp_thermal_control_step_t fan_ctrl_policy_f2b[] = {
+    {32,      0, 174000},
+    {38, 170000, 182000},
+    {50, 178000, 190000},
+    {63, 186000,      0}
 };
 
-fan_ctrl_policy_t  fan_ctrl_policy_b2f[] = {
-{32,     0,  140000},
-{38, 135000, 150000},
-{50, 145000, 160000},
-{69, 155000,      0}
+static const onlp_thermal_control_step_t fan_ctrl_policy_b2f[] = {
+    {32,      0, 140000},
+    {38, 135000, 150000},
+    {50, 145000, 160000},
+    {69, 155000,      0}
 };
 
 #define FAN_DUTY_CYCLE_MAX  100
-#define FAN_SPEED_CTRL_PATH "/sys/bus/i2c/devices/2-0066/fan_duty_cycle_percentage"
 
 /*
  * For AC power Front to Back :
@@ -176,115 +166,54 @@ fan_ctrl_policy_t  fan_ctrl_policy_b2f[] = {
  *		[LM75(48) + LM75(49) + LM75(4A)] < 145  => set Fan speed value from 7 to 5
  *		[LM75(48) + LM75(49) + LM75(4A)] < 155  => set Fan speed value from 10 to 7
  */
-int
-onlp_sysi_platform_manage_fans(void)
-{
-    int i = 0, arr_size, temp;
-    fan_ctrl_policy_t *policy;
-    int cur_duty_cycle, new_duty_cycle;
-    onlp_thermal_info_t thermal_1, thermal_2, thermal_3;
+static const onlp_oid_t fan_ctrl_thermals[] = {
+    ONLP_THERMAL_ID_CREATE(2),
+    ONLP_THERMAL_ID_CREATE(3),
+    ONLP_THERMAL_ID_CREATE(4),
+};
 
-    int  fd, len;
-    char  buf[10] = {0};
+static const onlp_oid_t fan_ctrl_fans[] = {
+    ONLP_FAN_ID_CREATE(1),
+    ONLP_FAN_ID_CREATE(2),
+    ONLP_FAN_ID_CREATE(3),
+    ONLP_FAN_ID_CREATE(4),
+    ONLP_FAN_ID_CREATE(5),
+    ONLP_FAN_ID_CREATE(6),
+};
 
-    /* Get each fan status
-     */
-    for (i = 1; i <= NUM_OF_FAN_ON_MAIN_BROAD; i++)
+static const onlp_thermal_control_group_t fan_ctrl_groups[] = {
     {
-        onlp_fan_info_t fan_info;
-
-        if (onlp_fani_info_get(ONLP_FAN_ID_CREATE(i), &fan_info) != ONLP_STATUS_OK) {
-            AIM_LOG_ERROR("Unable to get fan(%d) status\r\n", i);
-            return ONLP_STATUS_E_INTERNAL;
-        }
-
-        /* Decision 1: Set fan as full speed if any fan is failed.
-         */
-        if (fan_info.status & ONLP_FAN_STATUS_FAILED) {
-            AIM_LOG_ERROR("Fan(%d) is not working, set the other fans as full speed\r\n", i);
-            return onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), FAN_DUTY_CYCLE_MAX);
-        }
-
-        /* Decision 1.1: Set fan as full speed if any fan is not present.
-         */
-        if (!(fan_info.status & ONLP_FAN_STATUS_PRESENT)) {
-            AIM_LOG_ERROR("Fan(%d) is not present, set the other fans as full speed\r\n", i);
-            return onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), FAN_DUTY_CYCLE_MAX);
-        }
-
-        /* Get fan direction (Only get the first one since all fan direction are the same)
-         */
-        if (i == 1) {
-            if (fan_info.status & ONLP_FAN_STATUS_F2B) {
-                policy   = fan_ctrl_policy_f2b;
-                arr_size = AIM_ARRAYSIZE(fan_ctrl_policy_f2b);
-            }
-            else {
-                policy   = fan_ctrl_policy_b2f;
-                arr_size = AIM_ARRAYSIZE(fan_ctrl_policy_b2f);
-            }
-        }
-    }
-
-    /* Get current fan speed
-     */
-    fd = open(FAN_SPEED_CTRL_PATH, O_RDONLY);
-    if (fd == -1){
-        AIM_LOG_ERROR("Unable to open fan speed control node (%s)", FAN_SPEED_CTRL_PATH);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-
-    len = read(fd, buf, sizeof(buf));
-    close(fd);
-    if (len <= 0) {
-        AIM_LOG_ERROR("Unable to read fan speed from (%s)", FAN_SPEED_CTRL_PATH);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    cur_duty_cycle = atoi(buf);
-
-
-    /* Decision 2: If no matched fan speed is found from the policy,
-     *             use FAN_DUTY_CYCLE_MIN as default speed
-     */
-	for (i = 0; i < arr_size; i++) {
-	    if (policy[i].duty_cycle != cur_duty_cycle)
-		    continue;
-
-		break;
-	}
-
-	if (i == arr_size) {
-        return onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), policy[0].duty_cycle);
-	}
-
-    /* Get current temperature
-     */
-    if (onlp_thermali_info_get(ONLP_THERMAL_ID_CREATE(2), &thermal_1) != ONLP_STATUS_OK ||
-        onlp_thermali_info_get(ONLP_THERMAL_ID_CREATE(3), &thermal_2) != ONLP_STATUS_OK ||
-        onlp_thermali_info_get(ONLP_THERMAL_ID_CREATE(4), &thermal_3) != ONLP_STATUS_OK) {
-        AIM_LOG_ERROR("Unable to read thermal status");
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    temp = thermal_1.mcelsius + thermal_2.mcelsius + thermal_3.mcelsius;
-
-
-    /* Decision 3: Decide new fan speed depend on fan direction/current fan speed/temperature
-     */
-    new_duty_cycle = cur_duty_cycle;
-
-    if ((temp >= policy[i].temp_up_adjust) && (i != (arr_size-1))) {
-	    new_duty_cycle = policy[i+1].duty_cycle;
-	}
-	else if ((temp <= policy[i].temp_down_adjust) && (i != 0)) {
-	    new_duty_cycle = policy[i-1].duty_cycle;
-	}
+        .name = "LM75",
+        .thermals = fan_ctrl_thermals,
+        .thermal_count = AIM_ARRAYSIZE(fan_ctrl_thermals),
+        .aggregate = ONLP_THERMAL_CONTROL_AGGREGATE_SUM,
+        .mode = ONLP_THERMAL_CONTROL_MODE_TABLE,
+        .table = fan_ctrl_policy_f2b,
+        .table_size = AIM_ARRAYSIZE(fan_ctrl_policy_f2b),
+        .table_b2f = fan_ctrl_policy_b2f,
+        .table_b2f_size = AIM_ARRAYSIZE(fan_ctrl_policy_b2f),
+    },
+};
 
-	if (new_duty_cycle == cur_duty_cycle) {
-        /* Duty cycle does not change, just return */
-	    return ONLP_STATUS_OK;
-	}
+static const onlp_thermal_control_t fan_ctrl = {
+    .groups = fan_ctrl_groups,
+    .group_count = AIM_ARRAYSIZE(fan_ctrl_groups),
+    .fans = fan_ctrl_fans,
+    .fan_count = AIM_ARRAYSIZE(fan_ctrl_fans),
+    /* All fans share one duty cycle register */
+    .fan_set = ONLP_FAN_ID_CREATE(1),
+    .min_percentage = 0,
+    .max_percentage = FAN_DUTY_CYCLE_MAX,
+    .failsafe = (ONLP_THERMAL_CONTROL_FAILSAFE_FAN_FAILED |
+                 ONLP_THERMAL_CONTROL_FAILSAFE_FAN_MISSING),
+    .failsafe_percentage = FAN_DUTY_CYCLE_MAX,
+};
 
-    return onlp_fani_percentage_set(ONLP_FAN_ID_CREATE(1), new_duty_cycle);
+int
+onlp_sysi_thermal_control_get(const onlp_thermal_control_t** tc)
+{
+    *tc = &fan_ctrl;
+    return ONLP_STATUS_OK;
 }
 
 int
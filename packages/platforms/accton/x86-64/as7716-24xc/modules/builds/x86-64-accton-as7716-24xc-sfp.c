@@ -31,6 +31,7 @@
 #include <linux/sysfs.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
+#include "accton_i2c_cpld.h"
 
 #define DRIVER_NAME 	"as7716_24xc_sfp" /* Platform dependent */
 
@@ -76,7 +77,6 @@ static ssize_t qsfp_show_tx_rx_status(struct device *dev, struct device_attribut
 static ssize_t qsfp_set_tx_disable(struct device *dev, struct device_attribute *da, const char *buf, size_t count);;
 static ssize_t sfp_eeprom_read(struct i2c_client *, u8, u8 *,int);
 static ssize_t sfp_eeprom_write(struct i2c_client *, u8 , const char *,int);
-extern int accton_i2c_cpld_read (unsigned short cpld_addr, u8 reg);
 
 enum sfp_sysfs_attributes {
 	PRESENT,
@@ -279,41 +279,35 @@ static ssize_t show_port_number(struct device *dev, struct device_attribute *da,
 static struct sfp_port_data *sfp_update_present(struct i2c_client *client)
 {
 	struct sfp_port_data *data = i2c_get_clientdata(client);
-	int i = 0;
 	int status = -1;
-	u8 regs[] = {0x78, 0x79, 0x7C, 0x7B};
-	u8 reg_vals[4]= {0};
+	u8 reg_vals[5]= {0};	/* 0x78 ~ 0x7C, 0x7A is not used */
 
 	DEBUG_PRINT("Starting sfp present status update");
 	mutex_lock(&data->update_lock);
 
-	/* Read present status of port 1~32 */
+	/* Read present status of port 1~32 with one block read */
     data->present = 0;
 	
-    for (i = 0; i < ARRAY_SIZE(regs); i++) {
-        status = accton_i2c_cpld_read(0x60, regs[i]);
-        
-        if (status < 0) {
-            DEBUG_PRINT("cpld(0x60) reg(0x%x) err %d", regs[i], status);
-            goto exit;
-        }
-
-        //data->present |= (u64)status << (i*8);
-        reg_vals[i] = status;
-		DEBUG_PRINT("Present status = 0x%lx", reg_vals[i]);
+    status = accton_i2c_cpld_read_block(0x60, 0x78, sizeof(reg_vals), reg_vals);
+    if (status >= 0 && status != sizeof(reg_vals)) {
+        status = -EIO;
+    }
+    if (status < 0) {
+        DEBUG_PRINT("cpld(0x60) reg(0x78) err %d", status);
+        goto exit;
     }
 
 	data->present |= reg_vals[0];           /* Port  1 ~  8 */
 	data->present |= (u64)reg_vals[1] << 8; /* Port  9 ~ 16 */
 
-	data->present |= ((u64)reg_vals[2] & 0x1)  << 16; /* Port 17 */
-	data->present |= ((u64)reg_vals[2] & 0x2)  << 17; /* Port 19 */
-	data->present |= ((u64)reg_vals[2] & 0x4)  << 18; /* Port 21 */
-	data->present |= ((u64)reg_vals[2] & 0x8)  << 19; /* Port 23 */
-	data->present |= ((u64)reg_vals[2] & 0x10) << 20; /* Port 25 */
-	data->present |= ((u64)reg_vals[2] & 0x20) << 21; /* Port 27 */
-	data->present |= ((u64)reg_vals[2] & 0x40) << 22; /* Port 29 */
-	data->present |= ((u64)reg_vals[2] & 0x80) << 23; /* Port 31 */
+	data->present |= ((u64)reg_vals[4] & 0x1)  << 16; /* Port 17 */
+	data->present |= ((u64)reg_vals[4] & 0x2)  << 17; /* Port 19 */
+	data->present |= ((u64)reg_vals[4] & 0x4)  << 18; /* Port 21 */
+	data->present |= ((u64)reg_vals[4] & 0x8)  << 19; /* Port 23 */
+	data->present |= ((u64)reg_vals[4] & 0x10) << 20; /* Port 25 */
+	data->present |= ((u64)reg_vals[4] & 0x20) << 21; /* Port 27 */
+	data->present |= ((u64)reg_vals[4] & 0x40) << 22; /* Port 29 */
+	data->present |= ((u64)reg_vals[4] & 0x80) << 23; /* Port 31 */
 	
 	data->present |= ((u64)reg_vals[3] & 0x1)  << 17; /* Port 18 */
 	data->present |= ((u64)reg_vals[3] & 0x2)  << 18; /* Port 20 */
@@ -27,6 +27,7 @@
 #include <fcntl.h>
 
 #include <onlplib/file.h>
+#include <onlp/led.h>
 #include <onlp/platformi/sysi.h>
 #include <onlp/platformi/ledi.h>
 #include <onlp/platformi/thermali.h>
@@ -305,6 +306,8 @@ int
 onlp_sysi_platform_manage_leds(void)
 {
 	int i = 0, fan_fault = 0, psu_fault = 0;
+    const onlp_oid_t leds[] = { ONLP_LED_ID_CREATE(LED_FAN), ONLP_LED_ID_CREATE(LED_PSU) };
+    onlp_led_mode_t modes[AIM_ARRAYSIZE(leds)];
 
     /* Get each fan status
      */
@@ -324,11 +327,11 @@ onlp_sysi_platform_manage_leds(void)
     }
 
     if (fan_fault > 1) {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_FAN), ONLP_LED_MODE_RED);
+        modes[0] = ONLP_LED_MODE_RED;
     }else if (fan_fault == 1) {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_FAN), ONLP_LED_MODE_YELLOW);
+        modes[0] = ONLP_LED_MODE_YELLOW;
     }else {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_FAN), ONLP_LED_MODE_GREEN);
+        modes[0] = ONLP_LED_MODE_GREEN;
     }
     
     /* Get each psu status
@@ -349,13 +352,15 @@ onlp_sysi_platform_manage_leds(void)
     }
 
     if (psu_fault > 1) {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_PSU), ONLP_LED_MODE_RED);
+        modes[1] = ONLP_LED_MODE_RED;
     }else if (psu_fault == 1) {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_PSU), ONLP_LED_MODE_YELLOW);
+        modes[1] = ONLP_LED_MODE_YELLOW;
     }else {
-        onlp_ledi_mode_set(ONLP_LED_ID_CREATE(LED_PSU), ONLP_LED_MODE_GREEN);
+        modes[1] = ONLP_LED_MODE_GREEN;
     }
-    
+
+    /* Only the LEDs whose state changed are written */
+    onlp_led_mode_set_multi(leds, modes, AIM_ARRAYSIZE(leds));
 	return ONLP_STATUS_OK; 
 }
 
@@ -0,0 +1,339 @@
+/*
+ * Shared regmap-backed support for Accton port CPLDs.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <linux/module.h>
+#include <linux/i2c.h>
+#include <linux/slab.h>
+#include <linux/regmap.h>
+#include <linux/sysfs.h>
+#include "accton_cpld_regmap.h"
+
+#define ACCTON_CPLD_REG_MAX		0xFF
+#define ACCTON_CPLD_BITMAP_MAX		32	/* bytes, 256 ports */
+#define ACCTON_CPLD_BULK_MAX		I2C_SMBUS_BLOCK_MAX
+
+struct accton_cpld {
+	struct i2c_client                 *client;
+	struct regmap                     *regmap;
+	const struct accton_cpld_layout   *layout;
+
+	/* Control registers are cached, all others are volatile */
+	struct regmap_range                cached[ACCTON_CPLD_REG_MAX + 1];
+	struct regmap_access_table         volatile_table;
+	struct regmap_config               config;
+
+	struct bin_attribute               attrs[ACCTON_CPLD_SIGNAL_MAX];
+	int                                created[ACCTON_CPLD_SIGNAL_MAX];
+};
+
+static const char *signal_names[ACCTON_CPLD_SIGNAL_MAX] = {
+	[ACCTON_CPLD_PRESENT]    = "present",
+	[ACCTON_CPLD_RX_LOS]     = "rx_los",
+	[ACCTON_CPLD_TX_FAULT]   = "tx_fault",
+	[ACCTON_CPLD_TX_DISABLE] = "tx_disable",
+	[ACCTON_CPLD_LPMODE]     = "lpmode",
+	[ACCTON_CPLD_RESET]      = "reset",
+};
+
+static bool accton_cpld_signal_is_control(enum accton_cpld_signal signal)
+{
+	return signal == ACCTON_CPLD_TX_DISABLE ||
+	       signal == ACCTON_CPLD_LPMODE ||
+	       signal == ACCTON_CPLD_RESET;
+}
+
+static int accton_cpld_bitmap_size(struct accton_cpld *cpld)
+{
+	return DIV_ROUND_UP(cpld->layout->nports, 8);
+}
+
+int accton_cpld_reg_read(struct accton_cpld *cpld, u8 reg)
+{
+	unsigned int val;
+	int status;
+
+	status = regmap_read(cpld->regmap, reg, &val);
+	return status < 0 ? status : (int)val;
+}
+EXPORT_SYMBOL(accton_cpld_reg_read);
+
+int accton_cpld_reg_write(struct accton_cpld *cpld, u8 reg, u8 value)
+{
+	return regmap_write(cpld->regmap, reg, value);
+}
+EXPORT_SYMBOL(accton_cpld_reg_write);
+
+int accton_cpld_reg_update_bits(struct accton_cpld *cpld, u8 reg, u8 mask, u8 value)
+{
+	return regmap_update_bits(cpld->regmap, reg, mask, value);
+}
+EXPORT_SYMBOL(accton_cpld_reg_update_bits);
+
+int accton_cpld_bitmap_get(struct accton_cpld *cpld, enum accton_cpld_signal signal,
+			   u8 *buf, size_t len)
+{
+	const struct accton_cpld_signal_desc *desc;
+	u8 vals[ACCTON_CPLD_BULK_MAX];
+	int size = accton_cpld_bitmap_size(cpld);
+	int lo = ACCTON_CPLD_REG_MAX, hi = 0;
+	int i, j, status;
+	bool bulk;
+
+	if (signal >= ACCTON_CPLD_SIGNAL_MAX || len < size) {
+		return -EINVAL;
+	}
+
+	desc = &cpld->layout->signals[signal];
+	if (!desc->nbanks) {
+		return -EOPNOTSUPP;
+	}
+
+	for (i = 0; i < desc->nbanks; i++) {
+		lo = min_t(int, lo, desc->banks[i].reg);
+		hi = max_t(int, hi, desc->banks[i].reg);
+	}
+
+	/* Fetch every register holding this signal in one transfer when
+	 * they are close enough together, otherwise one at a time.
+	 */
+	bulk = (hi - lo + 1 <= ARRAY_SIZE(vals));
+	if (bulk) {
+		status = regmap_bulk_read(cpld->regmap, lo, vals, hi - lo + 1);
+		if (status < 0) {
+			return status;
+		}
+	}
+
+	memset(buf, 0, size);
+	for (i = 0; i < desc->nbanks; i++) {
+		const struct accton_cpld_bank *bank = &desc->banks[i];
+		u8 val;
+
+		if (bulk) {
+			val = vals[bank->reg - lo];
+		}
+		else {
+			status = accton_cpld_reg_read(cpld, bank->reg);
+			if (status < 0) {
+				return status;
+			}
+			val = status;
+		}
+
+		if (desc->active_low) {
+			val = ~val;
+		}
+
+		for (j = 0; j < bank->count; j++) {
+			if (val & BIT(bank->shift + j)) {
+				buf[(bank->offset + j) / 8] |= BIT((bank->offset + j) % 8);
+			}
+		}
+	}
+
+	return size;
+}
+EXPORT_SYMBOL(accton_cpld_bitmap_get);
+
+int accton_cpld_bitmap_set(struct accton_cpld *cpld, enum accton_cpld_signal signal,
+			   const u8 *buf, size_t len)
+{
+	const struct accton_cpld_signal_desc *desc;
+	int i, j, status;
+
+	if (signal >= ACCTON_CPLD_SIGNAL_MAX || !accton_cpld_signal_is_control(signal) ||
+	    len < accton_cpld_bitmap_size(cpld)) {
+		return -EINVAL;
+	}
+
+	desc = &cpld->layout->signals[signal];
+	if (!desc->nbanks) {
+		return -EOPNOTSUPP;
+	}
+
+	for (i = 0; i < desc->nbanks; i++) {
+		const struct accton_cpld_bank *bank = &desc->banks[i];
+		u8 mask = 0, val = 0;
+
+		for (j = 0; j < bank->count; j++) {
+			mask |= BIT(bank->shift + j);
+			if (buf[(bank->offset + j) / 8] & BIT((bank->offset + j) % 8)) {
+				val |= BIT(bank->shift + j);
+			}
+		}
+
+		if (desc->active_low) {
+			val = ~val & mask;
+		}
+
+		/* Control registers are cached so this does not read the bus */
+		status = regmap_update_bits(cpld->regmap, bank->reg, mask, val);
+		if (status < 0) {
+			return status;
+		}
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL(accton_cpld_bitmap_set);
+
+static ssize_t accton_cpld_bin_read(struct file *filp, struct kobject *kobj,
+				    struct bin_attribute *attr, char *buf,
+				    loff_t off, size_t count)
+{
+	struct accton_cpld *cpld = attr->private;
+	u8 bitmap[ACCTON_CPLD_BITMAP_MAX];
+	int len;
+
+	len = accton_cpld_bitmap_get(cpld, attr - cpld->attrs, bitmap, sizeof(bitmap));
+	if (len < 0) {
+		return len;
+	}
+
+	if (off >= len) {
+		return 0;
+	}
+
+	count = min_t(size_t, count, len - off);
+	memcpy(buf, bitmap + off, count);
+	return count;
+}
+
+static ssize_t accton_cpld_bin_write(struct file *filp, struct kobject *kobj,
+				     struct bin_attribute *attr, char *buf,
+				     loff_t off, size_t count)
+{
+	struct accton_cpld *cpld = attr->private;
+	int status;
+
+	/* The whole bitmap must be written at once */
+	if (off != 0 || count < attr->size) {
+		return -EINVAL;
+	}
+
+	status = accton_cpld_bitmap_set(cpld, attr - cpld->attrs, buf, attr->size);
+	return status < 0 ? status : count;
+}
+
+static void accton_cpld_remove_files(struct accton_cpld *cpld)
+{
+	int i;
+
+	for (i = 0; i < ACCTON_CPLD_SIGNAL_MAX; i++) {
+		if (cpld->created[i]) {
+			sysfs_remove_bin_file(&cpld->client->dev.kobj, &cpld->attrs[i]);
+			cpld->created[i] = 0;
+		}
+	}
+}
+
+struct accton_cpld *accton_cpld_register(struct i2c_client *client,
+					 const struct accton_cpld_layout *layout)
+{
+	struct accton_cpld *cpld;
+	int i, j, status;
+
+	if (DIV_ROUND_UP(layout->nports, 8) > ACCTON_CPLD_BITMAP_MAX) {
+		return ERR_PTR(-EINVAL);
+	}
+
+	cpld = devm_kzalloc(&client->dev, sizeof(*cpld), GFP_KERNEL);
+	if (!cpld) {
+		return ERR_PTR(-ENOMEM);
+	}
+
+	cpld->client = client;
+	cpld->layout = layout;
+
+	for (i = 0; i < ACCTON_CPLD_SIGNAL_MAX; i++) {
+		const struct accton_cpld_signal_desc *desc = &layout->signals[i];
+
+		if (!accton_cpld_signal_is_control(i)) {
+			continue;
+		}
+
+		for (j = 0; j < desc->nbanks; j++) {
+			struct regmap_range *r;
+
+			if (cpld->volatile_table.n_no_ranges >= ARRAY_SIZE(cpld->cached)) {
+				return ERR_PTR(-EINVAL);
+			}
+
+			r = &cpld->cached[cpld->volatile_table.n_no_ranges];
+
+			r->range_min = desc->banks[j].reg;
+			r->range_max = desc->banks[j].reg;
+			cpld->volatile_table.n_no_ranges++;
+		}
+	}
+	cpld->volatile_table.no_ranges = cpld->cached;
+
+	cpld->config.reg_bits = 8;
+	cpld->config.val_bits = 8;
+	cpld->config.max_register = ACCTON_CPLD_REG_MAX;
+	cpld->config.volatile_table = &cpld->volatile_table;
+	cpld->config.cache_type = cpld->volatile_table.n_no_ranges ?
+				  REGCACHE_RBTREE : REGCACHE_NONE;
+
+	cpld->regmap = devm_regmap_init_i2c(client, &cpld->config);
+	if (IS_ERR(cpld->regmap)) {
+		dev_err(&client->dev, "regmap init failed (%ld)\n", PTR_ERR(cpld->regmap));
+		return ERR_CAST(cpld->regmap);
+	}
+
+	for (i = 0; i < ACCTON_CPLD_SIGNAL_MAX; i++) {
+		struct bin_attribute *attr = &cpld->attrs[i];
+
+		if (!layout->signals[i].nbanks) {
+			continue;
+		}
+
+		sysfs_bin_attr_init(attr);
+		attr->attr.name = signal_names[i];
+		attr->attr.mode = S_IRUGO;
+		attr->size = DIV_ROUND_UP(layout->nports, 8);
+		attr->read = accton_cpld_bin_read;
+		attr->private = cpld;
+
+		if (accton_cpld_signal_is_control(i)) {
+			attr->attr.mode |= S_IWUSR;
+			attr->write = accton_cpld_bin_write;
+		}
+
+		status = sysfs_create_bin_file(&client->dev.kobj, attr);
+		if (status) {
+			accton_cpld_remove_files(cpld);
+			return ERR_PTR(status);
+		}
+		cpld->created[i] = 1;
+	}
+
+	return cpld;
+}
+EXPORT_SYMBOL(accton_cpld_register);
+
+void accton_cpld_unregister(struct accton_cpld *cpld)
+{
+	if (!IS_ERR_OR_NULL(cpld)) {
+		accton_cpld_remove_files(cpld);
+	}
+}
+EXPORT_SYMBOL(accton_cpld_unregister);
+
+MODULE_DESCRIPTION("Accton port CPLD regmap library");
+MODULE_LICENSE("GPL");
@@ -0,0 +1,97 @@
+/*
+ * Shared regmap-backed support for Accton port CPLDs.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __ACCTON_CPLD_REGMAP_H__
+#define __ACCTON_CPLD_REGMAP_H__
+
+#include <linux/i2c.h>
+#include <linux/types.h>
+
+/*
+ * Platform CPLD drivers describe where each transceiver signal lives
+ * with a layout table and hand it to accton_cpld_register(). The library
+ * then exposes one binary sysfs attribute per signal class on the client
+ * device. Each attribute holds a packed bitmap: bit N of byte N/8 is the
+ * port (port_base + N). Reading an attribute fetches the registers for
+ * that signal with one bulk transfer.
+ *
+ * Status registers are volatile. Control registers (tx_disable, lpmode,
+ * reset) are cached, so read-modify-write of a single port does not go
+ * back to the bus.
+ *
+ * The library only needs SMBus byte access, so it can be exercised
+ * against i2c-stub with a layout pointing at the stub's registers.
+ */
+
+enum accton_cpld_signal {
+	ACCTON_CPLD_PRESENT,
+	ACCTON_CPLD_RX_LOS,
+	ACCTON_CPLD_TX_FAULT,
+	ACCTON_CPLD_TX_DISABLE,
+	ACCTON_CPLD_LPMODE,
+	ACCTON_CPLD_RESET,
+	ACCTON_CPLD_SIGNAL_MAX
+};
+
+/* 'count' consecutive bits of 'reg', starting at bit 'shift', hold the
+ * signal for the ports at bitmap offsets 'offset' .. 'offset'+'count'-1.
+ */
+struct accton_cpld_bank {
+	u8 reg;
+	u8 shift;
+	u8 count;
+	u8 offset;
+};
+
+#define ACCTON_CPLD_BANK(_reg, _shift, _count, _offset) \
+	{ .reg = (_reg), .shift = (_shift), .count = (_count), .offset = (_offset) }
+
+struct accton_cpld_signal_desc {
+	const struct accton_cpld_bank *banks;
+	int  nbanks;
+	bool active_low;
+};
+
+#define ACCTON_CPLD_SIGNAL(_banks, _active_low) \
+	{ .banks = (_banks), .nbanks = ARRAY_SIZE(_banks), .active_low = (_active_low) }
+
+struct accton_cpld_layout {
+	u16 port_base;		/* front panel number of bitmap bit 0 */
+	u16 nports;
+	struct accton_cpld_signal_desc signals[ACCTON_CPLD_SIGNAL_MAX];
+};
+
+struct accton_cpld;
+
+struct accton_cpld *accton_cpld_register(struct i2c_client *client,
+					 const struct accton_cpld_layout *layout);
+void accton_cpld_unregister(struct accton_cpld *cpld);
+
+int accton_cpld_reg_read(struct accton_cpld *cpld, u8 reg);
+int accton_cpld_reg_write(struct accton_cpld *cpld, u8 reg, u8 value);
+/* Read-modify-write of 'mask' in 'reg', serialized with the bitmap setters */
+int accton_cpld_reg_update_bits(struct accton_cpld *cpld, u8 reg, u8 mask, u8 value);
+
+/* Fill 'buf' with the packed bitmap for 'signal'.
+ * Returns the number of bytes written or a negative error code.
+ */
+int accton_cpld_bitmap_get(struct accton_cpld *cpld, enum accton_cpld_signal signal,
+			   u8 *buf, size_t len);
+
+/* Apply the packed bitmap in 'buf' to a control signal.
+ * Returns 0 or a negative error code.
+ */
+int accton_cpld_bitmap_set(struct accton_cpld *cpld, enum accton_cpld_signal signal,
+			   const u8 *buf, size_t len);
+
+#endif /* __ACCTON_CPLD_REGMAP_H__ */
@@ -25,17 +25,27 @@
 #include <linux/module.h>
 #include <linux/i2c.h>
 #include <linux/slab.h>
-#include <linux/list.h>
+#include <linux/rwsem.h>
+#include <linux/mutex.h>
 #include <linux/dmi.h>
+#include "accton_i2c_cpld.h"
 
-static LIST_HEAD(cpld_client_list);
-static struct mutex	 list_lock;
+#define CPLD_ADDR_MAX	0x80
 
+/* Each CPLD is serialized by its own lock. The address table lock is
+ * only taken exclusively when a client is added or removed, so accesses
+ * to different CPLDs proceed in parallel.
+ */
 struct cpld_client_node {
-	struct i2c_client *client;
-	struct list_head   list;
+	struct i2c_client       *client;
+	struct mutex             update_lock;
+	int                      block_read;
+	struct cpld_client_node *next;	/* other CPLD at the same address */
 };
 
+static struct cpld_client_node *cpld_clients[CPLD_ADDR_MAX];
+static DECLARE_RWSEM(cpld_clients_lock);
+
 /* Addresses scanned for accton_i2c_cpld
  */
 static const unsigned short normal_i2c[] = { 0x31, 0x35, 0x60, 0x61, 0x62, 0x64, I2C_CLIENT_END };
@@ -56,46 +66,53 @@ static ssize_t show_cpld_version(struct device *dev, struct device_attribute *at
 
 static struct device_attribute ver = __ATTR(version, 0600, show_cpld_version, NULL);
 
-static void accton_i2c_cpld_add_client(struct i2c_client *client)
+static int accton_i2c_cpld_add_client(struct i2c_client *client)
 {
-	struct cpld_client_node *node = kzalloc(sizeof(struct cpld_client_node), GFP_KERNEL);
-	
+	struct cpld_client_node *node;
+
+	if (client->addr >= CPLD_ADDR_MAX) {
+		return -EINVAL;
+	}
+
+	node = kzalloc(sizeof(struct cpld_client_node), GFP_KERNEL);
 	if (!node) {
 		dev_dbg(&client->dev, "Can't allocate cpld_client_node (0x%x)\n", client->addr);
-		return;
+		return -ENOMEM;
 	}
 	
 	node->client = client;
+	mutex_init(&node->update_lock);
+	node->block_read = i2c_check_functionality(client->adapter,
+						   I2C_FUNC_SMBUS_READ_I2C_BLOCK);
 	
-	mutex_lock(&list_lock);
-	list_add(&node->list, &cpld_client_list);
-	mutex_unlock(&list_lock);
+	/* The most recently added client answers for its address */
+	down_write(&cpld_clients_lock);
+	node->next = cpld_clients[client->addr];
+	cpld_clients[client->addr] = node;
+	up_write(&cpld_clients_lock);
+
+	return 0;
 }
 
 static void accton_i2c_cpld_remove_client(struct i2c_client *client)
 {
-	struct list_head		*list_node = NULL;
-	struct cpld_client_node *cpld_node = NULL;
-	int found = 0;
+	struct cpld_client_node **pnode, *node = NULL;
 	
-	mutex_lock(&list_lock);
+	if (client->addr >= CPLD_ADDR_MAX) {
+		return;
+	}
 
-	list_for_each(list_node, &cpld_client_list)
-	{
-		cpld_node = list_entry(list_node, struct cpld_client_node, list);
-		
-		if (cpld_node->client == client) {
-			found = 1;
+	down_write(&cpld_clients_lock);
+	for (pnode = &cpld_clients[client->addr]; *pnode; pnode = &(*pnode)->next) {
+		if ((*pnode)->client == client) {
+			node = *pnode;
+			*pnode = node->next;
 			break;
 		}
 	}
-	
-	if (found) {
-		list_del(list_node);
-		kfree(cpld_node);
-	}
-	
-	mutex_unlock(&list_lock);
+	up_write(&cpld_clients_lock);
+
+	kfree(node);
 }
 
 static int accton_i2c_cpld_probe(struct i2c_client *client,
@@ -109,16 +126,22 @@ static int accton_i2c_cpld_probe(struct i2c_client *client,
 		goto exit;
 	}
 
-	status = sysfs_create_file(&client->dev.kobj, &ver.attr);
+	status = accton_i2c_cpld_add_client(client);
 	if (status) {
 		goto exit;
 	}
 
+	status = sysfs_create_file(&client->dev.kobj, &ver.attr);
+	if (status) {
+		goto exit_remove;
+	}
+
 	dev_info(&client->dev, "chip found\n");
-	accton_i2c_cpld_add_client(client);
 	
 	return 0;
 
+exit_remove:
+	accton_i2c_cpld_remove_client(client);
 exit:
 	return status;
 }
@@ -148,57 +171,110 @@ static struct i2c_driver accton_i2c_cpld_driver = {
 	.address_list = normal_i2c,
 };
 
-int accton_i2c_cpld_read(unsigned short cpld_addr, u8 reg)
+/* Look up the CPLD at the given address with the table lock held for
+ * reading. The caller must release it with accton_i2c_cpld_put().
+ */
+static struct cpld_client_node *accton_i2c_cpld_get(unsigned short cpld_addr)
 {
-	struct list_head   *list_node = NULL;
-	struct cpld_client_node *cpld_node = NULL;
-	int ret = -EPERM;
-	
-	mutex_lock(&list_lock);
+	if (cpld_addr >= CPLD_ADDR_MAX) {
+		return NULL;
+	}
 
-	list_for_each(list_node, &cpld_client_list)
-	{
-		cpld_node = list_entry(list_node, struct cpld_client_node, list);
-		
-		if (cpld_node->client->addr == cpld_addr) {
-			ret = i2c_smbus_read_byte_data(cpld_node->client, reg);
-			break;
-		}
+	down_read(&cpld_clients_lock);
+	if (!cpld_clients[cpld_addr]) {
+		up_read(&cpld_clients_lock);
+		return NULL;
 	}
+
+	return cpld_clients[cpld_addr];
+}
+
+static void accton_i2c_cpld_put(struct cpld_client_node *node)
+{
+	up_read(&cpld_clients_lock);
+}
+
+int accton_i2c_cpld_read(unsigned short cpld_addr, u8 reg)
+{
+	struct cpld_client_node *node;
+	int ret;
 	
-	mutex_unlock(&list_lock);
+	node = accton_i2c_cpld_get(cpld_addr);
+	if (!node) {
+		return -EPERM;
+	}
 
+	mutex_lock(&node->update_lock);
+	ret = i2c_smbus_read_byte_data(node->client, reg);
+	mutex_unlock(&node->update_lock);
+
+	accton_i2c_cpld_put(node);
 	return ret;
 }
 EXPORT_SYMBOL(accton_i2c_cpld_read);
 
 int accton_i2c_cpld_write(unsigned short cpld_addr, u8 reg, u8 value)
 {
-	struct list_head   *list_node = NULL;
-	struct cpld_client_node *cpld_node = NULL;
-	int ret = -EIO;
+	struct cpld_client_node *node;
+	int ret;
 	
-	mutex_lock(&list_lock);
+	node = accton_i2c_cpld_get(cpld_addr);
+	if (!node) {
+		return -EIO;
+	}
 
-	list_for_each(list_node, &cpld_client_list)
-	{
-		cpld_node = list_entry(list_node, struct cpld_client_node, list);
-		
-		if (cpld_node->client->addr == cpld_addr) {
-			ret = i2c_smbus_write_byte_data(cpld_node->client, reg, value);
-			break;
+	mutex_lock(&node->update_lock);
+	ret = i2c_smbus_write_byte_data(node->client, reg, value);
+	mutex_unlock(&node->update_lock);
+
+	accton_i2c_cpld_put(node);
+	return ret;
+}
+EXPORT_SYMBOL(accton_i2c_cpld_write);
+
+/* A single SMBus block transaction is used when the adapter supports
+ * it, otherwise the registers are read one at a time under the same lock.
+ */
+int accton_i2c_cpld_read_block(unsigned short cpld_addr, u8 reg, u8 len, u8 *values)
+{
+	struct cpld_client_node *node;
+	int ret = 0, i;
+
+	if (!values || len > I2C_SMBUS_BLOCK_MAX) {
+		return -EINVAL;
+	}
+
+	node = accton_i2c_cpld_get(cpld_addr);
+	if (!node) {
+		return -EPERM;
+	}
+
+	mutex_lock(&node->update_lock);
+	if (node->block_read) {
+		ret = i2c_smbus_read_i2c_block_data(node->client, reg, len, values);
+	}
+	else {
+		for (i = 0; i < len; i++) {
+			ret = i2c_smbus_read_byte_data(node->client, reg + i);
+			if (ret < 0) {
+				break;
+			}
+			values[i] = ret;
+		}
+
+		if (ret >= 0) {
+			ret = len;
 		}
 	}
-	
-	mutex_unlock(&list_lock);
+	mutex_unlock(&node->update_lock);
 
+	accton_i2c_cpld_put(node);
 	return ret;
 }
-EXPORT_SYMBOL(accton_i2c_cpld_write);
+EXPORT_SYMBOL(accton_i2c_cpld_read_block);
 
 static int __init accton_i2c_cpld_init(void)
 {
-	mutex_init(&list_lock);
 	return i2c_add_driver(&accton_i2c_cpld_driver);
 }
 
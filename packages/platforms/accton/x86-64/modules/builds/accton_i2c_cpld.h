@@ -0,0 +1,27 @@
+/*
+ * Register access to Accton CPLDs bound to the accton_i2c_cpld driver.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#ifndef __ACCTON_I2C_CPLD_H__
+#define __ACCTON_I2C_CPLD_H__
+
+#include <linux/types.h>
+
+int accton_i2c_cpld_read(unsigned short cpld_addr, u8 reg);
+int accton_i2c_cpld_write(unsigned short cpld_addr, u8 reg, u8 value);
+
+/* Read 'len' (at most I2C_SMBUS_BLOCK_MAX) consecutive registers starting
+ * at 'reg'. Returns the number of bytes read or a negative error code.
+ */
+int accton_i2c_cpld_read_block(unsigned short cpld_addr, u8 reg, u8 len, u8 *values);
+
+#endif /* __ACCTON_I2C_CPLD_H__ */
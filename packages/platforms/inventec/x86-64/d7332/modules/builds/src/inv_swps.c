@@ -12,6 +12,9 @@
 #include <linux/workqueue.h>
 #include <linux/jiffies.h>
 #include <linux/delay.h>
+#include <linux/interrupt.h>
+#include <linux/gpio.h>
+#include <linux/ktime.h>
 /*ufile use*/
 #include <linux/fs.h>
 #include <linux/unistd.h>
@@ -28,6 +31,9 @@
 
 int io_no_init = 0;
 module_param(io_no_init, int, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+/*use the transceiver interrupt lines to trigger polling when available*/
+int intr_mode = 1;
+module_param(intr_mode, int, S_IRUSR | S_IRGRP);
 u32 logLevel = SWPS_ERR_LEV | SWPS_INFO_LEV;
 //u32 logLevel = ERR_ALL_LEV | INFO_ALL_LEV | DBG_ALL_LEV;
 bool int_flag_monitor_en = false;
@@ -38,6 +44,11 @@ static void polling_task_1U(void);
 static void polling_task_4U(void);
 static DECLARE_DELAYED_WORK(swps_polling, swps_polling_task);
 static u8 swps_polling_enabled = 1;
+static bool sff_fsm_work_is_busy(struct sff_obj_t *sff_obj);
+static void sff_fsm_work(struct work_struct *work);
+static void sff_fsm_work_flush(void);
+static void swps_intr_enable(bool enable);
+static struct workqueue_struct *swpsWq = NULL;
 static int swps_polling_task_start(void);
 static int swps_polling_task_stop(void);
 static int mux_ch_block(int i2c_ch, unsigned long mux_ch);
@@ -101,6 +112,7 @@ struct lc_func_t lc_func_4U = {
     .over_temp_deasserted = lc_dev_over_temp_deasserted,
     .temp_get = lc_dev_temp_get_text,
     .phy_reset_set = lc_dev_phy_reset_set,
+    .intr_gpio_get = lc_dev_intr_gpio_get,
 };
 
 struct lc_func_t lc_func_1U = {
@@ -111,6 +123,7 @@ struct lc_func_t lc_func_1U = {
     .mux_reset_set = io_dev_mux_reset_set,
     .mux_reset_get = io_dev_mux_reset_get,
     .i2c_is_alive = ioexp_is_channel_ready,
+    .intr_gpio_get = io_dev_intr_gpio_get,
 };
 
 /*check if pointer is valid
@@ -148,6 +161,33 @@ static inline u8 swps_polling_is_enabled(void)
     return swps_polling_enabled;
 }
 
+/*the polling period grows while nothing changes and falls back to
+ *SWPS_POLLING_PERIOD as soon as a port or card is not stable*/
+struct swps_polling_t {
+    unsigned long period;
+    unsigned long period_max; /*jiffies*/
+    unsigned long tick_stamp;
+    int ticks; /*SWPS_POLLING_PERIOD units elapsed since the last cycle*/
+    int irq[SWPS_INTR_GPIO_MAX];
+    int gpio[SWPS_INTR_GPIO_MAX];
+    int irq_num;
+};
+
+struct swps_polling_stats_t {
+    u32 cycles;
+    u32 intr_cnt;
+    u32 port_work_queued;
+    u32 port_work_skipped; /*port still busy from an earlier cycle*/
+    s64 last_us;
+    s64 max_us;
+    s64 total_us;
+    s64 port_max_us;
+    const char *port_max_name;
+};
+
+static struct swps_polling_t swpsPolling;
+static struct swps_polling_stats_t swpsStats;
+
 struct fsm_period_t {
     sff_fsm_state_t st;
     int delay_cnt;
@@ -2377,6 +2417,69 @@ static ssize_t swps_polling_show(struct swps_kobj_t *swps_kobj, struct swps_attr
     return scnprintf(buf, BUF_SIZE, "%d\n", swps_polling_is_enabled());
 }
 
+static ssize_t polling_stats_show(struct swps_kobj_t *swps_kobj, struct swps_attribute *attr,
+                                  char *buf)
+{
+    struct swps_polling_stats_t stats = swpsStats;
+    s64 avg_us = 0;
+
+    if (stats.cycles > 0) {
+        avg_us = div_s64(stats.total_us, stats.cycles);
+    }
+    return scnprintf(buf, BUF_SIZE,
+                     "mode: %s\n"
+                     "period_ms: %u\n"
+                     "cycles: %u\n"
+                     "cycle_last_us: %lld\n"
+                     "cycle_avg_us: %lld\n"
+                     "cycle_max_us: %lld\n"
+                     "port_task_max_us: %lld (%s)\n"
+                     "port_work_queued: %u\n"
+                     "port_work_skipped: %u\n"
+                     "intr_cnt: %u\n",
+                     (swpsPolling.irq_num > 0) ? "interrupt" : "polling",
+                     jiffies_to_msecs(swpsPolling.period),
+                     stats.cycles,
+                     stats.last_us,
+                     avg_us,
+                     stats.max_us,
+                     stats.port_max_us,
+                     p_valid(stats.port_max_name) ? stats.port_max_name : "none",
+                     stats.port_work_queued,
+                     stats.port_work_skipped,
+                     stats.intr_cnt);
+}
+static ssize_t polling_stats_store(struct swps_kobj_t *swps_kobj, struct swps_attribute *attr,
+                                   const char *buf, size_t count)
+{
+    if (!match(buf, CLEAR_CMD)) {
+        return -EINVAL;
+    }
+    memset(&swpsStats, 0, sizeof(swpsStats));
+    return count;
+}
+static ssize_t polling_period_max_show(struct swps_kobj_t *swps_kobj, struct swps_attribute *attr,
+                                       char *buf)
+{
+    return scnprintf(buf, BUF_SIZE, "%u\n", jiffies_to_msecs(swpsPolling.period_max));
+}
+/*setting it to the base period (100ms) disables the back-off*/
+static ssize_t polling_period_max_store(struct swps_kobj_t *swps_kobj, struct swps_attribute *attr,
+                                        const char *buf, size_t count)
+{
+    int ms = 0;
+    int ret = 0;
+
+    if ((ret = sscanf_to_int(buf, &ms)) < 0) {
+        return ret;
+    }
+    if (ms <= 0 || ms > SWPS_POLLING_PERIOD_LIMIT_MS ||
+        msecs_to_jiffies(ms) < SWPS_POLLING_PERIOD) {
+        return -EINVAL;
+    }
+    swpsPolling.period_max = msecs_to_jiffies(ms);
+    return count;
+}
 static ssize_t sff_int_flag_monitor_store(struct swps_kobj_t *swps_kobj, struct swps_attribute *attr,
         const char *buf, size_t count)
 {
@@ -2446,6 +2549,11 @@ static struct swps_attribute sff_prs_all_attr =
 static struct swps_attribute swps_polling_attr =
     __ATTR(swps_polling, S_IWUSR|S_IRUGO, swps_polling_show, swps_polling_store);
 
+static struct swps_attribute polling_stats_attr =
+    __ATTR(polling_stats, S_IWUSR|S_IRUGO, polling_stats_show, polling_stats_store);
+static struct swps_attribute polling_period_max_attr =
+    __ATTR(polling_period_max, S_IWUSR|S_IRUGO, polling_period_max_show, polling_period_max_store);
+
 static struct swps_attribute sff_int_flag_monitor_attr =
     __ATTR(sff_int_flag_monitor, S_IWUSR|S_IRUGO, sff_int_flag_monitor_show, sff_int_flag_monitor_store);
 
@@ -2686,6 +2794,8 @@ static struct attribute_group sff_common_group = {
 static struct attribute *lc_common_attributes[] = {
     &swps_version_attr.attr,
     &swps_polling_attr.attr,
+    &polling_stats_attr.attr,
+    &polling_period_max_attr.attr,
     &lc_prs_attr.attr,
     &log_level_attr.attr,
     &pltfm_name_attr.attr,
@@ -2750,14 +2860,19 @@ static void lc_objs_destroy(struct lc_t *card)
 static int swps_polling_task_start(void)
 {
     /*<TBD> check what's the right way to reset the fsm state*/
+    swpsPolling.period = SWPS_POLLING_PERIOD;
+    swpsPolling.tick_stamp = jiffies;
     schedule_delayed_work(&swps_polling, SWPS_POLLING_PERIOD);
+    swps_intr_enable(true);
     return 0;
 
 }
 static int swps_polling_task_stop(void)
 {
 
+    swps_intr_enable(false);
     cancel_delayed_work_sync(&swps_polling);
+    sff_fsm_work_flush();
     return 0;
 
 }
@@ -2791,6 +2906,8 @@ static int sff_objs_init(struct sff_mgr_t *sff, struct port_info_table_t *tbl)
         sff_obj[port].name = map[port].name;
         sff_fsm_init(&sff_obj[port], map[port].type);
         func_tbl_init(&sff_obj[port], map[port].type);
+        INIT_WORK(&sff_obj[port].fsm_work, sff_fsm_work);
+        sff_obj[port].fsm_work_busy = 0;
     }
     return 0;
 }
@@ -3174,6 +3291,8 @@ static void sff_kobjs_destroy(struct sff_mgr_t *sff)
     int port;
     int port_num = sff->valid_port_num;
     struct sff_obj_t *sff_obj = NULL;
+
+    sff_fsm_work_flush();
     for (port = 0; port < port_num; port++) {
         sff_obj = &(sff->obj[port]);
         sff_kobj_del(sff_obj);
@@ -3285,6 +3404,7 @@ static int sff_prs_scan(struct sff_mgr_t *sff)
     int ret = 0;
     unsigned long bitmap=0;
     unsigned long prs_change = 0;
+    unsigned long busy = 0;
     int port = 0;
     struct sff_obj_t *sff_obj = NULL;
     int port_num = sff->valid_port_num;
@@ -3295,6 +3415,14 @@ static int sff_prs_scan(struct sff_mgr_t *sff)
         SWPS_LOG_ERR("fail\n");
         return ret;
     }
+    /*a port whose fsm task is still running keeps its old presence,
+     *the change will be picked up once the task is done*/
+    for (port = 0; port < port_num; port++) {
+        if (sff_fsm_work_is_busy(&(sff->obj[port]))) {
+            set_bit(port, &busy);
+        }
+    }
+    bitmap = (bitmap & ~busy) | (prs_bitmap_get(sff) & busy);
     /*check which bits are updated*/
     //bitmap = ~bitmap;  /*reverse it to be human readable format*/
     prs_change = bitmap ^ prs_bitmap_get(sff);
@@ -3312,10 +3440,176 @@ static int sff_prs_scan(struct sff_mgr_t *sff)
     }
     return 0;
 }
+static bool sff_fsm_st_is_stable(sff_fsm_state_t st)
+{
+    return (SFF_FSM_ST_REMOVED == st ||
+            SFF_FSM_ST_IDLE == st ||
+            SFF_FSM_ST_FAULT == st ||
+            SFF_FSM_ST_ISOLATED == st ||
+            SFF_FSM_ST_MONITOR == st ||
+            SFF_FSM_ST_UNKNOWN_TYPE == st);
+}
+/*true if no card or port is in the middle of a state transition*/
+static bool swps_is_stable(struct lc_t *self)
+{
+    int lc_id = 0;
+    int port = 0;
+    struct lc_obj_t *card = NULL;
+    struct sff_obj_t *sff_obj = NULL;
+    lc_fsm_st_t st = LC_FSM_ST_IDLE;
+
+    if (io_no_init) {
+        return false;
+    }
+    for (lc_id = 0; lc_id < self->lc_num; lc_id++) {
+        card = &(self->obj[lc_id]);
+        st = lc_fsm_st_get(card);
+        if (LC_FSM_ST_IDLE == st ||
+            LC_FSM_ST_UNSUPPORTED == st) {
+            continue;
+        }
+        if (LC_FSM_ST_READY != st) {
+            return false;
+        }
+        for (port = 0; port < card->sff.valid_port_num; port++) {
+            sff_obj = &(card->sff.obj[port]);
+            if (sff_fsm_work_is_busy(sff_obj) ||
+                !sff_fsm_st_is_stable(sff_fsm_st_get(sff_obj))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static void swps_polling_ticks_update(void)
+{
+    unsigned long elapsed = jiffies - swpsPolling.tick_stamp;
+    int ticks = elapsed / SWPS_POLLING_PERIOD;
+
+    /*polling was stopped for a while, don't replay all missed ticks*/
+    if (ticks > SWPS_POLLING_TICKS_MAX) {
+        ticks = SWPS_POLLING_TICKS_MAX;
+        swpsPolling.tick_stamp = jiffies;
+    } else {
+        swpsPolling.tick_stamp += ticks * SWPS_POLLING_PERIOD;
+    }
+    swpsPolling.ticks = ticks;
+}
+/*the interrupt lines are active low and shared by several modules,
+ *an edge is not seen for a module that asserts while the line is already low*/
+static bool swps_intr_is_asserted(void)
+{
+    int i = 0;
+
+    for (i = 0; i < swpsPolling.irq_num; i++) {
+        if (0 == gpio_get_value_cansleep(swpsPolling.gpio[i])) {
+            return true;
+        }
+    }
+    return false;
+}
 static void swps_polling_task(struct work_struct *work)
 {
+    int lc_id = 0;
+    unsigned long lc_prs = lcMgr.lc_prs;
+    unsigned long sff_prs[LINE_CARD_NUM];
+    bool changed = false;
+    ktime_t start = ktime_get();
+    s64 us = 0;
+
+    for (lc_id = 0; lc_id < lcMgr.lc_num; lc_id++) {
+        sff_prs[lc_id] = lcMgr.obj[lc_id].sff.prs;
+    }
+    swps_polling_ticks_update();
     lcMgr.lc_func->polling_task();
-    schedule_delayed_work(&swps_polling, SWPS_POLLING_PERIOD);
+
+    changed = (lc_prs != lcMgr.lc_prs);
+    for (lc_id = 0; lc_id < lcMgr.lc_num; lc_id++) {
+        if (sff_prs[lc_id] != lcMgr.obj[lc_id].sff.prs) {
+            changed = true;
+        }
+    }
+    /*keep polling at the base period until every line is released*/
+    if (changed || !swps_is_stable(&lcMgr) || swps_intr_is_asserted()) {
+        swpsPolling.period = SWPS_POLLING_PERIOD;
+    } else {
+        swpsPolling.period = min(swpsPolling.period * 2, swpsPolling.period_max);
+    }
+
+    us = ktime_us_delta(ktime_get(), start);
+    swpsStats.cycles++;
+    swpsStats.last_us = us;
+    swpsStats.total_us += us;
+    if (us > swpsStats.max_us) {
+        swpsStats.max_us = us;
+    }
+    schedule_delayed_work(&swps_polling, swpsPolling.period);
+}
+/*transceiver interrupt, run the polling task now instead of at the end of the period*/
+static irqreturn_t swps_intr_isr(int irq, void *dev_id)
+{
+    swpsStats.intr_cnt++;
+    mod_delayed_work(system_wq, &swps_polling, 0);
+    return IRQ_HANDLED;
+}
+static void swps_intr_enable(bool enable)
+{
+    int i = 0;
+
+    for (i = 0; i < swpsPolling.irq_num; i++) {
+        if (enable) {
+            enable_irq(swpsPolling.irq[i]);
+        } else {
+            disable_irq(swpsPolling.irq[i]);
+        }
+    }
+}
+static void swps_intr_deinit(void)
+{
+    int i = 0;
+
+    for (i = 0; i < swpsPolling.irq_num; i++) {
+        free_irq(swpsPolling.irq[i], &swpsPolling);
+    }
+    swpsPolling.irq_num = 0;
+}
+/*request every interrupt line the platform provides,
+ *if any of them can't be used, stay in polling mode*/
+static int swps_intr_init(struct lc_t *self)
+{
+    int idx = 0;
+    int gpio = 0;
+    int irq = 0;
+    int ret = 0;
+
+    if (!intr_mode || NULL == self->lc_func->intr_gpio_get) {
+        return 0;
+    }
+    for (idx = 0; idx < SWPS_INTR_GPIO_MAX; idx++) {
+        if ((ret = self->lc_func->intr_gpio_get(idx, &gpio)) < 0) {
+            break;
+        }
+        if ((irq = gpio_to_irq(gpio)) < 0) {
+            ret = irq;
+            break;
+        }
+        if ((ret = request_any_context_irq(irq, swps_intr_isr, IRQF_TRIGGER_FALLING,
+                                           "swps", &swpsPolling)) < 0) {
+            break;
+        }
+        swpsPolling.gpio[swpsPolling.irq_num] = gpio;
+        swpsPolling.irq[swpsPolling.irq_num++] = irq;
+    }
+    if (ret < 0 && ret != -ENODEV) {
+        SWPS_LOG_INFO("interrupt mode not available ret:%d, polling only\n", ret);
+        swps_intr_deinit();
+        return 0;
+    }
+    if (swpsPolling.irq_num > 0) {
+        swpsPolling.period_max = msecs_to_jiffies(SWPS_POLLING_PERIOD_INTR_MAX_MS);
+        SWPS_LOG_INFO("interrupt mode, %d lines\n", swpsPolling.irq_num);
+    }
+    return 0;
 }
 
 
@@ -3354,8 +3648,9 @@ static void sff_fsm_delay_cnt_reset(struct sff_obj_t *sff_obj, sff_fsm_state_t s
 }
 static void sff_fsm_cnt_run(struct sff_obj_t *sff_obj)
 {
-
-    (sff_obj->fsm.cnt)++;
+    /*count in SWPS_POLLING_PERIOD units so fsm delays do not stretch
+     *while the polling period is backed off*/
+    (sff_obj->fsm.cnt) += swpsPolling.ticks;
 }
 static bool sff_fsm_delay_cnt_is_hit(struct sff_obj_t *sff_obj)
 {
@@ -3557,26 +3852,56 @@ static void io_no_init_handler(struct lc_t *card)
     }
 
 }
+static bool sff_fsm_work_is_busy(struct sff_obj_t *sff_obj)
+{
+    return test_bit(0, &sff_obj->fsm_work_busy);
+}
+/*fsm task of one port, a port stuck in i2c retries doesn't hold up the others*/
+static void sff_fsm_work(struct work_struct *work)
+{
+    struct sff_obj_t *sff_obj = container_of(work, struct sff_obj_t, fsm_work);
+    ktime_t start = ktime_get();
+    s64 us = 0;
+
+    if (sff_obj->fsm.task(sff_obj) < 0) {
+        SWPS_LOG_DBG("%s fsm task fail\n", sff_obj->name);
+    }
+    sff_fsm_cnt_run(sff_obj);
+
+    us = ktime_us_delta(ktime_get(), start);
+    if (us > swpsStats.port_max_us) {
+        swpsStats.port_max_us = us;
+        swpsStats.port_max_name = sff_obj->name;
+    }
+    clear_bit_unlock(0, &sff_obj->fsm_work_busy);
+}
+/*wait for all port fsm tasks, before touching sff objs from the polling task*/
+static void sff_fsm_work_flush(void)
+{
+    if (p_valid(swpsWq)) {
+        flush_workqueue(swpsWq);
+    }
+}
 static int sff_fsm_run(struct sff_mgr_t *sff)
 {
     int port = 0;
-    int ret = 0;
     struct sff_obj_t *sff_obj = NULL;
     int port_num = sff->valid_port_num;
 
     for(port = 0; port < port_num; port++) {
         sff_obj = &(sff->obj[port]);
+        if (sff_fsm_work_is_busy(sff_obj)) {
+            swpsStats.port_work_skipped++;
+            continue;
+        }
         if (sff_fsm_delay_cnt_is_hit(sff_obj)) {
-            ret = sff_obj->fsm.task(sff_obj);
-            if (ret < 0) {
-                break;
-            }
+            set_bit(0, &sff_obj->fsm_work_busy);
+            queue_work(swpsWq, &sff_obj->fsm_work);
+            swpsStats.port_work_queued++;
+            continue;
         }
         sff_fsm_cnt_run(sff_obj);
     }
-    if (ret < 0) {
-        return ret;
-    }
     return 0;
 }
 
@@ -3875,7 +4200,8 @@ static int _lc_fsm_run_4U(struct lc_obj_t *card)
         if (!i2c_bus_is_alive(card)) {
             i2c_bus_recovery(card);
         }
-        if (card->over_temp_cnt++ >= LC_OVER_TEMP_NUM) {
+        card->over_temp_cnt += swpsPolling.ticks;
+        if (card->over_temp_cnt > LC_OVER_TEMP_NUM) {
             card->over_temp_cnt = 0;
 
             check_pfunc(lc_func->over_temp_asserted);
@@ -4270,6 +4596,7 @@ static void i2c_bus_recovery(struct lc_obj_t *card)
     if (!i2c_bus_recovery_is_supported()) {
         return;
     }
+    sff_fsm_work_flush();
     failed_mux_detect(card);
     SWPS_LOG_ERR("mux reset done\n");
     if (i2c_bus_is_alive(card)) {
@@ -4479,10 +4806,19 @@ static int __init swps_init(void)
         goto exit_err;
         SWPS_LOG_ERR("drv load fail\n");
     }
-    
+
+    swpsWq = alloc_workqueue("swps", WQ_UNBOUND, 0);
+    if (!p_valid(swpsWq)) {
+        SWPS_LOG_ERR("alloc_workqueue fail\n");
+        goto exit_err;
+    }
+    swpsPolling.period_max = msecs_to_jiffies(SWPS_POLLING_PERIOD_MAX_MS);
+
     if(swps_polling_is_enabled()) {
         swps_polling_task_start();
     }
+    /*after polling starts so the lines come up enabled only once*/
+    swps_intr_init(&lcMgr);
     SWPS_LOG_INFO("swps:%s  init ok\n", pltfmInfo->name);
     return 0;
 
@@ -4498,6 +4834,8 @@ static void __exit swps_exit(void)
     if(swps_polling_is_enabled()) {
         swps_polling_task_stop();
     }
+    swps_intr_deinit();
+    destroy_workqueue(swpsWq);
      
     sff_eeprom_deinit();
     lcMgr.lc_func->dev_deinit();
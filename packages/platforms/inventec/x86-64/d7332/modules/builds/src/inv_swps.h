@@ -2,6 +2,7 @@
 #define __SWPS_H
 
 #include <linux/i2c.h>
+#include <linux/workqueue.h>
 #include "sff_spec.h"
 #include "lc_dev.h"
 #include "io_dev.h"
@@ -22,6 +23,15 @@
 #define MUX_CH_NUM  (8)
 
 #define SWPS_POLLING_PERIOD    (msecs_to_jiffies(100))  /* msec */
+/*upper limit of the polling period while all ports are stable*/
+#define SWPS_POLLING_PERIOD_MAX_MS      (1000)
+/*upper limit when presence changes are reported by interrupt*/
+#define SWPS_POLLING_PERIOD_INTR_MAX_MS (5000)
+/*largest value accepted by polling_period_max*/
+#define SWPS_POLLING_PERIOD_LIMIT_MS    (60000)
+#define SWPS_INTR_GPIO_MAX (8)
+/*max SWPS_POLLING_PERIOD units accounted to one polling cycle*/
+#define SWPS_POLLING_TICKS_MAX (20)
 
 #define DYNAMIC_SFF_KOBJ
 
@@ -298,6 +308,8 @@ struct sff_obj_t {
     struct sff_mgr_t *mgr;
     struct func_tbl_t *func_tbl;
     bool page_sel_lock;
+    struct work_struct fsm_work; /*runs fsm.task outside of the polling task*/
+    unsigned long fsm_work_busy;
 };
 struct mux_ch_t {
     int i2c_ch;
@@ -447,6 +459,8 @@ struct lc_func_t {
     int (*mux_reset_set)(int lc_id, int rst);
     int (*mux_reset_get)(int lc_id, int *rst);
     int (*phy_reset_set)(int lc_id, u8 val);
+    /*gpio of the idx-th transceiver interrupt line, -ENODEV after the last one*/
+    int (*intr_gpio_get)(int idx, int *gpio);
 
 };
 struct lc_t {
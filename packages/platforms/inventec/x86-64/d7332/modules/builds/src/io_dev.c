@@ -379,6 +379,7 @@ static int ioexp_i2c_clients_init(struct ioexp_dev_t *ioexp_dev)
             break;
         }
         mutex_init(&(ioexp_client->lock));
+        mutex_init(&(ioexp_client->update_lock));
 
     }
     if (ret < 0) {
@@ -476,6 +477,7 @@ static int cpld_io_i2c_clients_create_init(struct cpld_io_t *cpld_io)
         }
         cpld_io->cpld_client[i].client = client;
         mutex_init(&(cpld_io->cpld_client[i].lock));
+        mutex_init(&(cpld_io->cpld_client[i].update_lock));
 
     }
     if (i < size) {
@@ -793,7 +795,10 @@ int ioexp_output_set(struct ioexp_dev_t *dev, ioexp_output_type_t type, int port
         return -1;
     }
 
+    /*port fsm works run concurrently and share the expander output register*/
+    mutex_lock(&ioexp_client->update_lock);
     if ((ret = func->read(ioexp_client, func->offset[PCA95XX_OUTPUT])) < 0) {
+        mutex_unlock(&ioexp_client->update_lock);
         SFF_IO_LOG_ERR("read fail! ioexp_id:%d ch_id:%d addr:0x%x\n",
                        ioexp->ioexp_id, ioexp->ch_id, ioexp->addr);
         return ret;
@@ -806,7 +811,9 @@ int ioexp_output_set(struct ioexp_dev_t *dev, ioexp_output_type_t type, int port
         clear_bit(bit, (unsigned long *)&reg);
     }
 
-    if ((ret = func->write(ioexp_client, func->offset[PCA95XX_OUTPUT], reg)) < 0) {
+    ret = func->write(ioexp_client, func->offset[PCA95XX_OUTPUT], reg);
+    mutex_unlock(&ioexp_client->update_lock);
+    if (ret < 0) {
         return ret;
     }
     SFF_IO_LOG_DBG("%s set ok ch_id:%d addr:0x%x reg:0x%x\n", ioexp_output_name[type], ioexp->ch_id, ioexp->addr, reg);
@@ -890,7 +897,9 @@ int ioexp_output_all_set(struct ioexp_dev_t *dev, ioexp_output_type_t type, unsi
             break;
         }
 
+        mutex_lock(&ioexp_client->update_lock);
         if ((ret = func->read(ioexp_client, func->offset[PCA95XX_OUTPUT])) < 0) {
+            mutex_unlock(&ioexp_client->update_lock);
             SFF_IO_LOG_ERR("read fail! ioexp_id:%d ch_id:%d addr:0x%x\n",
                            ioexp->ioexp_id, ioexp->ch_id, ioexp->addr);
             break;
@@ -898,7 +907,9 @@ int ioexp_output_all_set(struct ioexp_dev_t *dev, ioexp_output_type_t type, unsi
         reg = ret;
         set_reg_update(ioexp, bitmap, &reg);
 
-        if ((ret = func->write(ioexp_client, func->offset[PCA95XX_OUTPUT], reg)) < 0) {
+        ret = func->write(ioexp_client, func->offset[PCA95XX_OUTPUT], reg);
+        mutex_unlock(&ioexp_client->update_lock);
+        if (ret < 0) {
             break;
         }
 
@@ -1202,6 +1213,18 @@ int io_dev_hdlr(void)
     check_pfunc(ioexp_dev->input_hdlr);
     return ioexp_dev->input_hdlr(ioexp_dev);
 }
+/*the cpld ioexp interrupt line, only when interrupt mode is supported*/
+int io_dev_intr_gpio_get(int idx, int *gpio)
+{
+    if (!ioDev.intr_mode_supported) {
+        return -ENOSYS;
+    }
+    if (0 != idx) {
+        return -ENODEV;
+    }
+    *gpio = ioDev.cpld_io.config->sff_intr_gpio;
+    return 0;
+}
 int ioexp_input_handler(void)
 {
     struct ioexp_dev_t *ioexp_dev = &ioDev.ioexp_dev;
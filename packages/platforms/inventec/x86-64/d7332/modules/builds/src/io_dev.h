@@ -94,6 +94,8 @@ struct i2c_ch_map_t {
 struct io_dev_client_t {
     struct i2c_client *client;
     struct mutex lock;
+    /*serializes read-modify-write of the output registers*/
+    struct mutex update_lock;
 };
 
 struct ioexp_dev_t {
@@ -162,4 +164,5 @@ bool ioexp_is_i2c_ready(void);
 int io_dev_init(int platform_id, int io_no_init);
 void io_dev_deinit(void);
 int io_dev_hdlr(void);
+int io_dev_intr_gpio_get(int idx, int *gpio);
 #endif /*__IO_DEV_H*/
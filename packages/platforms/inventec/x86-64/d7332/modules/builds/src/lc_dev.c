@@ -270,6 +270,8 @@ typedef enum {
 struct lc_client_t {
 
     struct mutex lock;
+    /*serializes read-modify-write of the sff output registers*/
+    struct mutex update_lock;
     struct i2c_client *client;
 };
 
@@ -752,6 +754,7 @@ int lc_i2c_client_init_all(struct lc_dev_t *self)
             break;
         }
         mutex_init(&(lc_client->lock));
+        mutex_init(&(lc_client->update_lock));
 
     }
     if (ret < 0) {
@@ -1133,7 +1136,10 @@ static int lc_sff_output_bitmap_set(lc_sff_output_type_t type, int lc_id, int po
         return -EBADRQC;
     }
     
-    if ((ret = lc_i2c_smbus_write_word_data(lc_client, offset, val)) < 0) {
+    mutex_lock(&lc_client->update_lock);
+    ret = lc_i2c_smbus_write_word_data(lc_client, offset, val);
+    mutex_unlock(&lc_client->update_lock);
+    if (ret < 0) {
         return ret;
     }
 
@@ -1169,7 +1175,10 @@ static int lc_sff_output_set(lc_sff_output_type_t type, int lc_id, int port, u8
         return -EBADRQC;
     }
     
+    /*port fsm works run concurrently and share the cpld output register*/
+    mutex_lock(&lc_client->update_lock);
     if((ret = lc_i2c_smbus_read_word_data(lc_client, offset)) < 0) {
+        mutex_unlock(&lc_client->update_lock);
         return ret;
     }
 
@@ -1183,7 +1192,9 @@ static int lc_sff_output_set(lc_sff_output_type_t type, int lc_id, int port, u8
     /*debug*/
     LC_DEV_LOG_DBG("%s lc_id:%d port:%d val:%d\n", lc_sff_output_name[type], lc_id, port, val);
     
-    if ((ret = lc_i2c_smbus_write_word_data(lc_client, offset, reg)) < 0) {
+    ret = lc_i2c_smbus_write_word_data(lc_client, offset, reg);
+    mutex_unlock(&lc_client->update_lock);
+    if (ret < 0) {
         return ret;
     }
 
@@ -1216,7 +1227,10 @@ static int lc_sff_output_all_set(lc_sff_output_type_t type, int lc_id, unsigned
             ret = -EBADRQC;
             break;
         }
-        if ((ret = lc_i2c_smbus_write_word_data(lc_client, offset, reg[port_grp])) < 0) {
+        mutex_lock(&lc_client->update_lock);
+        ret = lc_i2c_smbus_write_word_data(lc_client, offset, reg[port_grp]);
+        mutex_unlock(&lc_client->update_lock);
+        if (ret < 0) {
             break;
         }
     }
@@ -2683,6 +2697,18 @@ int lc_dev_hdlr(void)
 #endif    
     return 0;
 }
+/*idx 0 ~ CARD_NUM-1: per card sff interrupt, CARD_NUM: card presence interrupt*/
+int lc_dev_intr_gpio_get(int idx, int *gpio)
+{
+    if (idx < CARD_NUM) {
+        *gpio = lcDev.obj[idx].sff_intr_gpio;
+    } else if (CARD_NUM == idx) {
+        *gpio = lcDev.lc_intr_gpio;
+    } else {
+        return -ENODEV;
+    }
+    return 0;
+}
 static int intr_gpio_init(struct lc_dev_t *mgr)
 {
     int ret = 0;
@@ -40,6 +40,7 @@ int lc_dev_led_st_get(int lc_id, lc_led_ctrl_t *ctrl);
 int lc_dev_init(int platform_id, int io_no_init);
 void lc_dev_deinit(void);
 int lc_dev_hdlr(void);
+int lc_dev_intr_gpio_get(int idx, int *gpio);
 struct sff_io_driver_t *sff_io_drv_get_lcdev(void);
 int lc_dev_over_temp_asserted(int lc_id, bool *asserted);
 int lc_dev_over_temp_deasserted(int lc_id, bool *deasserted);
@@ -3,6 +3,9 @@
 import argparse
 import sys
 import os
+import time
+import struct
+import hashlib
 import zipfile
 import json
 import apt_inst
@@ -10,6 +13,32 @@ import onlu
 
 logger = onlu.init_logging('switool')
 
+#
+# The rootfs squashfs is stored uncompressed with its data starting on
+# a page boundary so the loader can attach it with 'losetup -o' straight
+# out of the SWI. The 'swi-index' member lists the data offset and size
+# of every aligned member, one "name offset size" line each.
+#
+SWI_INDEX = 'swi-index'
+SWI_ALIGN = 4096
+
+# Same extra field layout as Android's zipalign: alignment, then padding.
+ZIP_ALIGN_EXTRA_ID = 0xd935
+
+#
+# The 'swi-digests' member holds sha1 digests of every member's contents
+# in SWI_DIGEST_CHUNK sized pieces. The loader's swicache.py uses the
+# digest of this member to identify a SWI without hashing all of it.
+#
+SWI_DIGESTS = 'swi-digests'
+SWI_DIGEST_CHUNK = 4 * 1024 * 1024
+
+def chunk_digests(f, chunk=SWI_DIGEST_CHUNK):
+    digests = []
+    for block in iter(lambda: f.read(chunk), b''):
+        digests.append(hashlib.sha1(block).hexdigest())
+    return digests
+
 class OnlSwitchImage(object):
 
     def __init__(self, fname, mode):
@@ -17,12 +46,93 @@ class OnlSwitchImage(object):
         self.mode = mode
         self.zipfile = zipfile.ZipFile(fname, mode=mode)
         self.manifest = None
+        self.index = []
+        self.digests = {}
 
     def add(self, fname, arcname=None, compressed=True):
-        self.zipfile.write(fname, arcname=arcname, compress_type = zipfile.ZIP_DEFLATED if compressed else zipefile.ZIP_STORED)
+        self.zipfile.write(fname, arcname=arcname, compress_type = zipfile.ZIP_DEFLATED if compressed else zipfile.ZIP_STORED)
+        with open(fname, 'rb') as f:
+            self.digests[self.zipfile.filelist[-1].filename] = chunk_digests(f)
+
+    def add_aligned(self, fname, arcname=None, align=SWI_ALIGN):
+        """Store fname uncompressed with its data aligned to 'align' bytes."""
+        if arcname is None:
+            arcname = os.path.basename(fname)
+
+        st = os.stat(fname)
+        zinfo = zipfile.ZipInfo(arcname, time.localtime(st.st_mtime)[0:6])
+        zinfo.external_attr = (st.st_mode & 0xFFFF) << 16L
+        zinfo.compress_type = zipfile.ZIP_STORED
+        zinfo.file_size = zinfo.compress_size = st.st_size
+
+        crc = 0
+        digests = []
+        with open(fname, 'rb') as f:
+            for chunk in iter(lambda: f.read(SWI_DIGEST_CHUNK), b''):
+                crc = zipfile.crc32(chunk, crc)
+                digests.append(hashlib.sha1(chunk).hexdigest())
+        zinfo.CRC = crc & 0xffffffff
+
+        fp = self.zipfile.fp
+        zip64 = st.st_size > zipfile.ZIP64_LIMIT
+        zinfo.header_offset = fp.tell()
+        self.zipfile._writecheck(zinfo)
+
+        # Size the padding so the file data lands on the boundary.
+        hdrlen = len(zinfo.FileHeader(zip64)) + 6
+        pad = -(zinfo.header_offset + hdrlen) % align
+        zinfo.extra = struct.pack('<HHH', ZIP_ALIGN_EXTRA_ID, 2 + pad, align) + '\0' * pad
+
+        fp.write(zinfo.FileHeader(zip64))
+        offset = fp.tell()
+        if offset % align:
+            raise ValueError("%s: misaligned data offset %d" % (arcname, offset))
+
+        with open(fname, 'rb') as f:
+            for chunk in iter(lambda: f.read(1 << 20), b''):
+                fp.write(chunk)
+
+        self.zipfile.filelist.append(zinfo)
+        self.zipfile.NameToInfo[zinfo.filename] = zinfo
+        self.zipfile._didModify = True
+
+        self.index.append((arcname, offset, st.st_size))
+        self.digests[arcname] = digests
 
     def add_rootfs(self, rootfs_sqsh):
-        self.add(rootfs_sqsh)
+        self.add_aligned(rootfs_sqsh)
+
+    def add_index(self):
+        data = "".join("%s %d %d\n" % entry for entry in self.index)
+        self.zipfile.writestr(SWI_INDEX, data, zipfile.ZIP_DEFLATED)
+
+    def get_index(self):
+        if SWI_INDEX not in self.zipfile.namelist():
+            return None
+        index = {}
+        for line in self.zipfile.read(SWI_INDEX).splitlines():
+            (name, offset, size) = line.split()
+            index[name] = (int(offset), int(size))
+        return index
+
+    def add_digests(self):
+        data = json.dumps(dict(algorithm='sha1',
+                               chunk_size=SWI_DIGEST_CHUNK,
+                               members=self.digests),
+                          indent=2, sort_keys=True)
+        self.zipfile.writestr(SWI_DIGESTS, data, zipfile.ZIP_DEFLATED)
+
+    def get_digests(self):
+        if SWI_DIGESTS not in self.zipfile.namelist():
+            return None
+        return json.loads(self.zipfile.read(SWI_DIGESTS))
+
+    def close(self):
+        if self.mode != 'r' and self.index:
+            self.add_index()
+        if self.mode != 'r' and self.digests:
+            self.add_digests()
+        self.zipfile.close()
 
     def add_manifest(self, manifest):
         self.add(manifest, arcname="manifest.json")
@@ -56,6 +166,7 @@ ap.add_argument('--manifest', help='SWI Manifest file.')
 ap.add_argument('--add-files', help='Add additional files.', default=[], nargs='+')
 ap.add_argument("--contents", help='Show SWI contents.', action='store_true')
 ap.add_argument("--platforms", help='Show SWI contents.', action='store_true')
+ap.add_argument("--index", help='Show offsets of aligned SWI members.', action='store_true')
 ap.add_argument('swi', help='SWI image name.')
 
 ops = ap.parse_args()
@@ -81,6 +192,8 @@ if ops.create or ops.overwrite:
     swi.add_manifest(ops.manifest)
     for f in ops.add_files:
         swi.add(f, arcname=f)
+    swi.close()
+    swi = OnlSwitchImage(ops.swi, 'r')
 
 if swi is None:
 
@@ -95,3 +208,7 @@ if ops.contents:
 
 if ops.platforms:
     print " ".join(swi.get_platforms())
+
+if ops.index:
+    for (name, (offset, size)) in sorted((swi.get_index() or {}).items()):
+        print "%s %d %d" % (name, offset, size)